@@ -58,6 +58,14 @@ namespace solv
         auto noarch() const -> std::string_view;
         auto sha256() const -> std::string_view;
         auto signatures() const -> std::string_view;
+
+        /**
+         * The signatures of the solvable as an opaque table of bytes.
+         *
+         * @see ObjSolvableView::set_signatures_table
+         **/
+        auto signatures_table() const -> std::string_view;
+
         auto size() const -> std::size_t;
         auto timestamp() const -> std::size_t;
 
@@ -219,6 +227,18 @@ namespace solv
         void set_signatures(raw_str_view str) const;
         void set_signatures(const std::string& str) const;
 
+        /**
+         * Set the signatures of the solvable file as an opaque table of bytes.
+         *
+         * The bytes are stored under a dedicated binary key, without the overhead of a string
+         * in the pool and in solv files.
+         * This is not used by libsolv and is purely for data storing.
+         *
+         * @note A call to @ref ObjRepoView::internalize is required for this attribute to
+         *       be available for lookup.
+         */
+        void set_signatures_table(std::string_view bytes) const;
+
         /**
          * Set the size of the solvable size.
          *
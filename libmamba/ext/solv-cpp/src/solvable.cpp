@@ -19,6 +19,12 @@
 
 namespace solv
 {
+    namespace
+    {
+        // Not a libsolv known id, the key is created in the pool string table on first use
+        constexpr const char* signatures_table_key = "solvable:mamba:signaturetable";
+    }
+
     /********************************************
      *  Implementation of ConstObjSolvableView  *
      ********************************************/
@@ -318,6 +324,36 @@ namespace solv
         return set_signatures(str.c_str());
     }
 
+    auto ObjSolvableViewConst::signatures_table() const -> std::string_view
+    {
+        ::Repo* repo = raw()->repo;
+        const ::Id key = ::pool_str2id(repo->pool, signatures_table_key, /* create= */ 0);
+        if (key == 0)
+        {
+            return {};
+        }
+        int size = 0;
+        const void* data = ::repo_lookup_binary(repo, id(), key, &size);
+        if (data == nullptr)
+        {
+            return {};
+        }
+        return { static_cast<const char*>(data), static_cast<std::size_t>(size) };
+    }
+
+    void ObjSolvableView::set_signatures_table(std::string_view bytes) const
+    {
+        ::Repo* repo = raw()->repo;
+        const ::Id key = ::pool_str2id(repo->pool, signatures_table_key, /* create= */ 1);
+        ::repodata_set_binary(
+            ::repo_last_repodata(repo),
+            id(),
+            key,
+            const_cast<char*>(bytes.data()),
+            static_cast<int>(bytes.size())
+        );
+    }
+
     auto ObjSolvableViewConst::size() const -> std::size_t
     {
         return ::solvable_lookup_num(const_cast<::Solvable*>(raw()), SOLVABLE_DOWNLOADSIZE, 0);
@@ -4,6 +4,8 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <string_view>
+
 #include <catch2/catch_all.hpp>
 
 #include "solv-cpp/pool.hpp"
@@ -102,6 +104,16 @@ namespace
                 REQUIRE(solv.platform() == "linux-64");
                 REQUIRE(solv.type() == SolvableType::Virtualpackage);
 
+                SECTION("Signatures table")
+                {
+                    using namespace std::string_view_literals;
+                    const auto table = "\x01\x00\x02\xff"sv;
+                    solv.set_signatures_table(table);
+                    REQUIRE(solv.signatures_table() == "");
+                    repo.internalize();
+                    REQUIRE(solv.signatures_table() == table);
+                }
+
                 SECTION("Override attribute")
                 {
                     solv.set_license("GPL");
@@ -123,6 +135,7 @@ namespace
             REQUIRE(solv.md5() == "");
             REQUIRE(solv.sha256() == "");
             REQUIRE(solv.signatures() == "");
+            REQUIRE(solv.signatures_table() == "");
             REQUIRE(solv.noarch() == "");
             REQUIRE(solv.size() == 0);
             REQUIRE(solv.timestamp() == 0);
@@ -8,6 +8,7 @@
 #define MAMBA_API_CONFIGURATION_HPP
 
 #include <functional>
+#include <memory>
 
 #include <yaml-cpp/yaml.h>
 
@@ -103,6 +104,8 @@ namespace mamba
 {
     namespace detail
     {
+        struct RCSnapshot;
+
         struct ConfigurableImplBase
         {
             virtual ~ConfigurableImplBase() = default;
@@ -473,6 +476,7 @@ namespace mamba
         std::vector<fs::u8path> m_sources;
         std::vector<fs::u8path> m_valid_sources;
         std::map<fs::u8path, YAML::Node> m_rc_yaml_nodes_cache;
+        std::unique_ptr<detail::RCSnapshot> m_rc_snapshot;
 
         bool m_load_lock = false;
 
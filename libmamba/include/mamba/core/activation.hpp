@@ -7,11 +7,14 @@
 #ifndef MAMBA_CORE_ACTIVATION_HPP
 #define MAMBA_CORE_ACTIVATION_HPP
 
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <nlohmann/json_fwd.hpp>
+
 #include "mamba/fs/filesystem.hpp"
 
 // TODO write a map that keeps insertion order
@@ -102,6 +105,22 @@ namespace mamba
         ActivationType m_action;
 
         std::unordered_map<std::string, std::string> m_env;
+
+    private:
+
+        std::string activation_cache_key(const fs::u8path& prefix);
+        nlohmann::json activation_cache_stamps(const fs::u8path& prefix);
+        std::optional<EnvironmentTransform> read_activation_cache(
+            const fs::u8path& cache_file,
+            const std::string& key,
+            const fs::u8path& prefix
+        );
+        void write_activation_cache(
+            const fs::u8path& cache_file,
+            const std::string& key,
+            nlohmann::json stamps,
+            const EnvironmentTransform& envt
+        );
     };
 
     class PosixActivator : public Activator
@@ -81,6 +81,7 @@ namespace mamba
             bool json{ false };
             bool quiet{ false };
             int verbosity{ 0 };
+            bool async_logging{ false };
         };
 
         struct GraphicsParams
@@ -93,6 +94,7 @@ namespace mamba
         {
             bool no_rc{ false };
             bool no_env{ false };
+            bool no_rc_snapshot{ false };
         };
 
         // Configurable
@@ -115,9 +117,15 @@ namespace mamba
         bool auto_activate_base = false;
 
         bool extract_sparse = false;
+        bool extract_while_downloading = false;
 
         bool dry_run = false;
         bool download_only = false;
+        std::size_t download_chunk_min_size = 64 * 1024 * 1024;
+        std::size_t download_max_speed = 0;
+        std::size_t download_max_host_connections = 0;
+        std::string download_coordinator = "";
+        std::string trace_file = "";
         bool always_yes = false;
 
         bool register_envs = true;
@@ -139,6 +147,7 @@ namespace mamba
         bool ascii_only = false;
         // micromamba only
         bool shell_completion = true;
+        bool use_activation_cache = true;
 
         OutputParams output_params;
         GraphicsParams graphics_params;
@@ -168,6 +177,10 @@ namespace mamba
                 .fail_fast = false,
                 .sort = true,
                 .verbose = this->output_params.verbosity >= 2,
+                .chunk_min_size = this->download_chunk_min_size,
+                .max_speed_Bps = this->download_max_speed,
+                .max_host_connections = this->download_max_host_connections,
+                .coordinator_socket = this->download_coordinator,
             };
         }
 
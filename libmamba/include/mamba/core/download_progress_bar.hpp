@@ -54,8 +54,6 @@ namespace mamba
 
         void complete_checking_progress_bar(std::size_t index);
 
-        using time_point = std::chrono::steady_clock::time_point;
-        std::vector<time_point> m_throttle_time;
         std::vector<ProgressProxy> m_progress_bar;
         MonitorOptions m_options;
     };
@@ -104,9 +102,6 @@ namespace mamba
         void update_progress_bar(std::size_t index, const download::Success& success);
 
         std::vector<ProgressProxy> m_extract_bar;
-
-        using time_point = std::chrono::steady_clock::time_point;
-        std::vector<time_point> m_throttle_time;
         std::vector<ProgressProxy> m_download_bar;
     };
 }
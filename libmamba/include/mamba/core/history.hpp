@@ -52,11 +52,25 @@ namespace mamba
         std::vector<ParseResult> parse();
         bool parse_comment_line(const std::string& line, UserRequest& req);
         std::vector<UserRequest> get_user_requests();
+        /**
+         * The user requests from the given revision onward.
+         *
+         * Only the end of the history is parsed, starting at the revision offset found in
+         * the history index.
+         */
+        std::vector<UserRequest> get_user_requests_from_revision(std::size_t revision);
+        /**
+         * The specs requested by the user, as of the last entry of the history.
+         *
+         * The specs are kept in the history index, only the entries added since the last
+         * call are parsed.
+         */
         std::unordered_map<std::string, specs::MatchSpec> get_requested_specs_map();
         void add_entry(const History::UserRequest& entry);
 
         fs::u8path m_prefix;
         fs::u8path m_history_file_path;
+        fs::u8path m_index_file_path;
         ChannelContext& m_channel_context;
     };
 
@@ -72,6 +86,10 @@ namespace mamba
 
         [[nodiscard]] static PackageDiff
         from_revision(const std::vector<History::UserRequest>& user_requests, std::size_t target_revision);
+
+        /** Same as above, only reading the history from the target revision onward. */
+        [[nodiscard]] static PackageDiff
+        from_revision(History& history, std::size_t target_revision);
     };
 
     /** The following function parses the different formats that can be found in the history
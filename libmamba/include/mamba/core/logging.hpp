@@ -80,8 +80,29 @@
 #undef LOG_ERROR
 #undef LOG_CRITICAL
 
+// Minimum level of the log records emitted through the `LOG` macros, set at compile time from
+// the `BUILD_LOG_LEVEL` CMake option. The records below it are removed from the binary.
 // clang-format off
-#define LOG(severity)   mamba::logging::MessageLogger(severity).stream()
+#define MAMBA_LOG_LEVEL_TRACE       0
+#define MAMBA_LOG_LEVEL_DEBUG       1
+#define MAMBA_LOG_LEVEL_INFO        2
+#define MAMBA_LOG_LEVEL_WARN        3
+#define MAMBA_LOG_LEVEL_ERROR       4
+#define MAMBA_LOG_LEVEL_CRITICAL    5
+#define MAMBA_LOG_LEVEL_OFF         6
+// clang-format on
+
+#ifndef MAMBA_ACTIVE_LOG_LEVEL
+#define MAMBA_ACTIVE_LOG_LEVEL MAMBA_LOG_LEVEL_TRACE
+#endif
+
+// The streamed arguments are only evaluated if the record would not be filtered out,
+// @see `mamba::logging::is_log_enabled`.
+// clang-format off
+#define LOG(severity)                                                                   \
+    !mamba::logging::is_log_enabled(severity)                                           \
+        ? (void) 0                                                                      \
+        : mamba::logging::details::LogVoidify() & mamba::logging::MessageLogger(severity).stream()
 #define LOG_TRACE       LOG(mamba::log_level::trace)
 #define LOG_DEBUG       LOG(mamba::log_level::debug)
 #define LOG_INFO        LOG(mamba::log_level::info)
@@ -966,8 +987,35 @@ namespace mamba
             static void emit(LogRecord log_record);
         };
 
+        /** Minimum level of the log records emitted through the `LOG` macros, set at compile
+            time by defining `MAMBA_ACTIVE_LOG_LEVEL`.
+        */
+        inline constexpr log_level active_log_level = static_cast<log_level>(
+            MAMBA_ACTIVE_LOG_LEVEL
+        );
+
+        /** @returns `false` if a log record of the provided level would certainly be filtered
+            out, either because it is below `active_log_level` or because it is below the current
+            log level while no backtrace is kept.
+
+            Used by the `LOG` macros to avoid building the messages of such records.
+            This call is thread-safe.
+        */
+        auto is_log_enabled(log_level level) -> bool;
+
         namespace details
         {
+            auto is_runtime_log_enabled(log_level level) -> bool;
+
+            // Turns the stream expression of the `LOG` macros into `void` to match the other
+            // branch of the conditional.
+            struct LogVoidify
+            {
+                auto operator&(std::ostream&) const -> void
+                {
+                }
+            };
+
             // NOTE: this looks complicated because it's a workaround for `std::vector`
             // implementations which are not `constexpr` (required by c++20), we defer the vector
             // creation to the moment it's needed. Constexpr constructor is required for a type
@@ -1021,15 +1069,9 @@ namespace mamba::logging
         call_log_handler_if_existing(&AnyLogHandler::log, std::move(record));
     }
 
-    inline auto enable_backtrace(size_t records_buffer_size) -> void
-    {
-        call_log_handler_if_existing(&AnyLogHandler::enable_backtrace, records_buffer_size);
-    }
-
-    // as thread-safe as handler's implementation if set
-    inline auto disable_backtrace() -> void
+    inline auto is_log_enabled(log_level level) -> bool
     {
-        call_log_handler_if_existing(&AnyLogHandler::enable_backtrace, 0);
+        return level >= active_log_level and details::is_runtime_log_enabled(level);
     }
 
     // as thread-safe as handler's implementation if set
@@ -0,0 +1,141 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_CORE_LOGGING_ASYNC_HPP
+#define MAMBA_CORE_LOGGING_ASYNC_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mamba/core/logging.hpp>
+
+namespace mamba::logging
+{
+    struct LogHandler_Async_Options  // not nested type because clang and gcc dont like it
+    {
+        /** Number of log records each logging thread can have pending before they are dropped.
+         */
+        std::size_t buffer_size = 4096;
+
+        /** Maximum time between two deliveries of the pending log records to the backend. */
+        std::chrono::milliseconds flush_interval{ 50 };
+    };
+
+    /** `LogHandler` delivering log records to another log handler from a background thread.
+
+        Logging threads only move their log records into a per-thread lock-free ring buffer,
+        the formatting and writing of the records is done by the backend log handler on a
+        flusher thread. The records of a thread keep their order, the records of different
+        threads are delivered in the order they were pushed in.
+
+        When the buffer of a thread is full, its records below the `warn` level are dropped
+        and counted, while records of higher levels are delivered synchronously.
+        Records at or above the flush threshold are also delivered synchronously, followed by
+        a flush of the backend.
+
+        All the other operations first deliver the pending log records to the backend, so that
+        they see the same records as with a synchronous log handler. Stopping the handler
+        delivers all the pending records, except at program exit where they are delivered by an
+        `atexit` hook, while the backend is still alive.
+
+        @see `mamba::logging::LogHandler`
+    */
+    class LogHandler_Async
+    {
+    public:
+
+        using Options = LogHandler_Async_Options;
+
+        /** Constructor taking the log handler the log records will be delivered to, either
+            moved in or as a pointer, as for `AnyLogHandler`.
+
+            post-condition: `is_started() == false` until `start_log_handler` is called.
+        */
+        template <LogHandlerOrPtr T>
+            requires(not std::is_same_v<std::remove_cvref_t<T>, LogHandler_Async>)
+        explicit LogHandler_Async(T&& backend, Options options = Options{})
+            : LogHandler_Async(AnyLogHandler(std::forward<T>(backend)), std::move(options), 0)
+        {
+        }
+
+        ~LogHandler_Async();
+
+        LogHandler_Async(const LogHandler_Async& other) = delete;
+        LogHandler_Async& operator=(const LogHandler_Async& other) = delete;
+
+        LogHandler_Async(LogHandler_Async&& other) noexcept;
+        LogHandler_Async& operator=(LogHandler_Async&& other) noexcept;
+
+        /** `LogHandler` API implementation, @see mamba::logging::LogHandler for the expected
+           behavior.
+
+            All these functions are thread-safe except for `start_log_handling` and
+           `stop_log_handling`.
+
+            pre-conditions:
+                - `is_started() == true`, except for `start_log_handling` and `stop_log_handling`
+                  which don't require this pre-condition.
+
+            post-conditions:
+                - after `start_log_handling` call:`is_started() == true`;
+                - after `stop_log_handling` call: `is_started() == false`.
+        */
+        ///@{
+        auto start_log_handling(LoggingParams params, std::vector<log_source> sources) -> void;
+        auto stop_log_handling(stop_reason reason) -> void;
+
+        auto set_log_level(log_level new_level) -> void;
+        auto set_params(LoggingParams new_params) -> void;
+
+        auto log(LogRecord record) -> void;
+
+        auto enable_backtrace(size_t record_buffer_size) -> void;
+        auto log_backtrace() -> void;
+        auto log_backtrace_no_guards() -> void;
+
+        auto flush(std::optional<log_source> source = {}) -> void;
+
+        auto set_flush_threshold(log_level threshold_level) -> void;
+        ///@}
+
+        /** @returns `true` after `start_log_handling` has been called and `stop_log_handling` was
+            not called since.
+        */
+        auto is_started() const -> bool;
+
+        /** @returns The number of log records dropped because a logging thread buffer was full.
+         */
+        auto dropped_count() const -> std::uint64_t;
+
+        /** @returns The options this log handler has been constructed with. */
+        auto get_options() const -> const Options&;
+
+    private:
+
+        LogHandler_Async(AnyLogHandler backend, Options options, int);
+
+        struct Impl;
+        std::unique_ptr<Impl> pimpl;
+    };
+
+    static_assert(LogHandler<LogHandler_Async>);
+
+    /** Replaces the registered log handler, if any, by a `LogHandler_Async` delivering the log
+        records to it.
+
+        Does nothing if the registered log handler is already a `LogHandler_Async`.
+        This call is NOT thread-safe.
+    */
+    auto use_async_log_handler(LogHandler_Async_Options options = {}) -> void;
+}
+
+#endif
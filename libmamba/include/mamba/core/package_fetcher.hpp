@@ -8,6 +8,7 @@
 #define MAMBA_CORE_PACKAGE_FETCHER_HPP
 
 #include <functional>
+#include <memory>
 
 #include "mamba/core/package_cache.hpp"
 #include "mamba/core/package_handling.hpp"
@@ -93,6 +94,7 @@ namespace mamba
 
         // The PackageFetcher object should be stable in memory (i.e. not moved) after this
         // method has been called, until the PackageExtractTask has been completed.
+        // With streaming extraction, it must be called before build_download_request.
         PackageExtractTask build_extract_task(ExtractOptions options);
 
         void clear_cache() const;
@@ -114,6 +116,8 @@ namespace mamba
         ValidationResult validate_size(std::size_t downloaded_size) const;
         ValidationResult validate_checksum(const CheckSumParams& params) const;
 
+        bool promote_streaming_extraction(const fs::u8path& extract_path);
+
         void write_repodata_record(const fs::u8path& base_path) const;
         void update_urls_txt() const;
 
@@ -127,6 +131,7 @@ namespace mamba
         bool m_needs_download = false;
         std::string m_downloaded_url = {};
         bool m_needs_extract = false;
+        std::shared_ptr<StreamingExtraction> p_streaming_extraction = nullptr;
     };
 
     class PackageFetcherSemaphore
@@ -7,10 +7,12 @@
 #ifndef MAMBA_CORE_PACKAGE_HANDLING_HPP
 #define MAMBA_CORE_PACKAGE_HANDLING_HPP
 
+#include <memory>
 #include <string>
 #include <system_error>
 #include <vector>
 
+#include "mamba/core/error_handling.hpp"
 #include "mamba/fs/filesystem.hpp"
 
 namespace mamba
@@ -31,6 +33,8 @@ namespace mamba
     {
         bool sparse = false;
         extract_subproc_mode subproc_mode;
+        /** Extract ``.conda`` packages while they are downloaded. */
+        bool streaming = false;
         static ExtractOptions from_context(const Context&);
     };
 
@@ -83,6 +87,47 @@ namespace mamba
 
     bool validate(const fs::u8path& pkg_folder, const ValidationParams& params);
 
+    /**
+     * Extracts a ``.conda`` package while it is downloaded.
+     *
+     * The download reports each write to the package file, and a worker thread reads the
+     * data back to unpack it into the destination directory. The writes must be sequential
+     * from the start of the file, otherwise the extraction is abandoned. The destination
+     * directory is removed if the extraction does not succeed.
+     */
+    class StreamingExtraction
+    {
+    public:
+
+        StreamingExtraction(
+            fs::u8path file,
+            std::size_t file_size,
+            fs::u8path dest_dir,
+            ExtractOptions options
+        );
+        ~StreamingExtraction();
+
+        StreamingExtraction(const StreamingExtraction&) = delete;
+        StreamingExtraction& operator=(const StreamingExtraction&) = delete;
+        StreamingExtraction(StreamingExtraction&&) = delete;
+        StreamingExtraction& operator=(StreamingExtraction&&) = delete;
+
+        const fs::u8path& destination() const;
+
+        // Called from the downloading thread, it never waits for the extraction.
+        void on_write(std::size_t offset, std::size_t size);
+
+        // Waits for the extraction of the complete file, and returns the SHA256 of the
+        // data that was extracted.
+        expected_t<std::string> wait();
+
+    private:
+
+        struct Impl;
+
+        std::unique_ptr<Impl> p_impl;
+    };
+
 }  // namespace mamba
 
 #endif  // MAMBA_PACKAGE_HANDLING_HPP
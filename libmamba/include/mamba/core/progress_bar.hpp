@@ -45,6 +45,8 @@ namespace mamba
 
         ProgressProxy& set_progress(std::size_t current, std::size_t total);
         ProgressProxy& update_progress(std::size_t current, std::size_t total);
+        // Lock-free, applied to the bar by the progress bar manager at its next frame
+        ProgressProxy& report_progress(std::size_t current, std::size_t total, std::size_t speed);
         ProgressProxy& set_progress(double progress);
         ProgressProxy& set_current(std::size_t current);
         ProgressProxy& set_in_progress(std::size_t in_progress);
@@ -58,6 +58,28 @@ namespace mamba
         const std::string& specific_process_name
     );
 
+    /**
+     * Replace the current process with the command, run in the activated environment.
+     *
+     * Unlike ``run_in_environment``, the environment is computed by this process with the
+     * POSIX activator rather than a wrapper shell, and the command is not supervised nor
+     * registered in the process directory.
+     * The activation cache is not used, since a fresh process scans the prefix faster than it
+     * reads the cache.
+     * A shell is still used to source the ``activate.d`` scripts when the prefix has some.
+     * Only returns if the command could not be executed, falling back to
+     * ``run_in_environment`` on Windows.
+     */
+    int exec_in_environment(
+        const Context& context,
+        const fs::u8path& prefix,
+        std::vector<std::string> command,
+        const std::string& cwd,
+        int stream_options,
+        bool clean_env,
+        const std::vector<std::string>& env_vars
+    );
+
     nlohmann::json get_all_running_processes_info(
         const std::function<bool(const nlohmann::json&)>& filter = std::function<
             bool(const nlohmann::json&)>()
@@ -72,6 +72,9 @@ namespace mamba
         /** Check if zst is available and freshly checked. */
         [[nodiscard]] auto has_up_to_date_zst() const -> bool;
 
+        /** Check if the zst availability, be it positive or negative, was freshly checked. */
+        [[nodiscard]] auto has_up_to_date_zst_check() const -> bool;
+
         void set_http_metadata(HttpMetadata data);
         void set_zst(bool value);
         void store_file_metadata(const fs::u8path& file);
@@ -126,7 +129,9 @@ namespace mamba
         /**
          * Download the missing, invalid, or outdated indexes as needed in parallel.
          *
-         * It first creates check requests to update some metadata, then download the indexes.
+         * When the zst availability of a subdir is unknown, its zst index is directly requested
+         * with the cache validators, so that a single round trip answers both.
+         * Only the subdirs without zst index are then downloaded again as ``repodata.json``.
          * The result can be inspected with the input subdirs methods, such as
          * @ref valid_cache_found, @ref valid_json_cache_path etc.
          */
@@ -139,7 +144,6 @@ namespace mamba
             const download::mirror_map& mirrors,
             const download::Options& download_options,
             const download::RemoteFetchParams& remote_fetch_params,
-            download::Monitor* check_monitor = nullptr,
             download::Monitor* download_monitor = nullptr
         ) -> expected_t<void>;
         template <typename Subdirs>
@@ -150,7 +154,6 @@ namespace mamba
             const download::mirror_map& mirrors,
             const download::Options& download_options,
             const download::RemoteFetchParams& remote_fetch_params,
-            download::Monitor* check_monitor = nullptr,
             download::Monitor* download_monitor = nullptr
         ) -> expected_t<void>;
 
@@ -201,6 +204,7 @@ namespace mamba
         bool m_valid_cache_found = false;
         bool m_json_cache_valid = false;
         bool m_solv_cache_valid = false;
+        bool m_zst_probe_failed = false;
 
         SubdirIndexLoader(
             const SubdirParams& params,
@@ -232,17 +236,15 @@ namespace mamba
         void refresh_last_write_time(const fs::u8path& json_file, const fs::u8path& solv_file);
 
         template <typename First, typename End>
-        static auto
-        build_all_check_requests(First subdirs_first, End subdirs_last, const SubdirDownloadParams& params)
-            -> download::MultiRequest;
-        auto build_check_requests(const SubdirDownloadParams& params) -> download::MultiRequest;
-
-        template <typename First, typename End>
-        static auto
-        build_all_index_requests(First subdirs_first, End subdirs_last, const SubdirDownloadParams& params)
-            -> download::MultiRequest;
+        static auto build_all_index_requests(
+            First subdirs_first,
+            End subdirs_last,
+            const SubdirDownloadParams& params,
+            bool only_zst_fallbacks
+        ) -> download::MultiRequest;
         auto build_index_request(const SubdirDownloadParams& params)
             -> std::optional<download::Request>;
+        [[nodiscard]] auto must_probe_zst(const SubdirDownloadParams& params) const -> bool;
 
         [[nodiscard]] static auto download_requests(
             download::MultiRequest index_requests,
@@ -293,30 +295,35 @@ namespace mamba
         const download::mirror_map& mirrors,
         const download::Options& download_options,
         const download::RemoteFetchParams& remote_fetch_params,
-        download::Monitor* check_monitor,
         download::Monitor* download_monitor
     ) -> expected_t<void>
     {
         auto result = download_requests(
-            build_all_check_requests(subdirs_first, subdirs_last, subdir_params),
+            build_all_index_requests(subdirs_first, subdirs_last, subdir_params, false),
             auth_info,
             mirrors,
             download_options,
             remote_fetch_params,
-            check_monitor
+            download_monitor
         );
-
-        // Allow to continue if failed checks, unless asked to stop.
-        constexpr auto is_interrupted = [](const auto& e)
-        { return e.error_code() == mamba_error_code::user_interrupted; };
-
-        if (!result.has_value() && result.map_error(is_interrupted).error())
+        if (!result.has_value())
         {
             return result;
         }
 
+        // Second round only for the subdirs whose zst index turned out to be missing
+        auto fallback_requests = build_all_index_requests(
+            subdirs_first,
+            subdirs_last,
+            subdir_params,
+            true
+        );
+        if (fallback_requests.empty())
+        {
+            return result;
+        }
         return download_requests(
-            build_all_index_requests(subdirs_first, subdirs_last, subdir_params),
+            std::move(fallback_requests),
             auth_info,
             mirrors,
             download_options,
@@ -333,7 +340,6 @@ namespace mamba
         const download::mirror_map& mirrors,
         const download::Options& download_options,
         const download::RemoteFetchParams& remote_fetch_params,
-        download::Monitor* check_monitor,
         download::Monitor* download_monitor
     ) -> expected_t<void>
     {
@@ -345,47 +351,16 @@ namespace mamba
             mirrors,
             download_options,
             remote_fetch_params,
-            check_monitor,
             download_monitor
         );
     }
 
-    template <typename First, typename End>
-    auto SubdirIndexLoader::build_all_check_requests(
-        First subdirs_first,
-        End subdirs_last,
-        const SubdirDownloadParams& params
-    ) -> download::MultiRequest
-    {
-        download::MultiRequest requests;
-        for (; subdirs_first != subdirs_last; ++subdirs_first)
-        {
-            // TODO(C++23): We make a special handling of iterators of pointers due to the
-            // difficulty and necessity to create a range of references from Python objects.
-            SubdirIndexLoader* p_subdir = nullptr;
-            if constexpr (std::is_pointer_v<std::remove_reference_t<decltype(*subdirs_first)>>)
-            {
-                p_subdir = *subdirs_first;
-            }
-            else
-            {
-                p_subdir = &(*subdirs_first);
-            }
-
-            if (p_subdir != nullptr && !p_subdir->valid_cache_found())
-            {
-                auto check_list = p_subdir->build_check_requests(params);
-                std::move(check_list.begin(), check_list.end(), std::back_inserter(requests));
-            }
-        }
-        return requests;
-    }
-
     template <typename First, typename End>
     auto SubdirIndexLoader::build_all_index_requests(
         First subdirs_first,
         End subdirs_last,
-        const SubdirDownloadParams& params
+        const SubdirDownloadParams& params,
+        bool only_zst_fallbacks
     ) -> download::MultiRequest
     {
         download::MultiRequest requests;
@@ -403,7 +378,8 @@ namespace mamba
                 p_subdir = &(*subdirs_first);
             }
 
-            if (!p_subdir->valid_cache_found())
+            if (!p_subdir->valid_cache_found()
+                && (!only_zst_fallbacks || p_subdir->m_zst_probe_failed))
             {
                 if (auto request = p_subdir->build_index_request(params))
                 {
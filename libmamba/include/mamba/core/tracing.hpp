@@ -0,0 +1,108 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_CORE_TRACING_HPP
+#define MAMBA_CORE_TRACING_HPP
+
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include "mamba/fs/filesystem.hpp"
+
+namespace mamba::tracing
+{
+    using clock = std::chrono::steady_clock;
+
+    /** @returns `true` if the spans are recorded, between `enable_tracing` and
+        `disable_tracing`.
+    */
+    auto is_tracing_enabled() -> bool;
+
+    auto enable_tracing() -> void;
+    auto disable_tracing() -> void;
+
+    /** Records a span of the calling thread.
+
+        The name must be a string with static storage duration, such as a literal.
+        Does nothing when the tracing is disabled.
+    */
+    auto record_span(
+        std::string_view name,
+        clock::time_point start,
+        clock::time_point end,
+        std::string_view detail = {}
+    ) -> void;
+
+    /** Records a span on a named track rather than on the calling thread.
+
+        This is for operations run concurrently by a single thread, such as the downloads.
+        The span name must be a string with static storage duration, the track name is copied.
+        Does nothing when the tracing is disabled.
+    */
+    auto record_track_span(
+        std::string_view track,
+        std::string_view name,
+        clock::time_point start,
+        clock::time_point end,
+        std::string_view detail = {}
+    ) -> void;
+
+    /** Removes the spans recorded so far by all the threads and tracks. */
+    auto clear_spans() -> void;
+
+    /** @returns The spans recorded so far as Chrome trace-event JSON (chrome://tracing,
+        Perfetto), each thread and named track having its own track.
+    */
+    auto to_trace_events() -> nlohmann::json;
+
+    /** Writes the spans recorded so far as Chrome trace-event JSON to the given file,
+        logging a warning if it cannot be written.
+    */
+    auto write_trace(const fs::u8path& path) -> void;
+
+    /** Records the time spent in a scope as a span of the calling thread.
+
+        When the tracing is disabled, the span only costs the `is_tracing_enabled` check.
+        The name must be a string with static storage duration and the detail, such as the
+        name of the processed package, must outlive the span.
+    */
+    class ScopedSpan
+    {
+    public:
+
+        explicit ScopedSpan(std::string_view name, std::string_view detail = {}) noexcept
+            : m_name(name)
+            , m_detail(detail)
+        {
+            if (is_tracing_enabled())
+            {
+                m_start = clock::now();
+            }
+        }
+
+        ~ScopedSpan()
+        {
+            if (m_start.has_value())
+            {
+                record_span(m_name, m_start.value(), clock::now(), m_detail);
+            }
+        }
+
+        ScopedSpan(const ScopedSpan&) = delete;
+        ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    private:
+
+        std::string_view m_name;
+        std::string_view m_detail;
+        std::optional<clock::time_point> m_start;
+    };
+}
+
+#endif
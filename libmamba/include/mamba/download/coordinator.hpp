@@ -0,0 +1,80 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_DOWNLOAD_COORDINATOR_HPP
+#define MAMBA_DOWNLOAD_COORDINATOR_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include "mamba/download/parameters.hpp"
+#include "mamba/fs/filesystem.hpp"
+#include "mamba/specs/authentication_info.hpp"
+
+namespace mamba::download
+{
+    /*
+     * Bounds of the artifacts kept in the staging directory of a FetchCoordinator to be served
+     * again, the least recently requested ones being removed first.
+     */
+    struct StagingLimits
+    {
+        std::size_t max_size = std::size_t(10) << 30;
+        std::chrono::seconds max_age = std::chrono::hours(24);
+    };
+
+    /*
+     * FetchCoordinator
+     *
+     * Downloads on behalf of the processes of a host, which send their requests through a
+     * Unix socket when their Options::coordinator_socket is set. An artifact requested by
+     * several processes at the same time is downloaded once, in a staging directory, and
+     * each process gets a copy of it. Artifacts with a SHA256 are immutable and, once their
+     * size and checksum are verified, are served again from the staging directory to later
+     * requests, within the StagingLimits and until a client reports that they failed its
+     * validation.
+     * A client falls back to downloading in process when the coordinator stops answering.
+     */
+    class FetchCoordinator
+    {
+    public:
+
+        FetchCoordinator(
+            fs::u8path socket_path,
+            fs::u8path staging_dir,
+            const RemoteFetchParams& params,
+            const specs::AuthenticationDataBase& auth_info,
+            Options options,
+            StagingLimits limits = {}
+        );
+        ~FetchCoordinator();
+
+        FetchCoordinator(const FetchCoordinator&) = delete;
+        FetchCoordinator& operator=(const FetchCoordinator&) = delete;
+        FetchCoordinator(FetchCoordinator&&) = delete;
+        FetchCoordinator& operator=(FetchCoordinator&&) = delete;
+
+        // Serves the requests until stop is called or the process is interrupted.
+        void serve();
+        void stop();
+
+        // Number of artifacts requested by the clients, and downloaded by the coordinator.
+        [[nodiscard]] std::size_t requested_count() const;
+        [[nodiscard]] std::size_t downloaded_count() const;
+
+        // Whether the coordinator can run on this platform.
+        static bool is_supported();
+
+    private:
+
+        struct Impl;
+
+        std::unique_ptr<Impl> p_impl;
+    };
+}
+
+#endif
@@ -0,0 +1,76 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_DOWNLOAD_METRICS_HPP
+#define MAMBA_DOWNLOAD_METRICS_HPP
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include "mamba/download/request.hpp"
+
+namespace mamba::download
+{
+    /*
+     * TransferMetrics
+     *
+     * Records the attempts made to download the observed requests, with their timings,
+     * to report them as JSON.
+     * When the tracing is enabled, each attempt and its phases are also recorded as spans of
+     * the command trace, on a track named after the request.
+     * The recording starts with the construction of this object.
+     */
+    class TransferMetrics
+    {
+    public:
+
+        using clock = std::chrono::steady_clock;
+
+        TransferMetrics();
+
+        TransferMetrics(const TransferMetrics&) = delete;
+        TransferMetrics& operator=(const TransferMetrics&) = delete;
+        TransferMetrics(TransferMetrics&&) = delete;
+        TransferMetrics& operator=(TransferMetrics&&) = delete;
+
+        // Chains a recorder to the progress callback of the requests, which must
+        // not outlive this object.
+        void observe(MultiRequest& requests);
+
+        // Per-request and total metrics of the recorded transfers.
+        [[nodiscard]] nlohmann::json to_json() const;
+
+    private:
+
+        struct Attempt
+        {
+            clock::time_point end;
+            std::optional<TransferData> transfer;
+            std::string error;
+        };
+
+        struct Record
+        {
+            std::string name;
+            std::vector<Attempt> attempts;
+            bool success = false;
+        };
+
+        void record(std::size_t index, const Event& event);
+
+        clock::time_point m_start;
+        mutable std::mutex m_mutex;
+        std::deque<Record> m_records;
+    };
+}
+
+#endif
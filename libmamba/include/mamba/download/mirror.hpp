@@ -66,9 +66,19 @@ namespace mamba::download
         MirrorRequest& operator=(MirrorRequest&&) = default;
     };
 
+    // Measured performance of a mirror, kept as exponentially weighted moving averages
+    // so that recent transfers weigh more. It is persisted between runs by the mirror_map.
+    struct MirrorPerformance
+    {
+        std::size_t measured_transfers = 0;
+        double throughput_Bps = 0.;
+        double time_to_first_byte_s = 0.;
+    };
+
     struct MirrorStats  // Moved out of Mirror internals because of compilers not agreeing:
                         // https://godbolt.org/z/GcjWhrb9W
     {
+        MirrorPerformance performance = {};
         std::optional<std::size_t> allowed_connections = std::nullopt;
         std::size_t max_tried_connections = 0;
         std::size_t running_transfers = 0;
@@ -97,9 +107,22 @@ namespace mamba::download
         request_generator_list
         get_request_generators(const std::string& url_path, const std::string& spec_sha256) const;
 
+        // Host receiving the requests for the artifact at `url_path`, including the port if any.
+        // It is empty for local files.
+        std::string host(const std::string& url_path) const;
+
         std::size_t max_retries() const;
         std::size_t successful_transfers() const;
         std::size_t failed_transfers() const;
+        std::size_t running_transfers() const;
+
+        MirrorPerformance performance() const;
+        void set_performance(const MirrorPerformance& performance);
+
+        // Expected duration in seconds of a new transfer of `size` bytes, given the measured
+        // latency and the throughput shared with the transfers already running on this mirror.
+        // Returns std::nullopt while no transfer has been measured.
+        std::optional<double> expected_transfer_seconds(std::size_t size) const;
 
         bool can_accept_more_connections() const;
         bool can_retry_with_fewer_connections() const;
@@ -107,6 +130,7 @@ namespace mamba::download
         void cap_allowed_connections();
         void increase_running_transfers();
         void update_transfers_done(bool success, bool record_success);
+        void record_transfer(const TransferData& data);
 
     protected:
 
@@ -115,6 +139,7 @@ namespace mamba::download
     private:
 
         virtual request_generator_list get_request_generators_impl(const std::string&, const std::string&) const = 0;
+        virtual std::string get_host_impl(const std::string& url_path) const = 0;
 
         MirrorID m_id;
         size_t m_max_retries;
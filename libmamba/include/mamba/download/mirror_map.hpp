@@ -15,6 +15,7 @@
 #include <unordered_map>
 
 #include "mamba/download/mirror.hpp"
+#include "mamba/fs/filesystem.hpp"
 #include "mamba/util/iterator.hpp"
 
 namespace mamba::download
@@ -55,12 +56,26 @@ namespace mamba::download
         template <class MirrorType, class... Args>
         auto create_unique_mirror(const std::string& mirror_name, Args&&... args) -> MirrorType&;
 
+        // Restores the performance of the mirrors saved in `path` by `save_performance`, for
+        // the mirrors stored here and the ones added later. Unreadable files are ignored.
+        void load_performance(const fs::u8path& path);
+
+        // Saves the performance of the mirrors stored here into `path`, keeping the entries
+        // of other mirrors already saved there. Failures are only logged.
+        void save_performance(const fs::u8path& path) const;
+
+        static constexpr std::string_view performance_filename = "mirror_performance.json";
+
     private:
 
         using map_type = std::unordered_map<std::string, mirror_set>;
+        using performance_map = std::unordered_map<std::string, MirrorPerformance>;
+
+        void restore_performance(Mirror& mirror) const;
 
         mirror_set m_empty_set;
         map_type m_mirrors;
+        performance_map m_saved_performance;
     };
 
     template <class MirrorType, class... Args>
@@ -83,6 +98,7 @@ namespace mamba::download
         }
 
         auto mirror = std::make_unique<MirrorType>(std::forward<Args>(args)...);
+        restore_performance(*mirror);
         mirrors.push_back(std::move(mirror));
         return dynamic_cast<MirrorType&>(*(mirrors.back()));
     }
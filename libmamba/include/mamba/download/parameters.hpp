@@ -7,6 +7,7 @@
 #ifndef MAMBA_DOWNLOAD_PARAMETERS_HPP
 #define MAMBA_DOWNLOAD_PARAMETERS_HPP
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <optional>
@@ -42,6 +43,25 @@ namespace mamba::download
         bool fail_fast = false;
         bool sort = true;
         bool verbose = false;
+        // A transfer of at least hedge_min_size bytes still slower than hedge_min_speed_Bps
+        // after hedge_delay is duplicated on another mirror, the first one to complete wins.
+        // Hedged transfers only use idle connections. A null speed disables hedging.
+        std::size_t hedge_min_size = 16 * 1024 * 1024;
+        std::size_t hedge_min_speed_Bps = 256 * 1024;
+        std::chrono::milliseconds hedge_delay = std::chrono::seconds(5);
+        // A download of at least chunk_min_size bytes is split into up to max_chunks byte
+        // ranges downloaded concurrently, possibly from several mirrors, when enough
+        // connections are idle. A null size disables chunked downloads.
+        std::size_t chunk_min_size = 64 * 1024 * 1024;
+        std::size_t max_chunks = 4;
+        // The transfers share a bandwidth of max_speed_Bps bytes per second, in turn, and at
+        // most max_host_connections of them run concurrently on a given host. Local files
+        // are not limited. A null value disables the corresponding limit.
+        std::size_t max_speed_Bps = 0;
+        std::size_t max_host_connections = 0;
+        // Unix socket of a FetchCoordinator downloading on behalf of the processes of the host.
+        // The requests it cannot serve are downloaded in process. Empty means no coordinator.
+        std::string coordinator_socket = "";
         termination_function on_unexpected_termination = std::nullopt;
     };
 
@@ -7,6 +7,7 @@
 #ifndef MAMBA_DOWNLOAD_REQUEST_HPP
 #define MAMBA_DOWNLOAD_REQUEST_HPP
 
+#include <chrono>
 #include <functional>
 #include <optional>
 #include <string>
@@ -27,6 +28,15 @@ namespace mamba::download
         std::string effective_url = "";
         std::size_t downloaded_size = 0;
         std::size_t average_speed_Bps = 0;
+        // Size of the cached copy that a 304 "Not Modified" answer spared downloading
+        std::size_t saved_size = 0;
+        // Timings of the phases of the transfer, each measured from its start. The phases
+        // that did not happen (e.g. the TLS handshake on a reused connection) are 0.
+        std::chrono::microseconds name_lookup_time = {};
+        std::chrono::microseconds connect_time = {};
+        std::chrono::microseconds tls_handshake_time = {};
+        std::chrono::microseconds time_to_first_byte = {};
+        std::chrono::microseconds total_time = {};
     };
 
     struct Filename
@@ -86,6 +96,7 @@ namespace mamba::download
         // TODO: remove these functions when we plug a library with continuation
         using on_success_callback_t = std::function<expected_t<void>(const Success&)>;
         using on_failure_callback_t = std::function<void(const Error&)>;
+        using on_write_callback_t = std::function<void(std::size_t offset, std::size_t size)>;
 
         std::string name;
         // If filename is not initialized, the data will be downloaded
@@ -93,13 +104,26 @@ namespace mamba::download
         std::optional<std::string> filename;
         bool check_only;
         bool ignore_failure;
+        // The file may legitimately be missing, so the outcome of the transfer
+        // does not count for or against the mirror, and other mirrors are not tried.
+        bool may_be_missing = false;
         std::optional<std::size_t> expected_size = std::nullopt;
         std::optional<std::string> etag = std::nullopt;
         std::optional<std::string> last_modified = std::nullopt;
+        // Size of the cached copy validated by `etag` and `last_modified`, reported as saved
+        // when the server answers that it was not modified.
+        std::optional<std::size_t> cached_size = std::nullopt;
+        // A failed transfer over HTTP keeps its partial file to be resumed by a later download.
+        // Transfers whose file is never downloaded again, such as hedges, must not keep one.
+        bool resumable = true;
 
         std::optional<progress_callback_t> progress = std::nullopt;
         std::optional<on_success_callback_t> on_success = std::nullopt;
         std::optional<on_failure_callback_t> on_failure = std::nullopt;
+        // Called from the downloading thread each time `size` bytes have been written at
+        // `offset` in `filename`, once they can be read back from the file. A retried transfer
+        // writes again from its start. Hedged and chunked transfers do not report their writes.
+        std::optional<on_write_callback_t> on_write = std::nullopt;
 
     protected:
 
@@ -39,7 +39,10 @@ namespace mamba
 
 namespace mamba::solver::libsolv
 {
+    class PortfolioSolver;
+    class SolveSnapshot;
     class Solver;
+    class SolverSession;
     class UnSolvable;
 
     /**
@@ -147,7 +150,18 @@ namespace mamba::solver::libsolv
             [[nodiscard]] static auto get(Database& database) -> solv::ObjPool&;
             [[nodiscard]] static auto get(const Database& database) -> const solv::ObjPool&;
 
+            /**
+             * Incremented whenever a repository is added, removed, or set as installed.
+             *
+             * Libsolv reuses the ids of the removed repositories and solvables, so that
+             * the pool can look identical after a repository is replaced.
+             */
+            [[nodiscard]] static auto generation(const Database& database) -> std::size_t;
+
+            friend class PortfolioSolver;
+            friend class SolveSnapshot;
             friend class Solver;
+            friend class SolverSession;
             friend class UnSolvable;
         };
 
@@ -0,0 +1,111 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_SOLVER_LIBSOLV_PORTFOLIO_SOLVER_HPP
+#define MAMBA_SOLVER_LIBSOLV_PORTFOLIO_SOLVER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mamba/core/error_handling.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/parameters.hpp"
+#include "mamba/solver/libsolv/solver.hpp"
+#include "mamba/solver/request.hpp"
+#include "mamba/solver/solution.hpp"
+
+namespace mamba::solver::libsolv
+{
+    /**
+     * A variation of the request flags tried by the @ref PortfolioSolver.
+     */
+    struct PortfolioStrategy
+    {
+        std::string name;
+        Request::Flags flags;
+    };
+
+    /**
+     * The default strategies derived from the request flags, in order of preference.
+     *
+     * The requested flags come first, followed by progressively relaxed flags (flexible
+     * channel priority, allowing downgrades and uninstalls), the opposite job ordering, and
+     * forcing reinstallation.
+     * Strategies with the same flags as a previous one are omitted.
+     */
+    [[nodiscard]] auto default_portfolio_strategies(const Request::Flags& flags)
+        -> std::vector<PortfolioStrategy>;
+
+    /**
+     * Solve a request with multiple strategies concurrently.
+     *
+     * Libsolv pools are not thread safe, so every strategy is solved on its own copy of the
+     * @ref Database, made through the libsolv binary serialization of its repositories.
+     * The solution returned is the one of the first successful strategy in the order they
+     * were given, regardless of which attempt finished first.
+     * The copy is only made when an attempt starts, and is released once the attempt is skipped.
+     * Once a strategy succeeded, less preferred strategies that have not started are skipped.
+     * Libsolv solves cannot be interrupted, hence attempts already running are waited on, and
+     * then discarded.
+     */
+    class PortfolioSolver
+    {
+    public:
+
+        struct Attempt
+        {
+            PortfolioStrategy strategy;
+            /** The copy of the database used by the attempt, null if it was skipped. */
+            std::unique_ptr<Database> database;
+            /** The outcome of the attempt, empty if it was skipped. */
+            std::optional<expected_t<Solver::Outcome>> outcome;
+        };
+
+        struct Outcome
+        {
+            /** All attempts in the order of the strategies. */
+            std::vector<Attempt> attempts;
+            /** The index of the selected attempt, if any attempt found a solution. */
+            std::optional<std::size_t> solved_index;
+
+            [[nodiscard]] auto has_solution() const -> bool;
+            /** @pre @ref has_solution() is ``true``. */
+            [[nodiscard]] auto solution() const -> const Solution&;
+            /** The attempts that ended as @ref UnSolvable, with their database. */
+            [[nodiscard]] auto unsolvables() const -> std::vector<const Attempt*>;
+        };
+
+        /**
+         * Construct a solver for the given strategies.
+         *
+         * @param strategies The strategies, in order of preference. If empty, the
+         *        @ref default_portfolio_strategies of the request flags are used.
+         * @param max_threads The maximum number of concurrent solves, or zero to use the
+         *        hardware concurrency.
+         */
+        explicit PortfolioSolver(
+            std::vector<PortfolioStrategy> strategies = {},
+            std::size_t max_threads = 0
+        );
+
+        [[nodiscard]] auto strategies() const -> const std::vector<PortfolioStrategy>&;
+
+        [[nodiscard]] auto solve(
+            Database& database,
+            const Request& request,
+            MatchSpecParser ms_parser = MatchSpecParser::Mixed
+        ) -> expected_t<Outcome>;
+
+    private:
+
+        std::vector<PortfolioStrategy> m_strategies;
+        std::size_t m_max_threads;
+    };
+}
+#endif
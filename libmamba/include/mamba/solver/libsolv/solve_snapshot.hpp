@@ -0,0 +1,59 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_SOLVER_LIBSOLV_SOLVE_SNAPSHOT_HPP
+#define MAMBA_SOLVER_LIBSOLV_SOLVE_SNAPSHOT_HPP
+
+#include "mamba/core/error_handling.hpp"
+#include "mamba/fs/filesystem.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/parameters.hpp"
+#include "mamba/solver/request.hpp"
+#include "mamba/specs/channel.hpp"
+
+namespace mamba::solver::libsolv
+{
+    /**
+     * The inputs of a solve, saved to be replayed offline.
+     *
+     * A snapshot is a directory with a ``snapshot.json`` file describing the request, the
+     * database settings and its repositories, along with one libsolv binary file per
+     * repository.
+     * The libsolv binary format is not stable, so snapshots are only meant to be read with
+     * the same version of libsolv.
+     * The channel parameters are not saved and must be given when reading the snapshot.
+     */
+    class SolveSnapshot
+    {
+    public:
+
+        static constexpr auto metadata_filename = std::string_view("snapshot.json");
+
+        /**
+         * Save the repositories of the @p database and the @p request in @p directory.
+         *
+         * The directory is created if it does not exist.
+         */
+        [[nodiscard]] static auto write(
+            Database& database,
+            const Request& request,
+            const fs::u8path& directory,
+            MatchSpecParser ms_parser = MatchSpecParser::Mixed
+        ) -> expected_t<void>;
+
+        /**
+         * Load a snapshot saved with @ref write.
+         */
+        [[nodiscard]] static auto
+        read(const fs::u8path& directory, specs::ChannelResolveParams channel_params)
+            -> expected_t<SolveSnapshot>;
+
+        Database database;
+        Request request;
+        MatchSpecParser matchspec_parser = MatchSpecParser::Mixed;
+    };
+}
+#endif
@@ -0,0 +1,118 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_SOLVER_LIBSOLV_SOLVER_SESSION_HPP
+#define MAMBA_SOLVER_LIBSOLV_SOLVER_SESSION_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "mamba/core/error_handling.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/parameters.hpp"
+#include "mamba/solver/libsolv/repo_info.hpp"
+#include "mamba/solver/libsolv/solver.hpp"
+#include "mamba/solver/request.hpp"
+
+namespace mamba::solver::libsolv
+{
+    /**
+     * A long lived solver reusing the libsolv state of a @ref Database across requests.
+     *
+     * The @ref Solver prepares the database from scratch on every solve: pins are added as
+     * new solvables and the whatprovides index is recomputed, which also drops the providers
+     * cached for MatchSpec dependencies.
+     * A session is meant to solve many requests against the same set of channels, where only
+     * the installed packages and the jobs change.
+     * Between two solves, it only recomputes the whatprovides index if the solvables in the
+     * database have changed, reuses the pin solvables when the pins are the same, and caches
+     * the translation of jobs that do not depend on the installed packages.
+     *
+     * The session keeps a reference to the database, which must outlive it.
+     * Changes made to the database through its own methods, such as adding a repository, are
+     * detected on the next solve.
+     * @ref invalidate can be used to force a full preparation of the database.
+     */
+    class SolverSession
+    {
+    public:
+
+        using Outcome = Solver::Outcome;
+
+        explicit SolverSession(Database& database);
+        SolverSession(const SolverSession&) = delete;
+        SolverSession(SolverSession&&);
+
+        ~SolverSession();
+
+        auto operator=(const SolverSession&) -> SolverSession& = delete;
+        auto operator=(SolverSession&&) -> SolverSession&;
+
+        [[nodiscard]] auto database() -> Database&;
+        [[nodiscard]] auto database() const -> const Database&;
+
+        /**
+         * Replace the installed packages.
+         *
+         * The repository previously created by this function is removed from the database
+         * and a new one is set as the installed repository.
+         */
+        template <typename Range>
+        auto set_installed_packages(
+            const Range& packages,
+            std::string_view name = "installed",
+            PipAsPythonDependency add = PipAsPythonDependency::No
+        ) -> RepoInfo;
+
+        /** Discard all state reused between solves. */
+        void invalidate();
+
+        [[nodiscard]] auto
+        solve(Request&& request, MatchSpecParser ms_parser = MatchSpecParser::Mixed)
+            -> expected_t<Outcome>;
+
+        [[nodiscard]] auto
+        solve(const Request& request, MatchSpecParser ms_parser = MatchSpecParser::Mixed)
+            -> expected_t<Outcome>;
+
+        /** Number of times the whatprovides index was computed by this session. */
+        [[nodiscard]] auto whatprovides_build_count() const -> std::size_t;
+
+        /** Number of request jobs whose translation was found in the cache. */
+        [[nodiscard]] auto job_cache_hit_count() const -> std::size_t;
+
+    private:
+
+        struct SessionImpl;
+
+        std::unique_ptr<SessionImpl> m_data;
+
+        auto solve_impl(const Request& request, MatchSpecParser ms_parser) -> expected_t<Outcome>;
+
+        void remove_session_installed_repo();
+        void set_session_installed_repo(RepoInfo repo);
+    };
+
+    /********************
+     *  Implementation  *
+     ********************/
+
+    template <typename Range>
+    auto SolverSession::set_installed_packages(
+        const Range& packages,
+        std::string_view name,
+        PipAsPythonDependency add
+    ) -> RepoInfo
+    {
+        remove_session_installed_repo();
+        auto repo = database().add_repo_from_packages(packages, name, add);
+        set_session_installed_repo(repo);
+        return repo;
+    }
+}
+#endif
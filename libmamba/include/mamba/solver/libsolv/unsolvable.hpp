@@ -27,6 +27,7 @@ namespace mamba
 namespace mamba::solver::libsolv
 {
     class Solver;
+    class SolverSession;
     class Database;
 
     class UnSolvable
@@ -69,6 +70,7 @@ namespace mamba::solver::libsolv
         [[nodiscard]] auto solver() const -> const solv::ObjSolver&;
 
         friend class Solver;
+        friend class SolverSession;
     };
 }
 #endif
@@ -8,6 +8,7 @@
 #define MAMBA_PROBLEMS_GRAPH_HPP
 
 #include <array>
+#include <chrono>
 #include <functional>
 #include <initializer_list>
 #include <ostream>
@@ -259,6 +260,10 @@ namespace mamba::solver
         fmt::text_style unavailable = fmt::fg(fmt::terminal_color::red);
         fmt::text_style available = fmt::fg(fmt::terminal_color::green);
         std::array<std::string_view, 4> indents = { "│  ", "   ", "├─ ", "└─ " };
+        /** Maximum number of lines in the explanation, or zero for no limit. */
+        std::size_t max_lines = 0;
+        /** Maximum time spent writing the explanation, or zero for no limit. */
+        std::chrono::milliseconds time_budget = {};
     };
 
     auto print_problem_tree_msg(
@@ -8,9 +8,12 @@
 #define MAMBA_SPECS_VERSION_SPEC_HPP
 
 #include <array>
+#include <cstdint>
 #include <functional>
+#include <optional>
 #include <string_view>
 #include <variant>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -20,6 +23,8 @@
 
 namespace mamba::specs
 {
+    class CompiledVersionSpec;
+
     /**
      * A stateful unary boolean function on the Version space.
      */
@@ -149,6 +154,7 @@ namespace mamba::specs
         friend auto operator==(not_version_glob, not_version_glob) -> bool;
         friend auto operator==(const VersionPredicate& lhs, const VersionPredicate& rhs) -> bool;
         friend struct ::fmt::formatter<VersionPredicate>;
+        friend class CompiledVersionSpec;
     };
 
     auto operator==(const VersionPredicate& lhs, const VersionPredicate& rhs) -> bool;
@@ -263,6 +269,149 @@ namespace mamba::specs
         tree_type m_tree;
 
         friend struct ::fmt::formatter<VersionSpec>;
+        friend class CompiledVersionSpec;
+    };
+
+    /**
+     * A fixed size numeric encoding of simple versions.
+     *
+     * Only versions with no local part, and made of at most ``max_parts`` purely numeric parts
+     * (not counting trailing zeros) can be encoded.
+     * This covers the vast majority of versions found in channels, and for these, comparing
+     * keys lexicographically gives the same result as comparing the versions, without any
+     * allocation or string comparison.
+     */
+    class VersionKey
+    {
+    public:
+
+        static constexpr std::size_t max_parts = 6;
+
+        /**
+         * Encode the version if it is simple enough.
+         */
+        [[nodiscard]] static auto make(const Version& version) -> std::optional<VersionKey>;
+
+        /** Construct the key of version ``0.0``. */
+        VersionKey() noexcept = default;
+
+        /**
+         * True if the version has the same leading parts as the given prefix.
+         *
+         * Same as ``Version::starts_with``, where the number of parts in the prefix is the number
+         * of parts it was written with.
+         */
+        [[nodiscard]] auto starts_with(const VersionKey& prefix) const noexcept -> bool;
+
+        [[nodiscard]] auto operator==(const VersionKey& other) const noexcept -> bool
+        {
+            return m_values == other.m_values;
+        }
+
+        [[nodiscard]] auto operator!=(const VersionKey& other) const noexcept -> bool
+        {
+            return m_values != other.m_values;
+        }
+
+        [[nodiscard]] auto operator<(const VersionKey& other) const noexcept -> bool
+        {
+            return m_values < other.m_values;
+        }
+
+        [[nodiscard]] auto operator<=(const VersionKey& other) const noexcept -> bool
+        {
+            return m_values <= other.m_values;
+        }
+
+        [[nodiscard]] auto operator>(const VersionKey& other) const noexcept -> bool
+        {
+            return m_values > other.m_values;
+        }
+
+        [[nodiscard]] auto operator>=(const VersionKey& other) const noexcept -> bool
+        {
+            return m_values >= other.m_values;
+        }
+
+    private:
+
+        /** The epoch followed by the version parts, padded with zeros. */
+        std::array<std::uint32_t, max_parts + 1> m_values = {};
+        /** The number of parts as written in the version. */
+        std::uint8_t m_written_parts = 0;
+    };
+
+    /**
+     * A VersionSpec compiled for fast repeated evaluation.
+     *
+     * The expression tree is linearized into a sequence of predicates with forward conditional
+     * jumps, so that evaluation is a simple short-circuiting loop.
+     * Predicates on simple versions (equality, ordering, and ``=1.2.*`` prefix) compare
+     * ``VersionKey`` directly, and fallback to ``VersionPredicate::contains`` otherwise.
+     *
+     * The result of ``contains`` is always the same as the one of the ``VersionSpec``.
+     */
+    class CompiledVersionSpec
+    {
+    public:
+
+        /** Construct a compiled spec that match all versions. */
+        CompiledVersionSpec() = default;
+        explicit CompiledVersionSpec(const VersionSpec& spec);
+
+        /**
+         * True if the set described by the VersionSpec contains the given version.
+         */
+        [[nodiscard]] auto contains(const Version& point) const -> bool;
+
+        /**
+         * Same as the other overload with the key of the version already computed.
+         *
+         * This lets callers cache the key along with the version they evaluate multiple times.
+         */
+        [[nodiscard]] auto
+        contains(const Version& point, const std::optional<VersionKey>& point_key) const -> bool;
+
+        /**
+         * Return the number of instructions in the compiled program.
+         */
+        [[nodiscard]] auto program_size() const -> std::size_t;
+
+    private:
+
+        enum struct OpCode : std::uint8_t
+        {
+            free,
+            generic,
+            key_equal,
+            key_not_equal,
+            key_greater,
+            key_greater_equal,
+            key_less,
+            key_less_equal,
+            key_starts_with,
+            key_not_starts_with,
+        };
+
+        struct Instruction
+        {
+            /** The pre-resolved operand for fast opcodes. */
+            VersionKey operand = {};
+            /** Index in the predicates used when the version cannot be compared with keys. */
+            std::uint32_t predicate = 0;
+            std::uint32_t on_true = 0;
+            std::uint32_t on_false = 0;
+            OpCode opcode = OpCode::generic;
+        };
+
+        std::vector<Instruction> m_program = {};
+        std::vector<VersionPredicate> m_predicates = {};
+
+        [[nodiscard]] auto execute(
+            const Instruction& instr,
+            const Version& point,
+            const std::optional<VersionKey>& point_key
+        ) const -> bool;
     };
 
     namespace version_spec_literals
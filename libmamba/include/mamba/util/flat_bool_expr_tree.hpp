@@ -172,6 +172,21 @@ namespace mamba::util
         template <typename UnaryFunc>
         void infix_for_each(UnaryFunc&& func) const;
 
+        /**
+         * Linearize the expression into a sequence of conditional jumps.
+         *
+         * The variables are visited from left to right and @p func is called with the variable,
+         * the position to jump to when it evaluates to true, and the position to jump to when
+         * it evaluates to false.
+         * A position is either the index of a variable in the visit order, or the number of
+         * variables for a true expression, or the number of variables plus one for a false
+         * expression.
+         * Jumps always go forward, and running them from the first variable gives the same
+         * short-circuiting evaluation as ``evaluate``.
+         */
+        template <typename JumpFunc>
+        void for_each_jump(JumpFunc&& func) const;
+
         // TODO(C++20): replace by the `= default` implementation of `operator==`
         [[nodiscard]] auto operator==(const self_type& other) const -> bool
         {
@@ -190,6 +205,16 @@ namespace mamba::util
         template <typename UnaryFunc>
         auto evaluate_impl(UnaryFunc& var_evaluator, idx_type idx) const -> bool;
 
+        template <typename JumpFunc>
+        void for_each_jump_impl(
+            JumpFunc& func,
+            const std::vector<size_type>& leaf_counts,
+            idx_type idx,
+            size_type start,
+            size_type on_true,
+            size_type on_false
+        ) const;
+
         tree_type m_tree = {};
     };
 
@@ -594,6 +619,59 @@ namespace mamba::util
         }
     }
 
+    template <typename V>
+    template <typename JumpFunc>
+    void flat_bool_expr_tree<V>::for_each_jump(JumpFunc&& func) const
+    {
+        if (m_tree.empty())
+        {
+            return;
+        }
+        // Children are always added before their parents, so a single forward pass is enough
+        // to count the variables in every sub tree.
+        auto leaf_counts = std::vector<size_type>(m_tree.size(), 0);
+        for (idx_type idx = 0; idx < m_tree.size(); ++idx)
+        {
+            leaf_counts[idx] = m_tree.is_leaf(idx)
+                                   ? 1
+                                   : leaf_counts[m_tree.left(idx)] + leaf_counts[m_tree.right(idx)];
+        }
+        const auto n_leaves = leaf_counts[m_tree.root()];
+        for_each_jump_impl(func, leaf_counts, m_tree.root(), 0, n_leaves, n_leaves + 1);
+    }
+
+    template <typename V>
+    template <typename JumpFunc>
+    void flat_bool_expr_tree<V>::for_each_jump_impl(
+        JumpFunc& func,
+        const std::vector<size_type>& leaf_counts,
+        idx_type idx,
+        size_type start,
+        size_type on_true,
+        size_type on_false
+    ) const
+    {
+        assert(idx < m_tree.size());
+        if (m_tree.is_leaf(idx))
+        {
+            func(m_tree.leaf(idx), on_true, on_false);
+            return;
+        }
+        const auto left = m_tree.left(idx);
+        const auto right = m_tree.right(idx);
+        // The right sub tree variables start right after the ones of the left sub tree.
+        const auto right_start = start + leaf_counts[left];
+        if ((m_tree.branch(idx) == BoolOperator::logical_and))
+        {
+            for_each_jump_impl(func, leaf_counts, left, start, right_start, on_false);
+        }
+        else  // BoolOperator::logical_or
+        {
+            for_each_jump_impl(func, leaf_counts, left, start, on_true, right_start);
+        }
+        for_each_jump_impl(func, leaf_counts, right, right_start, on_true, on_false);
+    }
+
     template <typename V>
     template <typename UnaryFunc>
     void flat_bool_expr_tree<V>::infix_for_each(UnaryFunc&& func) const
@@ -10,6 +10,8 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <nlohmann/json_fwd.hpp>
 
@@ -59,6 +61,10 @@ namespace mamba::validation
         void
         verify_package(const nlohmann::json& signed_data, const nlohmann::json& signatures) const;
         void verify_package(const nlohmann::json& signed_data, std::string_view signatures) const;
+        // Verify several packages at once, given their signed data and signatures
+        void verify_packages(
+            const std::vector<std::pair<nlohmann::json, std::string_view>>& packages
+        ) const;
 
         void generate_index_checker();
 
@@ -81,6 +87,10 @@ namespace mamba::validation
 
         auto initial_trusted_root() const -> fs::u8path;
 
+        auto verified_indexes_file() const -> fs::u8path;
+        auto is_verified_index(const fs::u8path& p, const std::string& index_hash) const -> bool;
+        void record_verified_index(const fs::u8path& p, const std::string& index_hash) const;
+
         void persist_file(const fs::u8path& file_path);
 
         auto get_root_role(const TimeRef& time_reference) -> std::unique_ptr<RootRole>;
@@ -0,0 +1,76 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_VALIDATION_SIGNATURE_VERIFIER_HPP
+#define MAMBA_VALIDATION_SIGNATURE_VERIFIER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mamba/validation/keys.hpp"
+
+namespace mamba::validation
+{
+    /**
+     * Verify signatures against the keys of a role.
+     *
+     * The public keys are parsed once when the verifier is built, rather than for each
+     * signature. The verifier is immutable and can be used by several threads at once.
+     */
+    class SignatureVerifier
+    {
+    public:
+
+        explicit SignatureVerifier(const RoleFullKeys& keyring);
+        ~SignatureVerifier();
+
+        SignatureVerifier(const SignatureVerifier&) = delete;
+        SignatureVerifier(SignatureVerifier&&) noexcept;
+        auto operator=(const SignatureVerifier&) -> SignatureVerifier& = delete;
+        auto operator=(SignatureVerifier&&) noexcept -> SignatureVerifier&;
+
+        /** Number of valid signatures of the data, counted up to the threshold. */
+        [[nodiscard]] auto count_valid_signatures(
+            std::string_view signed_data,
+            const std::set<RoleSignature>& signatures
+        ) const -> std::size_t;
+
+        /** Throw a ``threshold_error`` if there are not enough valid signatures. */
+        void check_signatures(std::string_view signed_data, const std::set<RoleSignature>& signatures)
+            const;
+
+        [[nodiscard]] auto threshold() const -> std::size_t;
+
+    private:
+
+        struct PublicKey;
+
+        [[nodiscard]] auto is_valid(std::string_view signed_data, const RoleSignature& signature) const
+            -> bool;
+
+        std::map<std::string, std::unique_ptr<PublicKey>> m_keys;
+        std::size_t m_threshold;
+    };
+
+    /**
+     * Call ``is_valid`` on the indices in ``[0, count)`` on several threads.
+     *
+     * Small counts are verified on the calling thread. The first exception thrown
+     * by ``is_valid`` is rethrown once all the threads are done.
+     *
+     * @return The sorted indices for which ``is_valid`` returned false.
+     */
+    [[nodiscard]] auto
+    find_invalid_in_parallel(std::size_t count, const std::function<bool(std::size_t)>& is_valid)
+        -> std::vector<std::size_t>;
+}
+#endif
@@ -10,6 +10,7 @@
 #include <array>
 #include <cstddef>
 #include <string>
+#include <string_view>
 
 namespace mamba::fs
 {
@@ -70,6 +71,15 @@ namespace mamba::validation
     verify_gpg_hashed_msg(const std::string& data, const std::string& pk, const std::string& signature)
         -> int;
 
+    /**
+     * Hash the binary data with the additional trailer added in V4 signature, as signed
+     * by a GPG/PGP signature.
+     * See RFC4880, section 5.2.4 https://datatracker.ietf.org/doc/html/rfc4880#section-5.2.4
+     * This method assumes hash function to be SHA-256
+     */
+    auto pgp_v4_hashed_msg(std::string_view data, const std::string& pgp_v4_trailer, int& error_code)
+        -> std::array<std::byte, MAMBA_SHA256_SIZE_BYTES>;
+
     /**
      * Verify a GPG/PGP signature against the binary data and
      * the additional trailer added in V4 signature.
@@ -10,6 +10,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <nlohmann/json_fwd.hpp>
@@ -199,10 +200,19 @@ namespace mamba::validation
     {
     public:
 
+        // The signed data of a package with its signatures
+        using signed_package = std::pair<nlohmann::json, nlohmann::json>;
+
         virtual ~RepoIndexChecker() = default;
         virtual void verify_index(const nlohmann::json& j) const = 0;
         virtual void verify_index(const fs::u8path& p) const = 0;
         virtual void verify_package(const nlohmann::json& signed_data, const nlohmann::json& signatures) const = 0;
+        // Verify several packages at once, possibly concurrently
+        virtual void verify_packages(const std::vector<signed_package>& packages) const;
+
+        // Identify the keys the packages are verified with, to know whether an index
+        // verified earlier is still trusted. Empty if the keys cannot be identified.
+        [[nodiscard]] virtual auto keys_fingerprint() const -> std::string;
 
     protected:
 
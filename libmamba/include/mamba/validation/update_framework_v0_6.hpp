@@ -10,10 +10,12 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <nlohmann/json_fwd.hpp>
 
 #include "mamba/validation/keys.hpp"
+#include "mamba/validation/signature_verifier.hpp"
 #include "mamba/validation/update_framework.hpp"
 
 namespace mamba::validation::v0_6
@@ -175,6 +177,8 @@ namespace mamba::validation::v0_6
         void verify_index(const nlohmann::json& j) const override;
         void
         verify_package(const nlohmann::json& signed_data, const nlohmann::json& signatures) const override;
+        void verify_packages(const std::vector<signed_package>& packages) const override;
+        [[nodiscard]] auto keys_fingerprint() const -> std::string override;
 
         friend void to_json(nlohmann::json& j, const PkgMgrRole& r);
         friend void from_json(const nlohmann::json& j, PkgMgrRole& r);
@@ -187,10 +191,16 @@ namespace mamba::validation::v0_6
         [[nodiscard]] auto pkg_signatures(const nlohmann::json& j) const -> std::set<RoleSignature>;
         void
         check_pkg_signatures(const nlohmann::json& signed_data, const nlohmann::json& signatures) const;
+        [[nodiscard]] auto has_valid_pkg_signatures(
+            const nlohmann::json& signed_data,
+            const nlohmann::json& signatures
+        ) const -> bool;
 
         void set_defined_roles(std::map<std::string, RolePubKeys> keys);
 
         RoleFullKeys m_keys;
+        // Shared by the copies of the role, the keys being parsed only once
+        std::shared_ptr<const SignatureVerifier> p_verifier;
 
         friend class KeyMgrRole;
     };
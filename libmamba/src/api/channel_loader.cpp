@@ -11,6 +11,7 @@
 #include "mamba/core/package_database_loader.hpp"
 #include "mamba/core/prefix_data.hpp"
 #include "mamba/core/subdir_index.hpp"
+#include "mamba/core/tracing.hpp"
 #include "mamba/solver/libsolv/database.hpp"
 #include "mamba/solver/libsolv/repo_info.hpp"
 #include "mamba/specs/package_info.hpp"
@@ -144,6 +145,15 @@ namespace mamba
 
             Console::instance().init_progress_bar_manager(ProgressBarMode::multi);
 
+            // The performance measured on the mirrors in previous runs drives their scheduling
+            fs::u8path mirror_performance_file;
+            if (const auto pkgs_dir = package_caches.first_writable_path(); !pkgs_dir.empty())
+            {
+                mirror_performance_file = pkgs_dir / "cache"
+                                          / download::mirror_map::performance_filename;
+                ctx.mirrors.load_performance(mirror_performance_file);
+            }
+
             std::vector<mamba_error> error_list;
 
             for (const auto& mirror : ctx.mirrored_channels)
@@ -208,7 +218,6 @@ namespace mamba
             expected_t<void> download_res;
             if (SubdirIndexMonitor::can_monitor(ctx))
             {
-                SubdirIndexMonitor check_monitor({ true, true });
                 SubdirIndexMonitor index_monitor;
                 download_res = SubdirIndexLoader::download_required_indexes(
                     subdirs,
@@ -217,7 +226,6 @@ namespace mamba
                     ctx.mirrors,
                     ctx.download_options(),
                     ctx.remote_fetch_params,
-                    &check_monitor,
                     &index_monitor
                 );
             }
@@ -233,6 +241,11 @@ namespace mamba
                 );
             }
 
+            if (!mirror_performance_file.empty())
+            {
+                ctx.mirrors.save_performance(mirror_performance_file);
+            }
+
             if (!download_res)
             {
                 mamba_error error = download_res.error();
@@ -316,6 +329,7 @@ namespace mamba
         MultiPackageCache& package_caches
     ) -> expected_t<void, mamba_aggregated_error>
     {
+        const auto span = tracing::ScopedSpan("load_channels");
         bool retry = false;
         return load_channels_impl(ctx, channel_context, database, package_caches, retry);
     }
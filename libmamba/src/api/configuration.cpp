@@ -5,8 +5,15 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <optional>
+#include <set>
 #include <stdexcept>
+#include <string_view>
 
 #include <nlohmann/json.hpp>
 #include <reproc++/run.hpp>
@@ -15,17 +22,54 @@
 #include "mamba/api/install.hpp"
 #include "mamba/core/fsutil.hpp"
 #include "mamba/core/logging.hpp"
+#include "mamba/core/logging_async.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/package_fetcher.hpp"
+#include "mamba/core/tracing.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/core/util_os.hpp"
 #include "mamba/util/build.hpp"
 #include "mamba/util/environment.hpp"
 #include "mamba/util/path_manip.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 
 namespace mamba
 {
+    namespace detail
+    {
+        /**
+         * Binary cache of the parsed configuration files, read with a single read.
+         *
+         * An entry is valid as long as the modification time and size of its file, and the
+         * environment variables expanded in it, are unchanged.
+         */
+        struct RCSnapshot
+        {
+            struct Entry
+            {
+                std::int64_t mtime = 0;
+                std::uint64_t size = 0;
+                std::vector<std::pair<std::string, std::optional<std::string>>> env = {};
+                YAML::Node node = {};
+                bool used = false;
+            };
+
+            using stamp_type = std::optional<std::pair<std::int64_t, std::uint64_t>>;
+
+            static auto read(fs::u8path path) -> std::unique_ptr<RCSnapshot>;
+            static auto stamp(const fs::u8path& file) -> stamp_type;
+
+            auto find(const fs::u8path& file) -> std::optional<YAML::Node>;
+            void insert(const fs::u8path& file, const stamp_type& stamp, const YAML::Node& node);
+            void save();
+
+            fs::u8path path;
+            std::map<std::string, Entry> entries;
+            bool dirty = false;
+        };
+    }
+
     /************************
      * ConfigurableImplBase *
      ************************/
@@ -1732,6 +1776,49 @@ namespace mamba
                         Defines the number of threads for package download.
                         It has to be strictly positive.)")));
 
+        insert(Configurable("download_chunk_min_size", &m_context.download_chunk_min_size)
+                   .group("Extract, Link & Install")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Minimum size in bytes of the packages downloaded in chunks")
+                   .long_description(unindent(R"(
+                        Packages of at least this size in bytes are split into byte ranges
+                        downloaded concurrently, possibly from several mirrors, using the
+                        download threads left idle. Zero disables chunked downloads.)")));
+
+        insert(Configurable("download_max_speed", &m_context.download_max_speed)
+                   .group("Extract, Link & Install")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Maximum download bandwidth in bytes per second")
+                   .long_description(unindent(R"(
+                        Maximum bandwidth in bytes per second shared by all the transfers
+                        of a download, which take turns when it is reached. Local files are
+                        not limited. Zero (default) means no limit.)")));
+
+        insert(Configurable("download_max_host_connections", &m_context.download_max_host_connections)
+                   .group("Extract, Link & Install")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Maximum number of concurrent downloads from a given host")
+                   .long_description(unindent(R"(
+                        Maximum number of concurrent transfers to a given host. The
+                        download threads left idle are used for the other hosts and for
+                        local files. Zero (default) means no limit.)")));
+
+        insert(Configurable("download_coordinator", &m_context.download_coordinator)
+                   .group("Extract, Link & Install")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Unix socket of a fetch coordinator to download through")
+                   .long_description(unindent(R"(
+                        Path of the Unix socket of a fetch coordinator started with
+                        `micromamba fetch-coordinator`. The packages and indexes are then
+                        downloaded by the coordinator, which downloads only once the
+                        artifacts requested by several processes at the same time. The
+                        downloads are done in process when the coordinator is not
+                        reachable or cannot serve them.)")));
+
         insert(Configurable("extract_threads", &m_context.threads_params.extract_threads)
                    .group("Extract, Link & Install")
                    .set_rc_configurable()
@@ -1744,6 +1831,19 @@ namespace mamba
                         host max concurrency minus the value, zero (default) is the host max
                         concurrency value.)")));
 
+        insert(Configurable("extract_while_downloading", &m_context.extract_while_downloading)
+                   .group("Extract, Link & Install")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Extract .conda packages while they are downloaded")
+                   .long_description(unindent(R"(
+                        Extract .conda packages in a staging directory while they are
+                        downloaded, so that the network and disk transfers overlap. The
+                        staging directory is only used once the checksum of the package
+                        is verified, otherwise the package is extracted again from the
+                        downloaded file. Packages downloaded in several chunks are
+                        extracted once downloaded.)")));
+
         insert(Configurable("allow_softlinks", &m_context.link_params.allow_softlinks)
                    .group("Extract, Link & Install")
                    .set_rc_configurable()
@@ -1926,6 +2026,31 @@ namespace mamba
                    .long_description(unindent(R"(
                             Set the log pattern.)")));
 
+        insert(Configurable("async_logging", &m_context.output_params.async_logging)
+                   .group("Output, Prompt and Flow Control")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Write the logs from a background thread")
+                   .long_description(unindent(R"(
+                            Write the logs from a background thread, so that logging
+                            threads do not wait on the output. Verbose logs may be
+                            dropped when they are emitted faster than they can be
+                            written, warnings and errors never are.)")));
+
+        insert(Configurable("trace_file", &m_context.trace_file)
+                   .group("Output, Prompt and Flow Control")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Write a trace of the command phases to this file")
+                   .long_description(unindent(R"(
+                            Path of a Chrome trace-event file, viewable in chrome://tracing
+                            or Perfetto, recording the time spent by the command in the
+                            configuration loading, channel loading, solving, download and
+                            extraction, linking and pyc compilation, with a track per
+                            thread. Each package download gets its own track, with the name
+                            lookup, connection, TLS handshake, waiting and receiving times
+                            measured by curl for each attempt.)")));
+
         insert(Configurable("json", &m_context.output_params.json)
                    .group("Output, Prompt and Flow Control")
                    .set_rc_configurable()
@@ -1949,6 +2074,16 @@ namespace mamba
                        "Enable or disable shell autocompletion (currently works for bash and zsh)."
                    ));
 
+        insert(Configurable("use_activation_cache", &m_context.use_activation_cache)
+                   .group("Output, Prompt and Flow Control")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Cache the environment changes computed by activate")
+                   .long_description(unindent(R"(
+                        The cache is stored in the user cache directory, and is invalidated
+                        when the environment variables read by the activation or the
+                        conda-meta and etc/conda directories of the prefix change.)")));
+
         insert(Configurable("env_prompt", &m_context.env_prompt)
                    .group("Output, Prompt and Flow Control")
                    .set_rc_configurable()
@@ -2028,7 +2163,7 @@ namespace mamba
         insert(Configurable("rc_files", std::vector<fs::u8path>({}))
                    .group("Config sources")
                    .set_env_var_names({ "MAMBARC", "CONDARC" })
-                   .needs({ "no_rc" })
+                   .needs({ "no_rc", "no_rc_snapshot" })
                    .set_post_merge_hook<std::vector<fs::u8path>>(
                        [this](std::vector<fs::u8path>& value)
                        { return detail::rc_files_hook(m_context, value); }
@@ -2045,6 +2180,15 @@ namespace mamba
                    .set_env_var_names()
                    .description("Disable the use of configuration files"));
 
+        insert(Configurable("no_rc_snapshot", &m_context.src_params.no_rc_snapshot)
+                   .group("Config sources")
+                   .set_env_var_names()
+                   .description("Disable the cache of parsed configuration files")
+                   .long_description(unindent(R"(
+                        Parsed configuration files are cached in a binary snapshot in the
+                        user cache directory, checked against the files modification time
+                        and size, and the environment variables they expand.)")));
+
         insert(Configurable("no_env", &m_context.src_params.no_env)
                    .group("Config sources")
                    .set_env_var_names()
@@ -2219,6 +2363,9 @@ namespace mamba
 
     void Configuration::load()
     {
+        // Recorded once the configuration tells whether the command is traced
+        const auto load_start = tracing::clock::now();
+
         logging::set_log_level(log_level::all);
         logging::set_flush_threshold(log_level::all);
         // Hard-coded value assuming it's enough to store the logs emitted
@@ -2260,6 +2407,11 @@ namespace mamba
         logging::set_flush_threshold(log_level::off);
 
         m_context.dump_backtrace_no_guards();
+        if (m_context.output_params.async_logging)
+        {
+            // After dumping the backtrace, which would be lost when restarting the handler
+            logging::use_async_log_handler();
+        }
         if (m_context.output_params.log_backtrace > 0)
         {
             logging::enable_backtrace(m_context.output_params.log_backtrace);
@@ -2268,6 +2420,12 @@ namespace mamba
         {
             logging::disable_backtrace();
         }
+
+        if (!m_context.trace_file.empty())
+        {
+            tracing::enable_tracing();
+            tracing::record_span("load_configuration", load_start, tracing::clock::now());
+        }
     }
 
     bool Configuration::is_loading()
@@ -2347,6 +2505,7 @@ namespace mamba
         m_sources.clear();
         m_valid_sources.clear();
         m_rc_yaml_nodes_cache.clear();
+        m_rc_snapshot = nullptr;
     }
 
     void Configuration::clear_cli_values()
@@ -2427,6 +2586,392 @@ namespace mamba
         return configuration_at_impl(name, m_config);
     }
 
+    /***************
+     * RC snapshot *
+     ***************/
+
+    namespace detail
+    {
+        namespace
+        {
+            constexpr std::string_view rc_snapshot_magic = "MAMBARC";
+            constexpr std::uint32_t rc_snapshot_version = 1;
+            // Above this number of entries, the ones unused by this process are dropped
+            constexpr std::size_t rc_snapshot_max_entries = 64;
+
+            class SnapshotWriter
+            {
+            public:
+
+                template <typename Int>
+                void write_int(Int value)
+                {
+                    m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+                }
+
+                void write_str(std::string_view str)
+                {
+                    write_int<std::uint64_t>(str.size());
+                    m_buffer.append(str);
+                }
+
+                void write_node(const YAML::Node& node)
+                {
+                    write_int(static_cast<std::uint8_t>(node.Type()));
+                    switch (node.Type())
+                    {
+                        case YAML::NodeType::Scalar:
+                            write_str(node.Tag());
+                            write_str(node.Scalar());
+                            break;
+                        case YAML::NodeType::Sequence:
+                            write_str(node.Tag());
+                            write_int<std::uint64_t>(node.size());
+                            for (const auto& item : node)
+                            {
+                                write_node(item);
+                            }
+                            break;
+                        case YAML::NodeType::Map:
+                            write_str(node.Tag());
+                            write_int<std::uint64_t>(node.size());
+                            for (const auto& item : node)
+                            {
+                                write_node(item.first);
+                                write_node(item.second);
+                            }
+                            break;
+                        default:
+                            break;
+                    }
+                }
+
+                auto buffer() const -> const std::string&
+                {
+                    return m_buffer;
+                }
+
+            private:
+
+                std::string m_buffer;
+            };
+
+            /** Reader of a ``SnapshotWriter`` buffer, throwing on truncated data. */
+            class SnapshotReader
+            {
+            public:
+
+                explicit SnapshotReader(std::string_view buffer)
+                    : m_buffer(buffer)
+                {
+                }
+
+                template <typename Int>
+                auto read_int() -> Int
+                {
+                    Int value = {};
+                    std::memcpy(&value, take(sizeof(value)).data(), sizeof(value));
+                    return value;
+                }
+
+                auto read_str() -> std::string_view
+                {
+                    return take(read_int<std::uint64_t>());
+                }
+
+                auto read_node() -> YAML::Node
+                {
+                    const auto type = static_cast<YAML::NodeType::value>(read_int<std::uint8_t>());
+                    switch (type)
+                    {
+                        case YAML::NodeType::Scalar:
+                        {
+                            const auto tag = read_str();
+                            auto node = YAML::Node(std::string(read_str()));
+                            node.SetTag(std::string(tag));
+                            return node;
+                        }
+                        case YAML::NodeType::Sequence:
+                        {
+                            auto node = YAML::Node(YAML::NodeType::Sequence);
+                            node.SetTag(std::string(read_str()));
+                            for (auto n = read_int<std::uint64_t>(); n > 0; --n)
+                            {
+                                node.push_back(read_node());
+                            }
+                            return node;
+                        }
+                        case YAML::NodeType::Map:
+                        {
+                            auto node = YAML::Node(YAML::NodeType::Map);
+                            node.SetTag(std::string(read_str()));
+                            for (auto n = read_int<std::uint64_t>(); n > 0; --n)
+                            {
+                                auto key = read_node();
+                                node.force_insert(key, read_node());
+                            }
+                            return node;
+                        }
+                        case YAML::NodeType::Null:
+                            return YAML::Node(YAML::NodeType::Null);
+                        default:
+                            throw std::runtime_error("Invalid node type in rc snapshot");
+                    }
+                }
+
+                auto done() const -> bool
+                {
+                    return m_buffer.empty();
+                }
+
+            private:
+
+                std::string_view m_buffer;
+
+                auto take(std::size_t size) -> std::string_view
+                {
+                    if (size > m_buffer.size())
+                    {
+                        throw std::runtime_error("Truncated rc snapshot");
+                    }
+                    auto out = m_buffer.substr(0, size);
+                    m_buffer.remove_prefix(size);
+                    return out;
+                }
+            };
+
+            auto is_env_var_char(char c) -> bool
+            {
+                return util::is_alphanum(c) || (c == '_');
+            }
+
+            /** Names of the variables that ``expandvars`` would substitute in the text. */
+            void add_expanded_env_vars(std::string_view text, std::set<std::string>& names)
+            {
+                for (auto pos = text.find('$'); pos != std::string_view::npos;
+                     pos = text.find('$', pos + 1))
+                {
+                    const bool braced = (pos + 1 < text.size()) && (text[pos + 1] == '{');
+                    const auto start = pos + (braced ? 2 : 1);
+                    auto end = start;
+                    while ((end < text.size()) && is_env_var_char(text[end]))
+                    {
+                        ++end;
+                    }
+                    if ((end == start) || (braced && ((end == text.size()) || (text[end] != '}'))))
+                    {
+                        continue;
+                    }
+                    auto [it, inserted] = names.emplace(text.substr(start, end - start));
+                    // Expanded values are expanded again
+                    if (auto value = util::get_env(*it); inserted && value)
+                    {
+                        add_expanded_env_vars(*value, names);
+                    }
+                }
+            }
+        }
+
+        auto rc_snapshot_path() -> fs::u8path
+        {
+            return fs::u8path(util::user_cache_dir()) / "mamba" / "rc_snapshot.bin";
+        }
+
+        auto RCSnapshot::read(fs::u8path path) -> std::unique_ptr<RCSnapshot>
+        {
+            auto snapshot = std::make_unique<RCSnapshot>();
+            snapshot->path = std::move(path);
+
+            std::error_code ec;
+            if (!fs::exists(snapshot->path, ec))
+            {
+                return snapshot;
+            }
+            try
+            {
+                auto in = open_ifstream(snapshot->path, std::ios::in | std::ios::binary);
+                const std::string buffer{ std::istreambuf_iterator<char>(in),
+                                          std::istreambuf_iterator<char>() };
+
+                auto reader = SnapshotReader(buffer);
+                if ((reader.read_str() != rc_snapshot_magic)
+                    || (reader.read_int<std::uint32_t>() != rc_snapshot_version))
+                {
+                    LOG_DEBUG << "Ignoring rc snapshot of another version";
+                    return snapshot;
+                }
+                std::map<std::string, Entry> entries;
+                for (auto n = reader.read_int<std::uint64_t>(); n > 0; --n)
+                {
+                    auto file = std::string(reader.read_str());
+                    auto& entry = entries[std::move(file)];
+                    entry.mtime = reader.read_int<std::int64_t>();
+                    entry.size = reader.read_int<std::uint64_t>();
+                    for (auto n_env = reader.read_int<std::uint64_t>(); n_env > 0; --n_env)
+                    {
+                        auto name = std::string(reader.read_str());
+                        std::optional<std::string> value = {};
+                        if (reader.read_int<std::uint8_t>() != 0)
+                        {
+                            value = std::string(reader.read_str());
+                        }
+                        entry.env.emplace_back(std::move(name), std::move(value));
+                    }
+                    entry.node = reader.read_node();
+                }
+                if (reader.done())
+                {
+                    snapshot->entries = std::move(entries);
+                }
+            }
+            catch (const std::exception& ex)
+            {
+                LOG_DEBUG << "Ignoring invalid rc snapshot '" << snapshot->path.string()
+                          << "': " << ex.what();
+            }
+            return snapshot;
+        }
+
+        auto RCSnapshot::stamp(const fs::u8path& file) -> stamp_type
+        {
+            std::error_code ec;
+            const auto mtime = fs::last_write_time(file, ec);
+            if (ec)
+            {
+                return std::nullopt;
+            }
+            const auto size = fs::file_size(file, ec);
+            if (ec)
+            {
+                return std::nullopt;
+            }
+            // Stored on 64 bits whatever the representation of the file clock
+            using mtime_duration = std::chrono::duration<std::int64_t, fs::file_time_type::period>;
+            const auto mtime_count = std::chrono::duration_cast<mtime_duration>(
+                mtime.time_since_epoch()
+            );
+            return { { mtime_count.count(), size } };
+        }
+
+        auto RCSnapshot::find(const fs::u8path& file) -> std::optional<YAML::Node>
+        {
+            auto it = entries.find(file.string());
+            if (it == entries.end())
+            {
+                return std::nullopt;
+            }
+            auto& entry = it->second;
+            const bool valid = (stamp(file) == std::pair(entry.mtime, entry.size))
+                               && std::all_of(
+                                   entry.env.cbegin(),
+                                   entry.env.cend(),
+                                   [](const auto& var)
+                                   { return util::get_env(var.first) == var.second; }
+                               );
+            if (!valid)
+            {
+                return std::nullopt;
+            }
+            entry.used = true;
+            return { entry.node };
+        }
+
+        void
+        RCSnapshot::insert(const fs::u8path& file, const stamp_type& stamp, const YAML::Node& node)
+        {
+            if (!stamp.has_value() || node.IsNull())
+            {
+                return;
+            }
+            // A file modified right before being read could be modified again without changing
+            // its modification time, depending on the timestamps resolution.
+            const auto mtime = fs::file_time_type(fs::file_time_type::duration(stamp->first));
+            if (fs::file_time_type::clock::now() - mtime < std::chrono::seconds(2))
+            {
+                return;
+            }
+
+            std::set<std::string> env_names;
+            try
+            {
+                auto in = open_ifstream(file);
+                const std::string text{ std::istreambuf_iterator<char>(in),
+                                        std::istreambuf_iterator<char>() };
+                add_expanded_env_vars(text, env_names);
+            }
+            catch (const std::exception&)
+            {
+                return;
+            }
+
+            auto& entry = entries[file.string()];
+            entry = { stamp->first, stamp->second, {}, node, true };
+            for (const auto& name : env_names)
+            {
+                entry.env.emplace_back(name, util::get_env(name));
+            }
+            dirty = true;
+        }
+
+        void RCSnapshot::save()
+        {
+            if (!dirty)
+            {
+                return;
+            }
+            dirty = false;
+
+            if (entries.size() > rc_snapshot_max_entries)
+            {
+                for (auto it = entries.begin(); it != entries.end();)
+                {
+                    it = it->second.used ? std::next(it) : entries.erase(it);
+                }
+            }
+
+            SnapshotWriter writer;
+            writer.write_str(rc_snapshot_magic);
+            writer.write_int(rc_snapshot_version);
+            writer.write_int<std::uint64_t>(entries.size());
+            for (const auto& [file, entry] : entries)
+            {
+                writer.write_str(file);
+                writer.write_int(entry.mtime);
+                writer.write_int(entry.size);
+                writer.write_int<std::uint64_t>(entry.env.size());
+                for (const auto& [name, value] : entry.env)
+                {
+                    writer.write_str(name);
+                    writer.write_int(static_cast<std::uint8_t>(value.has_value()));
+                    if (value.has_value())
+                    {
+                        writer.write_str(*value);
+                    }
+                }
+                writer.write_node(entry.node);
+            }
+
+            // The snapshot is only a cache, failing to write it is not an error
+            try
+            {
+                fs::create_directories(path.parent_path());
+                // Concurrent processes each write their own temporary file
+                const auto tmp_path = path.string() + ".tmp."
+                                      + util::generate_random_alphanumeric_string(8);
+                {
+                    const auto& buffer = writer.buffer();
+                    auto out = open_ofstream(tmp_path, std::ios::out | std::ios::binary);
+                    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                }
+                fs::rename(tmp_path, path);
+            }
+            catch (const std::exception& ex)
+            {
+                LOG_DEBUG << "Could not write rc snapshot '" << path.string() << "': " << ex.what();
+            }
+        }
+    }
+
     YAML::Node Configuration::load_rc_file(const fs::u8path& file)
     {
         YAML::Node config;
@@ -2467,21 +3012,41 @@ namespace mamba
         m_sources = get_existing_rc_sources(possible_rc_paths);
         m_valid_sources.clear();
 
+        if (!m_context.src_params.no_rc_snapshot && (m_rc_snapshot == nullptr))
+        {
+            m_rc_snapshot = detail::RCSnapshot::read(detail::rc_snapshot_path());
+        }
+
         for (const auto& s : m_sources)
         {
             if (!m_rc_yaml_nodes_cache.count(s))
             {
-                auto node = load_rc_file(s);
-                if (node.IsNull())
+                auto node = m_rc_snapshot ? m_rc_snapshot->find(s) : std::nullopt;
+                if (!node.has_value())
+                {
+                    // Stamped before reading, so that a concurrent change invalidates the entry
+                    const auto stamp = detail::RCSnapshot::stamp(s);
+                    node = load_rc_file(s);
+                    if (m_rc_snapshot)
+                    {
+                        m_rc_snapshot->insert(s, stamp, *node);
+                    }
+                }
+                if (node->IsNull())
                 {
                     continue;
                 }
 
-                m_rc_yaml_nodes_cache.insert({ s, node });
+                m_rc_yaml_nodes_cache.insert({ s, *node });
             }
             m_valid_sources.push_back(s);
         }
 
+        if (m_rc_snapshot)
+        {
+            m_rc_snapshot->save();
+        }
+
         if (!m_valid_sources.empty())
         {
             for (auto& it : m_config)
@@ -612,9 +612,8 @@ namespace mamba
 
             if (auto* unsolvable = std::get_if<solver::libsolv::UnSolvable>(&outcome))
             {
-                unsolvable->explain_problems_to(
+                LOG_ERROR << unsolvable->explain_problems(
                     db,
-                    LOG_ERROR,
                     {
                         /* .unavailable= */ ctx.graphics_params.palette.failure,
                         /* .available= */ ctx.graphics_params.palette.success,
@@ -1231,9 +1230,7 @@ namespace mamba
                 throw std::runtime_error(maybe_prefix_data.error().what());
             }
             PrefixData& prefix_data = maybe_prefix_data.value();
-            const auto user_requests = prefix_data.history().get_user_requests();
-
-            PackageDiff pkg_diff = PackageDiff::from_revision(user_requests, target_revision);
+            PackageDiff pkg_diff = PackageDiff::from_revision(prefix_data.history(), target_revision);
             auto removed_pkg_diff = pkg_diff.removed_pkg_diff;
             auto installed_pkg_diff = pkg_diff.installed_pkg_diff;
 
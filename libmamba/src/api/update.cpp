@@ -218,9 +218,8 @@ namespace mamba
                            .value();
         if (auto* unsolvable = std::get_if<solver::libsolv::UnSolvable>(&outcome))
         {
-            unsolvable->explain_problems_to(
+            LOG_ERROR << unsolvable->explain_problems(
                 db,
-                LOG_ERROR,
                 {
                     /* .unavailable= */ ctx.graphics_params.palette.failure,
                     /* .available= */ ctx.graphics_params.palette.success,
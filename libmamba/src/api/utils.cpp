@@ -195,7 +195,7 @@ namespace mamba
             fmt::join(deps, ", ")
         );
 
-        fmt::print(LOG_INFO, "Calling: {}", fmt::join(command, " "));
+        LOG_INFO << fmt::format("Calling: {}", fmt::join(command, " "));
 
         auto [status, ec] = reproc::run(wrapped_command, options);
         assert_reproc_success(options, status, ec);
@@ -4,6 +4,10 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <optional>
+
+#include <nlohmann/json.hpp>
+
 #include "mamba/core/activation.hpp"
 #include "mamba/core/context.hpp"
 #include "mamba/core/output.hpp"
@@ -11,7 +15,9 @@
 #include "mamba/core/util.hpp"
 #include "mamba/core/util_os.hpp"
 #include "mamba/util/build.hpp"
+#include "mamba/util/cryptography.hpp"
 #include "mamba/util/environment.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 
 namespace mamba
@@ -21,6 +27,92 @@ namespace mamba
         fs::u8path PREFIX_STATE_FILE = fs::u8path("conda-meta") / "state";
         fs::u8path PACKAGE_ENV_VARS_DIR = fs::u8path("etc") / "conda" / "env_vars.d";
         std::string CONDA_ENV_VARS_UNSET_VAR = "***unset***";  // NOLINT(runtime/string)
+
+        /*******************************
+         * Activation cache helpers    *
+         *******************************/
+
+        constexpr int activation_cache_version = 1;
+
+        /** Environment variables read by every activation, whatever the environment. */
+        auto is_activation_env_var(const std::string& name) -> bool
+        {
+            return (name == "PATH") || (name == "Path") || (name == "PS1") || (name == "prompt")
+                   || util::starts_with(name, "CONDA_") || util::starts_with(name, "__CONDA_");
+        }
+
+        void add_stamp(const fs::u8path& path, nlohmann::json& stamps)
+        {
+            std::error_code ec;
+            const auto mtime = fs::last_write_time(path, ec);
+            stamps[path.string()] = ec ? -1 : mtime.time_since_epoch().count();
+        }
+
+        /**
+         * Modification times of the files and directories of a prefix read by the activation.
+         *
+         * Installing or removing a package changes the ``conda-meta`` directory, and the
+         * directories only change when files are added or removed, so the environment variable
+         * files that are read are stamped one by one to catch in-place edits.
+         */
+        void add_prefix_stamps(const fs::u8path& prefix, nlohmann::json& stamps)
+        {
+            const fs::u8path conda_etc = prefix / "etc" / "conda";
+            for (const auto& path : { prefix / "conda-meta",
+                                      prefix / PREFIX_STATE_FILE,
+                                      conda_etc / "activate.d",
+                                      conda_etc / "deactivate.d",
+                                      prefix / PACKAGE_ENV_VARS_DIR })
+            {
+                add_stamp(path, stamps);
+            }
+            for (const auto& path : filter_dir(prefix / PACKAGE_ENV_VARS_DIR, ""))
+            {
+                add_stamp(path, stamps);
+            }
+        }
+
+        auto transform_to_json(const EnvironmentTransform& envt) -> nlohmann::json
+        {
+            const auto paths_to_json = [](const std::vector<fs::u8path>& paths)
+            {
+                auto out = nlohmann::json::array();
+                for (const auto& p : paths)
+                {
+                    out.push_back(p.string());
+                }
+                return out;
+            };
+            return {
+                { "export_path", envt.export_path },
+                { "unset_vars", envt.unset_vars },
+                { "set_vars", envt.set_vars },
+                { "export_vars", envt.export_vars },
+                { "activate_scripts", paths_to_json(envt.activate_scripts) },
+                { "deactivate_scripts", paths_to_json(envt.deactivate_scripts) },
+            };
+        }
+
+        auto transform_from_json(const nlohmann::json& j) -> EnvironmentTransform
+        {
+            const auto paths_from_json = [](const nlohmann::json& paths)
+            {
+                std::vector<fs::u8path> out;
+                for (const auto& p : paths)
+                {
+                    out.emplace_back(p.get<std::string>());
+                }
+                return out;
+            };
+            EnvironmentTransform envt;
+            j.at("export_path").get_to(envt.export_path);
+            j.at("unset_vars").get_to(envt.unset_vars);
+            j.at("set_vars").get_to(envt.set_vars);
+            j.at("export_vars").get_to(envt.export_vars);
+            envt.activate_scripts = paths_from_json(j.at("activate_scripts"));
+            envt.deactivate_scripts = paths_from_json(j.at("deactivate_scripts"));
+            return envt;
+        }
     }  // namespace
 
     /****************************
@@ -658,7 +750,173 @@ namespace mamba
     {
         m_stack = stack;
         m_action = ActivationType::ACTIVATE;
-        return script(build_activate(prefix));
+        if (!m_context.use_activation_cache)
+        {
+            return script(build_activate(prefix));
+        }
+
+        const auto key = activation_cache_key(prefix);
+        const auto cache_file = fs::u8path(util::user_cache_dir()) / "mamba" / "activation"
+                                / (util::Sha256Hasher().str_hex_str(key).substr(0, 32) + ".json");
+        if (auto envt = read_activation_cache(cache_file, key, prefix))
+        {
+            return script(*envt);
+        }
+
+        auto stamps = activation_cache_stamps(prefix);
+        auto envt = build_activate(prefix);
+        write_activation_cache(cache_file, key, std::move(stamps), envt);
+        return script(envt);
+    }
+
+    std::string Activator::activation_cache_key(const fs::u8path& prefix)
+    {
+        return util::concat(
+            std::to_string(activation_cache_version),
+            "\n",
+            shell(),
+            "\n",
+            prefix.string(),
+            "\n",
+            m_context.prefix_params.root_prefix.string(),
+            "\n",
+            m_stack ? "stack" : "",
+            "\n",
+            m_context.change_ps1 ? m_context.env_prompt : ""
+        );
+    }
+
+    nlohmann::json Activator::activation_cache_stamps(const fs::u8path& prefix)
+    {
+        auto stamps = nlohmann::json::object();
+        add_prefix_stamps(prefix, stamps);
+        // A step back, reactivation or environment switch also reads the active environment
+        if (auto it = m_env.find("CONDA_PREFIX"); it != m_env.end())
+        {
+            add_prefix_stamps(it->second, stamps);
+        }
+        return stamps;
+    }
+
+    std::optional<EnvironmentTransform> Activator::read_activation_cache(
+        const fs::u8path& cache_file,
+        const std::string& key,
+        const fs::u8path& prefix
+    )
+    {
+        std::error_code ec;
+        if (!fs::exists(cache_file, ec))
+        {
+            return std::nullopt;
+        }
+        try
+        {
+            auto in = open_ifstream(cache_file);
+            const auto j = nlohmann::json::parse(in);
+            if (j.at("key").get<std::string>() != key)
+            {
+                return std::nullopt;
+            }
+
+            // The recorded variables must have the same values, and no other variable read by
+            // every activation must have been set since.
+            const auto& env = j.at("env");
+            for (const auto& [name, value] : env.items())
+            {
+                auto it = m_env.find(name);
+                if (value.is_null() ? (it != m_env.end())
+                                    : ((it == m_env.end()) || (it->second != value)))
+                {
+                    return std::nullopt;
+                }
+            }
+            for (const auto& [name, value] : m_env)
+            {
+                if (is_activation_env_var(name) && !env.contains(name))
+                {
+                    return std::nullopt;
+                }
+            }
+
+            if (j.at("stamps") != activation_cache_stamps(prefix))
+            {
+                return std::nullopt;
+            }
+            LOG_DEBUG << "Using cached activation " << cache_file;
+            return transform_from_json(j.at("transform"));
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Ignoring activation cache " << cache_file << ": " << e.what();
+            return std::nullopt;
+        }
+    }
+
+    void Activator::write_activation_cache(
+        const fs::u8path& cache_file,
+        const std::string& key,
+        nlohmann::json stamps,
+        const EnvironmentTransform& envt
+    )
+    {
+        // Activations overwriting the current variables warn about it, and are not cached
+        const bool clobbers = std::any_of(
+            envt.export_vars.cbegin(),
+            envt.export_vars.cend(),
+            [](const auto& var) { return util::starts_with(var.first, "__CONDA_SHLVL_"); }
+        );
+        if (clobbers)
+        {
+            return;
+        }
+
+        // The transform depends on the variables read by every activation, and on the
+        // environments variables that it sets or unsets.
+        auto env = nlohmann::json::object();
+        for (const auto& [name, value] : m_env)
+        {
+            if (is_activation_env_var(name))
+            {
+                env[name] = value;
+            }
+        }
+        for (const auto& vars : { envt.set_vars, envt.export_vars })
+        {
+            for (const auto& [name, value] : vars)
+            {
+                auto it = m_env.find(name);
+                env[name] = (it != m_env.end()) ? nlohmann::json(it->second) : nlohmann::json();
+            }
+        }
+        for (const auto& name : envt.unset_vars)
+        {
+            auto it = m_env.find(name);
+            env[name] = (it != m_env.end()) ? nlohmann::json(it->second) : nlohmann::json();
+        }
+
+        const nlohmann::json j = {
+            { "key", key },
+            { "env", std::move(env) },
+            { "stamps", std::move(stamps) },
+            { "transform", transform_to_json(envt) },
+        };
+
+        // The cache is only an optimization, failing to write it is not an error
+        try
+        {
+            fs::create_directories(cache_file.parent_path());
+            const auto tmp_file = cache_file.string() + ".tmp."
+                                  + util::generate_random_alphanumeric_string(8);
+            {
+                auto out = open_ofstream(tmp_file);
+                out << j.dump();
+            }
+            fs::rename(tmp_file, cache_file);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Could not write activation cache " << cache_file << ": " << e.what();
+        }
     }
 
     std::string Activator::reactivate()
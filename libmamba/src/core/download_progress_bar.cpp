@@ -11,37 +11,15 @@ namespace mamba
 
     namespace
     {
-        using time_point = std::chrono::steady_clock::time_point;
-
-        void update_progress_bar(
-            ProgressProxy& progress_bar,
-            time_point& throttle_time,
-            const download::Progress& progress
-        )
+        void update_progress_bar(ProgressProxy& progress_bar, const download::Progress& progress)
         {
-            const auto now = std::chrono::steady_clock::now();
-
-            const auto throttle_threshold = std::chrono::milliseconds(50);
-            if (now - throttle_time < throttle_threshold)
-            {
-                return;
-            }
-            else
-            {
-                throttle_time = now;
-            }
-
-            if (!progress.total_to_download)
-            {
-                progress_bar.activate_spinner();
-            }
-            else
-            {
-                progress_bar.deactivate_spinner();
-            }
-
-            progress_bar.update_progress(progress.downloaded_size, progress.total_to_download);
-            progress_bar.set_speed(progress.speed_Bps);
+            // Called for each received chunk, the progress bar manager applies the progress
+            // when printing its next frame.
+            progress_bar.report_progress(
+                progress.downloaded_size,
+                progress.total_to_download,
+                progress.speed_Bps
+            );
         }
 
         void update_progress_bar(ProgressProxy& progress_bar, const download::Error& error)
@@ -158,7 +136,6 @@ namespace mamba
     void
     SubdirIndexMonitor::observe_impl(download::MultiRequest& requests, download::Options& options)
     {
-        m_throttle_time.resize(requests.size(), std::chrono::steady_clock::now());
         m_progress_bar.reserve(requests.size());
         for (std::size_t i = 0; i < requests.size(); ++i)
         {
@@ -192,7 +169,6 @@ namespace mamba
                 pbar_manager.clear_progress_bars();
             }
         }
-        m_throttle_time.clear();
         m_progress_bar.clear();
         m_options = MonitorOptions{};
     }
@@ -210,7 +186,7 @@ namespace mamba
     void
     SubdirIndexMonitor::update_progress_bar(std::size_t index, const download::Progress& progress)
     {
-        mamba::update_progress_bar(m_progress_bar[index], m_throttle_time[index], progress);
+        mamba::update_progress_bar(m_progress_bar[index], progress);
     }
 
     void SubdirIndexMonitor::update_progress_bar(std::size_t index, const download::Error& error)
@@ -269,7 +245,6 @@ namespace mamba
         assert(extract_tasks.size() >= dl_requests.size());
         auto& pbar_manager = Console::instance().init_progress_bar_manager(ProgressBarMode::aggregated);
         m_extract_bar.reserve(extract_tasks.size());
-        m_throttle_time.resize(dl_requests.size(), std::chrono::steady_clock::now());
         m_download_bar.reserve(dl_requests.size());
 
         for (size_t i = 0; i < extract_tasks.size(); ++i)
@@ -305,7 +280,6 @@ namespace mamba
         {
             pbar_manager.terminate();
         }
-        m_throttle_time.clear();
         m_download_bar.clear();
         m_extract_bar.clear();
     }
@@ -491,7 +465,7 @@ namespace mamba
     void
     PackageDownloadMonitor::update_progress_bar(std::size_t index, const download::Progress& progress)
     {
-        mamba::update_progress_bar(m_download_bar[index], m_throttle_time[index], progress);
+        mamba::update_progress_bar(m_download_bar[index], progress);
     }
 
     void PackageDownloadMonitor::update_progress_bar(std::size_t index, const download::Error& error)
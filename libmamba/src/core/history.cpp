@@ -4,14 +4,20 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <cstdint>
 #include <list>
-#include <regex>
+#include <map>
+#include <optional>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
 
 #include "mamba/core/channel_context.hpp"
 #include "mamba/core/fsutil.hpp"
 #include "mamba/core/history.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/util.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 
 namespace mamba
@@ -19,6 +25,7 @@ namespace mamba
     History::History(const fs::u8path& prefix, ChannelContext& channel_context)
         : m_prefix(prefix)
         , m_history_file_path(fs::absolute(m_prefix / "conda-meta" / "history"))
+        , m_index_file_path(fs::absolute(m_prefix / "conda-meta" / "history.idx"))
         , m_channel_context(channel_context)
     {
     }
@@ -37,58 +44,315 @@ namespace mamba
         return ur;
     }
 
-    std::vector<History::ParseResult> History::parse()
+    namespace
     {
-        std::vector<ParseResult> res;
-        LOG_INFO << "parsing history: " << m_history_file_path;
+        // Bump when the layout of the history index changes
+        inline constexpr int history_index_version = 1;
 
-        if (!fs::exists(m_history_file_path))
+        /**
+         * A history entry, with the offset in bytes of its first line in the history file.
+         */
+        struct HistoryEntry
         {
-            // return empty
+            std::uint64_t offset = 0;
+            History::ParseResult content;
+        };
+
+        /**
+         * Return the date of a ``==> date <==`` head line, or nothing if it is not one.
+         */
+        auto parse_head_line(std::string_view line) -> std::optional<std::string_view>
+        {
+            static constexpr std::string_view head_start = "==>";
+            static constexpr std::string_view head_end = "<==";
+            if ((line.size() < head_start.size() + head_end.size())
+                || !util::starts_with(line, head_start) || !util::ends_with(line, head_end))
+            {
+                return std::nullopt;
+            }
+            line.remove_prefix(head_start.size());
+            line.remove_suffix(head_end.size());
+            const auto date = util::strip(line);
+            if (date.empty())
+            {
+                return std::nullopt;
+            }
+            return { date };
+        }
+
+        /**
+         * Parse the history entries from the current position of the stream.
+         *
+         * The stream must be opened in binary mode and ``offset`` must be its current position,
+         * so that the entries offsets are the positions in the file.
+         */
+        auto parse_entries(std::istream& in, std::uint64_t offset) -> std::vector<HistoryEntry>
+        {
+            std::vector<HistoryEntry> res;
+            std::string line;
+            while (getline(in, line))
+            {
+                const std::uint64_t line_offset = offset;
+                offset += line.size() + (in.eof() ? 0 : 1);
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.pop_back();
+                }
+                if (line.empty())
+                {
+                    continue;
+                }
+                if (auto date = parse_head_line(line))
+                {
+                    HistoryEntry entry{ line_offset, {} };
+                    entry.content.head_line = std::string(date.value());
+                    res.push_back(std::move(entry));
+                    continue;
+                }
+                if (res.empty())
+                {
+                    res.push_back(HistoryEntry{ line_offset, {} });
+                }
+                if (line[0] == '#')
+                {
+                    res.back().content.comments.push_back(line);
+                }
+                else
+                {
+                    res.back().content.diff.push_back(line);
+                }
+            }
             return res;
         }
 
-        static const std::regex head_re("==>\\s*(.+?)\\s*<==");
-        std::ifstream in_file = open_ifstream(m_history_file_path, std::ios::in);
+        auto has_diff(const History::UserRequest& request) -> bool
+        {
+            return !request.link_dists.empty() || !request.unlink_dists.empty();
+        }
+
+        auto parse_spec(const std::string& str) -> specs::MatchSpec
+        {
+            return specs::MatchSpec::parse(str)
+                .or_else([](specs::ParseError&& err) { throw std::move(err); })
+                .value();
+        }
+
+        /**
+         * The history index, stored next to the history file.
+         *
+         * It holds the offsets of the revisions and the requested specs as of the part of
+         * the history already indexed, so that only the entries added since then are parsed.
+         */
+        struct HistoryIndex
+        {
+            // Bytes of the history file covered by the index
+            std::uint64_t size = 0;
+            // Offset and head line of the last entry, to detect a rewritten history
+            std::uint64_t last_entry_offset = 0;
+            std::string last_entry_line;
+            // Offset of each revision entry, by revision number
+            std::vector<std::uint64_t> revisions;
+            // Requested specs by package name, as written in the history
+            std::map<std::string, std::string> requested_specs;
+        };
+
+        void to_json(nlohmann::json& j, const HistoryIndex& index)
+        {
+            j = {
+                { "version", history_index_version },
+                { "size", index.size },
+                { "last_entry_offset", index.last_entry_offset },
+                { "last_entry_line", index.last_entry_line },
+                { "revisions", index.revisions },
+                { "requested_specs", index.requested_specs },
+            };
+        }
+
+        void from_json(const nlohmann::json& j, HistoryIndex& index)
+        {
+            if (j.at("version").get<int>() != history_index_version)
+            {
+                throw std::runtime_error("Unsupported history index version");
+            }
+            j.at("size").get_to(index.size);
+            j.at("last_entry_offset").get_to(index.last_entry_offset);
+            j.at("last_entry_line").get_to(index.last_entry_line);
+            j.at("revisions").get_to(index.revisions);
+            j.at("requested_specs").get_to(index.requested_specs);
+        }
 
-        std::string line;
-        while (getline(in_file, line))
+        /**
+         * Whether the indexed part of the history is unchanged.
+         *
+         * The history is only ever appended to, so a shorter file or a different last entry
+         * means it was rewritten.
+         */
+        auto
+        index_matches(const HistoryIndex& index, std::istream& history, std::uint64_t history_size)
+            -> bool
         {
-            if (line.size() == 0)
+            if (history_size < index.size)
             {
-                continue;
+                return false;
             }
-            std::smatch base_match;
-            if (std::regex_match(line, base_match, head_re))
+            if (index.last_entry_line.empty())
             {
-                ParseResult p;
-                p.head_line = base_match[1].str();
-                res.push_back(p);
+                return true;
             }
-            else if (line[0] == '#')
+            history.seekg(static_cast<std::streamoff>(index.last_entry_offset));
+            std::string line;
+            getline(history, line);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            history.clear();
+            return line == index.last_entry_line;
+        }
+
+        void apply_requested_specs(HistoryIndex& index, const History::UserRequest& request)
+        {
+            for (const auto& spec : request.remove)
             {
-                if (res.size() > 0)
+                index.requested_specs.erase(parse_spec(spec).name().to_string());
+            }
+            for (const auto* specs : { &request.update, &request.neutered })
+            {
+                for (const auto& spec : *specs)
                 {
-                    res[res.size() - 1].comments.push_back(line);
+                    index.requested_specs[parse_spec(spec).name().to_string()] = spec;
                 }
-                else
+            }
+        }
+
+        auto make_user_request(History& history, const History::ParseResult& el)
+            -> History::UserRequest
+        {
+            History::UserRequest r;
+            r.date = el.head_line;
+            for (const auto& c : el.comments)
+            {
+                history.parse_comment_line(c, r);
+            }
+
+            for (const auto& x : el.diff)
+            {
+                if (x[0] == '-')
                 {
-                    res.push_back(ParseResult());
-                    res[0].comments.push_back(line);
+                    r.unlink_dists.push_back(x.substr(1));
+                }
+                else if (x[0] == '+')
+                {
+                    r.link_dists.push_back(x.substr(1));
                 }
             }
-            else if (line.size() != 0)
+            return r;
+        }
+
+        auto read_index(const fs::u8path& index_file) -> std::optional<HistoryIndex>
+        {
+            if (!fs::exists(index_file))
+            {
+                return std::nullopt;
+            }
+            try
+            {
+                auto in = open_ifstream(index_file);
+                return nlohmann::json::parse(in).get<HistoryIndex>();
+            }
+            catch (const std::exception& e)
             {
-                if (res.size() > 0)
+                LOG_DEBUG << "Ignoring invalid history index " << index_file << ": " << e.what();
+                return std::nullopt;
+            }
+        }
+
+        void write_index(const fs::u8path& index_file, const HistoryIndex& index)
+        {
+            // Read-only commands may run on prefixes they cannot write to
+            if (!path::is_writable(index_file.parent_path()))
+            {
+                LOG_DEBUG << "Not writing history index " << index_file << " in read-only prefix";
+                return;
+            }
+            // The index is only a cache, failing to write it only slows down the next reads
+            try
+            {
+                // Concurrent processes each write their own temporary file
+                const auto tmp_file = index_file.string() + ".tmp."
+                                      + util::generate_random_alphanumeric_string(8);
                 {
-                    res[res.size() - 1].diff.push_back(line);
+                    auto out = open_ofstream(tmp_file);
+                    out << nlohmann::json(index).dump();
                 }
-                else
+                fs::rename(tmp_file, index_file);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_DEBUG << "Could not write history index " << index_file << ": " << e.what();
+            }
+        }
+
+        /**
+         * Read the history index and bring it up to date with the history file.
+         */
+        auto update_index(History& history) -> HistoryIndex
+        {
+            if (!fs::exists(history.m_history_file_path))
+            {
+                return {};
+            }
+
+            std::ifstream in = open_ifstream(history.m_history_file_path);
+            const std::uint64_t history_size = fs::file_size(history.m_history_file_path);
+
+            auto index = read_index(history.m_index_file_path);
+            if (!index.has_value() || !index_matches(index.value(), in, history_size))
+            {
+                LOG_INFO << "Indexing history: " << history.m_history_file_path;
+                index = HistoryIndex{};
+            }
+            if (index->size == history_size)
+            {
+                return std::move(index).value();
+            }
+
+            in.seekg(static_cast<std::streamoff>(index->size));
+            for (const auto& entry : parse_entries(in, index->size))
+            {
+                const auto request = make_user_request(history, entry.content);
+                if (has_diff(request))
+                {
+                    index->revisions.push_back(entry.offset);
+                }
+                apply_requested_specs(index.value(), request);
+                if (!entry.content.head_line.empty())
                 {
-                    res.push_back(ParseResult());
-                    res[0].diff.push_back(line);
+                    index->last_entry_offset = entry.offset;
+                    index->last_entry_line = "==> " + entry.content.head_line + " <==";
                 }
             }
+            index->size = history_size;
+            write_index(history.m_index_file_path, index.value());
+            return std::move(index).value();
+        }
+    }
+
+    std::vector<History::ParseResult> History::parse()
+    {
+        std::vector<ParseResult> res;
+        LOG_INFO << "parsing history: " << m_history_file_path;
+
+        if (!fs::exists(m_history_file_path))
+        {
+            // return empty
+            return res;
+        }
+
+        std::ifstream in_file = open_ifstream(m_history_file_path);
+        for (auto& entry : parse_entries(in_file, 0))
+        {
+            res.push_back(std::move(entry.content));
         }
         return res;
     }
@@ -206,25 +470,8 @@ namespace mamba
         std::size_t revision_num = 0;
         for (const auto& el : parse())
         {
-            UserRequest r;
-            r.date = el.head_line;
-            for (const auto& c : el.comments)
-            {
-                parse_comment_line(c, r);
-            }
-
-            for (const auto& x : el.diff)
-            {
-                if (x[0] == '-')
-                {
-                    r.unlink_dists.push_back(x.substr(1));
-                }
-                else if (x[0] == '+')
-                {
-                    r.link_dists.push_back(x.substr(1));
-                }
-            }
-            if ((r.link_dists.size() > 0) || (r.unlink_dists.size() > 0))
+            UserRequest r = make_user_request(*this, el);
+            if (has_diff(r))
             {
                 r.revision_num = revision_num++;
             }
@@ -234,44 +481,38 @@ namespace mamba
         return res;
     }
 
-    std::unordered_map<std::string, specs::MatchSpec> History::get_requested_specs_map()
+    std::vector<History::UserRequest> History::get_user_requests_from_revision(std::size_t revision)
     {
-        std::unordered_map<std::string, specs::MatchSpec> map;
-
-        auto to_specs = [&](const std::vector<std::string>& sv)
+        std::vector<UserRequest> res;
+        const auto index = update_index(*this);
+        if (revision >= index.revisions.size())
         {
-            std::vector<specs::MatchSpec> v;
-            v.reserve(sv.size());
-            for (const auto& el : sv)
-            {
-                v.emplace_back(
-                    specs::MatchSpec::parse(el)
-                        .or_else([](specs::ParseError&& err) { throw std::move(err); })
-                        .value()
-                );
-            }
-            return v;
-        };
+            return res;
+        }
 
-        for (const auto& request : get_user_requests())
+        const auto offset = index.revisions[revision];
+        std::ifstream in_file = open_ifstream(m_history_file_path);
+        in_file.seekg(static_cast<std::streamoff>(offset));
+        std::size_t revision_num = revision;
+        for (const auto& entry : parse_entries(in_file, offset))
         {
-            auto remove_specs = to_specs(request.remove);
-            for (auto& spec : remove_specs)
+            UserRequest r = make_user_request(*this, entry.content);
+            if (has_diff(r))
             {
-                map.erase(spec.name().to_string());
-            }
-            auto update_specs = to_specs(request.update);
-            for (auto& spec : update_specs)
-            {
-                map[spec.name().to_string()] = spec;
-            }
-            auto neutered_specs = to_specs(request.neutered);
-            for (auto& spec : neutered_specs)
-            {
-                map[spec.name().to_string()] = spec;
+                r.revision_num = revision_num++;
             }
+            res.push_back(std::move(r));
         }
+        return res;
+    }
 
+    std::unordered_map<std::string, specs::MatchSpec> History::get_requested_specs_map()
+    {
+        std::unordered_map<std::string, specs::MatchSpec> map;
+        for (const auto& [name, spec] : update_index(*this).requested_specs)
+        {
+            map.emplace(name, parse_spec(spec));
+        }
         return map;
     }
 
@@ -326,6 +567,13 @@ namespace mamba
             out << specs_output("remove", entry.remove);
             out << specs_output("neutered", entry.neutered);
         }
+        out.close();
+
+        // Index the new entry while it is fresh, rather than on the next read
+        if (fs::exists(m_index_file_path))
+        {
+            update_index(*this);
+        }
     }
 
     specs::PackageInfo read_history_url_entry(const std::string& s)
@@ -379,6 +627,16 @@ namespace mamba
         return pkg_info;
     }
 
+    PackageDiff PackageDiff::from_revision(History& history, std::size_t target_revision)
+    {
+        const auto user_requests = history.get_user_requests_from_revision(target_revision);
+        if (user_requests.empty())
+        {
+            return {};
+        }
+        return from_revision(user_requests, target_revision);
+    }
+
     PackageDiff PackageDiff::from_revision(
         const std::vector<History::UserRequest>& user_requests,
         std::size_t target_revision
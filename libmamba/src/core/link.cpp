@@ -16,6 +16,7 @@
 #include "./link.hpp"
 #include "mamba/core/menuinst.hpp"
 #include "mamba/core/output.hpp"
+#include "mamba/core/tracing.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/util/build.hpp"
 #include "mamba/util/environment.hpp"
@@ -849,6 +850,7 @@ namespace mamba
 
     bool LinkPackage::execute()
     {
+        const auto span = tracing::ScopedSpan("link", m_pkg_info.name);
         nlohmann::json index_json, out_json;
         LOG_TRACE << "Preparing linking from '" << m_source.string() << "'";
 
@@ -4,6 +4,7 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <atomic>
 #include <iostream>
 #include <mutex>
 #include <shared_mutex>
@@ -34,6 +35,8 @@ namespace mamba::logging
 #endif
         extern util::synchronized_value<LoggingParams, params_mutex> logging_params;
         extern AnyLogHandler current_log_handler;
+        extern std::atomic<log_level> runtime_log_level;
+        extern std::atomic<bool> backtrace_enabled;
     }
 
     namespace
@@ -53,6 +56,12 @@ namespace mamba::logging
             }
             return synched_value;
         }
+
+        auto update_runtime_log_params(const LoggingParams& params) -> void
+        {
+            details::runtime_log_level = params.logging_level;
+            details::backtrace_enabled = params.log_backtrace > 0;
+        }
     }
 
     AnyLogHandler::~AnyLogHandler()
@@ -103,6 +112,7 @@ namespace mamba::logging
             auto previous_handler = std::exchange(details::current_log_handler, std::move(new_handler));
 
             auto params = synchronize_with_value(details::logging_params, maybe_new_params);
+            update_runtime_log_params(*params);
 
             if (details::current_log_handler)
             {
@@ -143,6 +153,7 @@ namespace mamba::logging
         auto synched_params = details::logging_params.synchronize();
         const auto previous_level = synched_params->logging_level;
         synched_params->logging_level = new_level;
+        details::runtime_log_level = new_level;
         if (details::current_log_handler)
         {
             details::current_log_handler.set_log_level(synched_params->logging_level);
@@ -165,6 +176,7 @@ namespace mamba::logging
         auto synched_params = details::logging_params.synchronize();
         LoggingParams previous_params = *synched_params;
         *synched_params = std::move(new_params);
+        update_runtime_log_params(*synched_params);
         if (details::current_log_handler)
         {
             details::current_log_handler.set_params(*synched_params);
@@ -173,6 +185,27 @@ namespace mamba::logging
         return previous_params;
     }
 
+    auto enable_backtrace(size_t records_buffer_size) -> void
+    {
+        details::backtrace_enabled = records_buffer_size > 0;
+        call_log_handler_if_existing(&AnyLogHandler::enable_backtrace, records_buffer_size);
+    }
+
+    // as thread-safe as handler's implementation if set
+    auto disable_backtrace() -> void
+    {
+        enable_backtrace(0);
+    }
+
+    auto details::is_runtime_log_enabled(log_level level) -> bool
+    {
+        // The backtrace keeps the records whatever their level, and the records logged before
+        // the console exists are kept until they can be filtered by the log handler.
+        const auto threshold = runtime_log_level.load(std::memory_order_relaxed);
+        return level >= threshold or threshold == log_level::all
+               or backtrace_enabled.load(std::memory_order_relaxed) or not Console::is_available();
+    }
+
     ///////////////////////////////////////////////////////////////////
     // MessageLogger
     namespace details
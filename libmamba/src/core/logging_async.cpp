@@ -0,0 +1,488 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <typeindex>
+
+#include <fmt/core.h>
+
+#include <mamba/core/logging_async.hpp>
+
+namespace mamba::logging
+{
+    namespace
+    {
+        // When the buffer of a thread is full, records of this level or higher are delivered
+        // synchronously instead of being dropped.
+        constexpr log_level min_undroppable_level = log_level::warn;
+
+        struct PendingRecord
+        {
+            std::uint64_t sequence = 0;
+            LogRecord record;
+        };
+
+        /** Single-producer single-consumer ring buffer of log records.
+
+            The producer is the logging thread owning the ring, the consumer is whichever
+            thread holds the delivery mutex of the log handler.
+        */
+        class RecordRing
+        {
+        public:
+
+            explicit RecordRing(std::size_t capacity)
+                : m_records(std::max<std::size_t>(capacity, 1))
+            {
+            }
+
+            /** Moves the record into the ring, unless it is full. */
+            auto try_push(std::uint64_t sequence, LogRecord& record) -> bool
+            {
+                const auto tail = m_tail.load(std::memory_order_relaxed);
+                if (tail - m_head.load(std::memory_order_acquire) >= m_records.size())
+                {
+                    return false;
+                }
+                auto& pending = m_records[tail % m_records.size()];
+                pending.sequence = sequence;
+                pending.record = std::move(record);
+                m_tail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            auto pop_all(std::vector<PendingRecord>& out) -> void
+            {
+                auto head = m_head.load(std::memory_order_relaxed);
+                const auto tail = m_tail.load(std::memory_order_acquire);
+                for (; head != tail; ++head)
+                {
+                    out.push_back(std::move(m_records[head % m_records.size()]));
+                }
+                m_head.store(tail, std::memory_order_release);
+            }
+
+            auto is_half_full() const -> bool
+            {
+                const auto size = m_tail.load(std::memory_order_relaxed)
+                                  - m_head.load(std::memory_order_relaxed);
+                return 2 * size >= m_records.size();
+            }
+
+            /** Set by the producer once it will not push anymore. */
+            std::atomic<bool> abandoned = false;
+
+        private:
+
+            std::vector<PendingRecord> m_records;
+            alignas(64) std::atomic<std::size_t> m_head = 0;
+            alignas(64) std::atomic<std::size_t> m_tail = 0;
+        };
+
+        /** The ring of the current thread, for the log handler identified by ``owner``. */
+        struct ProducerSlot
+        {
+            std::uint64_t owner = 0;
+            std::shared_ptr<RecordRing> ring;
+
+            ~ProducerSlot()
+            {
+                if (ring)
+                {
+                    ring->abandoned.store(true, std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local ProducerSlot producer_slot;
+
+        std::atomic<std::uint64_t> next_handler_id = 1;
+
+        auto must_flush(log_level level, log_level threshold) -> bool
+        {
+            return threshold == log_level::all
+                   or (threshold != log_level::off and level >= threshold);
+        }
+    }
+
+    struct LogHandler_Async::Impl
+    {
+        AnyLogHandler backend;
+        Options options;
+
+        // Identifies one start of the handler, so that threads register new rings after a
+        // restart.
+        std::atomic<std::uint64_t> id = 0;
+        std::atomic<bool> is_active = false;
+        std::atomic<log_level> current_log_level = log_level::warn;
+        // Filtered out records still go to the backtrace of the backend
+        std::atomic<bool> backtrace_enabled = false;
+        std::atomic<log_level> flush_threshold = log_level::off;
+        std::atomic<std::uint64_t> sequence = 0;
+        std::atomic<std::uint64_t> dropped = 0;
+
+        // Guards the backend and the rings
+        std::mutex delivery_mutex;
+        std::vector<std::shared_ptr<RecordRing>> rings;
+        std::vector<PendingRecord> batch;
+        std::uint64_t reported_dropped = 0;
+
+        std::mutex wake_mutex;
+        std::condition_variable wake_condition;
+        bool stop_requested = false;
+        std::atomic<bool> wake_requested = false;
+        std::thread flusher;
+
+        // The handler whose records are delivered by the `atexit` hook.
+        static std::atomic<Impl*> at_exit_handler;
+        static std::atomic<bool> exiting;
+
+        Impl(AnyLogHandler backend_, Options options_)
+            : backend(std::move(backend_))
+            , options(std::move(options_))
+        {
+        }
+
+        ~Impl()
+        {
+            stop_flusher();
+            Impl* self = this;
+            at_exit_handler.compare_exchange_strong(self, nullptr);
+        }
+
+        auto ring_of_this_thread() -> RecordRing&
+        {
+            auto& slot = producer_slot;
+            const auto current_id = id.load(std::memory_order_relaxed);
+            if (slot.owner != current_id or not slot.ring)
+            {
+                if (slot.ring)
+                {
+                    slot.ring->abandoned.store(true, std::memory_order_release);
+                }
+                slot.ring = std::make_shared<RecordRing>(options.buffer_size);
+                slot.owner = current_id;
+
+                std::lock_guard lock(delivery_mutex);
+                rings.push_back(slot.ring);
+            }
+            return *slot.ring;
+        }
+
+        /** Delivers all the pending records to the backend, in order of sequence.
+
+            Requires holding `delivery_mutex`.
+            @returns `true` if something was delivered.
+        */
+        auto deliver_pending() -> bool
+        {
+            for (auto it = rings.begin(); it != rings.end();)
+            {
+                // Read before popping, so that no record pushed before abandoning is missed
+                const bool abandoned = (*it)->abandoned.load(std::memory_order_acquire);
+                (*it)->pop_all(batch);
+                it = abandoned ? rings.erase(it) : std::next(it);
+            }
+
+            const auto dropped_now = dropped.load(std::memory_order_relaxed);
+            if (batch.empty() and (dropped_now == reported_dropped))
+            {
+                return false;
+            }
+
+            std::sort(
+                batch.begin(),
+                batch.end(),
+                [](const auto& lhs, const auto& rhs) { return lhs.sequence < rhs.sequence; }
+            );
+            for (auto& pending : batch)
+            {
+                backend.log(std::move(pending.record));
+            }
+            batch.clear();
+
+            if (dropped_now != reported_dropped)
+            {
+                backend.log({ .message = fmt::format(
+                                  "{} log records dropped by the asynchronous log handler",
+                                  dropped_now - reported_dropped
+                              ),
+                              .level = log_level::warn,
+                              .source = log_source::libmamba });
+                reported_dropped = dropped_now;
+            }
+            return true;
+        }
+
+        auto wake_flusher() -> void
+        {
+            if (not wake_requested.exchange(true, std::memory_order_relaxed))
+            {
+                wake_condition.notify_one();
+            }
+        }
+
+        auto run_flusher() -> void
+        {
+            std::unique_lock wake_lock(wake_mutex);
+            while (not stop_requested)
+            {
+                wake_condition.wait_for(
+                    wake_lock,
+                    options.flush_interval,
+                    [&] { return stop_requested or wake_requested.load(); }
+                );
+                wake_requested = false;
+                wake_lock.unlock();
+                try
+                {
+                    std::lock_guard lock(delivery_mutex);
+                    if (deliver_pending())
+                    {
+                        backend.flush();
+                    }
+                }
+                catch (...)
+                {
+                    // A failing backend must not terminate the program from this thread,
+                    // the records are lost either way.
+                }
+                wake_lock.lock();
+            }
+        }
+
+        auto start_flusher() -> void
+        {
+            {
+                std::lock_guard wake_lock(wake_mutex);
+                stop_requested = false;
+            }
+            flusher = std::thread([this] { run_flusher(); });
+        }
+
+        auto stop_flusher() -> void
+        {
+            {
+                std::lock_guard wake_lock(wake_mutex);
+                stop_requested = true;
+            }
+            wake_condition.notify_one();
+            if (flusher.joinable())
+            {
+                flusher.join();
+            }
+        }
+
+        /** Delivers the records at exit, while the backend and its dependencies are alive.
+
+            Static destructors run after the `atexit` hooks registered after the construction
+            of these objects, which is the case once the backend has been started.
+        */
+        static auto deliver_at_exit() -> void
+        {
+            exiting = true;
+            if (auto* impl = at_exit_handler.exchange(nullptr))
+            {
+                impl->stop_flusher();
+                std::lock_guard lock(impl->delivery_mutex);
+                impl->deliver_pending();
+                impl->backend.flush();
+            }
+        }
+    };
+
+    std::atomic<LogHandler_Async::Impl*> LogHandler_Async::Impl::at_exit_handler = nullptr;
+    std::atomic<bool> LogHandler_Async::Impl::exiting = false;
+
+    LogHandler_Async::LogHandler_Async(AnyLogHandler backend, Options options, int)
+        : pimpl(std::make_unique<Impl>(std::move(backend), std::move(options)))
+    {
+        assert(pimpl->backend.has_value());
+    }
+
+    LogHandler_Async::~LogHandler_Async() = default;
+
+    LogHandler_Async::LogHandler_Async(LogHandler_Async&& other) noexcept = default;
+    LogHandler_Async& LogHandler_Async::operator=(LogHandler_Async&& other) noexcept = default;
+
+    auto LogHandler_Async::start_log_handling(LoggingParams params, std::vector<log_source> sources)
+        -> void
+    {
+        assert(pimpl);
+        if (pimpl->flusher.joinable())
+        {
+            pimpl->stop_flusher();
+        }
+
+        pimpl->current_log_level = params.logging_level;
+        pimpl->backtrace_enabled = params.log_backtrace > 0;
+        pimpl->id = next_handler_id++;
+        pimpl->backend.start_log_handling(std::move(params), std::move(sources));
+
+        static std::once_flag at_exit_flag;
+        std::call_once(at_exit_flag, [] { std::atexit(&Impl::deliver_at_exit); });
+        pimpl->at_exit_handler = pimpl.get();
+
+        pimpl->start_flusher();
+        pimpl->is_active = true;
+    }
+
+    auto LogHandler_Async::stop_log_handling(stop_reason reason) -> void
+    {
+        if (not pimpl)
+        {
+            return;
+        }
+
+        pimpl->is_active = false;
+        pimpl->stop_flusher();
+        Impl* self = pimpl.get();
+        Impl::at_exit_handler.compare_exchange_strong(self, nullptr);
+
+        std::lock_guard lock(pimpl->delivery_mutex);
+        // Once the `atexit` hook ran, the backend may rely on objects already destroyed.
+        if (not Impl::exiting)
+        {
+            pimpl->deliver_pending();
+            pimpl->backend.flush();
+        }
+        pimpl->rings.clear();
+        pimpl->backend.stop_log_handling(reason);
+    }
+
+    auto LogHandler_Async::set_log_level(log_level new_level) -> void
+    {
+        assert(pimpl);
+        pimpl->current_log_level = new_level;
+        std::lock_guard lock(pimpl->delivery_mutex);
+        pimpl->deliver_pending();
+        pimpl->backend.set_log_level(new_level);
+    }
+
+    auto LogHandler_Async::set_params(LoggingParams new_params) -> void
+    {
+        assert(pimpl);
+        pimpl->current_log_level = new_params.logging_level;
+        pimpl->backtrace_enabled = new_params.log_backtrace > 0;
+        std::lock_guard lock(pimpl->delivery_mutex);
+        pimpl->deliver_pending();
+        pimpl->backend.set_params(std::move(new_params));
+    }
+
+    auto LogHandler_Async::log(LogRecord record) -> void
+    {
+        assert(pimpl);
+        if (not pimpl->is_active
+            or (not pimpl->backtrace_enabled and (pimpl->current_log_level > record.level)))
+        {
+            return;
+        }
+
+        const auto level = record.level;
+        const auto sequence = pimpl->sequence.fetch_add(1, std::memory_order_relaxed);
+        auto& ring = pimpl->ring_of_this_thread();
+        if (ring.try_push(sequence, record))
+        {
+            if (ring.is_half_full())
+            {
+                pimpl->wake_flusher();
+            }
+        }
+        else if (level < min_undroppable_level)
+        {
+            pimpl->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            std::lock_guard lock(pimpl->delivery_mutex);
+            pimpl->deliver_pending();
+            pimpl->backend.log(std::move(record));
+        }
+
+        if (must_flush(level, pimpl->flush_threshold))
+        {
+            std::lock_guard lock(pimpl->delivery_mutex);
+            pimpl->deliver_pending();
+            pimpl->backend.flush();
+        }
+    }
+
+    auto LogHandler_Async::enable_backtrace(size_t record_buffer_size) -> void
+    {
+        assert(pimpl);
+        pimpl->backtrace_enabled = record_buffer_size > 0;
+        std::lock_guard lock(pimpl->delivery_mutex);
+        pimpl->deliver_pending();
+        pimpl->backend.enable_backtrace(record_buffer_size);
+    }
+
+    auto LogHandler_Async::log_backtrace() -> void
+    {
+        assert(pimpl);
+        std::lock_guard lock(pimpl->delivery_mutex);
+        pimpl->deliver_pending();
+        pimpl->backend.log_backtrace();
+    }
+
+    auto LogHandler_Async::log_backtrace_no_guards() -> void
+    {
+        assert(pimpl);
+        std::lock_guard lock(pimpl->delivery_mutex);
+        pimpl->deliver_pending();
+        pimpl->backend.log_backtrace_no_guards();
+    }
+
+    auto LogHandler_Async::flush(std::optional<log_source> source) -> void
+    {
+        assert(pimpl);
+        std::lock_guard lock(pimpl->delivery_mutex);
+        pimpl->deliver_pending();
+        pimpl->backend.flush(source);
+    }
+
+    auto LogHandler_Async::set_flush_threshold(log_level threshold_level) -> void
+    {
+        assert(pimpl);
+        pimpl->flush_threshold = threshold_level;
+        std::lock_guard lock(pimpl->delivery_mutex);
+        pimpl->deliver_pending();
+        pimpl->backend.set_flush_threshold(threshold_level);
+    }
+
+    auto LogHandler_Async::is_started() const -> bool
+    {
+        return pimpl and pimpl->is_active;
+    }
+
+    auto LogHandler_Async::dropped_count() const -> std::uint64_t
+    {
+        return pimpl ? pimpl->dropped.load() : 0;
+    }
+
+    auto LogHandler_Async::get_options() const -> const Options&
+    {
+        assert(pimpl);
+        return pimpl->options;
+    }
+
+    auto use_async_log_handler(LogHandler_Async_Options options) -> void
+    {
+        const auto& current = get_log_handler();
+        if (not current or (current.type_id() == std::type_index(typeid(LogHandler_Async))))
+        {
+            return;
+        }
+
+        set_log_handler(LogHandler_Async(stop_logging(), std::move(options)));
+    }
+}
@@ -7,6 +7,7 @@
 #include "mamba/core/invoke.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/package_fetcher.hpp"
+#include "mamba/core/tracing.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/specs/archive.hpp"
 #include "mamba/util/string.hpp"
@@ -145,6 +146,12 @@ namespace mamba
         request.expected_size = expected_size();
         request.sha256 = sha256();
 
+        if (p_streaming_extraction != nullptr)
+        {
+            request.on_write = [extraction = p_streaming_extraction](std::size_t offset, std::size_t size)
+            { extraction->on_write(offset, size); };
+        }
+
         request.on_success = [this, cb = std::move(callback)](const download::Success& success)
         {
             LOG_INFO << "Download finished, tarball available at '" << m_tarball_path.string() << "'";
@@ -285,13 +292,17 @@ namespace mamba
         {
             std::lock_guard<counting_semaphore> lock(PackageFetcherSemaphore::semaphore);
             interruption_point();
+            const auto span = tracing::ScopedSpan("extract", name());
             LOG_DEBUG << "Decompressing '" << m_tarball_path.string() << "'";
             try
             {
                 const fs::u8path extract_path = get_extract_path(filename(), m_cache_path);
                 // Be sure the first writable cache doesn't contain invalid extracted package
                 clear_extract_path(extract_path);
-                extract_impl(m_tarball_path, extract_path, options);
+                if (!promote_streaming_extraction(extract_path))
+                {
+                    extract_impl(m_tarball_path, extract_path, options);
+                }
 
                 interruption_point();
                 LOG_DEBUG << "Extracted to '" << extract_path.string() << "'";
@@ -313,6 +324,18 @@ namespace mamba
 
     PackageExtractTask PackageFetcher::build_extract_task(ExtractOptions options)
     {
+        // The extracted data is checked against the SHA256 before being used
+        if (options.streaming && m_needs_download && util::ends_with(filename(), ".conda")
+            && expected_size() > 0 && !sha256().empty())
+        {
+            const fs::u8path extract_path = get_extract_path(filename(), m_cache_path);
+            p_streaming_extraction = std::make_shared<StreamingExtraction>(
+                m_tarball_path,
+                expected_size(),
+                extract_path.string() + ".staging",
+                options
+            );
+        }
         return { this, std::move(options) };
     }
 
@@ -428,6 +451,37 @@ namespace mamba
         return res;
     }
 
+    bool PackageFetcher::promote_streaming_extraction(const fs::u8path& extract_path)
+    {
+        if (p_streaming_extraction == nullptr)
+        {
+            return false;
+        }
+        const auto extraction = std::exchange(p_streaming_extraction, nullptr);
+        const auto extracted_sha256 = extraction->wait();
+        if (!extracted_sha256)
+        {
+            LOG_DEBUG << "Could not extract '" << filename()
+                      << "' while downloading it: " << extracted_sha256.error().what();
+            return false;
+        }
+        if (extracted_sha256.value() != sha256())
+        {
+            LOG_WARNING << "Extracted data of '" << filename() << "' doesn't match its SHA256";
+            return false;
+        }
+        std::error_code ec;
+        fs::rename(extraction->destination(), extract_path, ec);
+        if (ec)
+        {
+            LOG_DEBUG << "Could not move '" << extraction->destination().string() << "' to '"
+                      << extract_path.string() << "': " << ec.message();
+            return false;
+        }
+        LOG_DEBUG << "Extracted '" << filename() << "' while downloading it";
+        return true;
+    }
+
     void PackageFetcher::write_repodata_record(const fs::u8path& base_path) const
     {
         const fs::u8path repodata_record_path = base_path / "info" / "repodata_record.json";
@@ -5,6 +5,13 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
 #include <archive.h>
 #include <archive_entry.h>
 #include <reproc++/run.hpp>
@@ -15,6 +22,8 @@
 #include "mamba/core/package_paths.hpp"
 #include "mamba/core/thread_utils.hpp"
 #include "mamba/core/util_os.hpp"
+#include "mamba/util/cryptography.hpp"
+#include "mamba/util/encoding.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/validation/tools.hpp"
 
@@ -30,6 +39,7 @@ namespace mamba
             /* .subproc_mode = */ context.command_params.is_mamba_exe
                 ? extract_subproc_mode::mamba_exe
                 : extract_subproc_mode::mamba_package,
+            /* .streaming = */ context.extract_while_downloading,
         };
     }
 
@@ -525,88 +535,124 @@ namespace mamba
         };
     }
 
-    void stream_extract_archive(
-        scoped_archive_read& a,
-        const fs::u8path& destination,
-        const ExtractOptions& options
-    )
+    namespace
     {
-        auto prev_path = fs::current_path();
-        if (!fs::exists(destination))
-        {
-            fs::create_directories(destination);
-        }
-        fs::current_path(destination);
-
-        /* Select which attributes we want to restore. */
-        int flags = ARCHIVE_EXTRACT_TIME;
-        flags |= ARCHIVE_EXTRACT_PERM;
-        flags |= ARCHIVE_EXTRACT_SECURE_NODOTDOT;
-        flags |= ARCHIVE_EXTRACT_SECURE_SYMLINKS;
-        flags |= ARCHIVE_EXTRACT_SECURE_NOABSOLUTEPATHS;
-        flags |= ARCHIVE_EXTRACT_UNLINK;
-
-        if (options.sparse)
+        // Moves the entry under `base_dir`. The resulting absolute paths are rejected by the
+        // ARCHIVE_EXTRACT_SECURE_NOABSOLUTEPATHS check, so it is done here instead.
+        void rebase_archive_entry(archive_entry* entry, const fs::u8path& base_dir)
         {
-            flags |= ARCHIVE_EXTRACT_SPARSE;
-        }
-
-        scoped_archive_write ext = scoped_archive_write::write_disk();
-        archive_write_disk_set_options(ext, flags);
-        archive_write_disk_set_standard_lookup(ext);
-
-        int r;
-        archive_entry* entry;
-        for (;;)
-        {
-            if (is_sig_interrupted())
+            const auto rebase = [&base_dir](const char* name)
             {
-                throw std::runtime_error("SIGINT received. Aborting extraction.");
+                const fs::u8path path = name;
+                if (path.has_root_path())
+                {
+                    throw std::runtime_error(fmt::format("Absolute path in archive: {}", name));
+                }
+                return (base_dir / path).string();
+            };
+            archive_entry_copy_pathname(entry, rebase(archive_entry_pathname(entry)).c_str());
+            if (const char* link = archive_entry_hardlink(entry); link != nullptr)
+            {
+                archive_entry_copy_hardlink(entry, rebase(link).c_str());
             }
+        }
 
-            r = archive_read_next_header(a, &entry);
-            if (r == ARCHIVE_EOF)
+        // Writes the entries relative to the working directory or, if `base_dir` is not
+        // empty, under `base_dir` which must not contain any symlink.
+        void
+        write_archive_entries(scoped_archive_read& a, const fs::u8path& base_dir, const ExtractOptions& options)
+        {
+            /* Select which attributes we want to restore. */
+            int flags = ARCHIVE_EXTRACT_TIME;
+            flags |= ARCHIVE_EXTRACT_PERM;
+            flags |= ARCHIVE_EXTRACT_SECURE_NODOTDOT;
+            flags |= ARCHIVE_EXTRACT_SECURE_SYMLINKS;
+            flags |= ARCHIVE_EXTRACT_UNLINK;
+
+            if (base_dir.empty())
             {
-                break;
+                flags |= ARCHIVE_EXTRACT_SECURE_NOABSOLUTEPATHS;
             }
-            if (r < ARCHIVE_OK)
+            if (options.sparse)
             {
-                throw std::runtime_error(archive_error_string(a));
+                flags |= ARCHIVE_EXTRACT_SPARSE;
             }
 
-            r = archive_write_header(ext, entry);
-            if (r < ARCHIVE_OK)
-            {
-                throw std::runtime_error(archive_error_string(ext));
-            }
-            else if (archive_entry_size(entry) > 0)
+            scoped_archive_write ext = scoped_archive_write::write_disk();
+            archive_write_disk_set_options(ext, flags);
+            archive_write_disk_set_standard_lookup(ext);
+
+            int r;
+            archive_entry* entry;
+            for (;;)
             {
-                r = copy_data(a, ext);
+                if (is_sig_interrupted())
+                {
+                    throw std::runtime_error("SIGINT received. Aborting extraction.");
+                }
+
+                r = archive_read_next_header(a, &entry);
+                if (r == ARCHIVE_EOF)
+                {
+                    break;
+                }
                 if (r < ARCHIVE_OK)
                 {
-                    const char* err_str = archive_error_string(ext);
-                    if (err_str == nullptr)
-                    {
-                        err_str = archive_error_string(a);
-                    }
-                    if (err_str != nullptr)
+                    throw std::runtime_error(archive_error_string(a));
+                }
+                if (!base_dir.empty())
+                {
+                    rebase_archive_entry(entry, base_dir);
+                }
+
+                r = archive_write_header(ext, entry);
+                if (r < ARCHIVE_OK)
+                {
+                    throw std::runtime_error(archive_error_string(ext));
+                }
+                else if (archive_entry_size(entry) > 0)
+                {
+                    r = copy_data(a, ext);
+                    if (r < ARCHIVE_OK)
                     {
-                        throw std::runtime_error(err_str);
+                        const char* err_str = archive_error_string(ext);
+                        if (err_str == nullptr)
+                        {
+                            err_str = archive_error_string(a);
+                        }
+                        if (err_str != nullptr)
+                        {
+                            throw std::runtime_error(err_str);
+                        }
+                        throw std::runtime_error("Extraction: writing data was not successful.");
                     }
-                    throw std::runtime_error("Extraction: writing data was not successful.");
                 }
-            }
-            r = archive_write_finish_entry(ext);
-            if (r == ARCHIVE_WARN)
-            {
-                LOG_WARNING << "libarchive warning: " << archive_error_string(a);
-            }
-            else if (r < ARCHIVE_OK)
-            {
-                throw std::runtime_error(archive_error_string(ext));
+                r = archive_write_finish_entry(ext);
+                if (r == ARCHIVE_WARN)
+                {
+                    LOG_WARNING << "libarchive warning: " << archive_error_string(a);
+                }
+                else if (r < ARCHIVE_OK)
+                {
+                    throw std::runtime_error(archive_error_string(ext));
+                }
             }
         }
+    }
 
+    void stream_extract_archive(
+        scoped_archive_read& a,
+        const fs::u8path& destination,
+        const ExtractOptions& options
+    )
+    {
+        auto prev_path = fs::current_path();
+        if (!fs::exists(destination))
+        {
+            fs::create_directories(destination);
+        }
+        fs::current_path(destination);
+        write_archive_entries(a, {}, options);
         fs::current_path(prev_path);
     }
 
@@ -633,6 +679,92 @@ namespace mamba
         return archive_read_open1(a);
     }
 
+    namespace
+    {
+        // Extracts the requested parts of the ``.conda`` archive opened in `a`, the inner
+        // tarballs being extracted by `extract_tarball`.
+        template <typename Func>
+        void extract_conda_parts(
+            scoped_archive_read& a,
+            conda_extract_context& extract_context,
+            const fs::u8path& file,
+            const std::vector<std::string>& parts,
+            Func&& extract_tarball
+        )
+        {
+            auto check_parts = [&parts](const std::string& name)
+            {
+                std::size_t pos = name.find_first_of('-');
+                if (pos == std::string::npos)
+                {
+                    return false;
+                }
+                std::string part = name.substr(0, pos);
+                if (std::find(parts.begin(), parts.end(), part) != parts.end())
+                {
+                    return true;
+                }
+                return false;
+            };
+
+            int r;
+            archive_entry* entry;
+            for (;;)
+            {
+                if (is_sig_interrupted())
+                {
+                    throw std::runtime_error("SIGINT received. Aborting extraction.");
+                }
+
+                r = archive_read_next_header(a, &entry);
+                if (r == ARCHIVE_EOF)
+                {
+                    break;
+                }
+                if (r < ARCHIVE_OK)
+                {
+                    throw std::runtime_error(archive_error_string(a));
+                }
+
+                fs::u8path p(archive_entry_pathname(entry));
+                if (p.extension() == ".zst" && check_parts(p.filename().string()))
+                {
+                    // extract zstd file
+                    scoped_archive_read inner;
+                    archive_read_support_filter_zstd(inner);
+                    archive_read_support_format_tar(inner);
+
+                    archive_read_open_archive_entry(inner, &extract_context);
+                    extract_tarball(inner);
+                }
+                else if (p.filename() == "metadata.json")
+                {
+                    std::size_t json_size = static_cast<std::size_t>(archive_entry_size(entry));
+                    if (json_size == 0)
+                    {
+                        LOG_INFO << "Package contains empty metadata.json file (" << file << ")";
+                        continue;
+                    }
+                    std::string json(json_size, '\0');
+                    archive_read_data(a, json.data(), json_size);
+                    try
+                    {
+                        auto obj = nlohmann::json::parse(json);
+                        if (obj["conda_pkg_format_version"] != 2)
+                        {
+                            LOG_WARNING << "Unsupported conda package format version (" << file
+                                        << ") - still trying to extract";
+                        }
+                    }
+                    catch (const std::exception& e)
+                    {
+                        LOG_WARNING << "Error parsing metadata.json (" << file << "): " << e.what();
+                    }
+                }
+            }
+        }
+    }
+
     void extract_conda(
         const fs::u8path& file,
         const fs::u8path& dest_dir,
@@ -651,76 +783,13 @@ namespace mamba
             throw std::runtime_error(archive_error_string(a));
         }
 
-        auto check_parts = [&parts](const std::string& name)
-        {
-            std::size_t pos = name.find_first_of('-');
-            if (pos == std::string::npos)
-            {
-                return false;
-            }
-            std::string part = name.substr(0, pos);
-            if (std::find(parts.begin(), parts.end(), part) != parts.end())
-            {
-                return true;
-            }
-            return false;
-        };
-
-        int r;
-        archive_entry* entry;
-        for (;;)
-        {
-            if (is_sig_interrupted())
-            {
-                throw std::runtime_error("SIGINT received. Aborting extraction.");
-            }
-
-            r = archive_read_next_header(a, &entry);
-            if (r == ARCHIVE_EOF)
-            {
-                break;
-            }
-            if (r < ARCHIVE_OK)
-            {
-                throw std::runtime_error(archive_error_string(a));
-            }
-
-            fs::u8path p(archive_entry_pathname(entry));
-            if (p.extension() == ".zst" && check_parts(p.filename().string()))
-            {
-                // extract zstd file
-                scoped_archive_read inner;
-                archive_read_support_filter_zstd(inner);
-                archive_read_support_format_tar(inner);
-
-                archive_read_open_archive_entry(inner, &extract_context);
-                stream_extract_archive(inner, dest_dir, options);
-            }
-            else if (p.filename() == "metadata.json")
-            {
-                std::size_t json_size = static_cast<std::size_t>(archive_entry_size(entry));
-                if (json_size == 0)
-                {
-                    LOG_INFO << "Package contains empty metadata.json file (" << file << ")";
-                    continue;
-                }
-                std::string json(json_size, '\0');
-                archive_read_data(a, json.data(), json_size);
-                try
-                {
-                    auto obj = nlohmann::json::parse(json);
-                    if (obj["conda_pkg_format_version"] != 2)
-                    {
-                        LOG_WARNING << "Unsupported conda package format version (" << file
-                                    << ") - still trying to extract";
-                    }
-                }
-                catch (const std::exception& e)
-                {
-                    LOG_WARNING << "Error parsing metadata.json (" << file << "): " << e.what();
-                }
-            }
-        }
+        extract_conda_parts(
+            a,
+            extract_context,
+            file,
+            parts,
+            [&](scoped_archive_read& inner) { stream_extract_archive(inner, dest_dir, options); }
+        );
     }
 
     static fs::u8path extract_dest_dir(const fs::u8path& file)
@@ -897,4 +966,222 @@ namespace mamba
         }
         return true;
     }
+
+    /***********************
+     * StreamingExtraction *
+     ***********************/
+
+    struct StreamingExtraction::Impl
+    {
+        Impl(fs::u8path lfile, std::size_t lfile_size, fs::u8path ldest_dir, ExtractOptions loptions)
+            : file(std::move(lfile))
+            , file_size(lfile_size)
+            , dest_dir(std::move(ldest_dir))
+            , options(std::move(loptions))
+        {
+        }
+
+        fs::u8path file;
+        std::size_t file_size;
+        fs::u8path dest_dir;
+        ExtractOptions options;
+
+        std::mutex mutex = {};
+        std::condition_variable data_available = {};
+        std::size_t written_size = 0;
+        bool abandoned = false;
+        std::string error = {};
+        std::thread worker = {};
+
+        // Only used by the worker thread
+        std::ifstream input = {};
+        std::vector<char> buffer = std::vector<char>(download::get_zstd_buff_out_size());
+        util::Sha256Digester digester = {};
+        std::size_t read_size = 0;
+        std::string sha256 = {};
+
+        void run();
+        // Requires the mutex to be locked
+        void abandon(std::string reason);
+        la_ssize_t read_block(archive* a, const void** block);
+
+        static la_ssize_t read_callback(archive* a, void* self, const void** block)
+        {
+            return static_cast<Impl*>(self)->read_block(a, block);
+        }
+    };
+
+    void StreamingExtraction::Impl::run()
+    {
+        try
+        {
+            fs::remove_all(dest_dir);
+            fs::create_directories(dest_dir);
+            // The entries are written under an absolute path, which must not contain symlinks
+            const fs::u8path base_dir = fs::canonical(dest_dir);
+            digester.digest_start();
+
+            scoped_archive_read a;
+            archive_read_support_format_zip(a);
+            archive_read_set_read_callback(a, read_callback);
+            archive_read_set_callback_data(a, this);
+            if (archive_read_open1(a) != ARCHIVE_OK)
+            {
+                throw std::runtime_error(archive_error_string(a));
+            }
+
+            conda_extract_context extract_context(a);
+            extract_conda_parts(
+                a,
+                extract_context,
+                file,
+                { "info", "pkg" },
+                [&](scoped_archive_read& inner) { write_archive_entries(inner, base_dir, options); }
+            );
+
+            // The data following the last member is part of the checksum as well
+            const void* block = nullptr;
+            la_ssize_t r = 0;
+            while ((r = read_block(a, &block)) > 0)
+            {
+            }
+            if (r < 0)
+            {
+                throw std::runtime_error(archive_error_string(a));
+            }
+
+            auto hash = std::array<std::byte, util::Sha256Digester::bytes_size>{};
+            digester.digest_finalize_to(hash.data());
+            sha256 = util::bytes_to_hex_str(hash.data(), hash.data() + hash.size());
+        }
+        catch (const std::exception& e)
+        {
+            std::lock_guard lock(mutex);
+            abandon(e.what());
+        }
+    }
+
+    void StreamingExtraction::Impl::abandon(std::string reason)
+    {
+        if (!abandoned)
+        {
+            abandoned = true;
+            error = std::move(reason);
+        }
+        data_available.notify_all();
+    }
+
+    la_ssize_t StreamingExtraction::Impl::read_block(archive* a, const void** block)
+    {
+        std::size_t available = 0;
+        {
+            std::unique_lock lock(mutex);
+            data_available.wait(
+                lock,
+                [this] { return abandoned || read_size < written_size || read_size == file_size; }
+            );
+            if (abandoned)
+            {
+                archive_set_error(a, ECANCELED, "%s", error.c_str());
+                return ARCHIVE_FATAL;
+            }
+            available = written_size - read_size;
+        }
+        if (available == 0)
+        {
+            return 0;
+        }
+
+        if (!input.is_open())
+        {
+            input.open(file.std_path(), std::ios::in | std::ios::binary);
+        }
+        const std::size_t count = std::min(available, buffer.size());
+        input.read(buffer.data(), static_cast<std::streamsize>(count));
+        if (!input || static_cast<std::size_t>(input.gcount()) != count)
+        {
+            archive_set_error(a, EIO, "Could not read %s", file.string().c_str());
+            return ARCHIVE_FATAL;
+        }
+        digester.digest_update(reinterpret_cast<const std::byte*>(buffer.data()), count);
+        read_size += count;
+        *block = buffer.data();
+        return static_cast<la_ssize_t>(count);
+    }
+
+    StreamingExtraction::StreamingExtraction(
+        fs::u8path file,
+        std::size_t file_size,
+        fs::u8path dest_dir,
+        ExtractOptions options
+    )
+        : p_impl(
+              std::make_unique<Impl>(std::move(file), file_size, std::move(dest_dir), std::move(options))
+          )
+    {
+    }
+
+    StreamingExtraction::~StreamingExtraction()
+    {
+        {
+            std::lock_guard lock(p_impl->mutex);
+            p_impl->abandon("The extraction was cancelled");
+        }
+        if (p_impl->worker.joinable())
+        {
+            p_impl->worker.join();
+        }
+        std::error_code ec;
+        fs::remove_all(p_impl->dest_dir, ec);
+    }
+
+    const fs::u8path& StreamingExtraction::destination() const
+    {
+        return p_impl->dest_dir;
+    }
+
+    void StreamingExtraction::on_write(std::size_t offset, std::size_t size)
+    {
+        std::lock_guard lock(p_impl->mutex);
+        if (p_impl->abandoned)
+        {
+            return;
+        }
+        if (offset != p_impl->written_size || p_impl->written_size + size > p_impl->file_size)
+        {
+            p_impl->abandon("The package was not written sequentially");
+            return;
+        }
+        p_impl->written_size += size;
+        // The worker is started with the transfer, so that waiting downloads use no thread
+        if (!p_impl->worker.joinable())
+        {
+            p_impl->worker = std::thread([impl = p_impl.get()] { impl->run(); });
+        }
+        p_impl->data_available.notify_all();
+    }
+
+    expected_t<std::string> StreamingExtraction::wait()
+    {
+        {
+            std::lock_guard lock(p_impl->mutex);
+            if (p_impl->written_size != p_impl->file_size)
+            {
+                p_impl->abandon("The package was not entirely written by the download");
+            }
+        }
+        if (p_impl->worker.joinable())
+        {
+            p_impl->worker.join();
+        }
+
+        std::lock_guard lock(p_impl->mutex);
+        if (p_impl->abandoned)
+        {
+            std::error_code ec;
+            fs::remove_all(p_impl->dest_dir, ec);
+            return make_unexpected(p_impl->error, mamba_error_code::unknown);
+        }
+        return p_impl->sha256;
+    }
 }  // namespace mamba
@@ -41,6 +41,13 @@ namespace mamba
         return *this;
     }
 
+    ProgressProxy&
+    ProgressProxy::report_progress(std::size_t current, std::size_t total, std::size_t speed)
+    {
+        p_bar->report_progress(current, total, speed);
+        return *this;
+    }
+
     ProgressProxy& ProgressProxy::set_progress(double progress)
     {
         p_bar->set_progress(progress);
@@ -1045,6 +1045,14 @@ namespace mamba
         return progress_bar.p_bar;
     }
 
+    void ProgressBarManager::apply_reported_progress()
+    {
+        for (auto& bar : m_progress_bars)
+        {
+            bar->apply_reported_progress();
+        }
+    }
+
     void ProgressBarManager::erase_lines(std::ostream& ostream, std::size_t count)
     {
         for (std::size_t i = 0; i < count; ++i)
@@ -1337,6 +1345,42 @@ namespace mamba
         return *this;
     }
 
+    ProgressBar&
+    ProgressBar::report_progress(std::size_t current, std::size_t total, std::size_t speed)
+    {
+        m_reported.current.store(current, std::memory_order_relaxed);
+        m_reported.total.store(total, std::memory_order_relaxed);
+        m_reported.speed.store(speed, std::memory_order_relaxed);
+        m_reported.pending.store(true, std::memory_order_release);
+        return *this;
+    }
+
+    bool ProgressBar::apply_reported_progress()
+    {
+        if (!m_reported.pending.exchange(false, std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        const auto current = m_reported.current.load(std::memory_order_relaxed);
+        const auto total = m_reported.total.load(std::memory_order_relaxed);
+        if (unset())
+        {
+            start();
+        }
+        if (!total)
+        {
+            activate_spinner();
+        }
+        else
+        {
+            deactivate_spinner();
+        }
+        set_progress(current, total);
+        set_speed(m_reported.speed.load(std::memory_order_relaxed));
+        return true;
+    }
+
     ProgressBar& ProgressBar::set_progress(double progress)
     {
         m_progress = progress;
@@ -1556,6 +1600,7 @@ namespace mamba
 
     ProgressBar& ProgressBar::mark_as_completed(const std::chrono::milliseconds& delay)
     {
+        apply_reported_progress();
         pause();
         set_full();
 
@@ -1747,6 +1792,9 @@ namespace mamba
             width = m_width;
         }
 
+        // Before locking the bars, as starting a bar locks it
+        apply_reported_progress();
+
         if (max_lines < std::numeric_limits<std::size_t>::max())
         {
             max_sub_bars = max_lines;
@@ -1989,6 +2037,9 @@ namespace mamba
             width = m_width;
         }
 
+        // Before locking the bars, as starting a bar locks it
+        apply_reported_progress();
+
         if (max_lines < std::numeric_limits<std::size_t>::max())
         {
             if (max_lines < m_labels.size())
@@ -125,6 +125,19 @@ namespace mamba
     class ProgressBar;
     class ProgressBarManager;
 
+    /** Last progress reported to a progress bar by a worker thread.
+
+        Workers only store the values, the progress bar manager applies them to the progress bar
+        when printing it, at the rate of its frames.
+    */
+    struct ReportedProgress
+    {
+        std::atomic<std::size_t> current = 0;
+        std::atomic<std::size_t> total = 0;
+        std::atomic<std::size_t> speed = 0;
+        std::atomic<bool> pending = false;
+    };
+
     class ProgressBarRepr
     {
     public:
@@ -243,6 +256,7 @@ namespace mamba
         std::vector<std::function<void()>> m_pre_start_hooks;
         std::vector<std::function<void()>> m_post_stop_hooks;
 
+        void apply_reported_progress();
         void erase_lines(std::ostream& ostream, std::size_t count);
         void call_print_hooks(std::ostream& ostream);
         void sort_bars(bool max_height_exceeded);
@@ -334,6 +348,8 @@ namespace mamba
 
         ProgressBar& set_progress(std::size_t current, std::size_t total);
         ProgressBar& update_progress(std::size_t current, std::size_t total);
+        ProgressBar& report_progress(std::size_t current, std::size_t total, std::size_t speed);
+        bool apply_reported_progress();
         ProgressBar& set_progress(double progress);
         ProgressBar& set_current(std::size_t current);
         ProgressBar& set_in_progress(std::size_t in_progress);
@@ -398,6 +414,8 @@ namespace mamba
         bool m_is_spinner;
         bool m_completed = false;
 
+        ReportedProgress m_reported;
+
         std::mutex m_mutex;
 
         ProgressBarRepr m_repr;
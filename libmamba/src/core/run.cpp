@@ -5,7 +5,9 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <array>
+#include <cerrno>
 #include <csignal>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -30,9 +32,11 @@ extern "C"
 #include <nlohmann/json.hpp>
 #include <reproc++/run.hpp>
 
+#include "mamba/core/activation.hpp"
 #include "mamba/core/context.hpp"
 #include "mamba/core/error_handling.hpp"
 #include "mamba/core/execution.hpp"
+#include "mamba/core/logging.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/run.hpp"
 #include "mamba/core/util_os.hpp"
@@ -294,6 +298,37 @@ namespace mamba
     }
 #endif
 
+    namespace
+    {
+        /** Values of ``ENVVAR=VALUE`` or ``ENVVAR`` (from the current environment) arguments. */
+        auto get_requested_env_vars(const std::vector<std::string>& env_vars)
+            -> std::map<std::string, std::string>
+        {
+            std::map<std::string, std::string> env_map;
+            for (auto& e : env_vars)
+            {
+                if (e.find_first_of("=") != std::string::npos)
+                {
+                    auto split_e = util::split(e, "=", 1);
+                    env_map[split_e[0]] = split_e[1];
+                }
+                else
+                {
+                    auto val = util::get_env(e);
+                    if (val)
+                    {
+                        env_map[e] = val.value();
+                    }
+                    else
+                    {
+                        LOG_WARNING << "Requested env var " << e << " does not exist in environment";
+                    }
+                }
+            }
+            return env_map;
+        }
+    }
+
     int run_in_environment(
         const Context& context,
         const fs::u8path& prefix,
@@ -321,7 +356,7 @@ namespace mamba
         }
 
         LOG_DEBUG << "Currently running processes: " << get_all_running_processes_info();
-        fmt::print(LOG_DEBUG, "Remaining args to run as command: {}", fmt::join(command, " "));
+        LOG_DEBUG << fmt::format("Remaining args to run as command: {}", fmt::join(command, " "));
 
         // replace the wrapping bash with new process entirely
 #ifndef _WIN32
@@ -337,7 +372,7 @@ namespace mamba
             context.command_params.is_mamba_exe
         );
 
-        fmt::print(LOG_DEBUG, "Running wrapped script: {}", fmt::join(command, " "));
+        LOG_DEBUG << fmt::format("Running wrapped script: {}", fmt::join(command, " "));
 
         bool sinkout = stream_options & static_cast<int>(STREAM_OPTIONS::SINKOUT);
         bool sinkerr = stream_options & static_cast<int>(STREAM_OPTIONS::SINKERR);
@@ -359,30 +394,9 @@ namespace mamba
             opt.env.behavior = reproc::env::empty;
         }
 
-        std::map<std::string, std::string> env_map;
         if (env_vars.size())
         {
-            for (auto& e : env_vars)
-            {
-                if (e.find_first_of("=") != std::string::npos)
-                {
-                    auto split_e = util::split(e, "=", 1);
-                    env_map[split_e[0]] = split_e[1];
-                }
-                else
-                {
-                    auto val = util::get_env(e);
-                    if (val)
-                    {
-                        env_map[e] = val.value();
-                    }
-                    else
-                    {
-                        LOG_WARNING << "Requested env var " << e << " does not exist in environment";
-                    }
-                }
-            }
-            opt.env.extra = env_map;
+            opt.env.extra = get_requested_env_vars(env_vars);
         }
 
         opt.redirect.out.type = sinkout ? reproc::redirect::discard : reproc::redirect::parent;
@@ -502,4 +516,148 @@ namespace mamba
         // exit with status code from reproc
         return status;
     }
+
+    int exec_in_environment(
+        const Context& context,
+        const fs::u8path& prefix,
+        std::vector<std::string> command,
+        const std::string& cwd,
+        int stream_options,
+        bool clean_env,
+        const std::vector<std::string>& env_vars
+    )
+    {
+#ifdef _WIN32
+        LOG_DEBUG << "Exec mode is not available on Windows, running the command as a child";
+        return run_in_environment(
+            context,
+            prefix,
+            std::move(command),
+            cwd,
+            stream_options,
+            clean_env,
+            false,
+            env_vars,
+            ""
+        );
+#else
+        if (!fs::exists(prefix))
+        {
+            LOG_CRITICAL << "The given prefix does not exist: " << prefix;
+            return 1;
+        }
+        if (!cwd.empty() && !fs::exists(cwd))
+        {
+            LOG_CRITICAL << "The given path does not exist: " << cwd;
+            return -1;
+        }
+        if (!command.empty() && (command.front() == "exec"))
+        {
+            command.erase(command.begin());
+        }
+        if (command.empty())
+        {
+            LOG_CRITICAL << "Did not receive any command to run inside environment";
+            return 1;
+        }
+
+        // Requested variables are read before the environment is cleaned
+        const auto extra_env = get_requested_env_vars(env_vars);
+        if (clean_env)
+        {
+            for (const auto& [name, value] : util::get_env_map())
+            {
+                util::unset_env(name);
+            }
+        }
+
+        // The environment is computed here rather than by activating it in a wrapper shell.
+        // The activation cache is not used: in a fresh process, hashing the key and parsing
+        // the cache file costs more than scanning the prefix.
+        const EnvironmentTransform envt = PosixActivator(context).build_activate(prefix);
+        if (!envt.export_path.empty())
+        {
+            util::set_env("PATH", envt.export_path);
+        }
+        for (const auto& name : envt.unset_vars)
+        {
+            util::unset_env(name);
+        }
+        for (const auto& [name, value] : envt.export_vars)
+        {
+            util::set_env(name, value);
+        }
+        if (context.command_params.is_mamba_exe)
+        {
+            util::set_env("MAMBA_EXE", get_self_exe_path().string());
+            util::set_env("MAMBA_ROOT_PREFIX", context.prefix_params.root_prefix.string());
+        }
+        for (const auto& [name, value] : extra_env)
+        {
+            util::set_env(name, value);
+        }
+
+        // Activation scripts must be sourced by a shell, which then replaces itself with
+        // the command.
+        if (!envt.activate_scripts.empty())
+        {
+            std::string script;
+            for (const auto& activate_script : envt.activate_scripts)
+            {
+                script += ". " + quote_for_shell({ activate_script.string() }) + "\n";
+            }
+            script += "exec \"$@\"";
+
+            auto shell_path = util::which("bash");
+            if (shell_path.empty())
+            {
+                shell_path = "sh";
+            }
+            const auto shell = shell_path.string();
+            command.insert(command.begin(), { shell, "-c", script, shell });
+        }
+
+        if (!cwd.empty() && (::chdir(cwd.c_str()) != 0))
+        {
+            LOG_CRITICAL << "Could not change directory to " << cwd << ": " << std::strerror(errno);
+            return -1;
+        }
+
+        const std::array<std::pair<STREAM_OPTIONS, int>, 3> sinks = { {
+            { STREAM_OPTIONS::SINKIN, STDIN_FILENO },
+            { STREAM_OPTIONS::SINKOUT, STDOUT_FILENO },
+            { STREAM_OPTIONS::SINKERR, STDERR_FILENO },
+        } };
+        for (const auto& [option, fd] : sinks)
+        {
+            if (stream_options & static_cast<int>(option))
+            {
+                if (const int null_fd = ::open("/dev/null", O_RDWR); null_fd != -1)
+                {
+                    ::dup2(null_fd, fd);
+                    ::close(null_fd);
+                }
+            }
+        }
+
+        LOG_DEBUG << fmt::format("Replacing process with: {}", fmt::join(command, " "));
+        logging::flush_logs();
+        std::cout.flush();
+        std::cerr.flush();
+
+        std::vector<char*> argv;
+        argv.reserve(command.size() + 1);
+        for (auto& arg : command)
+        {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+        ::execvp(argv.front(), argv.data());
+
+        // Only reached if the command could not be executed
+        const int error = errno;
+        LOG_CRITICAL << "Could not execute '" << command.front() << "': " << std::strerror(error);
+        return (error == ENOENT) ? 127 : 126;
+#endif
+    }
 }
@@ -21,6 +21,8 @@ extern "C"
 #include "mamba/core/logging.hpp"
 #include "mamba/core/output.hpp"
 
+#include "../download/curl.hpp"
+
 namespace mamba
 {
     // WARNING: The order in which the following static objects are defined is important
@@ -68,6 +70,10 @@ namespace mamba
         // require it with the documentation which should guide the implementers anyway.
         constinit AnyLogHandler current_log_handler;
 
+        // Copies of the logging parameters read by the `LOG` macros without locking.
+        constinit std::atomic<log_level> runtime_log_level{ LoggingParams{}.logging_level };
+        constinit std::atomic<bool> backtrace_enabled;
+
         // MessageLogger
         constinit std::atomic<bool> message_logger_use_buffer;
         constinit util::synchronized_value<MessageLoggerBuffer> message_logger_buffer;
@@ -124,6 +130,14 @@ namespace mamba
 
     static CURLSetup curl_setup;
 
+    // Must be released before curl global cleanup.
+    static download::TransferContext transfer_context;
+
+    download::TransferContext& download::TransferContext::instance()
+    {
+        return transfer_context;
+    }
+
     struct MessageLoggerData
     {
         static std::mutex m_mutex;
@@ -230,6 +230,11 @@ namespace mamba
         return m_has_zst.has_value() && m_has_zst.value().value && !m_has_zst.value().has_expired();
     }
 
+    auto SubdirMetadata::has_up_to_date_zst_check() const -> bool
+    {
+        return m_has_zst.has_value() && !m_has_zst.value().has_expired();
+    }
+
     void SubdirMetadata::set_http_metadata(HttpMetadata data)
     {
         m_http = std::move(data);
@@ -731,48 +736,10 @@ namespace mamba
         }
     }
 
-    auto SubdirIndexLoader::build_check_requests(const SubdirDownloadParams& params)
-        -> download::MultiRequest
+    auto SubdirIndexLoader::must_probe_zst(const SubdirDownloadParams& params) const -> bool
     {
-        download::MultiRequest request;
-
-        if ((!params.offline || caching_is_forbidden()) && params.repodata_check_zst
-            && !m_metadata.has_up_to_date_zst())
-        {
-            request.push_back(
-                download::Request(
-                    name() + " (check zst)",
-                    download::MirrorName(channel_id()),
-                    repodata_url_path() + ".zst",
-                    "",
-                    /* lhead_only = */ true,
-                    /* lignore_failure = */ true
-                )
-            );
-
-            request.back().on_success = [this](const download::Success& success)
-            {
-                const std::string& effective_url = success.transfer.effective_url;
-                int http_status = success.transfer.http_status;
-                LOG_INFO << "Checked: " << effective_url << " [" << http_status << "]";
-                if (util::ends_with(effective_url, ".zst"))
-                {
-                    m_metadata.set_zst(http_status == 200);
-                }
-                return expected_t<void>();
-            };
-
-            request.back().on_failure = [this](const download::Error& error)
-            {
-                if (error.transfer.has_value())
-                {
-                    LOG_INFO << "Checked: " << error.transfer.value().effective_url << " ["
-                             << error.transfer.value().http_status << "]";
-                }
-                m_metadata.set_zst(false);
-            };
-        }
-        return request;
+        return params.repodata_check_zst && !m_zst_probe_failed
+               && !m_metadata.has_up_to_date_zst_check();
     }
 
     auto SubdirIndexLoader::build_index_request(const SubdirDownloadParams& params)
@@ -789,7 +756,11 @@ namespace mamba
         // TODO(C++23): Use std::make_unique when std::move_only_function is available
         auto artifact = std::make_shared<TemporaryFile>("mambaf", "", writable_cache_dir);
 
-        bool use_zst = m_metadata.has_up_to_date_zst();
+        // Rather than checking for the zst index before downloading, it is requested directly
+        // and the repodata.json is only downloaded in a second round if it is missing.
+        const bool probe_zst = must_probe_zst(params);
+        const bool use_zst = probe_zst || m_metadata.has_up_to_date_zst();
+        m_zst_probe_failed = false;
 
         download::Request request(
             name(),
@@ -797,13 +768,29 @@ namespace mamba
             repodata_url_path() + (use_zst ? ".zst" : ""),
             artifact->path().string(),
             /*head_only*/ false,
-            /*ignore_failure*/ !is_noarch()
+            /*ignore_failure*/ probe_zst || !is_noarch()
         );
+        request.may_be_missing = probe_zst;
         request.etag = m_metadata.etag();
         request.last_modified = m_metadata.last_modified();
+        if (m_expired_cache_path.has_value())
+        {
+            std::error_code ec;
+            const auto size = fs::file_size(m_expired_cache_path.value() / "cache" / m_json_filename, ec);
+            if (!ec)
+            {
+                request.cached_size = size;
+            }
+        }
 
-        request.on_success = [this, artifact = std::move(artifact)](const download::Success& success)
+        request.on_success = [this, probe_zst, artifact = std::move(artifact)](
+                                 const download::Success& success
+                             )
         {
+            if (probe_zst)
+            {
+                m_metadata.set_zst(true);
+            }
             if (success.transfer.http_status == 304)
             {
                 return use_existing_cache();
@@ -822,8 +809,24 @@ namespace mamba
             }
         };
 
-        request.on_failure = [](const download::Error& error)
+        request.on_failure = [this, probe_zst](const download::Error& error)
         {
+            if (probe_zst)
+            {
+                // Only a client error tells that the zst index is missing, other failures
+                // are not remembered.
+                const int http_status = error.transfer.has_value()
+                                            ? error.transfer.value().http_status
+                                            : 0;
+                if (http_status >= 400 && http_status < 500)
+                {
+                    m_metadata.set_zst(false);
+                }
+                LOG_INFO << "No zst index for '" << name() << "' (response: " << http_status
+                         << "), falling back to " << m_repodata_filename;
+                m_zst_probe_failed = true;
+                return;
+            }
             if (error.transfer.has_value())
             {
                 LOG_WARNING << "Unable to retrieve repodata (response: "
@@ -0,0 +1,258 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/output.hpp"
+#include "mamba/core/tracing.hpp"
+#include "mamba/core/util.hpp"
+
+namespace mamba::tracing
+{
+    namespace
+    {
+        std::atomic<bool> tracing_enabled = false;
+
+        using microseconds = std::chrono::microseconds;
+
+        struct Span
+        {
+            std::string_view name;
+            std::string detail;
+            clock::time_point start;
+            clock::time_point end;
+        };
+
+        // Spans of a thread, only locked by the other threads when collecting them.
+        // Named tracks are shared by the threads recording on them.
+        struct ThreadSpans
+        {
+            std::mutex mutex;
+            std::vector<Span> spans;
+            std::int64_t tid = 0;
+            std::string track;
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadSpans>> threads;
+            std::map<std::string, std::shared_ptr<ThreadSpans>, std::less<>> tracks;
+        };
+
+        // Leaked, the threads may still record spans at exit
+        Registry& registry()
+        {
+            static auto* reg = new Registry();
+            return *reg;
+        }
+
+        ThreadSpans& thread_spans()
+        {
+            thread_local const std::shared_ptr<ThreadSpans> spans = []
+            {
+                auto new_spans = std::make_shared<ThreadSpans>();
+                auto& reg = registry();
+                std::lock_guard lock(reg.mutex);
+                new_spans->tid = static_cast<std::int64_t>(reg.threads.size() + 1);
+                reg.threads.push_back(new_spans);
+                return new_spans;
+            }();
+            return *spans;
+        }
+
+        ThreadSpans& track_spans(std::string_view track)
+        {
+            auto& reg = registry();
+            std::lock_guard lock(reg.mutex);
+            if (auto it = reg.tracks.find(track); it != reg.tracks.end())
+            {
+                return *it->second;
+            }
+            auto new_spans = std::make_shared<ThreadSpans>();
+            new_spans->tid = static_cast<std::int64_t>(reg.threads.size() + 1);
+            new_spans->track = std::string(track);
+            reg.threads.push_back(new_spans);
+            reg.tracks.emplace(new_spans->track, new_spans);
+            return *new_spans;
+        }
+
+        void add_span(
+            ThreadSpans& spans,
+            std::string_view name,
+            clock::time_point start,
+            clock::time_point end,
+            std::string_view detail
+        )
+        {
+            std::lock_guard lock(spans.mutex);
+            spans.spans.push_back({ name, std::string(detail), start, end });
+        }
+    }
+
+    auto is_tracing_enabled() -> bool
+    {
+        return tracing_enabled.load(std::memory_order_relaxed);
+    }
+
+    auto enable_tracing() -> void
+    {
+        tracing_enabled.store(true, std::memory_order_relaxed);
+    }
+
+    auto disable_tracing() -> void
+    {
+        tracing_enabled.store(false, std::memory_order_relaxed);
+    }
+
+    auto record_span(
+        std::string_view name,
+        clock::time_point start,
+        clock::time_point end,
+        std::string_view detail
+    ) -> void
+    {
+        if (!is_tracing_enabled())
+        {
+            return;
+        }
+        try
+        {
+            add_span(thread_spans(), name, start, end, detail);
+        }
+        catch (const std::exception&)
+        {
+            // Losing a span is better than failing the traced operation
+        }
+    }
+
+    auto record_track_span(
+        std::string_view track,
+        std::string_view name,
+        clock::time_point start,
+        clock::time_point end,
+        std::string_view detail
+    ) -> void
+    {
+        if (!is_tracing_enabled())
+        {
+            return;
+        }
+        try
+        {
+            add_span(track_spans(track), name, start, end, detail);
+        }
+        catch (const std::exception&)
+        {
+            // Losing a span is better than failing the traced operation
+        }
+    }
+
+    auto clear_spans() -> void
+    {
+        auto& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        for (auto& thread : reg.threads)
+        {
+            std::lock_guard thread_lock(thread->mutex);
+            thread->spans.clear();
+        }
+    }
+
+    auto to_trace_events() -> nlohmann::json
+    {
+        struct ThreadEvents
+        {
+            std::int64_t tid;
+            std::string track;
+            std::vector<Span> spans;
+        };
+
+        std::vector<ThreadEvents> threads;
+        {
+            auto& reg = registry();
+            std::lock_guard lock(reg.mutex);
+            for (const auto& thread : reg.threads)
+            {
+                std::lock_guard thread_lock(thread->mutex);
+                if (!thread->spans.empty())
+                {
+                    threads.push_back({ thread->tid, thread->track, thread->spans });
+                }
+            }
+        }
+
+        // The trace starts with the earliest span, which may predate the tracing activation
+        auto origin = clock::time_point::max();
+        for (const auto& thread : threads)
+        {
+            for (const auto& span : thread.spans)
+            {
+                origin = std::min(origin, span.start);
+            }
+        }
+
+        auto events = nlohmann::json::array();
+        for (const auto& thread : threads)
+        {
+            if (!thread.track.empty())
+            {
+                events.push_back({
+                    { "name", "thread_name" },
+                    { "ph", "M" },
+                    { "pid", 1 },
+                    { "tid", thread.tid },
+                    { "args", { { "name", thread.track } } },
+                });
+            }
+            for (const auto& span : thread.spans)
+            {
+                using std::chrono::duration_cast;
+                const auto start = duration_cast<microseconds>(span.start - origin);
+                const auto duration = duration_cast<microseconds>(span.end - span.start);
+                auto event = nlohmann::json{
+                    { "name", span.name },
+                    { "cat", "mamba" },
+                    { "ph", "X" },
+                    { "pid", 1 },
+                    { "tid", thread.tid },
+                    { "ts", start.count() },
+                    { "dur", duration.count() },
+                };
+                if (!span.detail.empty())
+                {
+                    event["args"] = { { "detail", span.detail } };
+                }
+                events.push_back(std::move(event));
+            }
+        }
+        return { { "traceEvents", std::move(events) }, { "displayTimeUnit", "ms" } };
+    }
+
+    auto write_trace(const fs::u8path& path) -> void
+    {
+        try
+        {
+            auto out = open_ofstream(path);
+            out << to_trace_events().dump();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_WARNING << "Could not write the trace to " << path << ": " << e.what();
+        }
+    }
+}
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <map>
+#include <optional>
 #include <ranges>
 #include <stack>
 #include <string>
@@ -26,7 +28,9 @@
 #include "mamba/core/package_fetcher.hpp"
 #include "mamba/core/repo_checker_store.hpp"
 #include "mamba/core/thread_utils.hpp"
+#include "mamba/core/tracing.hpp"
 #include "mamba/core/transaction.hpp"
+#include "mamba/download/metrics.hpp"
 #include "mamba/solver/libsolv/database.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/util/variant_cmp.hpp"
@@ -557,24 +561,29 @@ namespace mamba
         {
             FetcherList fetchers;
 
+            // The packages are verified in batches, one per repository checker
+            std::optional<RepoCheckerStore> repo_checker_store;
+            std::map<
+                validation::RepoChecker*,
+                std::vector<std::pair<nlohmann::json, std::string_view>>>
+                packages_to_verify;
             if (ctx.validation_params.verify_artifacts)
             {
                 LOG_INFO << "Content trust is enabled, package(s) signatures will be verified";
+                LOG_INFO << "Creating RepoChecker...";
+                repo_checker_store = RepoCheckerStore::make(ctx, channel_context, multi_cache);
             }
             for (const auto& pkg : solution.packages_to_install())
             {
                 if (ctx.validation_params.verify_artifacts)
                 {
-                    LOG_INFO << "Creating RepoChecker...";
-                    auto repo_checker_store = RepoCheckerStore::make(ctx, channel_context, multi_cache);
                     for (auto& chan : channel_context.make_channel(pkg.channel))
                     {
-                        auto repo_checker = repo_checker_store.find_checker(chan);
+                        auto repo_checker = repo_checker_store->find_checker(chan);
                         if (repo_checker)
                         {
-                            LOG_INFO << "RepoChecker successfully created.";
                             repo_checker->generate_index_checker();
-                            repo_checker->verify_package(
+                            packages_to_verify[repo_checker].emplace_back(
                                 pkg.json_signable(),
                                 std::string_view(pkg.signatures)
                             );
@@ -590,7 +599,6 @@ namespace mamba
                             );
                         }
                     }
-                    LOG_INFO << "'" << pkg.name << "' trusted from '" << pkg.channel << "'";
                 }
 
                 // FIXME: only do this for micromamba for now
@@ -636,6 +644,10 @@ namespace mamba
 
             if (ctx.validation_params.verify_artifacts)
             {
+                for (const auto& [repo_checker, packages] : packages_to_verify)
+                {
+                    repo_checker->verify_packages(packages);
+                }
                 auto out = Console::stream();
                 fmt::print(
                     out,
@@ -739,6 +751,17 @@ namespace mamba
             return all_downloaded;
         }
 
+        void report_download_metrics(
+            const Context& context,
+            const std::optional<download::TransferMetrics>& metrics
+        )
+        {
+            if (metrics.has_value() && context.output_params.json)
+            {
+                Console::instance().json_write({ { "download_metrics", metrics->to_json() } });
+            }
+        }
+
         bool clear_invalid_caches(const FetcherList& fetchers, ExtractTrackerList& trackers)
         {
             bool all_valid = true;
@@ -759,6 +782,15 @@ namespace mamba
 
     bool MTransaction::fetch_extract_packages(const Context& ctx, ChannelContext& channel_context)
     {
+        const auto span = tracing::ScopedSpan("fetch_extract_packages");
+
+        // Records the downloads for the JSON report and the command trace
+        std::optional<download::TransferMetrics> metrics;
+        if (ctx.output_params.json || tracing::is_tracing_enabled())
+        {
+            metrics.emplace();
+        }
+
         PackageFetcherSemaphore::set_max(ctx.threads_params.extract_threads);
 
         FetcherList fetchers = build_fetchers(ctx, channel_context, m_solution, m_multi_cache);
@@ -801,6 +833,10 @@ namespace mamba
             monitor = std::make_unique<PackageDownloadMonitor>();
             monitor->observe(download_requests, extract_tasks, download_options);
         }
+        if (metrics.has_value())
+        {
+            metrics->observe(download_requests);
+        }
 
         schedule_remaining_extractions(extract_tasks, extract_trackers, download_size);
         bool all_downloaded = trigger_download(
@@ -809,9 +845,16 @@ namespace mamba
             download_options,
             monitor.get()
         );
+        if (const fs::u8path pkgs_dir = m_multi_cache.first_writable_path(); !pkgs_dir.empty())
+        {
+            ctx.mirrors.save_performance(
+                pkgs_dir / "cache" / download::mirror_map::performance_filename
+            );
+        }
         if (!all_downloaded)
         {
             LOG_ERROR << "Download didn't finish!";
+            report_download_metrics(ctx, metrics);
             return false;
         }
 
@@ -820,6 +863,7 @@ namespace mamba
         {
             task.wait();
         }
+        report_download_metrics(ctx, metrics);
 
         const bool all_valid = clear_invalid_caches(fetchers, extract_trackers);
         // TODO: see if we can move this into the caller
@@ -10,6 +10,7 @@
 #include <reproc++/drain.hpp>
 
 #include "mamba/core/output.hpp"
+#include "mamba/core/tracing.hpp"
 #include "mamba/util/environment.hpp"
 #include "mamba/util/string.hpp"
 
@@ -184,6 +185,7 @@ namespace mamba
 
     void TransactionContext::wait_for_pyc_compilation()
     {
+        const auto span = tracing::ScopedSpan("wait_for_pyc_compilation");
         // throw_if_not_ready();
 
         if (m_pyc_process)
@@ -0,0 +1,1066 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/invoke.hpp"
+#include "mamba/core/output.hpp"
+#include "mamba/core/thread_utils.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/core/util_scope.hpp"
+#include "mamba/download/coordinator.hpp"
+#include "mamba/validation/tools.hpp"
+
+#include "downloader_impl.hpp"
+#include "mirror_impl.hpp"
+
+namespace mamba::download
+{
+    namespace
+    {
+        // The coordinator tells its clients that their downloads are still running at this
+        // interval, and the clients give up on a coordinator silent for longer.
+        constexpr auto heartbeat_interval = std::chrono::seconds(5);
+        constexpr auto answer_timeout = std::chrono::seconds(30);
+
+        /*
+         * A stream socket exchanging lines of text, closed on destruction.
+         */
+        class LineSocket
+        {
+        public:
+
+            LineSocket() = default;
+
+            ~LineSocket()
+            {
+                close();
+            }
+
+            LineSocket(const LineSocket&) = delete;
+            LineSocket& operator=(const LineSocket&) = delete;
+
+            LineSocket(LineSocket&& rhs) noexcept
+                : m_fd(std::exchange(rhs.m_fd, -1))
+                , m_buffer(std::move(rhs.m_buffer))
+            {
+            }
+
+            LineSocket& operator=(LineSocket&& rhs) noexcept
+            {
+                close();
+                m_fd = std::exchange(rhs.m_fd, -1);
+                m_buffer = std::move(rhs.m_buffer);
+                return *this;
+            }
+
+            bool is_valid() const
+            {
+                return m_fd >= 0;
+            }
+
+#ifndef _WIN32
+            // Returns an invalid socket if nothing listens on `path`.
+            static LineSocket connect(const fs::u8path& path)
+            {
+                auto address = make_address(path);
+                if (!address.has_value())
+                {
+                    return {};
+                }
+                LineSocket res(::socket(AF_UNIX, SOCK_STREAM, 0));
+                if (res.is_valid()
+                    && ::connect(res.m_fd, reinterpret_cast<sockaddr*>(&address.value()), sizeof(sockaddr_un))
+                           != 0)
+                {
+                    res.close();
+                }
+                return res;
+            }
+
+            static LineSocket listen(const fs::u8path& path)
+            {
+                if (connect(path).is_valid())
+                {
+                    throw std::runtime_error(
+                        fmt::format("A fetch coordinator already listens on {}", path.string())
+                    );
+                }
+                // The socket of a coordinator that did not exit cleanly
+                std::error_code ec;
+                fs::remove(path, ec);
+
+                auto address = make_address(path);
+                if (!address.has_value())
+                {
+                    throw std::runtime_error(fmt::format("Socket path too long: {}", path.string()));
+                }
+                LineSocket res(::socket(AF_UNIX, SOCK_STREAM, 0));
+                // Only the user can connect, the socket being created with the umask permissions
+                const mode_t previous_umask = ::umask(S_IRWXG | S_IRWXO);
+                const bool bound = res.is_valid()
+                                   && ::bind(
+                                          res.m_fd,
+                                          reinterpret_cast<sockaddr*>(&address.value()),
+                                          sizeof(sockaddr_un)
+                                      ) == 0;
+                ::umask(previous_umask);
+                if (!bound || ::listen(res.m_fd, SOMAXCONN) != 0)
+                {
+                    throw std::runtime_error(
+                        fmt::format("Could not listen on {}: {}", path.string(), strerror(errno))
+                    );
+                }
+                return res;
+            }
+
+            // Returns an invalid socket if no connection arrives within `timeout`.
+            LineSocket accept(std::chrono::milliseconds timeout)
+            {
+                pollfd fds = { m_fd, POLLIN, 0 };
+                if (::poll(&fds, 1, static_cast<int>(timeout.count())) <= 0)
+                {
+                    return {};
+                }
+                return LineSocket(::accept(m_fd, nullptr, nullptr));
+            }
+
+            bool send_line(std::string line)
+            {
+                line.push_back('\n');
+                std::size_t sent = 0;
+                while (sent < line.size())
+                {
+                    const auto res = ::send(m_fd, line.data() + sent, line.size() - sent, send_flags);
+                    if (res < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (res <= 0)
+                    {
+                        return false;
+                    }
+                    sent += static_cast<std::size_t>(res);
+                }
+                return true;
+            }
+
+            // Returns std::nullopt once the peer closed the connection, or if it sent
+            // nothing within `timeout`.
+            std::optional<std::string> receive_line(std::chrono::milliseconds timeout)
+            {
+                std::size_t end = m_buffer.find('\n');
+                while (end == std::string::npos)
+                {
+                    pollfd fds = { m_fd, POLLIN, 0 };
+                    const int ready = ::poll(&fds, 1, static_cast<int>(timeout.count()));
+                    if (ready < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (ready <= 0)
+                    {
+                        return std::nullopt;
+                    }
+                    char block[16384];
+                    const auto res = ::recv(m_fd, block, sizeof(block), 0);
+                    if (res < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (res <= 0)
+                    {
+                        return std::nullopt;
+                    }
+                    m_buffer.append(block, static_cast<std::size_t>(res));
+                    end = m_buffer.find('\n');
+                }
+                std::string line = m_buffer.substr(0, end);
+                m_buffer.erase(0, end + 1);
+                return line;
+            }
+
+        private:
+
+#ifdef MSG_NOSIGNAL
+            static constexpr int send_flags = MSG_NOSIGNAL;
+#else
+            static constexpr int send_flags = 0;
+#endif
+
+            explicit LineSocket(int fd)
+                : m_fd(fd)
+            {
+#ifdef SO_NOSIGPIPE
+                if (m_fd >= 0)
+                {
+                    int on = 1;
+                    ::setsockopt(m_fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+                }
+#endif
+                if (m_fd >= 0)
+                {
+                    ::fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+                }
+            }
+
+            static std::optional<sockaddr_un> make_address(const fs::u8path& path)
+            {
+                sockaddr_un address = {};
+                address.sun_family = AF_UNIX;
+                const std::string str = path.string();
+                if (str.size() >= sizeof(address.sun_path))
+                {
+                    return std::nullopt;
+                }
+                std::copy(str.begin(), str.end(), address.sun_path);
+                return address;
+            }
+
+            void close()
+            {
+                if (m_fd >= 0)
+                {
+                    ::close(m_fd);
+                    m_fd = -1;
+                }
+            }
+#else
+            static LineSocket connect(const fs::u8path&)
+            {
+                return {};
+            }
+
+            static LineSocket listen(const fs::u8path&)
+            {
+                throw std::runtime_error("The fetch coordinator is not supported on Windows");
+            }
+
+            LineSocket accept(std::chrono::milliseconds)
+            {
+                return {};
+            }
+
+            bool send_line(std::string)
+            {
+                return false;
+            }
+
+            std::optional<std::string> receive_line(std::chrono::milliseconds)
+            {
+                return std::nullopt;
+            }
+
+        private:
+
+            void close()
+            {
+            }
+#endif
+
+            int m_fd = -1;
+            std::string m_buffer = {};
+        };
+
+        /*************************************
+         * Serialization of the exchanges    *
+         *************************************/
+
+        // Only the requests to a file, whose mirrors can be rebuilt from their URL,
+        // are sent to the coordinator.
+        std::optional<nlohmann::json>
+        coordinated_request(const Request& request, const mirror_map& mirrors)
+        {
+            if (!request.filename.has_value() || request.check_only)
+            {
+                return std::nullopt;
+            }
+            auto mirror_urls = nlohmann::json::array();
+            for (const auto& mirror : mirrors.get_mirrors(request.mirror_name))
+            {
+                if (dynamic_cast<const HTTPMirror*>(mirror.get()) != nullptr)
+                {
+                    mirror_urls.push_back(mirror->id().to_string());
+                }
+                else if (dynamic_cast<const PassThroughMirror*>(mirror.get()) == nullptr)
+                {
+                    return std::nullopt;
+                }
+            }
+            return nlohmann::json{
+                { "name", request.name },
+                { "mirror_name", request.mirror_name },
+                { "mirror_urls", std::move(mirror_urls) },
+                { "url_path", request.url_path },
+                { "sha256", request.sha256 },
+                { "expected_size", request.expected_size.value_or(0) },
+                { "etag", request.etag.value_or("") },
+                { "last_modified", request.last_modified.value_or("") },
+                { "cached_size", request.cached_size.value_or(0) },
+                { "may_be_missing", request.may_be_missing },
+                { "filename", request.filename.value() },
+            };
+        }
+
+        nlohmann::json transfer_to_json(const TransferData& transfer)
+        {
+            return {
+                { "http_status", transfer.http_status },
+                { "effective_url", transfer.effective_url },
+                { "downloaded_size", transfer.downloaded_size },
+                { "average_speed_Bps", transfer.average_speed_Bps },
+                { "saved_size", transfer.saved_size },
+                { "name_lookup_time_us", transfer.name_lookup_time.count() },
+                { "connect_time_us", transfer.connect_time.count() },
+                { "tls_handshake_time_us", transfer.tls_handshake_time.count() },
+                { "time_to_first_byte_us", transfer.time_to_first_byte.count() },
+                { "total_time_us", transfer.total_time.count() },
+            };
+        }
+
+        TransferData transfer_from_json(const nlohmann::json& j)
+        {
+            const auto get_time = [&j](const char* key)
+            { return std::chrono::microseconds(j.value(key, std::int64_t(0))); };
+            return {
+                /* .http_status = */ j.value("http_status", 0),
+                /* .effective_url = */ j.value("effective_url", ""),
+                /* .downloaded_size = */ j.value("downloaded_size", std::size_t(0)),
+                /* .average_speed_Bps = */ j.value("average_speed_Bps", std::size_t(0)),
+                /* .saved_size = */ j.value("saved_size", std::size_t(0)),
+                /* .name_lookup_time = */ get_time("name_lookup_time_us"),
+                /* .connect_time = */ get_time("connect_time_us"),
+                /* .tls_handshake_time = */ get_time("tls_handshake_time_us"),
+                /* .time_to_first_byte = */ get_time("time_to_first_byte_us"),
+                /* .total_time = */ get_time("total_time_us"),
+            };
+        }
+
+        nlohmann::json success_to_json(const Success& success)
+        {
+            return {
+                { "transfer", transfer_to_json(success.transfer) },
+                { "cache_control", success.cache_control },
+                { "etag", success.etag },
+                { "last_modified", success.last_modified },
+            };
+        }
+
+        Success success_from_json(const nlohmann::json& j, std::string filename)
+        {
+            return {
+                /* .content = */ Filename{ std::move(filename) },
+                /* .transfer = */ transfer_from_json(j.value("transfer", nlohmann::json::object())),
+                /* .cache_control = */ j.value("cache_control", ""),
+                /* .etag = */ j.value("etag", ""),
+                /* .last_modified = */ j.value("last_modified", ""),
+            };
+        }
+
+        nlohmann::json error_to_json(const Error& error)
+        {
+            auto res = nlohmann::json{ { "message", error.message } };
+            if (error.transfer.has_value())
+            {
+                res["transfer"] = transfer_to_json(error.transfer.value());
+            }
+            return res;
+        }
+
+        Error error_from_json(const nlohmann::json& j)
+        {
+            Error error{ /* .message = */ j.value("message", "") };
+            if (j.contains("transfer"))
+            {
+                error.transfer = transfer_from_json(j["transfer"]);
+            }
+            return error;
+        }
+
+        // The key of the artifacts shared by the requesters, the filename and name being
+        // specific to each of them
+        std::string artifact_key(const nlohmann::json& request)
+        {
+            auto key_request = request;
+            key_request.erase("filename");
+            key_request.erase("name");
+            return key_request.dump();
+        }
+
+        // Gives the requester its own copy of the staged file, which a link would let it
+        // modify for the other requesters
+        bool place_file(const fs::u8path& staged_file, const fs::u8path& target)
+        {
+            std::error_code ec;
+            if (fs::equivalent(staged_file, target, ec))
+            {
+                return true;
+            }
+            ec.clear();
+            fs::copy_file(staged_file, target, fs::copy_options::overwrite_existing, ec);
+            return !ec;
+        }
+
+        // Returns why the staged file is not the requested artifact, if it is not
+        std::optional<std::string>
+        check_staged_file(const fs::u8path& staged_file, const nlohmann::json& request)
+        {
+            std::error_code ec;
+            const auto size = fs::file_size(staged_file, ec);
+            if (ec)
+            {
+                return fmt::format("could not read {}: {}", staged_file.string(), ec.message());
+            }
+            const auto expected_size = request.value("expected_size", std::size_t(0));
+            if ((expected_size > 0) && (size != expected_size))
+            {
+                return fmt::format("size {} instead of the expected {}", size, expected_size);
+            }
+            if (validation::sha256sum(staged_file) != request.value("sha256", ""))
+            {
+                return std::string("sha256 mismatch");
+            }
+            return std::nullopt;
+        }
+
+        // Asks the coordinator to drop the artifacts whose validation failed in the client
+        void report_invalid(const fs::u8path& socket_path, nlohmann::json invalid_requests)
+        {
+            const auto message = nlohmann::json{ { "invalid", std::move(invalid_requests) } };
+            auto socket = LineSocket::connect(socket_path);
+            if (!socket.is_valid() || !socket.send_line(message.dump())
+                || !socket.receive_line(answer_timeout).has_value())
+            {
+                LOG_DEBUG << "Could not report invalid artifacts to the fetch coordinator";
+            }
+        }
+    }
+
+    /*******************************
+     * Client of the coordinator   *
+     *******************************/
+
+    std::vector<std::optional<Result>> download_through_coordinator(
+        MultiRequest& requests,
+        const mirror_map& mirrors,
+        const Options& options
+    )
+    {
+        std::vector<std::optional<Result>> results(requests.size());
+
+        auto coordinated_requests = nlohmann::json::array();
+        std::vector<std::size_t> coordinated_indices;
+        for (std::size_t i = 0; i < requests.size(); ++i)
+        {
+            if (auto coordinated = coordinated_request(requests[i], mirrors))
+            {
+                coordinated_requests.push_back(std::move(coordinated).value());
+                coordinated_indices.push_back(i);
+            }
+        }
+        if (coordinated_indices.empty())
+        {
+            return results;
+        }
+
+        auto socket = LineSocket::connect(options.coordinator_socket);
+        if (!socket.is_valid()
+            || !socket.send_line(nlohmann::json{ { "requests", coordinated_requests } }.dump()))
+        {
+            LOG_DEBUG << "Fetch coordinator not reachable on " << options.coordinator_socket
+                      << ", downloading in process";
+            return results;
+        }
+
+        auto invalid_requests = nlohmann::json::array();
+        on_scope_exit report_guard(
+            [&]
+            {
+                if (!invalid_requests.empty())
+                {
+                    report_invalid(options.coordinator_socket, std::move(invalid_requests));
+                }
+            }
+        );
+
+        // A silent coordinator leaves the requests it did not answer to be downloaded in process
+        while (auto line = socket.receive_line(answer_timeout))
+        {
+            const auto answer = nlohmann::json::parse(line.value(), nullptr, false);
+            if (answer.is_object() && answer.contains("pending"))
+            {
+                continue;
+            }
+            const std::size_t index = answer.is_object() ? answer.value("index", requests.size())
+                                                         : requests.size();
+            if (index >= coordinated_indices.size())
+            {
+                LOG_WARNING << "Invalid answer from the fetch coordinator";
+                break;
+            }
+
+            Request& request = requests[coordinated_indices[index]];
+            if (answer.contains("success"))
+            {
+                Success success = success_from_json(answer["success"], request.filename.value());
+                if (request.progress.has_value())
+                {
+                    request.progress.value()(success);
+                }
+                if (request.on_success.has_value())
+                {
+                    auto ret = safe_invoke(request.on_success.value(), success);
+                    const expected_t<void> finalize_res = ret.has_value() ? ret.value()
+                                                                          : forward_error(ret);
+                    if (!finalize_res)
+                    {
+                        invalid_requests.push_back(coordinated_requests[index]);
+                        if (options.fail_fast && !request.ignore_failure)
+                        {
+                            throw finalize_res.error();
+                        }
+                        results[coordinated_indices[index]] = tl::unexpected(
+                            Error{ finalize_res.error().what() }
+                        );
+                        continue;
+                    }
+                }
+                results[coordinated_indices[index]] = std::move(success);
+            }
+            else if (answer.contains("error"))
+            {
+                Error error = error_from_json(answer["error"]);
+                if (request.progress.has_value())
+                {
+                    request.progress.value()(error);
+                }
+                if (request.on_failure.has_value())
+                {
+                    // We dont want to propagate errors coming from user's callbacks
+                    [[maybe_unused]] auto result = safe_invoke(request.on_failure.value(), error);
+                }
+                if (!request.ignore_failure)
+                {
+                    throw std::runtime_error(error.message);
+                }
+                results[coordinated_indices[index]] = tl::unexpected(std::move(error));
+            }
+            else
+            {
+                LOG_DEBUG << "Fetch coordinator could not serve " << request.name << ": "
+                          << answer.value("fallback", "") << ", downloading in process";
+            }
+        }
+        return results;
+    }
+
+    /********************
+     * FetchCoordinator *
+     ********************/
+
+    struct FetchCoordinator::Impl
+    {
+        using clock = std::chrono::steady_clock;
+
+        struct Artifact
+        {
+            nlohmann::json request;
+            fs::u8path staged_file;
+            bool is_immutable = false;
+            std::optional<Result> result = std::nullopt;
+            std::size_t staged_size = 0;
+            clock::time_point last_requested = clock::now();
+
+            // Kept by the map of artifacts as long as it is served, the staged file is removed
+            // once the artifact is erased and the clients being answered are done with it
+            ~Artifact()
+            {
+                std::error_code ec;
+                fs::remove(staged_file, ec);
+            }
+        };
+
+        using artifact_ptr = std::shared_ptr<Artifact>;
+
+        Impl(
+            fs::u8path lsocket_path,
+            fs::u8path lstaging_dir,
+            const RemoteFetchParams& lparams,
+            const specs::AuthenticationDataBase& lauth_info,
+            Options loptions,
+            StagingLimits llimits
+        )
+            : socket_path(std::move(lsocket_path))
+            , staging_dir(std::move(lstaging_dir))
+            , params(lparams)
+            , auth_info(lauth_info)
+            , options(std::move(loptions))
+            , limits(llimits)
+        {
+            // The coordinator downloads by itself
+            options.coordinator_socket.clear();
+            options.fail_fast = false;
+        }
+
+        void serve_client(LineSocket client);
+        void evict(const nlohmann::json& invalid_requests);
+        void download_artifacts(const std::vector<artifact_ptr>& to_download);
+        void verify_and_publish(Artifact& artifact, Result result);
+        void publish(Artifact& artifact, Result result);
+        // Must be called with the mutex locked
+        void expire_artifacts();
+        std::string answer(std::size_t index, const Artifact& artifact, const fs::u8path& target);
+
+        fs::u8path socket_path;
+        fs::u8path staging_dir;
+        const RemoteFetchParams& params;
+        const specs::AuthenticationDataBase& auth_info;
+        Options options;
+        StagingLimits limits;
+
+        std::atomic<bool> stopped = false;
+        std::atomic<std::size_t> requested_count = 0;
+        std::atomic<std::size_t> downloaded_count = 0;
+        // Bounds the checksums computed at the same time
+        counting_semaphore verification_slots = {};
+        std::mutex mutex = {};
+        std::condition_variable artifact_done = {};
+        // Artifacts being downloaded, and the immutable ones already downloaded
+        std::map<std::string, artifact_ptr> artifacts = {};
+        std::size_t staged_count = 0;
+        // Several clients may share the files they request
+        std::mutex placement_mutex = {};
+    };
+
+    void FetchCoordinator::Impl::serve_client(LineSocket client)
+    {
+        const auto line = client.receive_line(answer_timeout);
+        const auto message = nlohmann::json::parse(line.value_or(""), nullptr, false);
+        if (message.is_object() && message.contains("invalid") && message["invalid"].is_array())
+        {
+            evict(message["invalid"]);
+            client.send_line(nlohmann::json{ { "evicted", true } }.dump());
+            return;
+        }
+        if (!message.is_object() || !message.contains("requests") || !message["requests"].is_array())
+        {
+            return;
+        }
+
+        std::vector<std::pair<std::size_t, artifact_ptr>> pending;
+        std::vector<artifact_ptr> to_download;
+        {
+            std::lock_guard lock(mutex);
+            requested_count += message["requests"].size();
+            for (const auto& request : message["requests"])
+            {
+                auto [it, inserted] = artifacts.try_emplace(artifact_key(request));
+                if (inserted)
+                {
+                    const std::string url_path = request.value("url_path", "");
+                    it->second = std::make_shared<Artifact>(Artifact{
+                        /* .request = */ request,
+                        /* .staged_file = */ staging_dir
+                            / fmt::format("{}-{}", staged_count++, fs::u8path(url_path).filename().string()),
+                        /* .is_immutable = */ !request.value("sha256", "").empty(),
+                    });
+                    to_download.push_back(it->second);
+                }
+                it->second->last_requested = clock::now();
+                pending.emplace_back(pending.size(), it->second);
+            }
+        }
+
+        // The artifacts requested first are downloaded by this client, the others are
+        // already being downloaded by other clients.
+        std::thread downloader;
+        if (!to_download.empty())
+        {
+            downloaded_count += to_download.size();
+            downloader = std::thread([this, &to_download] { download_artifacts(to_download); });
+        }
+        on_scope_exit guard(
+            [&downloader]
+            {
+                if (downloader.joinable())
+                {
+                    downloader.join();
+                }
+            }
+        );
+
+        bool connected = true;
+        while (connected && !pending.empty())
+        {
+            std::vector<std::pair<std::size_t, artifact_ptr>> done;
+            {
+                std::unique_lock lock(mutex);
+                const auto is_done = [](const auto& entry) { return entry.second->result.has_value(); };
+                const bool any_done = artifact_done.wait_for(
+                    lock,
+                    heartbeat_interval,
+                    [&] { return std::any_of(pending.begin(), pending.end(), is_done); }
+                );
+                if (!any_done)
+                {
+                    const auto heartbeat = nlohmann::json{ { "pending", pending.size() } };
+                    lock.unlock();
+                    connected = client.send_line(heartbeat.dump());
+                    continue;
+                }
+                auto it = std::stable_partition(pending.begin(), pending.end(), std::not_fn(is_done));
+                std::move(it, pending.end(), std::back_inserter(done));
+                pending.erase(it, pending.end());
+            }
+            for (const auto& [index, artifact] : done)
+            {
+                connected = connected && client.send_line(
+                    answer(index, *artifact, message["requests"][index].value("filename", ""))
+                );
+            }
+        }
+    }
+
+    void FetchCoordinator::Impl::evict(const nlohmann::json& invalid_requests)
+    {
+        std::lock_guard lock(mutex);
+        for (const auto& request : invalid_requests)
+        {
+            // The artifacts still being downloaded were not the ones validated by the client
+            auto it = artifacts.find(artifact_key(request));
+            if ((it != artifacts.end()) && it->second->result.has_value())
+            {
+                LOG_INFO << "Dropping invalid artifact " << request.value("url_path", "");
+                artifacts.erase(it);
+            }
+        }
+    }
+
+    void FetchCoordinator::Impl::download_artifacts(const std::vector<artifact_ptr>& to_download)
+    {
+        // The checksums of the immutable artifacts are verified out of the download loop,
+        // which would otherwise stall the other transfers
+        std::vector<std::future<void>> verifications;
+        mirror_map mirrors;
+        MultiRequest requests;
+        requests.reserve(to_download.size());
+        for (const auto& artifact : to_download)
+        {
+            const auto& j = artifact->request;
+            const std::string mirror_name = j.value("mirror_name", "");
+            for (const auto& url : j.value("mirror_urls", std::vector<std::string>{}))
+            {
+                if (auto mirror = make_mirror(url); mirror != nullptr)
+                {
+                    mirrors.add_unique_mirror(mirror_name, std::move(mirror));
+                }
+            }
+
+            Request request(
+                j.value("name", ""),
+                MirrorName(mirror_name),
+                j.value("url_path", ""),
+                artifact->staged_file.string(),
+                /* lhead_only= */ false,
+                /* lignore_failure= */ true
+            );
+            request.sha256 = j.value("sha256", "");
+            if (const auto size = j.value("expected_size", std::size_t(0)); size > 0)
+            {
+                request.expected_size = size;
+            }
+            if (auto etag = j.value("etag", ""); !etag.empty())
+            {
+                request.etag = std::move(etag);
+            }
+            if (auto last_modified = j.value("last_modified", ""); !last_modified.empty())
+            {
+                request.last_modified = std::move(last_modified);
+            }
+            if (const auto size = j.value("cached_size", std::size_t(0)); size > 0)
+            {
+                request.cached_size = size;
+            }
+            request.may_be_missing = j.value("may_be_missing", false);
+            // The result is published as soon as the transfer completes
+            request.on_success = [this, a = artifact.get(), &verifications](const Success& success)
+            {
+                if (a->is_immutable)
+                {
+                    verifications.push_back(std::async(
+                        std::launch::async,
+                        [this, a, success] { verify_and_publish(*a, success); }
+                    ));
+                }
+                else
+                {
+                    publish(*a, success);
+                }
+                return expected_t<void>();
+            };
+            requests.push_back(std::move(request));
+        }
+
+        MultiResult results;
+        try
+        {
+            results = download(std::move(requests), mirrors, params, auth_info, options);
+        }
+        catch (const std::exception& e)
+        {
+            results.assign(to_download.size(), tl::unexpected(Error{ e.what() }));
+        }
+        for (auto& verification : verifications)
+        {
+            verification.wait();
+        }
+        for (std::size_t i = 0; i < to_download.size(); ++i)
+        {
+            verify_and_publish(*to_download[i], std::move(results[i]));
+        }
+    }
+
+    void FetchCoordinator::Impl::verify_and_publish(Artifact& artifact, Result result)
+    {
+        // Only one thread publishes an artifact, which is checked out of the lock
+        {
+            std::lock_guard lock(mutex);
+            if (artifact.result.has_value())
+            {
+                return;
+            }
+        }
+        if (artifact.is_immutable && result.has_value())
+        {
+            std::lock_guard slot(verification_slots);
+            if (auto mismatch = check_staged_file(artifact.staged_file, artifact.request))
+            {
+                LOG_WARNING << "Downloaded " << artifact.request.value("url_path", "")
+                            << " does not match its checksum: " << mismatch.value();
+                result = tl::unexpected(Error{ fmt::format(
+                    "Download error: {} does not match its checksum: {}",
+                    artifact.request.value("url_path", ""),
+                    mismatch.value()
+                ) });
+            }
+            else
+            {
+                std::error_code ec;
+                artifact.staged_size = fs::file_size(artifact.staged_file, ec);
+            }
+        }
+        publish(artifact, std::move(result));
+    }
+
+    void FetchCoordinator::Impl::publish(Artifact& artifact, Result result)
+    {
+        std::lock_guard lock(mutex);
+        if (artifact.result.has_value())
+        {
+            return;
+        }
+        artifact.result = std::move(result);
+        if (!artifact.is_immutable || !artifact.result.value().has_value())
+        {
+            // Only the immutable artifacts successfully downloaded and verified are served again
+            for (auto it = artifacts.begin(); it != artifacts.end(); ++it)
+            {
+                if (it->second.get() == &artifact)
+                {
+                    artifacts.erase(it);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            expire_artifacts();
+        }
+        artifact_done.notify_all();
+    }
+
+    void FetchCoordinator::Impl::expire_artifacts()
+    {
+        // The artifacts in the map with a result are the ones kept to be served again
+        const auto now = clock::now();
+        std::vector<std::map<std::string, artifact_ptr>::iterator> kept;
+        std::size_t kept_size = 0;
+        for (auto it = artifacts.begin(); it != artifacts.end();)
+        {
+            const Artifact& artifact = *it->second;
+            if (!artifact.result.has_value())
+            {
+                ++it;
+            }
+            else if (now - artifact.last_requested > limits.max_age)
+            {
+                it = artifacts.erase(it);
+            }
+            else
+            {
+                kept_size += artifact.staged_size;
+                kept.push_back(it++);
+            }
+        }
+
+        std::sort(
+            kept.begin(),
+            kept.end(),
+            [](const auto& lhs, const auto& rhs)
+            { return lhs->second->last_requested < rhs->second->last_requested; }
+        );
+        for (auto it = kept.begin(); (it != kept.end()) && (kept_size > limits.max_size); ++it)
+        {
+            kept_size -= (*it)->second->staged_size;
+            artifacts.erase(*it);
+        }
+    }
+
+    std::string
+    FetchCoordinator::Impl::answer(std::size_t index, const Artifact& artifact, const fs::u8path& target)
+    {
+        const Result& result = artifact.result.value();
+        auto res = nlohmann::json{ { "index", index } };
+        if (!result.has_value())
+        {
+            res["error"] = error_to_json(result.error());
+            return res.dump();
+        }
+
+        // A "Not Modified" answer to a conditional request has no content
+        std::unique_lock lock(placement_mutex);
+        if (fs::exists(artifact.staged_file) && !place_file(artifact.staged_file, target))
+        {
+            res["fallback"] = fmt::format("could not write {}", target.string());
+            return res.dump();
+        }
+        res["success"] = success_to_json(result.value());
+        return res.dump();
+    }
+
+    FetchCoordinator::FetchCoordinator(
+        fs::u8path socket_path,
+        fs::u8path staging_dir,
+        const RemoteFetchParams& params,
+        const specs::AuthenticationDataBase& auth_info,
+        Options options,
+        StagingLimits limits
+    )
+        : p_impl(std::make_unique<Impl>(
+              std::move(socket_path),
+              std::move(staging_dir),
+              params,
+              auth_info,
+              std::move(options),
+              limits
+          ))
+    {
+    }
+
+    FetchCoordinator::~FetchCoordinator() = default;
+
+    void FetchCoordinator::serve()
+    {
+        auto server = LineSocket::listen(p_impl->socket_path);
+
+        // Another coordinator may use the same staging directory with another socket
+        fs::create_directories(p_impl->staging_dir);
+        const auto staging_lock = LockFile(p_impl->staging_dir, std::chrono::seconds(1));
+        if (auto error = staging_lock.error())
+        {
+            throw std::runtime_error(fmt::format(
+                "Could not lock the staging directory {}: {}",
+                p_impl->staging_dir.string(),
+                error->what()
+            ));
+        }
+        for (const auto& entry : fs::directory_iterator(p_impl->staging_dir))
+        {
+            if (!staging_lock || (entry.path() != staging_lock.lockfile_path()))
+            {
+                fs::remove_all(entry.path());
+            }
+        }
+        on_scope_exit guard(
+            [this]
+            {
+                std::error_code ec;
+                fs::remove(p_impl->socket_path, ec);
+                fs::remove_all(p_impl->staging_dir, ec);
+            }
+        );
+        LOG_INFO << "Fetch coordinator listening on " << p_impl->socket_path.string();
+
+        std::list<std::future<void>> clients;
+        while (!p_impl->stopped && !is_sig_interrupted())
+        {
+            auto client = server.accept(std::chrono::milliseconds(200));
+            if (client.is_valid())
+            {
+                clients.push_back(std::async(
+                    std::launch::async,
+                    [this, c = std::move(client)]() mutable { p_impl->serve_client(std::move(c)); }
+                ));
+            }
+            clients.remove_if(
+                [](const auto& f)
+                { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+            );
+            {
+                std::lock_guard lock(p_impl->mutex);
+                p_impl->expire_artifacts();
+            }
+        }
+        // The clients still connected are served until their downloads complete
+        clients.clear();
+    }
+
+    void FetchCoordinator::stop()
+    {
+        p_impl->stopped = true;
+    }
+
+    std::size_t FetchCoordinator::requested_count() const
+    {
+        return p_impl->requested_count;
+    }
+
+    std::size_t FetchCoordinator::downloaded_count() const
+    {
+        return p_impl->downloaded_count;
+    }
+
+    bool FetchCoordinator::is_supported()
+    {
+#ifdef _WIN32
+        return false;
+#else
+        return true;
+#endif
+    }
+}
@@ -8,6 +8,7 @@
 
 #include "mamba/core/logging.hpp"
 #include "mamba/core/util.hpp"      // for hide_secrets
+#include "mamba/core/util_scope.hpp"
 #include "mamba/fs/filesystem.hpp"  // for fs::exists
 #include "mamba/util/environment.hpp"
 
@@ -126,6 +127,9 @@ namespace mamba::download
         )
         {
             auto handle = curl_easy_init();
+            on_scope_exit cleanup([handle]() { curl_easy_cleanup(handle); });
+            const auto& share = TransferContext::instance().share_handle();
+            curl_easy_setopt(handle, CURLOPT_SHARE, unwrap(share));
 
             configure_curl_handle(
                 handle,
@@ -244,9 +248,11 @@ namespace mamba::download
     CURLHandle::CURLHandle(CURLHandle&& rhs)
         : m_handle(std::move(rhs.m_handle))
         , p_headers(std::move(rhs.p_headers))
+        , p_share(rhs.p_share)
     {
         rhs.m_handle = nullptr;
         rhs.p_headers = nullptr;
+        rhs.p_share = nullptr;
         std::fill(m_errorbuffer.begin(), m_errorbuffer.end(), '\0');
         std::swap(m_errorbuffer, rhs.m_errorbuffer);
         set_opt(CURLOPT_ERRORBUFFER, m_errorbuffer.data());
@@ -257,6 +263,7 @@ namespace mamba::download
         using std::swap;
         swap(m_handle, rhs.m_handle);
         swap(p_headers, rhs.p_headers);
+        swap(p_share, rhs.p_share);
         swap(m_errorbuffer, rhs.m_errorbuffer);
         set_opt(CURLOPT_ERRORBUFFER, m_errorbuffer.data());
         rhs.set_opt(CURLOPT_ERRORBUFFER, rhs.m_errorbuffer.data());
@@ -402,6 +409,17 @@ namespace mamba::download
     void CURLHandle::reset_handle()
     {
         curl_easy_reset(m_handle);
+        set_opt(CURLOPT_ERRORBUFFER, m_errorbuffer.data());
+        if (p_share)
+        {
+            set_opt(CURLOPT_SHARE, p_share);
+        }
+    }
+
+    void CURLHandle::set_share(const CURLShareHandle& share)
+    {
+        p_share = unwrap(share);
+        set_opt(CURLOPT_SHARE, p_share);
     }
 
     CURLHandle& CURLHandle::add_header(const std::string& header)
@@ -466,6 +484,15 @@ namespace mamba::download
         return curl_easy_perform(m_handle);
     }
 
+    void CURLHandle::resume()
+    {
+        const CURLcode res = curl_easy_pause(m_handle, CURLPAUSE_CONT);
+        if (res != CURLE_OK)
+        {
+            LOG_WARNING << "Could not resume transfer: " << curl_easy_strerror(res);
+        }
+    }
+
     CURLId CURLHandle::get_id() const
     {
         return CURLId(m_handle);
@@ -640,7 +667,6 @@ namespace mamba::download
         return static_cast<std::size_t>(numfds);
     }
 
-    // TODO apparently not used?
     std::size_t CURLMultiHandle::poll(size_t timeout)
     {
         int numfds = 0;
@@ -651,4 +677,101 @@ namespace mamba::download
         }
         return static_cast<std::size_t>(numfds);
     }
+
+    /*******************
+     * CURLShareHandle *
+     *******************/
+
+    CURLShareHandle::CURLShareHandle()
+        : p_handle(curl_share_init())
+    {
+        if (p_handle == nullptr)
+        {
+            throw curl_error("Could not initialize CURL share handle");
+        }
+        curl_share_setopt(p_handle, CURLSHOPT_LOCKFUNC, &CURLShareHandle::lock);
+        curl_share_setopt(p_handle, CURLSHOPT_UNLOCKFUNC, &CURLShareHandle::unlock);
+        curl_share_setopt(p_handle, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(p_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(p_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(p_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    }
+
+    CURLShareHandle::~CURLShareHandle()
+    {
+        curl_share_cleanup(p_handle);
+    }
+
+    void CURLShareHandle::lock(CURL*, curl_lock_data data, curl_lock_access, void* self)
+    {
+        static_cast<CURLShareHandle*>(self)->m_mutexes[static_cast<std::size_t>(data)].lock();
+    }
+
+    void CURLShareHandle::unlock(CURL*, curl_lock_data data, void* self)
+    {
+        static_cast<CURLShareHandle*>(self)->m_mutexes[static_cast<std::size_t>(data)].unlock();
+    }
+
+    CURLSH* unwrap(const CURLShareHandle& h)
+    {
+        return h.p_handle;
+    }
+
+    /*******************
+     * TransferContext *
+     *******************/
+
+    CURLHandle TransferContext::acquire_handle()
+    {
+        {
+            auto idle_handles = m_idle_handles.synchronize();
+            if (!idle_handles->empty())
+            {
+                CURLHandle handle = std::move(idle_handles->back());
+                idle_handles->pop_back();
+                return handle;
+            }
+        }
+        CURLHandle handle;
+        handle.set_share(m_share_handle);
+        return handle;
+    }
+
+    void TransferContext::release_handle(CURLHandle&& handle)
+    {
+        if (unwrap(handle) == nullptr)
+        {
+            return;
+        }
+        handle.reset_handle();
+        handle.reset_headers();
+        auto idle_handles = m_idle_handles.synchronize();
+        if (idle_handles->size() < max_idle_handles)
+        {
+            idle_handles->push_back(std::move(handle));
+        }
+    }
+
+    const CURLShareHandle& TransferContext::share_handle() const
+    {
+        return m_share_handle;
+    }
+
+    void TransferContext::record_transfer(const CURLHandle& handle)
+    {
+        ++m_transfer_count;
+        const auto connections = handle.get_info<long>(CURLINFO_NUM_CONNECTS).value_or(0);
+        m_connection_count += static_cast<std::size_t>(connections);
+        // A reused connection has no TLS handshake
+        const auto tls_time = handle.get_info<curl_off_t>(CURLINFO_APPCONNECT_TIME_T).value_or(0);
+        if (tls_time > 0)
+        {
+            ++m_tls_handshake_count;
+        }
+    }
+
+    TransferStats TransferContext::stats() const
+    {
+        return { m_transfer_count, m_connection_count, m_tls_handshake_count };
+    }
 }  // namespace mamba
@@ -7,11 +7,15 @@
 #ifndef MAMBA_DL_CURL_HPP
 #define MAMBA_DL_CURL_HPP
 
+#include <array>
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 // TODO to be removed later and forward declare specific curl structs
 extern "C"
@@ -22,6 +26,8 @@ extern "C"
 #include <fmt/core.h>
 #include <tl/expected.hpp>
 
+#include "mamba/util/synchronized_value.hpp"
+
 namespace mamba::download
 {
     namespace curl
@@ -102,6 +108,8 @@ namespace mamba::download
 {
     using proxy_map_type = std::map<std::string, std::string>;
 
+    class CURLShareHandle;
+
     class CURLHandle
     {
     public:
@@ -129,7 +137,9 @@ namespace mamba::download
             const std::string& ssl_verify
         );
 
+        // Resets all the options of the handle, except its error buffer and share handle.
         void reset_handle();
+        void set_share(const CURLShareHandle& share);
 
         CURLHandle& add_header(const std::string& header);
         CURLHandle& add_headers(const std::vector<std::string>& headers);
@@ -146,6 +156,8 @@ namespace mamba::download
         std::string get_curl_effective_url() const;
 
         CURLcode perform();
+        // Resumes a transfer paused by its write callback
+        void resume();
 
         CURLId get_id() const;
 
@@ -158,6 +170,7 @@ namespace mamba::download
 
         CURL* m_handle;
         curl_slist* p_headers = nullptr;
+        CURLSH* p_share = nullptr;
         std::array<char, CURL_ERROR_SIZE> m_errorbuffer;
 
         friend CURL* unwrap(const CURLHandle&);
@@ -203,6 +216,77 @@ namespace mamba::download
         std::size_t m_max_parallel_downloads = 5;
     };
 
+    /**
+     * Shares the DNS cache, the TLS sessions and the connection cache between the handles
+     * it is set on, possibly from different threads.
+     */
+    class CURLShareHandle
+    {
+    public:
+
+        CURLShareHandle();
+        ~CURLShareHandle();
+
+        CURLShareHandle(const CURLShareHandle&) = delete;
+        CURLShareHandle& operator=(const CURLShareHandle&) = delete;
+        CURLShareHandle(CURLShareHandle&&) = delete;
+        CURLShareHandle& operator=(CURLShareHandle&&) = delete;
+
+    private:
+
+        static void lock(CURL*, curl_lock_data data, curl_lock_access, void* self);
+        static void unlock(CURL*, curl_lock_data data, void* self);
+
+        CURLSH* p_handle;
+        std::array<std::mutex, CURL_LOCK_DATA_LAST> m_mutexes;
+
+        friend CURLSH* unwrap(const CURLShareHandle&);
+    };
+
+    struct TransferStats
+    {
+        std::size_t transfer_count = 0;
+        std::size_t connection_count = 0;
+        std::size_t tls_handshake_count = 0;
+    };
+
+    /**
+     * Process-wide resources shared by all the downloads, so that successive downloads to the
+     * same hosts skip the DNS resolution, the TCP connection and the TLS handshake.
+     * It is released before curl global cleanup, at the end of the program.
+     */
+    class TransferContext
+    {
+    public:
+
+        static constexpr std::size_t max_idle_handles = 64;
+
+        static TransferContext& instance();
+
+        TransferContext() = default;
+
+        TransferContext(const TransferContext&) = delete;
+        TransferContext& operator=(const TransferContext&) = delete;
+
+        // Returns an idle handle from the pool, or a new one, set to use the share handle.
+        CURLHandle acquire_handle();
+        void release_handle(CURLHandle&& handle);
+
+        const CURLShareHandle& share_handle() const;
+
+        // Accounts for the connections a finished transfer had to open.
+        void record_transfer(const CURLHandle& handle);
+        TransferStats stats() const;
+
+    private:
+
+        CURLShareHandle m_share_handle;
+        util::synchronized_value<std::vector<CURLHandle>> m_idle_handles;
+        std::atomic<std::size_t> m_transfer_count = 0;
+        std::atomic<std::size_t> m_connection_count = 0;
+        std::atomic<std::size_t> m_tls_handshake_count = 0;
+    };
+
     template <class T>
     CURLHandle& CURLHandle::set_opt(CURLoption opt, const T& val)
     {
@@ -4,6 +4,10 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <charconv>
+
+#include <nlohmann/json.hpp>
+
 #include "mamba/api/configuration.hpp"
 #include "mamba/core/invoke.hpp"
 #include "mamba/core/thread_utils.hpp"
@@ -160,6 +164,218 @@ namespace mamba::download
         }
     }
 
+    namespace http
+    {
+        static constexpr int OK = 200;
+        static constexpr int PARTIAL_CONTENT = 206;
+        static constexpr int NOT_MODIFIED = 304;
+        static constexpr int PAYLOAD_TOO_LARGE = 413;
+        static constexpr int RANGE_NOT_SATISFIABLE = 416;
+        static constexpr int TOO_MANY_REQUESTS = 429;
+        static constexpr int INTERNAL_SERVER_ERROR = 500;
+        static constexpr int ARBITRARY_ERROR = 10000;
+    }
+
+    namespace
+    {
+        // An interrupted download is kept next to its target, along with a file recording the
+        // validators of the response, so that it can be resumed with an HTTP range request.
+        auto partial_path(const std::string& filename) -> std::string
+        {
+            return filename + ".partial";
+        }
+
+        auto partial_state_path(const std::string& filename) -> std::string
+        {
+            return filename + ".partial.json";
+        }
+
+        auto if_range_validator(const PartialDownload& state) -> std::string
+        {
+            // Weak entity tags cannot validate a range request
+            if (!state.etag.empty() && !util::starts_with(state.etag, "W/"))
+            {
+                return state.etag;
+            }
+            return state.last_modified;
+        }
+
+        auto read_partial_download(const std::string& filename) -> std::optional<PartialDownload>
+        {
+            const fs::u8path state_path = partial_state_path(filename);
+            const fs::u8path data_path = partial_path(filename);
+            if (!fs::exists(state_path) || !fs::exists(data_path))
+            {
+                return std::nullopt;
+            }
+
+            auto in = open_ifstream(state_path);
+            const auto json = nlohmann::json::parse(in, nullptr, /* allow_exceptions= */ false);
+            if (!json.is_object())
+            {
+                return std::nullopt;
+            }
+            auto state = PartialDownload{
+                /* .etag= */ json.value("etag", ""),
+                /* .last_modified= */ json.value("last_modified", ""),
+                /* .size= */ json.value("size", std::size_t(0)),
+            };
+            std::error_code ec;
+            const auto size = fs::file_size(data_path, ec);
+            if (ec || state.size == 0 || size != state.size || if_range_validator(state).empty())
+            {
+                return std::nullopt;
+            }
+            return state;
+        }
+
+        void write_partial_download(const std::string& filename, const PartialDownload& state)
+        {
+            auto out = open_ofstream(partial_state_path(filename));
+            const auto json = nlohmann::json{
+                { "etag", state.etag },
+                { "last_modified", state.last_modified },
+                { "size", state.size },
+            };
+            out << json.dump();
+        }
+
+        void remove_partial_download(const std::string& filename)
+        {
+            std::error_code ec;
+            fs::remove(partial_path(filename), ec);
+            fs::remove(partial_state_path(filename), ec);
+        }
+
+        // Only artifacts stored as received can be resumed, and the validators needed
+        // by If-Range are only available over HTTP.
+        bool is_resumable(const MirrorRequest& request)
+        {
+            return request.resumable && request.filename.has_value() && !request.check_only
+                   && !request.is_repodata_zst
+                   && util::starts_with(request.url, "http")
+                   && !util::ends_with(request.url, ".json")
+                   && !util::ends_with(request.url, ".json.zst")
+                   && !util::ends_with(request.url, ".json.bz2");
+        }
+
+        // The bucket holds up to a tenth of second of bandwidth, so that the transfers
+        // resumed together are not bursting over the limit.
+        double bandwidth_bucket_capacity(std::size_t max_speed_Bps)
+        {
+            return std::max(static_cast<double>(max_speed_Bps) / 10., double(CURL_MAX_WRITE_SIZE));
+        }
+    }
+
+    /*********************************
+     * TransferBudget implementation *
+     *********************************/
+
+    TransferBudget::TransferBudget(std::size_t max_speed_Bps, std::size_t max_host_connections)
+        : m_max_speed_Bps(max_speed_Bps)
+        , m_max_host_connections(max_host_connections)
+        , m_host_connections()
+        , m_tokens(bandwidth_bucket_capacity(max_speed_Bps))
+        , m_last_refill(std::chrono::steady_clock::now())
+        , m_paused_transfers()
+    {
+    }
+
+    std::size_t TransferBudget::free_connections(const std::string& host) const
+    {
+        if (m_max_host_connections == 0 || host.empty())
+        {
+            return SIZE_MAX;
+        }
+        const auto iter = m_host_connections.find(host);
+        const std::size_t used = (iter == m_host_connections.end()) ? 0 : iter->second;
+        return (used < m_max_host_connections) ? m_max_host_connections - used : 0;
+    }
+
+    void TransferBudget::add_connection(const std::string& host)
+    {
+        if (!host.empty())
+        {
+            ++m_host_connections[host];
+        }
+    }
+
+    void TransferBudget::remove_connection(const std::string& host)
+    {
+        auto iter = m_host_connections.find(host);
+        if (iter != m_host_connections.end() && --(iter->second) == 0)
+        {
+            m_host_connections.erase(iter);
+        }
+    }
+
+    bool TransferBudget::consume_bandwidth(CURLHandle& handle, std::size_t size)
+    {
+        if (m_max_speed_Bps == 0)
+        {
+            return true;
+        }
+        refill_bandwidth();
+        // The bucket may go in debt by the last write, which delays the next ones
+        if (m_tokens <= 0.)
+        {
+            m_paused_transfers.push_back(&handle);
+            return false;
+        }
+        m_tokens -= static_cast<double>(size);
+        return true;
+    }
+
+    void TransferBudget::forget_transfer(const CURLHandle& handle)
+    {
+        auto iter = std::find(m_paused_transfers.begin(), m_paused_transfers.end(), &handle);
+        if (iter != m_paused_transfers.end())
+        {
+            m_paused_transfers.erase(iter);
+        }
+    }
+
+    void TransferBudget::resume_transfers()
+    {
+        if (m_paused_transfers.empty())
+        {
+            return;
+        }
+        refill_bandwidth();
+        // Resuming a transfer may deliver its pending data and spend tokens right away
+        while (m_tokens > 0. && !m_paused_transfers.empty())
+        {
+            CURLHandle* handle = m_paused_transfers.front();
+            m_paused_transfers.pop_front();
+            handle->resume();
+        }
+    }
+
+    auto TransferBudget::next_resume_time() const -> std::optional<time_point_t>
+    {
+        if (m_paused_transfers.empty())
+        {
+            return std::nullopt;
+        }
+        const double missing_tokens = std::max(1. - m_tokens, 0.);
+        const auto refill_duration = std::chrono::duration<double>(
+            missing_tokens / static_cast<double>(m_max_speed_Bps)
+        );
+        return m_last_refill
+               + std::chrono::duration_cast<std::chrono::steady_clock::duration>(refill_duration);
+    }
+
+    void TransferBudget::refill_bandwidth()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const std::chrono::duration<double> elapsed = now - m_last_refill;
+        m_tokens = std::min(
+            m_tokens + elapsed.count() * static_cast<double>(m_max_speed_Bps),
+            bandwidth_bucket_capacity(m_max_speed_Bps)
+        );
+        m_last_refill = now;
+    }
+
     /**********************************
      * DownloadAttempt implementation *
      **********************************/
@@ -168,22 +384,26 @@ namespace mamba::download
         CURLHandle& handle,
         const MirrorRequest& request,
         CURLMultiHandle& downloader,
+        TransferBudget& budget,
         const RemoteFetchParams& params,
         const specs::AuthenticationDataBase& auth_info,
         bool verbose,
         on_success_callback success,
-        on_failure_callback error
+        on_failure_callback error,
+        std::optional<ByteRange> range
     )
         : p_impl(
               std::make_unique<Impl>(
                   handle,
                   request,
                   downloader,
+                  budget,
                   params,
                   auth_info,
                   verbose,
                   std::move(success),
-                  std::move(error)
+                  std::move(error),
+                  std::move(range)
               )
           )
     {
@@ -195,27 +415,48 @@ namespace mamba::download
         { return impl->finish_download(handle, code); };
     }
 
+    void DownloadAttempt::cancel(CURLMultiHandle& downloader)
+    {
+        // The download completed elsewhere, there is nothing to resume
+        p_impl->m_can_resume = false;
+        p_impl->clean_attempt(downloader, true);
+        if (p_impl->p_request->filename.has_value() && !p_impl->m_range.has_value())
+        {
+            remove_partial_download(p_impl->p_request->filename.value());
+        }
+    }
+
     DownloadAttempt::Impl::Impl(
         CURLHandle& handle,
         const MirrorRequest& request,
         CURLMultiHandle& downloader,
+        TransferBudget& budget,
         const RemoteFetchParams& params,
         const specs::AuthenticationDataBase& auth_info,
         bool verbose,
         on_success_callback success,
-        on_failure_callback error
+        on_failure_callback error,
+        std::optional<ByteRange> range
     )
         : p_handle(&handle)
         , p_request(&request)
+        , p_budget(&budget)
         , m_success_callback(std::move(success))
         , m_failure_callback(std::move(error))
         , m_retry_wait_seconds(static_cast<std::size_t>(params.retry_timeout))
+        , m_is_local_file(util::starts_with(request.url, "file://"))
+        , m_range(std::move(range))
     {
         p_stream = make_compression_stream(
             p_request->url,
             p_request->is_repodata_zst,
             [this](char* in, std::size_t size) { return this->write_data(in, size); }
         );
+        // A chunk writes in place in a file shared with the other chunks
+        if (!m_range.has_value())
+        {
+            restore_partial_download();
+        }
         configure_handle(params, auth_info, verbose);
         downloader.add_handle(*p_handle);
     }
@@ -231,6 +472,7 @@ namespace mamba::download
 
     bool DownloadAttempt::Impl::finish_download(CURLMultiHandle& downloader, CURLcode code)
     {
+        TransferContext::instance().record_transfer(*p_handle);
         if (!CURLHandle::is_curl_res_ok(code))
         {
             Error error = build_download_error(code);
@@ -260,6 +502,9 @@ namespace mamba::download
 
     void DownloadAttempt::Impl::clean_attempt(CURLMultiHandle& downloader, bool erase_downloaded)
     {
+        const bool written = m_file.is_open();
+        const bool keep_partial = erase_downloaded && can_keep_partial_download(written);
+        p_budget->forget_transfer(*p_handle);
         downloader.remove_handle(*p_handle);
         p_handle->reset_handle();
 
@@ -267,11 +512,19 @@ namespace mamba::download
         {
             m_file.close();
         }
-        if (erase_downloaded && p_request->filename.has_value()
-            && fs::exists(p_request->filename.value()))
+        if (keep_partial)
+        {
+            save_partial_download(written);
+        }
+        else if (erase_downloaded && !m_range.has_value() && p_request->filename.has_value()
+                 && fs::exists(p_request->filename.value()))
         {
             fs::remove(p_request->filename.value());
         }
+        if (!keep_partial && m_resume_state.has_value())
+        {
+            remove_partial_download(p_request->filename.value());
+        }
 
         m_response.clear();
         m_cache_control.clear();
@@ -279,6 +532,74 @@ namespace mamba::download
         m_last_modified.clear();
     }
 
+    void DownloadAttempt::Impl::restore_partial_download()
+    {
+        m_can_resume = is_resumable(*p_request);
+        if (!m_can_resume)
+        {
+            return;
+        }
+
+        const auto& filename = p_request->filename.value();
+        if (auto state = read_partial_download(filename))
+        {
+            std::error_code ec;
+            fs::rename(partial_path(filename), filename, ec);
+            if (!ec)
+            {
+                LOG_INFO << "Resuming download of " << filename << " from byte " << state->size;
+                m_resume_state = std::move(state);
+                return;
+            }
+        }
+        remove_partial_download(filename);
+    }
+
+    bool DownloadAttempt::Impl::can_keep_partial_download(bool written) const
+    {
+        if (!m_can_resume)
+        {
+            return false;
+        }
+        const int status = p_handle->get_info<int>(CURLINFO_RESPONSE_CODE).value_or(0);
+        if (!written)
+        {
+            // The partial download restored for this attempt was left untouched
+            return m_resume_state.has_value() && status != http::RANGE_NOT_SATISFIABLE;
+        }
+        const bool has_validator = !m_etag.empty() || !m_last_modified.empty()
+                                   || m_resume_state.has_value();
+        return (status == http::OK || status == http::PARTIAL_CONTENT) && has_validator;
+    }
+
+    void DownloadAttempt::Impl::save_partial_download(bool written)
+    {
+        const auto& filename = p_request->filename.value();
+        auto state = m_resume_state.value_or(PartialDownload{});
+        if (written)
+        {
+            std::error_code ec;
+            state.size = fs::file_size(filename, ec);
+            // A server may omit the validators in partial responses
+            if (!m_etag.empty() || !m_last_modified.empty())
+            {
+                state.etag = m_etag;
+                state.last_modified = m_last_modified;
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(filename, partial_path(filename), ec);
+        if (ec || state.size == 0)
+        {
+            fs::remove(filename, ec);
+            remove_partial_download(filename);
+            return;
+        }
+        LOG_INFO << "Keeping " << state.size << " bytes of " << filename << " to resume later";
+        write_partial_download(filename, state);
+    }
+
     void DownloadAttempt::Impl::invoke_progress_callback(const Event& event) const
     {
         if (p_request->progress.has_value())
@@ -446,6 +767,18 @@ namespace mamba::download
             p_handle->add_headers(p_request->headers);
         }
 
+        if (m_resume_state.has_value())
+        {
+            p_handle->add_header(fmt::format("Range: bytes={}-", m_resume_state->size));
+            p_handle->add_header("If-Range: " + if_range_validator(m_resume_state.value()));
+        }
+
+        if (m_range.has_value())
+        {
+            const std::size_t last = m_range->offset + m_range->size - 1;
+            p_handle->add_header(fmt::format("Range: bytes={}-{}", m_range->offset, last));
+        }
+
         p_handle->set_opt_header();
     }
 
@@ -455,7 +788,46 @@ namespace mamba::download
         {
             if (!m_file.is_open())
             {
-                m_file = open_ofstream(p_request->filename.value(), std::ios::binary);
+                auto mode = std::ios::binary;
+                if (m_resume_state.has_value())
+                {
+                    const int status = p_handle->get_info<int>(CURLINFO_RESPONSE_CODE).value_or(0);
+                    if (status == http::PARTIAL_CONTENT)
+                    {
+                        if (m_content_range_start != m_resume_state->size)
+                        {
+                            LOG_ERROR << "Unexpected range received for "
+                                      << p_request->filename.value();
+                            m_can_resume = false;
+                            return size + 1;
+                        }
+                        mode |= std::ios::app;
+                        m_resumed = true;
+                        m_file_written = m_resume_state->size;
+                    }
+                    else if (!is_http_status_ok(status))
+                    {
+                        // Keep the partial download intact for a later attempt
+                        return size;
+                    }
+                }
+                if (m_range.has_value())
+                {
+                    const int status = p_handle->get_info<int>(CURLINFO_RESPONSE_CODE).value_or(0);
+                    if (!is_http_status_ok(status))
+                    {
+                        // The error is reported when the transfer completes
+                        return size;
+                    }
+                    if (status != http::PARTIAL_CONTENT || m_content_range_start != m_range->offset)
+                    {
+                        LOG_WARNING << "Byte range not served for " << hide_secrets(p_request->url);
+                        return size + 1;
+                    }
+                    // Do not truncate the preallocated file
+                    mode |= std::ios::in;
+                }
+                m_file = open_ofstream(p_request->filename.value(), mode);
                 if (!m_file)
                 {
                     LOG_ERROR << "Could not open file for download " << p_request->filename.value()
@@ -463,10 +835,31 @@ namespace mamba::download
                     // Return a size _different_ than the expected write size to signal an error
                     return size + 1;
                 }
+                if (m_range.has_value())
+                {
+                    m_file.seekp(static_cast<std::streamoff>(m_range->offset));
+                }
+            }
+
+            if (m_range.has_value())
+            {
+                if (m_range_written + size > m_range->size)
+                {
+                    LOG_ERROR << "Received more data than requested for "
+                              << p_request->filename.value();
+                    return size + 1;
+                }
+                m_range_written += size;
             }
 
             m_file.write(buffer, static_cast<std::streamsize>(size));
 
+            const bool report_write = p_request->on_write.has_value() && !m_range.has_value();
+            if (report_write)
+            {
+                // The file may be read while it is downloaded
+                m_file.flush();
+            }
             if (!m_file)
             {
                 LOG_ERROR << "Could not write to file " << p_request->filename.value() << ": "
@@ -474,6 +867,15 @@ namespace mamba::download
                 // Return a size _different_ than the expected write size to signal an error
                 return size + 1;
             }
+            if (report_write)
+            {
+                [[maybe_unused]] auto result = safe_invoke(
+                    p_request->on_write.value(),
+                    m_file_written,
+                    size
+                );
+            }
+            m_file_written += size;
         }
         else
         {
@@ -521,6 +923,17 @@ namespace mamba::download
             {
                 s->m_last_modified = value;
             }
+            else if (lkey == "content-range")
+            {
+                // Format is "bytes <start>-<end>/<size>"
+                std::size_t start = 0;
+                const auto range = util::remove_prefix(value, "bytes ");
+                const auto* last = range.data() + range.size();
+                if (std::from_chars(range.data(), last, start).ec == std::errc())
+                {
+                    s->m_content_range_start = start;
+                }
+            }
         }
 
         return buffer_size;
@@ -529,7 +942,14 @@ namespace mamba::download
     size_t
     DownloadAttempt::Impl::curl_write_callback(char* buffer, size_t size, size_t nbitems, void* self)
     {
-        return reinterpret_cast<DownloadAttempt::Impl*>(self)->p_stream->write(buffer, size * nbitems);
+        auto* s = reinterpret_cast<DownloadAttempt::Impl*>(self);
+        const size_t buffer_size = size * nbitems;
+        // The data is delivered again when the transfer is resumed
+        if (!s->m_is_local_file && !s->p_budget->consume_bandwidth(*s->p_handle, buffer_size))
+        {
+            return CURL_WRITEFUNC_PAUSE;
+        }
+        return s->p_stream->write(buffer, buffer_size);
     }
 
     int DownloadAttempt::Impl::curl_progress_callback(
@@ -543,22 +963,17 @@ namespace mamba::download
         auto* self = reinterpret_cast<DownloadAttempt::Impl*>(f);
         const auto speed_Bps = self->p_handle->get_info<std::size_t>(CURLINFO_SPEED_DOWNLOAD_T)
                                    .value_or(0);
-        const size_t total = total_to_download ? static_cast<std::size_t>(total_to_download)
-                                               : self->p_request->expected_size.value_or(0);
+        // Curl only counts the bytes of this transfer, not the ones resumed from
+        const std::size_t offset = self->m_resumed ? self->m_resume_state->size : 0;
+        const size_t total = total_to_download
+                                 ? static_cast<std::size_t>(total_to_download) + offset
+                                 : self->p_request->expected_size.value_or(0);
         self->p_request->progress.value()(
-            Progress{ static_cast<std::size_t>(now_downloaded), total, speed_Bps }
+            Progress{ static_cast<std::size_t>(now_downloaded) + offset, total, speed_Bps }
         );
         return 0;
     }
 
-    namespace http
-    {
-        static constexpr int PAYLOAD_TOO_LARGE = 413;
-        static constexpr int TOO_MANY_REQUESTS = 429;
-        static constexpr int INTERNAL_SERVER_ERROR = 500;
-        static constexpr int ARBITRARY_ERROR = 10000;
-    }
-
     bool DownloadAttempt::Impl::can_retry(CURLcode code) const
     {
         return p_handle->can_retry(code) && !util::starts_with(p_request->url, "file://");
@@ -566,9 +981,11 @@ namespace mamba::download
 
     bool DownloadAttempt::Impl::can_retry(const TransferData& data) const
     {
+        // A range that cannot be satisfied is retried without resuming
         return (data.http_status == http::PAYLOAD_TOO_LARGE
                 || data.http_status == http::TOO_MANY_REQUESTS
-                || data.http_status >= http::INTERNAL_SERVER_ERROR)
+                || data.http_status >= http::INTERNAL_SERVER_ERROR
+                || (data.http_status == http::RANGE_NOT_SATISFIABLE && m_resume_state.has_value()))
                && !util::starts_with(p_request->url, "file://");
     }
 
@@ -580,12 +997,27 @@ namespace mamba::download
         std::string url = util::is_file_uri(p_request->url)
                               ? p_request->url
                               : p_handle->get_info<char*>(CURLINFO_EFFECTIVE_URL).value();
+        // Curl only counts the bytes of this transfer, not the ones resumed from
+        const std::size_t resumed_size = m_resumed ? m_resume_state->size : 0;
+        const std::size_t downloaded_size = resumed_size
+            + p_handle->get_info<std::size_t>(CURLINFO_SIZE_DOWNLOAD_T).value_or(0);
+        const int http_status = p_handle->get_info<int>(CURLINFO_RESPONSE_CODE)
+                                    .value_or(http::ARBITRARY_ERROR);
+        const auto get_time = [this](CURLINFO option)
+        { return std::chrono::microseconds(p_handle->get_info<std::size_t>(option).value_or(0)); };
         return {
-            /* .http_status = */ p_handle->get_info<int>(CURLINFO_RESPONSE_CODE)
-                .value_or(http::ARBITRARY_ERROR),
+            /* .http_status = */ http_status,
             /* .effective_url = */ std::move(url),
-            /* .dwonloaded_size = */ p_handle->get_info<std::size_t>(CURLINFO_SIZE_DOWNLOAD_T).value_or(0),
-            /* .average_speed = */ p_handle->get_info<std::size_t>(CURLINFO_SPEED_DOWNLOAD_T).value_or(0)
+            /* .dwonloaded_size = */ downloaded_size,
+            /* .average_speed = */ p_handle->get_info<std::size_t>(CURLINFO_SPEED_DOWNLOAD_T).value_or(0),
+            /* .saved_size = */ http_status == http::NOT_MODIFIED
+                ? p_request->cached_size.value_or(0)
+                : 0,
+            /* .name_lookup_time = */ get_time(CURLINFO_NAMELOOKUP_TIME_T),
+            /* .connect_time = */ get_time(CURLINFO_CONNECT_TIME_T),
+            /* .tls_handshake_time = */ get_time(CURLINFO_APPCONNECT_TIME_T),
+            /* .time_to_first_byte = */ get_time(CURLINFO_STARTTRANSFER_TIME_T),
+            /* .total_time = */ get_time(CURLINFO_TOTAL_TIME_T),
         };
     }
 
@@ -659,6 +1091,7 @@ namespace mamba::download
      */
     MirrorAttempt::MirrorAttempt(Mirror& mirror, const std::string& url_path, const std::string& spec_sha256)
         : p_mirror(&mirror)
+        , m_host(mirror.host(url_path))
         , m_request_generators(p_mirror->get_request_generators(url_path, spec_sha256))
     {
     }
@@ -701,24 +1134,29 @@ namespace mamba::download
     auto MirrorAttempt::prepare_attempt(
         CURLHandle& handle,
         CURLMultiHandle& downloader,
+        TransferBudget& budget,
         const RemoteFetchParams& params,
         const specs::AuthenticationDataBase& auth_info,
         bool verbose,
         on_success_callback success,
-        on_failure_callback error
+        on_failure_callback error,
+        std::optional<ByteRange> range
     ) -> completion_function
     {
         LOG_DEBUG << "Preparing download...";
         m_state = State::PREPARING_DOWNLOAD;
+        p_budget = &budget;
         m_attempt = DownloadAttempt(
             handle,
             m_request.value(),
             downloader,
+            budget,
             params,
             auth_info,
             verbose,
             std::move(success),
-            std::move(error)
+            std::move(error),
+            std::move(range)
         );
         return m_attempt.create_completion_function();
     }
@@ -729,6 +1167,24 @@ namespace mamba::download
                || (m_state == State::LAST_REQUEST_FAILED && can_retry());
     }
 
+    auto MirrorAttempt::next_start_time() const -> std::optional<time_point_t>
+    {
+        if (m_state == State::WAITING_SEQUENCE_START || m_state == State::LAST_REQUEST_FINISHED)
+        {
+            return time_point_t{};
+        }
+        if (m_state == State::LAST_REQUEST_FAILED)
+        {
+            return m_next_retry.value_or(time_point_t{});
+        }
+        return std::nullopt;
+    }
+
+    bool MirrorAttempt::has_started() const
+    {
+        return m_state != State::WAITING_SEQUENCE_START;
+    }
+
     bool MirrorAttempt::has_failed() const
     {
         return m_state == State::SEQUENCE_FAILED;
@@ -740,10 +1196,26 @@ namespace mamba::download
         return res;
     }
 
+    bool MirrorAttempt::is_single_request() const
+    {
+        return m_request_generators.size() == 1;
+    }
+
+    Mirror* MirrorAttempt::mirror() const
+    {
+        return p_mirror;
+    }
+
+    const std::string& MirrorAttempt::host() const
+    {
+        return m_host;
+    }
+
     void MirrorAttempt::set_transfer_started()
     {
         m_state = State::RUNNING_DOWNLOAD;
         p_mirror->increase_running_transfers();
+        p_budget->add_connection(m_host);
     }
 
     void MirrorAttempt::set_state(bool success)
@@ -794,6 +1266,25 @@ namespace mamba::download
         p_last_content = content;
     }
 
+    void MirrorAttempt::update_mirror_performance(const TransferData& data)
+    {
+        p_mirror->record_transfer(data);
+    }
+
+    bool MirrorAttempt::cancel(CURLMultiHandle& downloader)
+    {
+        const bool running = m_state == State::PREPARING_DOWNLOAD
+                             || m_state == State::RUNNING_DOWNLOAD;
+        if (running)
+        {
+            m_attempt.cancel(downloader);
+            p_mirror->update_transfers_done(false, false);
+            release_connection();
+        }
+        m_state = State::SEQUENCE_FAILED;
+        return running;
+    }
+
     bool MirrorAttempt::can_retry() const
     {
         return !m_next_retry.has_value() || m_next_retry.value() < std::chrono::steady_clock::now();
@@ -801,7 +1292,15 @@ namespace mamba::download
 
     void MirrorAttempt::update_transfers_done(bool success)
     {
-        p_mirror->update_transfers_done(success, !m_request.value().check_only);
+        const bool record_success = !m_request.value().check_only
+                                    && !m_request.value().may_be_missing;
+        p_mirror->update_transfers_done(success, record_success);
+        release_connection();
+    }
+
+    void MirrorAttempt::release_connection()
+    {
+        p_budget->remove_connection(m_host);
     }
 
     /**********************************
@@ -811,16 +1310,22 @@ namespace mamba::download
     DownloadTracker::DownloadTracker(
         const Request& request,
         const mirror_set_view& mirrors,
-        DownloadTrackerOptions options
+        DownloadTrackerOptions options,
+        TransferBudget& budget
     )
-        : m_handle()
+        : m_handle(TransferContext::instance().acquire_handle())
         , p_initial_request(&request)
         , m_mirror_set(mirrors)
         , m_options(std::move(options))
+        , p_budget(&budget)
         , m_state(State::WAITING)
         , m_attempt_results()
         , m_tried_mirrors()
         , m_mirror_attempt()
+        , m_transfer_start()
+        , p_hedge()
+        , m_cancelled_attempts()
+        , m_chunks()
     {
         prepare_mirror_attempt();
         if (has_failed())
@@ -841,16 +1346,19 @@ namespace mamba::download
     ) -> completion_map_entry
     {
         m_state = State::PREPARING;
+        update_mirror_choice();
 
         m_mirror_attempt.prepare_request(*p_initial_request);
         auto completion_func = m_mirror_attempt.prepare_attempt(
             m_handle,
             handle,
+            *p_budget,
             params,
             auth_info,
             verbose,
             [this](Success res)
             {
+                m_mirror_attempt.update_mirror_performance(res.transfer);
                 expected_t<void> finalize_res = invoke_on_success(res);
                 set_state(finalize_res.has_value());
                 throw_if_required(finalize_res);
@@ -882,69 +1390,210 @@ namespace mamba::download
     void DownloadTracker::set_transfer_started()
     {
         m_state = State::RUNNING;
+        m_transfer_start = std::chrono::steady_clock::now();
         m_mirror_attempt.set_transfer_started();
     }
 
-    const Result& DownloadTracker::get_result() const
+    const std::string& DownloadTracker::transfer_host() const
     {
-        return m_attempt_results.back();
+        return m_mirror_attempt.host();
     }
 
-    expected_t<void> DownloadTracker::invoke_on_success(const Success& res) const
+    auto DownloadTracker::next_start_time() const -> std::optional<time_point_t>
     {
-        if (!m_mirror_attempt.has_finished())
+        if (is_waiting())
         {
-            return m_mirror_attempt.invoke_on_success(res);
+            return can_try_other_mirror() ? time_point_t{} : m_mirror_attempt.next_start_time();
         }
-        else
+        if (m_state != State::RUNNING || m_chunking_failed)
         {
-            if (p_initial_request->on_success.has_value())
-            {
-                auto ret = safe_invoke(p_initial_request->on_success.value(), res);
-                return ret.has_value() ? ret.value() : forward_error(ret);
-            }
+            return std::nullopt;
         }
-        return expected_t<void>();
-    }
 
-    void DownloadTracker::invoke_on_failure(const Error& res) const
-    {
-        if (!m_mirror_attempt.has_finished())
-        {
-            m_mirror_attempt.invoke_on_failure(res);
-        }
-        else
+        std::optional<time_point_t> start_time;
+        for (const auto& chunk : m_chunks)
         {
-            if (p_initial_request->on_failure.has_value())
+            const auto chunk_start = chunk->attempt.next_start_time();
+            if (!chunk->done && chunk_start.has_value()
+                && (!start_time.has_value() || chunk_start.value() < start_time.value()))
             {
-                // We dont want to propagate errors coming from user's callbacks
-                [[maybe_unused]] auto result = safe_invoke(p_initial_request->on_failure.value(), res);
+                start_time = chunk_start;
             }
         }
+        return start_time;
     }
 
-    bool DownloadTracker::is_waiting() const
+    bool DownloadTracker::can_start_hedge() const
     {
-        return m_state == State::WAITING;
+        // Only the last request of a sequence is hedged, so that the hedge does not
+        // depend on the content downloaded by the previous ones.
+        const bool is_candidate = m_options.hedge_min_speed_Bps > 0 && p_hedge == nullptr
+                                  && m_state == State::RUNNING && m_mirror_attempt.has_finished()
+                                  && p_initial_request->filename.has_value()
+                                  && !p_initial_request->check_only
+                                  && p_initial_request->expected_size.value_or(0)
+                                         >= m_options.hedge_min_size;
+        if (!is_candidate
+            || std::chrono::steady_clock::now() - m_transfer_start < m_options.hedge_delay)
+        {
+            return false;
+        }
+        const auto speed_Bps = m_handle.get_info<std::size_t>(CURLINFO_SPEED_DOWNLOAD_T)
+                                   .value_or(0);
+        return speed_Bps < m_options.hedge_min_speed_Bps;
     }
 
-    bool DownloadTracker::can_try_other_mirror() const
-    {
-        bool is_file = util::starts_with(p_initial_request->url_path, "file://");
-        bool is_check = p_initial_request->check_only;
-        return !is_file && !is_check && m_tried_mirrors.size() < m_options.max_mirror_tries;
-    }
+    auto DownloadTracker::prepare_hedge_attempt(
+        CURLMultiHandle& handle,
+        const RemoteFetchParams& params,
+        const specs::AuthenticationDataBase& auth_info,
+        bool verbose
+    ) -> std::optional<completion_map_entry>
+    {
+        // The hedge writes to its own file, and reports neither progress nor writes since
+        // they would interleave with the ones of the hedged transfer. It is not retried, so a
+        // partial file would be left behind.
+        Request hedge_request = *p_initial_request;
+        hedge_request.filename = hedge_request.filename.value() + ".hedge";
+        hedge_request.resumable = false;
+        hedge_request.progress = std::nullopt;
+        hedge_request.on_write = std::nullopt;
+        hedge_request.on_success = std::nullopt;
+        hedge_request.on_failure = std::nullopt;
+
+        // A hedge is attempted at most once per download
+        p_hedge = std::make_unique<Hedge>(
+            Hedge{ TransferContext::instance().acquire_handle(), std::move(hedge_request), {} }
+        );
 
-    void DownloadTracker::set_state(bool success)
-    {
-        m_mirror_attempt.set_state(success);
-        if (success)
+        Mirror* mirror = select_best_mirror();
+        if (mirror == nullptr || !has_free_connection(mirror))
         {
-            m_state = m_mirror_attempt.has_finished() ? State::FINISHED : State::WAITING;
+            return std::nullopt;
         }
-        else
+        p_hedge->attempt = MirrorAttempt(
+            *mirror,
+            p_initial_request->url_path,
+            p_initial_request->sha256
+        );
+        if (!p_hedge->attempt.is_single_request())
         {
-            set_error_state();
+            return std::nullopt;
+        }
+        m_tried_mirrors.insert(mirror->id());
+        p_multi_handle = &handle;
+
+        LOG_INFO << "Hedging slow download of " << p_initial_request->name << " with "
+                 << hide_secrets(mirror->id().to_string());
+        p_hedge->attempt.prepare_request(p_hedge->request);
+        auto completion_func = p_hedge->attempt.prepare_attempt(
+            p_hedge->handle,
+            handle,
+            *p_budget,
+            params,
+            auth_info,
+            verbose,
+            [this](Success res)
+            {
+                p_hedge->attempt.update_mirror_performance(res.transfer);
+                p_hedge->attempt.set_state(true);
+                return finish_hedge(std::move(res));
+            },
+            [this](Error res)
+            {
+                LOG_DEBUG << "Hedged download of " << p_initial_request->name
+                          << " failed: " << res.message;
+                p_hedge->attempt.set_state(res);
+                // The hedged transfer is still running
+                return true;
+            }
+        );
+        p_hedge->attempt.set_transfer_started();
+        return completion_map_entry{ p_hedge->handle.get_id(), completion_func };
+    }
+
+    std::vector<CURLId> DownloadTracker::take_cancelled_attempts()
+    {
+        return std::exchange(m_cancelled_attempts, {});
+    }
+
+    const Result& DownloadTracker::get_result() const
+    {
+        return m_attempt_results.back();
+    }
+
+    void DownloadTracker::release_handle(CURLMultiHandle& handle)
+    {
+        // The handle is still attached to the multi handle if the download was interrupted
+        handle.remove_handle(m_handle);
+        TransferContext::instance().release_handle(std::move(m_handle));
+    }
+
+    expected_t<void> DownloadTracker::invoke_on_success(const Success& res) const
+    {
+        if (!m_mirror_attempt.has_finished())
+        {
+            return m_mirror_attempt.invoke_on_success(res);
+        }
+        else
+        {
+            return invoke_request_on_success(res);
+        }
+    }
+
+    expected_t<void> DownloadTracker::invoke_request_on_success(const Success& res) const
+    {
+        if (p_initial_request->on_success.has_value())
+        {
+            auto ret = safe_invoke(p_initial_request->on_success.value(), res);
+            return ret.has_value() ? ret.value() : forward_error(ret);
+        }
+        return expected_t<void>();
+    }
+
+    void DownloadTracker::invoke_on_failure(const Error& res) const
+    {
+        if (!m_mirror_attempt.has_finished())
+        {
+            m_mirror_attempt.invoke_on_failure(res);
+        }
+        else
+        {
+            if (p_initial_request->on_failure.has_value())
+            {
+                // We dont want to propagate errors coming from user's callbacks
+                [[maybe_unused]] auto result = safe_invoke(p_initial_request->on_failure.value(), res);
+            }
+        }
+    }
+
+    bool DownloadTracker::is_waiting() const
+    {
+        return m_state == State::WAITING;
+    }
+
+    bool DownloadTracker::can_try_other_mirror() const
+    {
+        bool is_file = util::starts_with(p_initial_request->url_path, "file://");
+        // Failures that are not recorded on the mirror would have it selected again
+        bool is_check = p_initial_request->check_only || p_initial_request->may_be_missing;
+        return !is_file && !is_check && m_tried_mirrors.size() < m_options.max_mirror_tries;
+    }
+
+    void DownloadTracker::set_state(bool success)
+    {
+        m_mirror_attempt.set_state(success);
+        if (success)
+        {
+            m_state = m_mirror_attempt.has_finished() ? State::FINISHED : State::WAITING;
+            if (m_state == State::FINISHED)
+            {
+                cancel_hedge();
+            }
+        }
+        else
+        {
+            set_error_state();
         }
     }
 
@@ -967,9 +1616,62 @@ namespace mamba::download
         else
         {
             m_state = State::FAILED;
+            cancel_hedge();
         }
     }
 
+    bool DownloadTracker::finish_hedge(Success&& res)
+    {
+        // The hedged transfer lost the race, it is cancelled before its file is replaced
+        if (m_mirror_attempt.cancel(*p_multi_handle))
+        {
+            m_cancelled_attempts.push_back(m_handle.get_id());
+        }
+
+        const auto& filename = p_initial_request->filename.value();
+        std::error_code ec;
+        fs::rename(p_hedge->request.filename.value(), filename, ec);
+        if (ec)
+        {
+            Error error;
+            error.message = fmt::format(
+                "Could not move hedged download to {}: {}",
+                filename,
+                ec.message()
+            );
+            invoke_on_failure(error);
+            m_state = State::FAILED;
+            throw_if_required(error);
+            save(std::move(error));
+            return is_waiting();
+        }
+
+        res.content = Filename{ filename };
+        return complete_download(std::move(res));
+    }
+
+    void DownloadTracker::cancel_hedge()
+    {
+        if (p_hedge != nullptr && p_multi_handle != nullptr
+            && p_hedge->attempt.cancel(*p_multi_handle))
+        {
+            m_cancelled_attempts.push_back(p_hedge->handle.get_id());
+        }
+    }
+
+    bool DownloadTracker::complete_download(Success&& res)
+    {
+        if (p_initial_request->progress.has_value())
+        {
+            p_initial_request->progress.value()(res);
+        }
+        expected_t<void> finalize_res = invoke_request_on_success(res);
+        m_state = finalize_res.has_value() ? State::FINISHED : State::FAILED;
+        throw_if_required(finalize_res);
+        save(std::move(res));
+        return is_waiting();
+    }
+
     void DownloadTracker::throw_if_required(const expected_t<void>& res)
     {
         if (m_state == State::FAILED && !p_initial_request->ignore_failure && m_options.fail_fast)
@@ -1026,18 +1728,79 @@ namespace mamba::download
             Mirror* mirror = (iter == mirrors.end()) ? nullptr : iter->get();
             return mirror;
         }
+
+        // Size assumed for transfers of unknown size when comparing mirrors
+        constexpr std::size_t default_expected_size = 1024 * 1024;
+
+        // Returns the mirror expected to complete the transfer the soonest.
+        // Mirrors without measurements come first so that each of them gets measured,
+        // the least loaded one first. Ties keep the order of the mirror set.
+        template <class F>
+        Mirror* find_best_mirror(const mirror_set_view& mirrors, std::size_t size, F&& f)
+        {
+            Mirror* best = nullptr;
+            auto best_score = std::pair(false, 0.);
+            for (const auto& mirror : mirrors)
+            {
+                if (!f(mirror))
+                {
+                    continue;
+                }
+                const auto seconds = mirror->expected_transfer_seconds(size);
+                const auto running = static_cast<double>(mirror->running_transfers());
+                const auto score = seconds.has_value() ? std::pair(true, seconds.value())
+                                                       : std::pair(false, running);
+                if (best == nullptr || score < best_score)
+                {
+                    best = mirror.get();
+                    best_score = score;
+                }
+            }
+            return best;
+        }
     }
 
-    Mirror* DownloadTracker::select_new_mirror() const
+    void DownloadTracker::update_mirror_choice()
     {
-        Mirror* new_mirror = find_mirror(
+        // The first mirror is chosen again when its transfer starts rather than when the
+        // tracker is created, to account for the transfers started in the meantime.
+        Mirror* current = m_mirror_attempt.mirror();
+        if (current == nullptr || m_mirror_attempt.has_started() || m_tried_mirrors.size() != 1)
+        {
+            return;
+        }
+
+        m_tried_mirrors.erase(current->id());
+        Mirror* best = select_best_mirror();
+        if (best == nullptr || best == current || !has_free_connection(best))
+        {
+            m_tried_mirrors.insert(current->id());
+            return;
+        }
+        m_tried_mirrors.insert(best->id());
+        m_mirror_attempt = MirrorAttempt(
+            *best,
+            p_initial_request->url_path,
+            p_initial_request->sha256
+        );
+    }
+
+    Mirror* DownloadTracker::select_best_mirror() const
+    {
+        return find_best_mirror(
             m_mirror_set,
+            p_initial_request->expected_size.value_or(default_expected_size),
             [this](const auto& mirror)
             {
                 return !has_tried_mirror(mirror.get()) && !is_bad_mirror(mirror.get())
                        && mirror->can_accept_more_connections();
             }
         );
+    }
+
+    Mirror* DownloadTracker::select_new_mirror() const
+    {
+        Mirror* new_mirror = select_best_mirror();
 
         std::size_t iteration = 0;
         while (new_mirror == nullptr && ++iteration < m_options.max_mirror_tries)
@@ -1065,6 +1828,277 @@ namespace mamba::download
                && mirror->failed_transfers() >= mirror->max_retries();
     }
 
+    bool DownloadTracker::has_free_connection(Mirror* mirror) const
+    {
+        return p_budget->free_connections(mirror->host(p_initial_request->url_path)) > 0;
+    }
+
+    auto DownloadTracker::prepare_chunk_attempts(
+        CURLMultiHandle& handle,
+        const RemoteFetchParams& params,
+        const specs::AuthenticationDataBase& auth_info,
+        bool verbose,
+        std::size_t max_attempts
+    ) -> std::vector<completion_map_entry>
+    {
+        std::vector<completion_map_entry> entries;
+        if (can_start_chunked_download(max_attempts))
+        {
+            start_chunked_download(std::min(m_options.max_chunks, max_attempts));
+            p_multi_handle = &handle;
+        }
+        if (m_chunks.empty() || m_chunking_failed)
+        {
+            return entries;
+        }
+
+        for (auto& chunk : m_chunks)
+        {
+            if (entries.size() >= max_attempts)
+            {
+                break;
+            }
+            if (!chunk->done && chunk->attempt.can_start_transfer())
+            {
+                auto entry = prepare_chunk_attempt(*chunk, handle, params, auth_info, verbose);
+                entries.push_back(std::move(entry));
+            }
+        }
+        return entries;
+    }
+
+    bool DownloadTracker::can_start_chunked_download(std::size_t max_attempts) const
+    {
+        const auto& request = *p_initial_request;
+        // A partial download left by a previous run is resumed instead
+        return m_options.chunk_min_size > 0 && std::min(m_options.max_chunks, max_attempts) > 1
+               && m_chunks.empty() && is_waiting() && !m_mirror_attempt.has_started()
+               && request.filename.has_value() && !request.check_only
+               && request.expected_size.value_or(0) >= m_options.chunk_min_size
+               && m_mirror_attempt.mirror() != nullptr
+               && is_chunkable_mirror(m_mirror_attempt.mirror())
+               && !fs::exists(partial_path(request.filename.value()));
+    }
+
+    bool DownloadTracker::is_chunkable_mirror(Mirror* mirror) const
+    {
+        // Byte ranges are only requested over HTTP, and only when the artifact
+        // is downloaded with a single request.
+        const auto generators = mirror->get_request_generators(
+            p_initial_request->url_path,
+            p_initial_request->sha256
+        );
+        return generators.size() == 1
+               && util::starts_with(generators.front()(*p_initial_request, nullptr).url, "http");
+    }
+
+    void DownloadTracker::start_chunked_download(std::size_t chunk_count)
+    {
+        const auto& filename = p_initial_request->filename.value();
+        const std::size_t size = p_initial_request->expected_size.value();
+
+        std::error_code ec;
+        {
+            // Creates the file if needed
+            auto out = open_ofstream(filename);
+        }
+        fs::resize_file(filename, size, ec);
+        if (ec)
+        {
+            LOG_WARNING << "Could not preallocate " << filename << ": " << ec.message();
+            m_chunking_failed = true;
+            return;
+        }
+
+        LOG_INFO << "Downloading " << p_initial_request->name << " in " << chunk_count << " chunks";
+        const std::size_t chunk_size = size / chunk_count;
+        for (std::size_t i = 0; i < chunk_count; ++i)
+        {
+            const std::size_t offset = i * chunk_size;
+            const ByteRange range = { offset, (i + 1 == chunk_count) ? size - offset : chunk_size };
+
+            // The chunks report their progress through the initial request, and their writes
+            // are not reported since they are not sequential
+            Request chunk_request = *p_initial_request;
+            chunk_request.on_success = std::nullopt;
+            chunk_request.on_failure = std::nullopt;
+            chunk_request.progress = std::nullopt;
+            chunk_request.on_write = std::nullopt;
+            auto chunk = std::make_unique<Chunk>(Chunk{
+                TransferContext::instance().acquire_handle(),
+                std::move(chunk_request),
+                {},
+                range,
+            });
+            if (p_initial_request->progress.has_value())
+            {
+                chunk->request.progress = [this, c = chunk.get()](const Event& event)
+                {
+                    if (const auto* progress = std::get_if<Progress>(&event))
+                    {
+                        c->progress = *progress;
+                        report_chunk_progress();
+                    }
+                };
+            }
+            m_chunks.push_back(std::move(chunk));
+        }
+        m_state = State::RUNNING;
+        m_transfer_start = std::chrono::steady_clock::now();
+    }
+
+    auto DownloadTracker::prepare_chunk_attempt(
+        Chunk& chunk,
+        CURLMultiHandle& handle,
+        const RemoteFetchParams& params,
+        const specs::AuthenticationDataBase& auth_info,
+        bool verbose
+    ) -> completion_map_entry
+    {
+        if (chunk.attempt.mirror() == nullptr)
+        {
+            // Each chunk is started on the mirror expected to complete it the soonest,
+            // which accounts for the chunks already started.
+            Mirror* mirror = find_best_mirror(
+                m_mirror_set,
+                chunk.range.size,
+                [this](const auto& candidate)
+                {
+                    return !is_bad_mirror(candidate.get())
+                           && candidate->can_accept_more_connections()
+                           && has_free_connection(candidate.get())
+                           && is_chunkable_mirror(candidate.get());
+                }
+            );
+            if (mirror == nullptr)
+            {
+                mirror = m_mirror_attempt.mirror();
+            }
+            chunk.attempt = MirrorAttempt(
+                *mirror,
+                p_initial_request->url_path,
+                p_initial_request->sha256
+            );
+        }
+
+        chunk.progress = {};
+        chunk.attempt.prepare_request(chunk.request);
+        auto completion_func = chunk.attempt.prepare_attempt(
+            chunk.handle,
+            handle,
+            *p_budget,
+            params,
+            auth_info,
+            verbose,
+            [this, c = &chunk](Success res) { return finish_chunk(*c, std::move(res)); },
+            [this, c = &chunk](Error res) { return fail_chunk(*c, std::move(res)); },
+            chunk.range
+        );
+        chunk.attempt.set_transfer_started();
+        return { chunk.handle.get_id(), completion_func };
+    }
+
+    bool DownloadTracker::finish_chunk(Chunk& chunk, Success&& res)
+    {
+        chunk.attempt.update_mirror_performance(res.transfer);
+        if (res.transfer.downloaded_size != chunk.range.size)
+        {
+            Error error;
+            error.message = fmt::format(
+                "Incomplete byte range for {}: received {} bytes over {}",
+                p_initial_request->name,
+                res.transfer.downloaded_size,
+                chunk.range.size
+            );
+            error.retry_wait_seconds = std::size_t(0);
+            return fail_chunk(chunk, std::move(error));
+        }
+
+        chunk.attempt.set_state(true);
+        chunk.done = true;
+        chunk.transfer = std::move(res.transfer);
+        const bool all_done = std::all_of(
+            m_chunks.begin(),
+            m_chunks.end(),
+            [](const auto& c) { return c->done; }
+        );
+        if (!all_done)
+        {
+            return true;
+        }
+
+        // The chunks are merged into a single transfer, whose content is validated
+        // by the request callback as for any other download.
+        const auto elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - m_transfer_start
+        );
+        Success success;
+        success.content = Filename{ p_initial_request->filename.value() };
+        success.transfer.http_status = http::OK;
+        success.transfer.effective_url = m_chunks.front()->transfer.effective_url;
+        success.transfer.name_lookup_time = m_chunks.front()->transfer.name_lookup_time;
+        success.transfer.connect_time = m_chunks.front()->transfer.connect_time;
+        success.transfer.tls_handshake_time = m_chunks.front()->transfer.tls_handshake_time;
+        success.transfer.time_to_first_byte = m_chunks.front()->transfer.time_to_first_byte;
+        success.transfer.total_time = std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+        for (const auto& c : m_chunks)
+        {
+            success.transfer.downloaded_size += c->transfer.downloaded_size;
+            success.transfer.time_to_first_byte = std::min(
+                success.transfer.time_to_first_byte,
+                c->transfer.time_to_first_byte
+            );
+        }
+        if (elapsed.count() > 0.)
+        {
+            success.transfer.average_speed_Bps = static_cast<std::size_t>(
+                static_cast<double>(success.transfer.downloaded_size) / elapsed.count()
+            );
+        }
+        return complete_download(std::move(success));
+    }
+
+    bool DownloadTracker::fail_chunk(Chunk& chunk, Error&& res)
+    {
+        LOG_DEBUG << "Chunk of " << p_initial_request->name << " failed: " << res.message;
+        chunk.attempt.set_state(res);
+        if (chunk.attempt.has_failed() && !m_chunking_failed)
+        {
+            stop_chunked_download();
+        }
+        return true;
+    }
+
+    void DownloadTracker::stop_chunked_download()
+    {
+        LOG_WARNING << "Chunked download of " << p_initial_request->name
+                    << " failed, downloading it in a single transfer";
+        m_chunking_failed = true;
+        for (auto& chunk : m_chunks)
+        {
+            if (chunk->attempt.cancel(*p_multi_handle))
+            {
+                m_cancelled_attempts.push_back(chunk->handle.get_id());
+            }
+        }
+
+        std::error_code ec;
+        fs::remove(p_initial_request->filename.value(), ec);
+        m_state = State::WAITING;
+    }
+
+    void DownloadTracker::report_chunk_progress() const
+    {
+        Progress progress{ 0, p_initial_request->expected_size.value_or(0), 0 };
+        for (const auto& chunk : m_chunks)
+        {
+            progress.downloaded_size += chunk->done ? chunk->range.size
+                                                    : chunk->progress.downloaded_size;
+            progress.speed_Bps += chunk->done ? 0 : chunk->progress.speed_Bps;
+        }
+        p_initial_request->progress.value()(progress);
+    }
+
     /*****************************
      * DOWNLOADER IMPLEMENTATION *
      *****************************/
@@ -1083,6 +2117,7 @@ namespace mamba::download
         , p_mirrors(&mirrors)
         , p_params(&params)
         , p_auth_info(&auth_info)
+        , m_budget(m_options.max_speed_Bps, m_options.max_host_connections)
     {
         if (m_options.sort)
         {
@@ -1096,14 +2131,27 @@ namespace mamba::download
 
         m_trackers.reserve(m_requests.size());
         std::size_t max_retries = static_cast<std::size_t>(params.max_retries);
-        DownloadTrackerOptions tracker_options{ max_retries, options.fail_fast };
+        DownloadTrackerOptions tracker_options{
+            max_retries,
+            options.fail_fast,
+            options.hedge_min_size,
+            options.hedge_min_speed_Bps,
+            options.hedge_delay,
+            options.chunk_min_size,
+            options.max_chunks,
+        };
         std::transform(
             m_requests.begin(),
             m_requests.end(),
             std::back_inserter(m_trackers),
             [tracker_options, this](const Request& req)
             {
-                return DownloadTracker(req, p_mirrors->get_mirrors(req.mirror_name), tracker_options);
+                return DownloadTracker(
+                    req,
+                    p_mirrors->get_mirrors(req.mirror_name),
+                    tracker_options,
+                    m_budget
+                );
             }
         );
         m_waiting_count = m_trackers.size();
@@ -1113,10 +2161,27 @@ namespace mamba::download
             [](const auto& tracker) { return tracker.has_failed(); }
         );
         m_waiting_count -= static_cast<size_t>(failed_count);
+
+        for (std::size_t i = 0; i < m_trackers.size(); ++i)
+        {
+            if (!m_trackers[i].has_failed())
+            {
+                m_ready_queue.push_back(i);
+            }
+        }
+    }
+
+    Downloader::~Downloader()
+    {
+        for (auto& tracker : m_trackers)
+        {
+            tracker.release_handle(m_curl_handle);
+        }
     }
 
     MultiResult Downloader::download()
     {
+        const TransferStats initial_stats = TransferContext::instance().stats();
         while (!download_done())
         {
             if (is_sig_interrupted())
@@ -1125,44 +2190,152 @@ namespace mamba::download
                 break;
             }
             prepare_next_downloads();
+            prepare_hedged_downloads();
             update_downloads();
         }
+        log_transfer_stats(initial_stats);
         return build_result();
     }
 
     void Downloader::prepare_next_downloads()
     {
-        size_t running_attempts = m_completion_map.size();
-        const size_t max_parallel_downloads = m_options.download_threads;
-        auto start_filter = mamba::util::filter(
-            m_trackers,
-            [&](DownloadTracker& tracker)
-            { return running_attempts < max_parallel_downloads && tracker.can_start_transfer(); }
-        );
+        const auto now = std::chrono::steady_clock::now();
+        while (!m_retry_timers.empty() && m_retry_timers.top().first <= now)
+        {
+            m_ready_queue.push_back(m_retry_timers.top().second);
+            m_retry_timers.pop();
+        }
+
+        while (!m_ready_queue.empty() && m_completion_map.size() < m_options.download_threads)
+        {
+            const std::size_t tracker_index = m_ready_queue.front();
+            m_ready_queue.pop_front();
+            const auto& host = m_trackers[tracker_index].transfer_host();
+            if (m_budget.free_connections(host) == 0)
+            {
+                // The other trackers can still use the connections to other hosts
+                m_host_queues[host].push_back(tracker_index);
+                continue;
+            }
+            schedule(tracker_index, start_downloads(tracker_index));
+        }
+    }
+
+    void Downloader::release_host_queues()
+    {
+        for (auto& [host, queue] : m_host_queues)
+        {
+            // The trackers are moved to the front of the ready queue, in their order
+            const std::size_t count = std::min(m_budget.free_connections(host), queue.size());
+            const auto last = queue.begin() + static_cast<std::ptrdiff_t>(count);
+            m_ready_queue.insert(m_ready_queue.begin(), queue.begin(), last);
+            queue.erase(queue.begin(), last);
+        }
+    }
+
+    bool Downloader::start_downloads(std::size_t tracker_index)
+    {
+        auto& tracker = m_trackers[tracker_index];
+        bool has_started = false;
 
-        // Here we loop over all requests contained in filtered m_trackers
-        for (auto& tracker : start_filter)
+        if (m_options.chunk_min_size > 0)
         {
+            const std::size_t max_attempts = std::min(
+                m_options.download_threads - m_completion_map.size(),
+                m_budget.free_connections(tracker.transfer_host())
+            );
+            for (auto& [id, completion] : tracker.prepare_chunk_attempts(
+                     m_curl_handle,
+                     *p_params,
+                     *p_auth_info,
+                     m_options.verbose,
+                     max_attempts
+                 ))
+            {
+                m_completion_map.insert({ id, { tracker_index, std::move(completion) } });
+                has_started = true;
+            }
+        }
+
+        if (tracker.can_start_transfer())
+        {
+            auto [id, completion] = tracker.prepare_new_attempt(
+                m_curl_handle,
+                *p_params,
+                *p_auth_info,
+                m_options.verbose
+            );
             auto [iter, success] = m_completion_map.insert(
-                tracker.prepare_new_attempt(m_curl_handle, *p_params, *p_auth_info, m_options.verbose)
+                { id, { tracker_index, std::move(completion) } }
             );
             if (success)
             {
                 tracker.set_transfer_started();
-                ++running_attempts;
+                has_started = true;
             }
         }
+        return has_started;
     }
 
-    void Downloader::update_downloads()
+    void Downloader::schedule(std::size_t tracker_index, bool has_started)
     {
-        std::size_t still_running = m_curl_handle.perform();
+        const auto start_time = m_trackers[tracker_index].next_start_time();
+        if (!start_time.has_value())
+        {
+            return;
+        }
+        if (start_time.value() > std::chrono::steady_clock::now())
+        {
+            m_retry_timers.emplace(start_time.value(), tracker_index);
+        }
+        else if (has_started)
+        {
+            // The tracker has more transfers to start, before the trackers not started yet
+            m_ready_queue.push_front(tracker_index);
+        }
+    }
 
-        if (still_running == m_waiting_count)
+    void Downloader::prepare_hedged_downloads()
+    {
+        if (m_options.hedge_min_speed_Bps == 0
+            || m_completion_map.size() >= m_options.download_threads)
         {
-            m_curl_handle.wait(m_curl_handle.get_timeout());
+            return;
         }
 
+        // Only the trackers with a running transfer can be hedged
+        std::vector<std::size_t> running_trackers;
+        running_trackers.reserve(m_completion_map.size());
+        for (const auto& [id, transfer] : m_completion_map)
+        {
+            running_trackers.push_back(transfer.tracker_index);
+        }
+
+        for (const std::size_t tracker_index : running_trackers)
+        {
+            auto& tracker = m_trackers[tracker_index];
+            // Hedges only use the connections left idle by the other downloads
+            if (m_completion_map.size() < m_options.download_threads && tracker.can_start_hedge())
+            {
+                if (auto entry = tracker.prepare_hedge_attempt(
+                        m_curl_handle,
+                        *p_params,
+                        *p_auth_info,
+                        m_options.verbose
+                    ))
+                {
+                    auto [id, completion] = std::move(entry).value();
+                    m_completion_map.insert({ id, { tracker_index, std::move(completion) } });
+                }
+            }
+        }
+    }
+
+    void Downloader::update_downloads()
+    {
+        m_budget.resume_transfers();
+        std::size_t still_running = m_curl_handle.perform();
+
         while (auto resp = m_curl_handle.pop_message())
         {
             const auto& msg = resp.value();
@@ -1182,14 +2355,73 @@ namespace mamba::download
             }
             else
             {
-                bool still_waiting = completion_callback->second(m_curl_handle, msg.m_transfer_result);
+                const std::size_t tracker_index = completion_callback->second.tracker_index;
+                bool still_waiting = completion_callback->second.completion(
+                    m_curl_handle,
+                    msg.m_transfer_result
+                );
                 m_completion_map.erase(completion_callback);
-                if (!still_waiting)
+                for (const CURLId& id : m_trackers[tracker_index].take_cancelled_attempts())
+                {
+                    m_completion_map.erase(id);
+                }
+                if (still_waiting)
+                {
+                    m_ready_queue.push_front(tracker_index);
+                }
+                else
                 {
                     --m_waiting_count;
                 }
             }
         }
+
+        // The connections of the completed transfers can be used by the waiting trackers
+        release_host_queues();
+
+        // Sleep until a transfer makes progress or a retry is due, unless
+        // new transfers can be started right away.
+        const bool can_start = !m_ready_queue.empty()
+                               && m_completion_map.size() < m_options.download_threads;
+        if (!can_start && !download_done())
+        {
+            m_curl_handle.poll(wait_timeout());
+        }
+    }
+
+    std::size_t Downloader::wait_timeout() const
+    {
+        std::size_t timeout = m_curl_handle.get_timeout();
+        std::optional<time_point_t> wake_time = m_budget.next_resume_time();
+        if (!m_retry_timers.empty()
+            && (!wake_time.has_value() || m_retry_timers.top().first < wake_time.value()))
+        {
+            wake_time = m_retry_timers.top().first;
+        }
+        if (wake_time.has_value())
+        {
+            const auto until_wake = std::chrono::ceil<std::chrono::milliseconds>(
+                wake_time.value() - std::chrono::steady_clock::now()
+            );
+            if (until_wake.count() <= 0)
+            {
+                return 0;
+            }
+            timeout = std::min(timeout, static_cast<std::size_t>(until_wake.count()));
+        }
+        return timeout;
+    }
+
+    void Downloader::log_transfer_stats(const TransferStats& initial_stats) const
+    {
+        const TransferStats stats = TransferContext::instance().stats();
+        LOG_INFO << fmt::format(
+            "Performed {} transfers for {} requests: {} new connections, {} TLS handshakes",
+            stats.transfer_count - initial_stats.transfer_count,
+            m_trackers.size(),
+            stats.connection_count - initial_stats.connection_count,
+            stats.tls_handshake_count - initial_stats.tls_handshake_count
+        );
     }
 
     bool Downloader::download_done() const
@@ -1238,6 +2470,51 @@ namespace mamba::download
         on_done_impl();
     }
 
+    namespace
+    {
+        MultiResult download_impl(
+            MultiRequest requests,
+            const mirror_map& mirrors,
+            Options options,
+            const RemoteFetchParams& params,
+            const specs::AuthenticationDataBase& auth_info
+        )
+        {
+            if (options.coordinator_socket.empty())
+            {
+                Downloader dl(std::move(requests), mirrors, std::move(options), params, auth_info);
+                return dl.download();
+            }
+
+            // The requests the coordinator did not serve are downloaded in process
+            auto coordinated = download_through_coordinator(requests, mirrors, options);
+            MultiRequest remaining_requests;
+            for (std::size_t i = 0; i < requests.size(); ++i)
+            {
+                if (!coordinated[i].has_value())
+                {
+                    remaining_requests.push_back(std::move(requests[i]));
+                }
+            }
+            MultiResult remaining_results;
+            if (!remaining_requests.empty())
+            {
+                Downloader
+                    dl(std::move(remaining_requests), mirrors, std::move(options), params, auth_info);
+                remaining_results = dl.download();
+            }
+
+            MultiResult res;
+            res.reserve(coordinated.size());
+            auto remaining_it = remaining_results.begin();
+            for (auto& result : coordinated)
+            {
+                res.push_back(result.has_value() ? std::move(result).value() : std::move(*remaining_it++));
+            }
+            return res;
+        }
+    }
+
     MultiResult download(
         MultiRequest requests,
         const mirror_map& mirrors,
@@ -1260,13 +2537,11 @@ namespace mamba::download
         {
             monitor->observe(requests, options);
             on_scope_exit guard([monitor]() { monitor->on_done(); });
-            Downloader dl(std::move(requests), mirrors, std::move(options), params, auth_info);
-            return dl.download();
+            return download_impl(std::move(requests), mirrors, std::move(options), params, auth_info);
         }
         else
         {
-            Downloader dl(std::move(requests), mirrors, std::move(options), params, auth_info);
-            return dl.download();
+            return download_impl(std::move(requests), mirrors, std::move(options), params, auth_info);
         }
     }
 
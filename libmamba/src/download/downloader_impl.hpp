@@ -8,9 +8,17 @@
 #define MAMBA_DL_DOWNLOADER_IMPL_HPP
 
 #include <chrono>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
 #include <optional>
+#include <queue>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "mamba/download/downloader.hpp"
 #include "mamba/download/mirror_map.hpp"
@@ -23,6 +31,66 @@
 
 namespace mamba::download
 {
+    // The state of an interrupted download, recorded to resume it later.
+    struct PartialDownload
+    {
+        std::string etag;
+        std::string last_modified;
+        std::size_t size = 0;
+    };
+
+    // A byte range of the target file, downloaded by one chunk of a chunked download.
+    struct ByteRange
+    {
+        std::size_t offset = 0;
+        std::size_t size = 0;
+    };
+
+    /*
+     * TransferBudget
+     *
+     * Limits shared by the transfers of a download: the bandwidth and the number of
+     * concurrent transfers per host. An empty host, as for local files, is not limited.
+     */
+    class TransferBudget
+    {
+    public:
+
+        using time_point_t = std::chrono::steady_clock::time_point;
+
+        TransferBudget(std::size_t max_speed_Bps, std::size_t max_host_connections);
+
+        std::size_t free_connections(const std::string& host) const;
+        void add_connection(const std::string& host);
+        void remove_connection(const std::string& host);
+
+        /**
+         * The bandwidth is spent from a token bucket. When it is empty, a transfer receiving
+         * data is paused and queued, and the paused transfers are resumed in turn as the
+         * bucket refills, so that a small transfer is not starved by large ones.
+         * Returns false if the transfer must pause.
+         */
+        bool consume_bandwidth(CURLHandle& handle, std::size_t size);
+        void forget_transfer(const CURLHandle& handle);
+        void resume_transfers();
+
+        /**
+         * Returns when a paused transfer can be resumed, or std::nullopt if none is paused.
+         */
+        std::optional<time_point_t> next_resume_time() const;
+
+    private:
+
+        void refill_bandwidth();
+
+        std::size_t m_max_speed_Bps;
+        std::size_t m_max_host_connections;
+        std::map<std::string, std::size_t> m_host_connections;
+        double m_tokens;
+        time_point_t m_last_refill;
+        std::deque<CURLHandle*> m_paused_transfers;
+    };
+
     /*
      * DownloadAttempt
      */
@@ -40,14 +108,17 @@ namespace mamba::download
             CURLHandle& handle,
             const MirrorRequest& request,
             CURLMultiHandle& downloader,
+            TransferBudget& budget,
             const RemoteFetchParams& params,
             const specs::AuthenticationDataBase& auth_info,
             bool verbose,
             on_success_callback success,
-            on_failure_callback error
+            on_failure_callback error,
+            std::optional<ByteRange> range = std::nullopt
         );
 
         auto create_completion_function() -> completion_function;
+        void cancel(CURLMultiHandle& downloader);
 
     private:
 
@@ -60,17 +131,23 @@ namespace mamba::download
                 CURLHandle& handle,
                 const MirrorRequest& request,
                 CURLMultiHandle& downloader,
+                TransferBudget& budget,
                 const RemoteFetchParams& params,
                 const specs::AuthenticationDataBase& auth_info,
                 bool verbose,
                 on_success_callback success,
-                on_failure_callback error
+                on_failure_callback error,
+                std::optional<ByteRange> range
             );
 
             bool finish_download(CURLMultiHandle& downloader, CURLcode code);
             void clean_attempt(CURLMultiHandle& downloader, bool erase_downloaded);
             void invoke_progress_callback(const Event&) const;
 
+            void restore_partial_download();
+            bool can_keep_partial_download(bool written) const;
+            void save_partial_download(bool written);
+
             void configure_handle(
                 const RemoteFetchParams& params,
                 const specs::AuthenticationDataBase& auth_info,
@@ -103,15 +180,24 @@ namespace mamba::download
 
             CURLHandle* p_handle = nullptr;
             const MirrorRequest* p_request = nullptr;
+            TransferBudget* p_budget = nullptr;
             on_success_callback m_success_callback;
             on_failure_callback m_failure_callback;
             std::size_t m_retry_wait_seconds = std::size_t(0);
+            bool m_is_local_file = false;
             std::unique_ptr<CompressionStream> p_stream = nullptr;
             std::ofstream m_file;
             mutable std::string m_response = "";
             std::string m_cache_control;
             std::string m_etag;
             std::string m_last_modified;
+            bool m_can_resume = false;
+            bool m_resumed = false;
+            std::optional<PartialDownload> m_resume_state;
+            std::optional<std::size_t> m_content_range_start;
+            std::optional<ByteRange> m_range;
+            std::size_t m_range_written = 0;
+            std::size_t m_file_written = 0;
         };
 
         std::unique_ptr<Impl> p_impl = nullptr;
@@ -131,6 +217,7 @@ namespace mamba::download
         using completion_function = DownloadAttempt::completion_function;
         using on_success_callback = DownloadAttempt::on_success_callback;
         using on_failure_callback = DownloadAttempt::on_failure_callback;
+        using time_point_t = std::chrono::steady_clock::time_point;
 
         MirrorAttempt() = default;
         MirrorAttempt(Mirror& mirror, const std::string& url_path, const std::string& spec_sha256);
@@ -142,21 +229,34 @@ namespace mamba::download
         auto prepare_attempt(
             CURLHandle& handle,
             CURLMultiHandle& downloader,
+            TransferBudget& budget,
             const RemoteFetchParams& params,
             const specs::AuthenticationDataBase& auth_info,
             bool verbose,
             on_success_callback success,
-            on_failure_callback error
+            on_failure_callback error,
+            std::optional<ByteRange> range = std::nullopt
         ) -> completion_function;
 
         bool can_start_transfer() const;
+        // Returns when a transfer can be started, or std::nullopt if none can be.
+        std::optional<time_point_t> next_start_time() const;
+        bool has_started() const;
         bool has_failed() const;
         bool has_finished() const;
+        bool is_single_request() const;
+        Mirror* mirror() const;
+        const std::string& host() const;
 
         void set_transfer_started();
         void set_state(bool success);
         void set_state(const Error& res);
         void update_last_content(const Content* content);
+        void update_mirror_performance(const TransferData& data);
+
+        // Interrupts the running transfer, if any, without counting it as a failure.
+        // Returns true if a transfer was interrupted.
+        bool cancel(CURLMultiHandle& downloader);
 
     private:
 
@@ -173,9 +273,12 @@ namespace mamba::download
 
         bool can_retry() const;
         void update_transfers_done(bool success);
+        void release_connection();
 
         Mirror* p_mirror = nullptr;
         State m_state = State::WAITING_SEQUENCE_START;
+        std::string m_host;
+        TransferBudget* p_budget = nullptr;
 
         using request_generator_list = Mirror::request_generator_list;
         request_generator_list m_request_generators;
@@ -185,7 +288,6 @@ namespace mamba::download
         DownloadAttempt m_attempt;
         const Content* p_last_content = nullptr;
 
-        using time_point_t = std::chrono::steady_clock::time_point;
         std::optional<time_point_t> m_next_retry;
         size_t m_retries = 0;
     };
@@ -194,6 +296,11 @@ namespace mamba::download
     {
         std::size_t max_mirror_tries = 0;
         bool fail_fast = false;
+        std::size_t hedge_min_size = 0;
+        std::size_t hedge_min_speed_Bps = 0;
+        std::chrono::milliseconds hedge_delay = {};
+        std::size_t chunk_min_size = 0;
+        std::size_t max_chunks = 0;
     };
 
     class DownloadTracker
@@ -202,11 +309,13 @@ namespace mamba::download
 
         using completion_function = DownloadAttempt::completion_function;
         using completion_map_entry = std::pair<CURLId, completion_function>;
+        using time_point_t = std::chrono::steady_clock::time_point;
 
         DownloadTracker(
             const Request& request,
             const mirror_set_view& mirror_set,
-            DownloadTrackerOptions options
+            DownloadTrackerOptions options,
+            TransferBudget& budget
         );
 
         auto prepare_new_attempt(
@@ -220,8 +329,56 @@ namespace mamba::download
         bool can_start_transfer() const;
         void set_transfer_started();
 
+        /**
+         * Returns the host of the mirror the next transfer is started on.
+         */
+        const std::string& transfer_host() const;
+
+        /**
+         * Returns when a new transfer can be started, possibly in the past,
+         * or std::nullopt if none can be started until a running transfer completes.
+         */
+        std::optional<time_point_t> next_start_time() const;
+
+        /**
+         * A hedged attempt duplicates a slow transfer on another mirror, the
+         * first attempt to complete cancels the other one.
+         */
+        bool can_start_hedge() const;
+        auto prepare_hedge_attempt(
+            CURLMultiHandle& handle,
+            const RemoteFetchParams& params,
+            const specs::AuthenticationDataBase& auth_info,
+            bool verbose
+        ) -> std::optional<completion_map_entry>;
+
+        /**
+         * A chunked download splits a large file into byte ranges downloaded
+         * concurrently, possibly from several mirrors, into a preallocated file.
+         * Starts the chunked download if possible, or the chunks waiting for a
+         * retry, within the limit of @p max_attempts new transfers.
+         */
+        auto prepare_chunk_attempts(
+            CURLMultiHandle& handle,
+            const RemoteFetchParams& params,
+            const specs::AuthenticationDataBase& auth_info,
+            bool verbose,
+            std::size_t max_attempts
+        ) -> std::vector<completion_map_entry>;
+
+        /**
+         * Returns the ids of the transfers cancelled since the last call,
+         * whose completion functions must not be invoked anymore.
+         */
+        std::vector<CURLId> take_cancelled_attempts();
+
         const Result& get_result() const;
 
+        /**
+         * Gives the handle back to the transfer context for later downloads.
+         */
+        void release_handle(CURLMultiHandle& handle);
+
     private:
 
         enum class State
@@ -234,6 +391,7 @@ namespace mamba::download
         };
 
         expected_t<void> invoke_on_success(const Success&) const;
+        expected_t<void> invoke_request_on_success(const Success&) const;
         void invoke_on_failure(const Error&) const;
 
         bool is_waiting() const;
@@ -258,21 +416,85 @@ namespace mamba::download
         void save(Error&&);
 
         void prepare_mirror_attempt();
+        void update_mirror_choice();
         Mirror* select_new_mirror() const;
+        Mirror* select_best_mirror() const;
         bool has_tried_mirror(Mirror* mirror) const;
         bool is_bad_mirror(Mirror* mirror) const;
+        bool has_free_connection(Mirror* mirror) const;
+
+        bool finish_hedge(Success&&);
+        void cancel_hedge();
+        bool complete_download(Success&&);
+
+        // The chunks are allocated on demand and must be stable in memory since their
+        // callbacks capture them.
+        struct Chunk
+        {
+            CURLHandle handle;
+            Request request;
+            MirrorAttempt attempt;
+            ByteRange range;
+            Progress progress = {};
+            TransferData transfer = {};
+            bool done = false;
+        };
+
+        bool can_start_chunked_download(std::size_t max_attempts) const;
+        bool is_chunkable_mirror(Mirror* mirror) const;
+        void start_chunked_download(std::size_t chunk_count);
+        auto prepare_chunk_attempt(
+            Chunk& chunk,
+            CURLMultiHandle& handle,
+            const RemoteFetchParams& params,
+            const specs::AuthenticationDataBase& auth_info,
+            bool verbose
+        ) -> completion_map_entry;
+        bool finish_chunk(Chunk& chunk, Success&& res);
+        bool fail_chunk(Chunk& chunk, Error&& res);
+        void stop_chunked_download();
+        void report_chunk_progress() const;
+
+        // The hedge is allocated on demand since most downloads never need one,
+        // and must be stable in memory since its callbacks capture it.
+        struct Hedge
+        {
+            CURLHandle handle;
+            Request request;
+            MirrorAttempt attempt;
+        };
 
         CURLHandle m_handle;
         const Request* p_initial_request;
         mirror_set_view m_mirror_set;
         DownloadTrackerOptions m_options;
+        TransferBudget* p_budget;
 
         State m_state;
         std::vector<Result> m_attempt_results;
         util::flat_set<MirrorID> m_tried_mirrors;
         MirrorAttempt m_mirror_attempt;
+
+        time_point_t m_transfer_start;
+        std::unique_ptr<Hedge> p_hedge;
+        CURLMultiHandle* p_multi_handle = nullptr;
+        std::vector<CURLId> m_cancelled_attempts;
+        std::vector<std::unique_ptr<Chunk>> m_chunks;
+        bool m_chunking_failed = false;
     };
 
+    /*
+     * Downloads through the FetchCoordinator listening on Options::coordinator_socket the
+     * requests it can serve, and invokes their callbacks. The results of the other requests,
+     * and of the ones the coordinator could not serve, are left empty to be downloaded in
+     * process, as all the requests when the coordinator is not reachable.
+     */
+    std::vector<std::optional<Result>> download_through_coordinator(
+        MultiRequest& requests,
+        const mirror_map& mirrors,
+        const Options& options
+    );
+
     class Downloader
     {
     public:
@@ -284,13 +506,23 @@ namespace mamba::download
             const RemoteFetchParams& params,
             const specs::AuthenticationDataBase& auth_info
         );
+        ~Downloader();
+
+        Downloader(const Downloader&) = delete;
+        Downloader& operator=(const Downloader&) = delete;
 
         MultiResult download();
 
     private:
 
         void prepare_next_downloads();
+        void release_host_queues();
+        bool start_downloads(std::size_t tracker_index);
+        void schedule(std::size_t tracker_index, bool has_started);
+        void prepare_hedged_downloads();
         void update_downloads();
+        std::size_t wait_timeout() const;
+        void log_transfer_stats(const TransferStats& initial_stats) const;
         bool download_done() const;
         MultiResult build_result() const;
         void invoke_unexpected_termination() const;
@@ -303,9 +535,24 @@ namespace mamba::download
         const RemoteFetchParams* p_params;
         const specs::AuthenticationDataBase* p_auth_info;
         std::size_t m_waiting_count;
+        TransferBudget m_budget;
 
         using completion_function = DownloadTracker::completion_function;
-        std::unordered_map<CURLId, completion_function> m_completion_map;
+        struct RunningTransfer
+        {
+            std::size_t tracker_index;
+            completion_function completion;
+        };
+        std::unordered_map<CURLId, RunningTransfer> m_completion_map;
+
+        // Trackers are only polled when they may start a transfer: the ready queue holds
+        // the ones that can start right away, the timer queue the ones waiting to retry.
+        using time_point_t = DownloadTracker::time_point_t;
+        using timer_entry = std::pair<time_point_t, std::size_t>;
+        std::deque<std::size_t> m_ready_queue;
+        std::priority_queue<timer_entry, std::vector<timer_entry>, std::greater<>> m_retry_timers;
+        // Trackers waiting for a connection to their host, in their order in the ready queue
+        std::map<std::string, std::deque<std::size_t>> m_host_queues;
     };
 }
 
@@ -0,0 +1,189 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/output.hpp"
+#include "mamba/core/tracing.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/download/metrics.hpp"
+
+namespace mamba::download
+{
+    namespace
+    {
+        using microseconds = std::chrono::microseconds;
+
+        nlohmann::json timings_to_json(const TransferData& transfer)
+        {
+            return {
+                { "name_lookup", transfer.name_lookup_time.count() },
+                { "connect", transfer.connect_time.count() },
+                { "tls_handshake", transfer.tls_handshake_time.count() },
+                { "first_byte", transfer.time_to_first_byte.count() },
+                { "total", transfer.total_time.count() },
+            };
+        }
+
+        // An attempt and its phases, as measured by curl from the start of the transfer
+        void trace_attempt(
+            std::string_view track,
+            TransferMetrics::clock::time_point end,
+            const std::optional<TransferData>& transfer,
+            std::string_view error
+        )
+        {
+            if (!transfer.has_value())
+            {
+                tracing::record_track_span(track, "error", end, end, error);
+                return;
+            }
+            const auto start = end - transfer->total_time;
+            const auto detail = error.empty() ? hide_secrets(transfer->effective_url)
+                                              : std::string(error);
+            tracing::record_track_span(track, "download", start, end, detail);
+
+            const microseconds connected = std::max(
+                transfer->connect_time,
+                transfer->tls_handshake_time
+            );
+            const std::pair<std::string_view, std::pair<microseconds, microseconds>> phases[] = {
+                { "name lookup", { microseconds(0), transfer->name_lookup_time } },
+                { "connect", { transfer->name_lookup_time, transfer->connect_time } },
+                { "tls handshake", { transfer->connect_time, transfer->tls_handshake_time } },
+                { "waiting", { connected, transfer->time_to_first_byte } },
+                { "receiving", { transfer->time_to_first_byte, transfer->total_time } },
+            };
+            for (const auto& [name, span] : phases)
+            {
+                if (span.first < span.second)
+                {
+                    tracing::record_track_span(
+                        track,
+                        name,
+                        start + span.first,
+                        start + span.second
+                    );
+                }
+            }
+        }
+    }
+
+    TransferMetrics::TransferMetrics()
+        : m_start(clock::now())
+    {
+    }
+
+    void TransferMetrics::observe(MultiRequest& requests)
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto& request : requests)
+        {
+            const std::size_t index = m_records.size();
+            m_records.push_back(Record{ request.name, {} });
+            request.progress = [this, index, previous = std::move(request.progress)](const Event& event)
+            {
+                if (previous.has_value())
+                {
+                    previous.value()(event);
+                }
+                record(index, event);
+            };
+        }
+    }
+
+    void TransferMetrics::record(std::size_t index, const Event& event)
+    {
+        if (std::holds_alternative<Progress>(event))
+        {
+            return;
+        }
+
+        std::lock_guard lock(m_mutex);
+        Record& rec = m_records[index];
+        if (const auto* success = std::get_if<Success>(&event))
+        {
+            // A request completes with a single success, the earlier ones are the
+            // intermediate steps of the mirror (e.g. an authentication token).
+            if (rec.success)
+            {
+                rec.attempts.pop_back();
+            }
+            rec.attempts.push_back(Attempt{ clock::now(), success->transfer, "" });
+            rec.success = true;
+        }
+        else if (const auto* error = std::get_if<Error>(&event))
+        {
+            rec.attempts.push_back(Attempt{ clock::now(), error->transfer, error->message });
+            rec.success = false;
+        }
+
+        if (tracing::is_tracing_enabled())
+        {
+            const Attempt& attempt = rec.attempts.back();
+            trace_attempt(rec.name, attempt.end, attempt.transfer, attempt.error);
+        }
+    }
+
+    nlohmann::json TransferMetrics::to_json() const
+    {
+        std::lock_guard lock(m_mutex);
+        auto transfers = nlohmann::json::array();
+        std::size_t failed = 0;
+        std::size_t retries = 0;
+        std::size_t downloaded_size = 0;
+        std::size_t saved_size = 0;
+        for (const auto& rec : m_records)
+        {
+            if (rec.attempts.empty())
+            {
+                continue;
+            }
+            const Attempt& last = rec.attempts.back();
+            auto j = nlohmann::json{
+                { "name", rec.name },
+                { "success", rec.success },
+                { "attempts", rec.attempts.size() },
+            };
+            if (last.transfer.has_value())
+            {
+                const TransferData& transfer = last.transfer.value();
+                j["url"] = hide_secrets(transfer.effective_url);
+                j["http_status"] = transfer.http_status;
+                j["downloaded_size"] = transfer.downloaded_size;
+                j["saved_size"] = transfer.saved_size;
+                j["average_speed_Bps"] = transfer.average_speed_Bps;
+                j["timings_us"] = timings_to_json(transfer);
+                downloaded_size += transfer.downloaded_size;
+                saved_size += transfer.saved_size;
+            }
+            if (!rec.success)
+            {
+                j["error"] = last.error;
+                ++failed;
+            }
+            retries += rec.attempts.size() - 1;
+            transfers.push_back(std::move(j));
+        }
+
+        const auto elapsed = std::chrono::duration_cast<microseconds>(clock::now() - m_start);
+        const std::size_t count = transfers.size();
+        return {
+            { "transfers", std::move(transfers) },
+            { "total",
+              {
+                  { "transfers", count },
+                  { "failed", failed },
+                  { "retries", retries },
+                  { "downloaded_size", downloaded_size },
+                  { "saved_size", saved_size },
+                  { "elapsed_us", elapsed.count() },
+              } },
+        };
+    }
+}
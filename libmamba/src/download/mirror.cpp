@@ -85,6 +85,11 @@ namespace mamba::download
         return get_request_generators_impl(url_path, spec_sha256);
     }
 
+    std::string Mirror::host(const std::string& url_path) const
+    {
+        return get_host_impl(url_path);
+    }
+
     std::size_t Mirror::max_retries() const
     {
         return m_max_retries;
@@ -100,6 +105,38 @@ namespace mamba::download
         return m_stats->failed_transfers;
     }
 
+    std::size_t Mirror::running_transfers() const
+    {
+        return m_stats->running_transfers;
+    }
+
+    MirrorPerformance Mirror::performance() const
+    {
+        return m_stats->performance;
+    }
+
+    void Mirror::set_performance(const MirrorPerformance& performance)
+    {
+        m_stats->performance = performance;
+    }
+
+    std::optional<double> Mirror::expected_transfer_seconds(std::size_t size) const
+    {
+        const auto stats = m_stats.synchronize();
+        const auto& perf = stats->performance;
+        if (perf.measured_transfers == 0)
+        {
+            return std::nullopt;
+        }
+        double seconds = perf.time_to_first_byte_s;
+        if (perf.throughput_Bps > 0.)
+        {
+            const auto sharing_transfers = static_cast<double>(stats->running_transfers + 1);
+            seconds += static_cast<double>(size) * sharing_transfers / perf.throughput_Bps;
+        }
+        return seconds;
+    }
+
     bool Mirror::can_accept_more_connections() const
     {
         const auto stats = m_stats.synchronize();
@@ -159,4 +196,37 @@ namespace mamba::download
             }
         }
     }
+
+    namespace
+    {
+        // Weight of the last transfer in the moving averages
+        constexpr double performance_smoothing = 0.3;
+        // Smaller transfers are dominated by the latency and say little about the throughput
+        constexpr std::size_t min_throughput_sample_size = 64 * 1024;
+
+        double moving_average(double average, double sample)
+        {
+            return performance_smoothing * sample + (1. - performance_smoothing) * average;
+        }
+    }
+
+    void Mirror::record_transfer(const TransferData& data)
+    {
+        auto stats = m_stats.synchronize();
+        auto& perf = stats->performance;
+
+        const double ttfb = std::chrono::duration<double>(data.time_to_first_byte).count();
+        perf.time_to_first_byte_s = (perf.measured_transfers == 0)
+                                        ? ttfb
+                                        : moving_average(perf.time_to_first_byte_s, ttfb);
+
+        if (data.downloaded_size >= min_throughput_sample_size && data.average_speed_Bps > 0)
+        {
+            const auto speed = static_cast<double>(data.average_speed_Bps);
+            perf.throughput_Bps = (perf.throughput_Bps == 0.)
+                                      ? speed
+                                      : moving_average(perf.throughput_Bps, speed);
+        }
+        ++perf.measured_transfers;
+    }
 }
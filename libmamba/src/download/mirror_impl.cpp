@@ -25,6 +25,22 @@ namespace mamba::download
     namespace
     {
         const auto PASSTHROUGH_MIRROR_ID = MirrorID("");
+
+        std::string get_url_host(const std::string& url)
+        {
+            const auto url_handler = util::URL::parse(url);
+            if (!url_handler.has_value() || url_handler->scheme() == "file")
+            {
+                return {};
+            }
+            auto host = url_handler->host();
+            const auto& port = url_handler->port();
+            if (!port.empty())
+            {
+                host += ":" + port;
+            }
+            return host;
+        }
     }
 
     PassThroughMirror::PassThroughMirror()
@@ -44,6 +60,11 @@ namespace mamba::download
                  { return MirrorRequest(dl_request, dl_request.url_path); } };
     }
 
+    std::string PassThroughMirror::get_host_impl(const std::string& url_path) const
+    {
+        return get_url_host(url_path);
+    }
+
     /*****************************
      * HTTPMirror implementation *
      *****************************/
@@ -66,6 +87,11 @@ namespace mamba::download
                  { return MirrorRequest(dl_request, util::url_concat(url, dl_request.url_path)); } };
     }
 
+    std::string HTTPMirror::get_host_impl(const std::string&) const
+    {
+        return get_url_host(m_url);
+    }
+
     /****************************
      * OCIMirror implementation *
      ****************************/
@@ -209,6 +235,11 @@ namespace mamba::download
         return req_gen;
     }
 
+    std::string OCIMirror::get_host_impl(const std::string&) const
+    {
+        return get_url_host(m_url);
+    }
+
     MirrorRequest OCIMirror::build_authentication_request(
         const Request& initial_request,
         const std::string& split_path
@@ -29,6 +29,7 @@ namespace mamba::download
         using request_generator_list = Mirror::request_generator_list;
         request_generator_list
         get_request_generators_impl(const std::string&, const std::string&) const override;
+        std::string get_host_impl(const std::string& url_path) const override;
     };
 
     class HTTPMirror : public Mirror
@@ -44,6 +45,7 @@ namespace mamba::download
         using request_generator_list = Mirror::request_generator_list;
         request_generator_list
         get_request_generators_impl(const std::string&, const std::string&) const override;
+        std::string get_host_impl(const std::string& url_path) const override;
 
         std::string m_url;
     };
@@ -84,6 +86,7 @@ namespace mamba::download
             const std::string& url_path,
             const std::string& spec_sha256
         ) const override;
+        std::string get_host_impl(const std::string& url_path) const override;
 
         MirrorRequest
         build_authentication_request(const Request& initial_request, const std::string& split_path) const;
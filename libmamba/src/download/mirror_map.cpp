@@ -4,7 +4,13 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/output.hpp"
+#include "mamba/core/util.hpp"
 #include "mamba/download/mirror_map.hpp"
+#include "mamba/util/cryptography.hpp"
+#include "mamba/util/random.hpp"
 
 #include "mirror_impl.hpp"
 
@@ -53,12 +59,145 @@ namespace mamba::download
             {
                 return false;
             }
+            restore_performance(*mirror);
             mirrors.push_back(std::move(mirror));
         }
         else
         {
+            restore_performance(*mirror);
             m_mirrors[std::string(mirror_name)].push_back(std::move(mirror));
         }
         return true;
     }
+
+    namespace
+    {
+        constexpr int performance_file_version = 1;
+
+        // Mirror ids may contain credentials, only their hash is written to disk.
+        std::string performance_key(const Mirror& mirror)
+        {
+            return util::Sha256Hasher().str_hex_str(mirror.id().to_string());
+        }
+
+        auto read_performance_file(const fs::u8path& path)
+            -> std::unordered_map<std::string, MirrorPerformance>
+        {
+            auto saved = std::unordered_map<std::string, MirrorPerformance>();
+            if (!fs::exists(path))
+            {
+                return saved;
+            }
+            auto in = open_ifstream(path);
+            const auto json = nlohmann::json::parse(in, nullptr, /* allow_exceptions= */ false);
+            // Wrongly typed fields throw when read, the whole file is then ignored
+            try
+            {
+                if (!json.is_object() || json.value("version", 0) != performance_file_version)
+                {
+                    LOG_DEBUG << "Ignoring invalid mirror performance file " << path;
+                    return saved;
+                }
+                const auto mirrors = json.find("mirrors");
+                if (mirrors == json.end() || !mirrors->is_object())
+                {
+                    return saved;
+                }
+                for (const auto& [key, entry] : mirrors->items())
+                {
+                    if (entry.is_object())
+                    {
+                        auto& perf = saved[key];
+                        perf.measured_transfers = entry.value(
+                            "measured_transfers",
+                            perf.measured_transfers
+                        );
+                        perf.throughput_Bps = entry.value("throughput_Bps", perf.throughput_Bps);
+                        perf.time_to_first_byte_s = entry.value(
+                            "time_to_first_byte_s",
+                            perf.time_to_first_byte_s
+                        );
+                    }
+                }
+            }
+            catch (const nlohmann::json::exception& e)
+            {
+                LOG_DEBUG << "Ignoring invalid mirror performance file " << path << ": "
+                          << e.what();
+                saved.clear();
+            }
+            return saved;
+        }
+    }
+
+    void mirror_map::load_performance(const fs::u8path& path)
+    {
+        m_saved_performance = read_performance_file(path);
+        for (auto& [name, mirrors] : m_mirrors)
+        {
+            for (auto& mirror : mirrors)
+            {
+                restore_performance(*mirror);
+            }
+        }
+    }
+
+    void mirror_map::save_performance(const fs::u8path& path) const
+    {
+        auto saved = read_performance_file(path);
+        for (const auto& [name, mirrors] : m_mirrors)
+        {
+            for (const auto& mirror : mirrors)
+            {
+                if (const auto perf = mirror->performance(); perf.measured_transfers > 0)
+                {
+                    saved[performance_key(*mirror)] = perf;
+                }
+            }
+        }
+
+        auto entries = nlohmann::json::object();
+        for (const auto& [key, perf] : saved)
+        {
+            entries[key] = {
+                { "measured_transfers", perf.measured_transfers },
+                { "throughput_Bps", perf.throughput_Bps },
+                { "time_to_first_byte_s", perf.time_to_first_byte_s },
+            };
+        }
+        const auto json = nlohmann::json{
+            { "version", performance_file_version },
+            { "mirrors", std::move(entries) },
+        };
+
+        try
+        {
+            fs::create_directories(path.parent_path());
+            // Concurrent processes each write their own temporary file
+            const auto tmp_path = path.string() + ".tmp."
+                                  + util::generate_random_alphanumeric_string(8);
+            {
+                auto out = open_ofstream(tmp_path);
+                out << json.dump(4);
+            }
+            fs::rename(tmp_path, path);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Could not save mirror performance to " << path << ": " << e.what();
+        }
+    }
+
+    void mirror_map::restore_performance(Mirror& mirror) const
+    {
+        if (m_saved_performance.empty())
+        {
+            return;
+        }
+        if (auto it = m_saved_performance.find(performance_key(mirror));
+            it != m_saved_performance.end())
+        {
+            mirror.set_performance(it->second);
+        }
+    }
 }
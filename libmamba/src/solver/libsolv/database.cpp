@@ -37,6 +37,7 @@ namespace mamba::solver::libsolv
         Settings settings;
         solv::ObjPool pool = {};
         Matcher matcher;
+        std::size_t generation = 0;
     };
 
     Database::Database(specs::ChannelResolveParams channel_params)
@@ -87,6 +88,11 @@ namespace mamba::solver::libsolv
         return database.pool();
     }
 
+    auto Database::Impl::generation(const Database& database) -> std::size_t
+    {
+        return database.m_data->generation;
+    }
+
     auto Database::channel_params() const -> const specs::ChannelResolveParams&
     {
         return m_data->matcher.channel_params();
@@ -168,6 +174,7 @@ namespace mamba::solver::libsolv
         }
         auto repo = pool().add_repo(url).second;
         repo.set_url(std::string(url));
+        ++m_data->generation;
 
         auto make_repo = [&]() -> expected_t<solv::ObjRepoView>
         {
@@ -227,6 +234,7 @@ namespace mamba::solver::libsolv
     ) -> expected_t<RepoInfo>
     {
         auto repo = pool().add_repo(expected.url).second;
+        ++m_data->generation;
 
         return read_solv(pool(), repo, path, expected, static_cast<bool>(add))
             .transform(
@@ -247,6 +255,7 @@ namespace mamba::solver::libsolv
 
     auto Database::add_repo_from_packages_impl_pre(std::string_view name) -> RepoInfo
     {
+        ++m_data->generation;
         if (name.empty())
         {
             return RepoInfo(
@@ -288,6 +297,7 @@ namespace mamba::solver::libsolv
     void Database::remove_repo(RepoInfo repo)
     {
         pool().remove_repo(repo.id(), /* reuse_ids= */ true);
+        ++m_data->generation;
     }
 
     auto Database::repo_count() const -> std::size_t
@@ -313,6 +323,7 @@ namespace mamba::solver::libsolv
     void Database::set_installed_repo(RepoInfo repo)
     {
         pool().set_installed_repo(repo.id());
+        ++m_data->generation;
     }
 
     void Database::set_repo_priority(RepoInfo repo, Priorities priorities)
@@ -4,9 +4,12 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <unordered_map>
 #include <variant>
 
 #include <fmt/ostream.h>
@@ -26,15 +29,17 @@
 #include "mamba/specs/conda_url.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/util/cfile.hpp"
+#include "mamba/util/encoding.hpp"
 #include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/util/type_traits.hpp"
+#include "mamba/util/variant_cmp.hpp"
 
 #include "solver/helpers.hpp"
 #include "solver/libsolv/helpers.hpp"
 #include "solver/libsolv/matcher.hpp"
 
-#define MAMBA_TOOL_VERSION "2.0"
+#define MAMBA_TOOL_VERSION "2.1"
 
 #define MAMBA_SOLV_VERSION MAMBA_TOOL_VERSION "_" LIBSOLV_VERSION_STRING
 
@@ -104,6 +109,99 @@ namespace mamba::solver::libsolv
         solv.add_self_provide();
     }
 
+    namespace
+    {
+        // An entry of the signatures table is a binary ed25519 key id followed by the binary
+        // signature made with that key.
+        inline constexpr std::size_t signature_keyid_size = 32;
+        inline constexpr std::size_t signature_size = 64;
+        inline constexpr std::size_t signature_entry_size = signature_keyid_size + signature_size;
+
+        /**
+         * Rebuild the JSON signatures from the signatures table.
+         *
+         * The result is the same as ``nlohmann::json::dump`` of the original signatures block.
+         */
+        auto signatures_table_to_json(std::string_view table) -> std::string
+        {
+            const auto* bytes = reinterpret_cast<const std::byte*>(table.data());
+            const std::size_t count = table.size() / signature_entry_size;
+
+            std::string out = R"({"signatures":{)";
+            out.reserve(out.size() + count * (2 * signature_entry_size + 20) + 2);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto* keyid = bytes + i * signature_entry_size;
+                const auto* sig = keyid + signature_keyid_size;
+                if (i > 0)
+                {
+                    out += ',';
+                }
+                out += '"';
+                out += util::bytes_to_hex_str(keyid, sig);
+                out += R"(":{"signature":")";
+                out += util::bytes_to_hex_str(sig, sig + signature_size);
+                out += R"("})";
+            }
+            out += "}}";
+            return out;
+        }
+
+        /**
+         * Build the signatures table from the JSON signatures of a package.
+         *
+         * Only plain ed25519 signatures fit in the table, other signatures (e.g. with
+         * additional headers) are left to the JSON representation.
+         */
+        auto make_signatures_table(const nlohmann::json& signatures) -> std::optional<std::string>
+        {
+            const auto is_lower_hex = [](std::string_view str, std::size_t size)
+            {
+                return (str.size() == 2 * size)
+                       && std::all_of(
+                           str.cbegin(),
+                           str.cend(),
+                           [](char c) { return ('0' <= c && c <= '9') || ('a' <= c && c <= 'f'); }
+                       );
+            };
+
+            if (!signatures.is_object() || signatures.empty())
+            {
+                return std::nullopt;
+            }
+
+            auto table = std::string(signatures.size() * signature_entry_size, '\0');
+            auto* out = reinterpret_cast<std::byte*>(table.data());
+            auto error = util::EncodingError::Ok;
+            for (const auto& [keyid, sig] : signatures.items())
+            {
+                if (!sig.is_object() || (sig.size() != 1))
+                {
+                    return std::nullopt;
+                }
+                const auto sig_hex = sig.find("signature");
+                if ((sig_hex == sig.end()) || !sig_hex->is_string())
+                {
+                    return std::nullopt;
+                }
+                const auto& sig_str = sig_hex->get_ref<const std::string&>();
+                if (!is_lower_hex(keyid, signature_keyid_size)
+                    || !is_lower_hex(sig_str, signature_size))
+                {
+                    return std::nullopt;
+                }
+                util::hex_to_bytes_to(keyid, out, error);
+                util::hex_to_bytes_to(sig_str, out + signature_keyid_size, error);
+                out += signature_entry_size;
+            }
+            if (error != util::EncodingError::Ok)
+            {
+                return std::nullopt;
+            }
+            return table;
+        }
+    }
+
     auto make_package_info(const solv::ObjPool& pool, solv::ObjSolvableViewConst s)
         -> specs::PackageInfo
     {
@@ -124,7 +222,14 @@ namespace mamba::solver::libsolv
         out.md5 = s.md5();
         out.sha256 = s.sha256();
         out.python_site_packages_path = s.python_site_packages_path();
-        out.signatures = s.signatures();
+        if (const auto table = s.signatures_table(); !table.empty())
+        {
+            out.signatures = signatures_table_to_json(table);
+        }
+        else
+        {
+            out.signatures = s.signatures();
+        }
 
         const auto dep_to_str = [&pool](solv::DependencyId id)
         { return pool.dependency_to_string(id); };
@@ -158,42 +263,80 @@ namespace mamba::solver::libsolv
             return util::lstrip_if_parts(tail, [&](char c) { return !is_sep(c); });
         }
 
+        /**
+         * The signatures of a package as they are stored in its solvable.
+         *
+         * Either as a signatures table or, when they do not fit it, as the JSON string
+         * that libsolv also uses.
+         */
+        struct PackageSignatures
+        {
+            std::string table;
+            std::string json;
+        };
+
+        using RepodataSignatures = std::unordered_map<std::string, PackageSignatures>;
+
         void set_solv_signatures(
             solv::ObjSolvableView solv,
             const std::string& filename,
-            const std::optional<nlohmann::json>& signatures
+            const RepodataSignatures& signatures
         )
         {
-            // NOTE We need to use an intermediate nlohmann::json object to store signatures
-            // as simdjson objects are not conceived to be modified smoothly
-            // and we need an equivalent structure to how libsolv is storing the signatures
-            nlohmann::json glob_sigs;
-            if (signatures)
-            {
-                if (auto signatures_for_file = signatures->find(filename);
-                    signatures_for_file != signatures->end())
+            if (auto signatures_for_file = signatures.find(filename);
+                signatures_for_file != signatures.end())
+            {
+                if (!signatures_for_file->second.table.empty())
                 {
-                    glob_sigs["signatures"] = *signatures_for_file;
-
-                    solv.set_signatures(glob_sigs.dump());
-                    LOG_INFO << "Signatures for '" << filename
-                             << "' are set in corresponding solvable.";
+                    solv.set_signatures_table(signatures_for_file->second.table);
                 }
+                else
+                {
+                    solv.set_signatures(signatures_for_file->second.json);
+                }
+                LOG_INFO << "Signatures for '" << filename
+                         << "' are set in corresponding solvable.";
             }
         }
 
         template <class SimdJSONValue>
-        std::optional<nlohmann::json> extract_signatures(std::optional<SimdJSONValue>& signatures)
+        auto read_signatures(std::optional<SimdJSONValue>& signatures) -> RepodataSignatures
         {
+            auto out = RepodataSignatures();
             if (!signatures || signatures->error())
             {
-                return {};
+                return out;
             }
 
-            const std::string raw_json(signatures->raw_json().value());
-            auto all_signatures = nlohmann::json::parse(raw_json);
+            auto signatures_as_object = signatures->get_object();
+            if (signatures_as_object.error())
+            {
+                return out;
+            }
+            for (auto sig_field : signatures_as_object)
+            {
+                // NOTE Each package signatures are small, they are read with nlohmann::json
+                // as simdjson "on-demand" values cannot be read twice, which is needed for
+                // the signatures that do not fit in the table.
+                const std::string filename(sig_field.unescaped_key().value());
+                auto raw_json = sig_field.value().raw_json();
+                if (raw_json.error())
+                {
+                    continue;
+                }
+                const auto pkg_signatures = nlohmann::json::parse(raw_json.value_unsafe());
 
-            return all_signatures;
+                auto& stored = out[filename];
+                if (auto table = make_signatures_table(pkg_signatures))
+                {
+                    stored.table = std::move(table).value();
+                }
+                else
+                {
+                    stored.json = nlohmann::json{ { "signatures", pkg_signatures } }.dump();
+                }
+            }
+            return out;
         }
 
         template <class JSONObject>
@@ -206,7 +349,7 @@ namespace mamba::solver::libsolv
 
             const std::string& filename,
             JSONObject&& pkg,
-            const std::optional<nlohmann::json>& signatures,
+            const RepodataSignatures& signatures,
             const std::string& default_subdir,
             MatchSpecParser parser
         ) -> bool
@@ -340,8 +483,7 @@ namespace mamba::solver::libsolv
                         }
                         else
                         {
-                            fmt::print(
-                                LOG_WARNING,
+                            LOG_WARNING << fmt::format(
                                 R"(Found invalid MatchSpec "{}" in "{}")",
                                 ms,
                                 filename
@@ -365,8 +507,7 @@ namespace mamba::solver::libsolv
                         }
                         else
                         {
-                            fmt::print(
-                                LOG_WARNING,
+                            LOG_WARNING << fmt::format(
                                 R"(Found invalid MatchSpec "{}" in "{}")",
                                 ms,
                                 filename
@@ -416,7 +557,7 @@ namespace mamba::solver::libsolv
             const std::string& channel_id,
             const std::string& default_subdir,
             JSONObject& packages,
-            const std::optional<nlohmann::json>& signatures,
+            const RepodataSignatures& signatures,
             Filter&& filter,
             OnParsed&& on_parsed,
             MatchSpecParser parser
@@ -461,7 +602,7 @@ namespace mamba::solver::libsolv
             const std::string& channel_id,
             const std::string& default_subdir,
             JSONObject& packages,
-            const std::optional<nlohmann::json>& signatures,
+            const RepodataSignatures& signatures,
             MatchSpecParser parser
         )
         {
@@ -487,7 +628,7 @@ namespace mamba::solver::libsolv
             const std::string& channel_id,
             const std::string& default_subdir,
             JSONObject& packages,
-            const std::optional<nlohmann::json>& signatures,
+            const RepodataSignatures& signatures,
             MatchSpecParser parser
         ) -> util::flat_set<std::string>
         {
@@ -518,7 +659,7 @@ namespace mamba::solver::libsolv
             const std::string& channel_id,
             const std::string& default_subdir,
             JSONObject& packages,
-            const std::optional<nlohmann::json>& signatures,
+            const RepodataSignatures& signatures,
             const SortedStringRange& added,
             MatchSpecParser parser
         )
@@ -700,7 +841,7 @@ namespace mamba::solver::libsolv
         }();
 
 
-        const auto json_signatures = extract_signatures(signatures);
+        const auto repodata_signatures = read_signatures(signatures);
 
         if (package_types == PackageTypes::CondaOrElseTarBz2)
         {
@@ -714,7 +855,7 @@ namespace mamba::solver::libsolv
                     channel_id,
                     default_subdir,
                     pkgs,
-                    json_signatures,
+                    repodata_signatures,
                     ms_parser
                 );
             }
@@ -727,7 +868,7 @@ namespace mamba::solver::libsolv
                     channel_id,
                     default_subdir,
                     pkgs,
-                    json_signatures,
+                    repodata_signatures,
                     added,
                     ms_parser
                 );
@@ -745,7 +886,7 @@ namespace mamba::solver::libsolv
                     channel_id,
                     default_subdir,
                     pkgs,
-                    json_signatures,
+                    repodata_signatures,
                     ms_parser
                 );
             }
@@ -760,7 +901,7 @@ namespace mamba::solver::libsolv
                     channel_id,
                     default_subdir,
                     pkgs,
-                    json_signatures,
+                    repodata_signatures,
                     ms_parser
                 );
             }
@@ -914,6 +1055,42 @@ namespace mamba::solver::libsolv
             );
     }
 
+    auto write_repo_copy(solv::ObjPool& pool, solv::ObjRepoView repo, std::FILE* file)
+        -> expected_t<RepoCopyInfo>
+    {
+        repo.internalize();
+        if (auto written = repo.write(file); !written)
+        {
+            return make_unexpected(std::move(written).error(), mamba_error_code::internal_failure);
+        }
+        const auto installed = pool.installed_repo();
+        return { RepoCopyInfo{
+            /* .name= */ std::string(repo.name()),
+            /* .priority= */ repo.raw()->priority,
+            /* .subpriority= */ repo.raw()->subpriority,
+            /* .installed= */ installed.has_value() && (installed->id() == repo.id()),
+        } };
+    }
+
+    auto read_repo_copy(solv::ObjPool& pool, const RepoCopyInfo& info, std::FILE* file)
+        -> expected_t<solv::ObjRepoView>
+    {
+        auto [id, repo] = pool.add_repo(info.name);
+        if (auto read = repo.read(file); !read)
+        {
+            pool.remove_repo(id, /* reuse_ids= */ true);
+            return make_unexpected(std::move(read).error(), mamba_error_code::repodata_not_loaded);
+        }
+        repo.raw()->priority = info.priority;
+        repo.raw()->subpriority = info.subpriority;
+        repo.internalize();
+        if (info.installed)
+        {
+            pool.set_installed_repo(id);
+        }
+        return { repo };
+    }
+
     void
     set_solvables_url(solv::ObjRepoView repo, const std::string& repo_url, const std::string& channel_id)
     {
@@ -1696,18 +1873,8 @@ namespace mamba::solver::libsolv
             {
                 // WARNING pins are not working with namespace dependencies so far
                 return pool_add_pin(pool, job.spec, MatchSpecParser::Libsolv)
-                    .transform(
-                        [&](solv::ObjSolvableView pin_solv)
-                        {
-                            const auto name_id = pool.add_string(pin_solv.name());
-                            // WARNING keep separate or libsolv does not understand
-                            // Force verify the dummy solvable dependencies, as this is not the
-                            // default for installed packages.
-                            raw_jobs.push_back(SOLVER_VERIFY, name_id);
-                            // Lock the dummy solvable so that it stays install.
-                            raw_jobs.push_back(SOLVER_LOCK, name_id);
-                        }
-                    );
+                    .transform([&](solv::ObjSolvableView pin_solv)
+                               { add_pin_to_decision_queue(raw_jobs, pool, pin_solv); });
             }
             else
             {
@@ -1774,4 +1941,91 @@ namespace mamba::solver::libsolv
         }
         return { std::move(solv_jobs) };
     }
+
+    auto add_request_job_to_decision_queue(
+        const Request::Job& job,
+        solv::ObjQueue& jobs,
+        solv::ObjPool& pool,
+        bool force_reinstall,
+        MatchSpecParser parser
+    ) -> expected_t<void>
+    {
+        return std::visit(
+            [&](const auto& j) -> expected_t<void>
+            { return add_job(j, jobs, pool, force_reinstall, parser); },
+            job
+        );
+    }
+
+    void add_pin_to_decision_queue(
+        solv::ObjQueue& jobs,
+        solv::ObjPool& pool,
+        solv::ObjSolvableViewConst pin_solv
+    )
+    {
+        const auto name_id = pool.add_string(pin_solv.name());
+        // WARNING keep separate or libsolv does not understand
+        // Force verify the dummy solvable dependencies, as this is not the
+        // default for installed packages.
+        jobs.push_back(SOLVER_VERIFY, name_id);
+        // Lock the dummy solvable so that it stays install.
+        jobs.push_back(SOLVER_LOCK, name_id);
+    }
+
+    void set_solver_flags(solv::ObjSolver& solver, const Request::Flags& flags)
+    {
+        solver.set_flag(SOLVER_FLAG_ALLOW_DOWNGRADE, flags.allow_downgrade);
+        solver.set_flag(SOLVER_FLAG_ALLOW_UNINSTALL, flags.allow_uninstall);
+        solver.set_flag(SOLVER_FLAG_STRICT_REPO_PRIORITY, flags.strict_repo_priority);
+    }
+
+    namespace
+    {
+        /**
+         * An arbitrary comparison function to get determinist output.
+         *
+         * Could be improved as libsolv seems to be sensitive to sort order.
+         * https://github.com/mamba-org/mamba/issues/3058
+         */
+        auto make_request_cmp()
+        {
+            return util::make_variant_cmp(
+                /** index_cmp= */
+                [](auto lhs, auto rhs) { return lhs < rhs; },
+                /** alternative_cmp= */
+                [](const auto& lhs, const auto& rhs)
+                {
+                    using Itm = std::decay_t<decltype(lhs)>;
+                    if constexpr (!std::is_same_v<Itm, Request::UpdateAll>)
+                    {
+                        return lhs.spec.name().to_string() < rhs.spec.name().to_string();
+                    }
+                    return false;
+                }
+            );
+        }
+    }
+
+    void sort_request_jobs(Request::job_list& jobs)
+    {
+        std::sort(jobs.begin(), jobs.end(), make_request_cmp());
+    }
+
+    auto solver_to_solution(  //
+        const solv::ObjPool& pool,
+        const solv::ObjSolver& solver,
+        const Request& request
+    ) -> Solution
+    {
+        auto trans = solv::ObjTransaction::from_solver(pool, solver);
+        trans.order(pool);
+
+        auto solution = transaction_to_solution(pool, trans, request, request.flags);
+
+        if (solution_needs_python_relink(pool, solution))
+        {
+            return add_noarch_relink_to_solution(std::move(solution), pool, "python");
+        }
+        return solution;
+    }
 }
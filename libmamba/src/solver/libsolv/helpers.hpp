@@ -7,6 +7,7 @@
 #ifndef MAMBA_SOLVER_LIBSOLV_HELPERS
 #define MAMBA_SOLVER_LIBSOLV_HELPERS
 
+#include <cstdio>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -21,6 +22,7 @@
 #include "solv-cpp/pool.hpp"
 #include "solv-cpp/repo.hpp"
 #include "solv-cpp/solvable.hpp"
+#include "solv-cpp/solver.hpp"
 #include "solv-cpp/transaction.hpp"
 
 #include "solver/libsolv/matcher.hpp"
@@ -78,6 +80,33 @@ namespace mamba::solver::libsolv
         const RepodataOrigin& metadata
     ) -> expected_t<solv::ObjRepoView>;
 
+    /** The properties of a repository that are not part of the libsolv binary format. */
+    struct RepoCopyInfo
+    {
+        std::string name;
+        int priority = 0;
+        int subpriority = 0;
+        bool installed = false;
+    };
+
+    /**
+     * Write a repository in the libsolv binary format, to be restored by @ref read_repo_copy.
+     *
+     * Unlike @ref write_solv, no cache metadata is added to the repository.
+     */
+    [[nodiscard]] auto write_repo_copy(  //
+        solv::ObjPool& pool,
+        solv::ObjRepoView repo,
+        std::FILE* file
+    ) -> expected_t<RepoCopyInfo>;
+
+    /** Add a repository written by @ref write_repo_copy to the pool. */
+    [[nodiscard]] auto read_repo_copy(  //
+        solv::ObjPool& pool,
+        const RepoCopyInfo& info,
+        std::FILE* file
+    ) -> expected_t<solv::ObjRepoView>;
+
     void
     set_solvables_url(solv::ObjRepoView repo, const std::string& repo_url, const std::string& channel_id);
 
@@ -175,5 +204,38 @@ namespace mamba::solver::libsolv
         MatchSpecParser parser
 
     ) -> expected_t<solv::ObjQueue>;
+
+    /**
+     * Translate a single request job into libsolv jobs appended to the decision queue.
+     *
+     * Pins add solvables to the pool, and hence must be added before the whatprovides
+     * index is created and other jobs are translated.
+     */
+    [[nodiscard]] auto add_request_job_to_decision_queue(
+        const Request::Job& job,
+        solv::ObjQueue& jobs,
+        solv::ObjPool& pool,
+        bool force_reinstall,
+        MatchSpecParser parser
+    ) -> expected_t<void>;
+
+    /** Add the jobs keeping a pin solvable created by @ref pool_add_pin installed. */
+    void add_pin_to_decision_queue(
+        solv::ObjQueue& jobs,
+        solv::ObjPool& pool,
+        solv::ObjSolvableViewConst pin_solv
+    );
+
+    void set_solver_flags(solv::ObjSolver& solver, const Request::Flags& flags);
+
+    /** Sort the jobs in an arbitrary, but deterministic, order. */
+    void sort_request_jobs(Request::job_list& jobs);
+
+    /** Compute the ordered transaction of a successful solve, with python noarch relinks. */
+    [[nodiscard]] auto solver_to_solution(  //
+        const solv::ObjPool& pool,
+        const solv::ObjSolver& solver,
+        const Request& request
+    ) -> Solution;
 }
 #endif
@@ -60,6 +60,12 @@ namespace mamba::solver::libsolv
     {
         m_packages_buffer.clear();  // Reuse the buffer
 
+        // The version is checked with its compiled form, so we remove it from the MatchSpec
+        // to avoid evaluating it twice.
+        const auto& version_spec = get_compiled_version_spec(ms.version());
+        auto ms_except_version = ms;
+        ms_except_version.set_version({});
+
         auto add_pkg_if_matching = [&](solv::ObjSolvableViewConst s)
         {
             if (flags.skip_installed && s.installed())
@@ -67,7 +73,8 @@ namespace mamba::solver::libsolv
                 return;
             }
 
-            if (pkg_match_except_channel(pool, s, ms) && pkg_match_channels(s, ms))
+            if (pkg_match_except_channel(pool, s, ms_except_version, version_spec)
+                && pkg_match_channels(s, ms))
             {
                 m_packages_buffer.push_back(s.id());
             }
@@ -110,35 +117,59 @@ namespace mamba::solver::libsolv
             .value();
     }
 
-    namespace
+    auto Matcher::get_version(std::string_view version) -> expected_t<cached_version_const_ref>
     {
-        template <typename Map>
-        [[nodiscard]] auto make_cached_version(Map& cache, std::string version)
-            -> specs::expected_parse_t<std::reference_wrapper<const specs::Version>>
+        auto str = std::string(version);
+        if (auto it = m_version_cache.find(str); it != m_version_cache.cend())
         {
-            if (auto it = cache.find(version); it != cache.cend())
-            {
-                return { std::cref(it->second) };
-            }
-            if (version.empty())
-            {
-                auto [it, inserted] = cache.emplace(std::move(version), specs::Version());
-                assert(inserted);
-                return { std::cref(it->second) };
-            }
-            return specs::Version::parse(version).transform(
-                [&](specs::Version&& ver) -> std::reference_wrapper<const specs::Version>
-                {
-                    auto [it, inserted] = cache.emplace(std::move(version), std::move(ver));
-                    assert(inserted);
-                    return { std::cref(it->second) };
-                }
+            return { std::cref(it->second) };
+        }
+
+        auto make_cached = [&](specs::Version&& ver) -> cached_version_const_ref
+        {
+            auto key = specs::VersionKey::make(ver);
+            auto [it, inserted] = m_version_cache.emplace(
+                std::move(str),
+                CachedVersion{ std::move(ver), std::move(key) }
+            );
+            assert(inserted);
+            return { std::cref(it->second) };
+        };
+
+        if (version.empty())
+        {
+            return make_cached(specs::Version());
+        }
+        return specs::Version::parse(version)
+            .transform(make_cached)
+            .transform_error(  //
+                [](specs::ParseError&& err)
+                { return mamba_error(err.what(), mamba_error_code::invalid_spec); }
+
             );
+    }
+
+    auto Matcher::get_compiled_version_spec(const specs::VersionSpec& vs)
+        -> const specs::CompiledVersionSpec&
+    {
+        auto str = vs.to_string();
+        if (auto it = m_version_spec_cache.find(str); it != m_version_spec_cache.cend())
+        {
+            return it->second;
         }
+        auto [it, inserted] = m_version_spec_cache.emplace(
+            std::move(str),
+            specs::CompiledVersionSpec(vs)
+        );
+        assert(inserted);
+        return it->second;
     }
 
-    auto Matcher::get_pkg_attributes(solv::ObjPoolView pool, solv::ObjSolvableViewConst solv)
-        -> expected_t<Pkg>
+    auto Matcher::get_pkg_attributes(
+        solv::ObjPoolView pool,
+        solv::ObjSolvableViewConst solv,
+        const specs::Version& version
+    ) -> Pkg
     {
         auto track_features = specs::MatchSpec::string_set();
         for (solv::StringId id : solv.track_features())
@@ -146,38 +177,37 @@ namespace mamba::solver::libsolv
             track_features.insert(std::string(pool.get_string(id)));
         }
 
-        return make_cached_version(m_version_cache, std::string(solv.version()))
-            .transform(
-                [&](auto ver_ref)
-                {
-                    return Pkg{
-                        /* .name= */ solv.name(),
-                        /* .version= */ ver_ref,
-                        /* .build_string= */ solv.build_string(),
-                        /* .build_number= */ solv.build_number(),
-                        /* .md5= */ solv.md5(),
-                        /* .sha256= */ solv.sha256(),
-                        /* .license= */ solv.license(),
-                        /* .platform= */ std::string(solv.platform()),
-                        /* .track_features= */ std::move(track_features),
-                    };
-                }
-            )
-            .transform_error(  //
-                [](specs::ParseError&& err)
-                { return mamba_error(err.what(), mamba_error_code::invalid_spec); }
-
-            );
+        return {
+            /* .name= */ solv.name(),
+            /* .version= */ std::cref(version),
+            /* .build_string= */ solv.build_string(),
+            /* .build_number= */ solv.build_number(),
+            /* .md5= */ solv.md5(),
+            /* .sha256= */ solv.sha256(),
+            /* .license= */ solv.license(),
+            /* .platform= */ std::string(solv.platform()),
+            /* .track_features= */ std::move(track_features),
+        };
     }
 
     auto Matcher::pkg_match_except_channel(  //
         solv::ObjPoolView pool,
         solv::ObjSolvableViewConst solv,
-        const specs::MatchSpec& ms
+        const specs::MatchSpec& ms,
+        const specs::CompiledVersionSpec& vs
     ) -> bool
     {
-        return get_pkg_attributes(pool, solv)
-            .transform([&](const Pkg& pkg) -> bool { return ms.contains_except_channel(pkg); })
+        return get_version(solv.version())
+            .transform(
+                [&](const CachedVersion& ver) -> bool
+                {
+                    // The version is the cheapest and most selective attribute to check first
+                    return vs.contains(ver.version, ver.key)
+                           && ms.contains_except_channel(
+                               get_pkg_attributes(pool, solv, ver.version)
+                           );
+                }
+            )
             .or_else([](const auto&) -> expected_t<bool> { return false; })
             .value();
     }
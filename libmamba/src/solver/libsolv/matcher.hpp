@@ -8,6 +8,7 @@
 #define MAMBA_SOLVER_LIBSOLV_MATCHER
 
 #include <functional>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -16,6 +17,7 @@
 #include "mamba/specs/channel.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/specs/version.hpp"
+#include "mamba/specs/version_spec.hpp"
 #include "solv-cpp/pool.hpp"
 #include "solv-cpp/solvable.hpp"
 
@@ -75,15 +77,30 @@ namespace mamba::solver::libsolv
             specs::MatchSpec::string_set track_features;
         };
 
+        /** A parsed package version with its precomputed key for compiled version specs. */
+        struct CachedVersion
+        {
+            specs::Version version;
+            std::optional<specs::VersionKey> key;
+        };
+
+        using cached_version_const_ref = std::reference_wrapper<const CachedVersion>;
+
+        auto get_version(std::string_view version) -> expected_t<cached_version_const_ref>;
+        auto get_compiled_version_spec(const specs::VersionSpec& vs)
+            -> const specs::CompiledVersionSpec&;
+
         auto get_pkg_attributes(  //
             solv::ObjPoolView pool,
-            solv::ObjSolvableViewConst solv
-        ) -> expected_t<Pkg>;
+            solv::ObjSolvableViewConst solv,
+            const specs::Version& version
+        ) -> Pkg;
 
         auto pkg_match_except_channel(  //
             solv::ObjPoolView pool,
             solv::ObjSolvableViewConst solv,
-            const specs::MatchSpec& ms
+            const specs::MatchSpec& ms,
+            const specs::CompiledVersionSpec& vs
         ) -> bool;
 
         auto get_channels(const specs::UnresolvedChannel& uc) -> expected_t<channel_list_const_ref>;
@@ -103,7 +120,9 @@ namespace mamba::solver::libsolv
         solv::ObjQueue m_packages_buffer = {};
         // No need for matchspec cache since they have the same string id they should be handled
         // by libsolv.
-        std::unordered_map<std::string, specs::Version> m_version_cache = {};
+        std::unordered_map<std::string, CachedVersion> m_version_cache = {};
+        // Version specs however are shared among many matchspecs (e.g. with different names).
+        std::unordered_map<std::string, specs::CompiledVersionSpec> m_version_spec_cache = {};
         std::unordered_map<std::string, channel_list> m_channel_cache = {};
     };
 }
@@ -0,0 +1,341 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "mamba/solver/libsolv/portfolio_solver.hpp"
+#include "solv-cpp/pool.hpp"
+#include "solv-cpp/repo.hpp"
+
+#include "solver/libsolv/helpers.hpp"
+
+namespace mamba::solver::libsolv
+{
+    namespace
+    {
+        [[nodiscard]] auto same_flags(const Request::Flags& lhs, const Request::Flags& rhs) -> bool
+        {
+            return (lhs.keep_dependencies == rhs.keep_dependencies)
+                   && (lhs.keep_user_specs == rhs.keep_user_specs)
+                   && (lhs.force_reinstall == rhs.force_reinstall)
+                   && (lhs.allow_downgrade == rhs.allow_downgrade)
+                   && (lhs.allow_uninstall == rhs.allow_uninstall)
+                   && (lhs.strict_repo_priority == rhs.strict_repo_priority)
+                   && (lhs.order_request == rhs.order_request);
+        }
+    }
+
+    auto default_portfolio_strategies(const Request::Flags& flags) -> std::vector<PortfolioStrategy>
+    {
+        auto out = std::vector<PortfolioStrategy>();
+        const auto add = [&](std::string name, Request::Flags strategy_flags)
+        {
+            const bool duplicate = std::any_of(
+                out.cbegin(),
+                out.cend(),
+                [&](const auto& other) { return same_flags(other.flags, strategy_flags); }
+            );
+            if (!duplicate)
+            {
+                out.push_back({ std::move(name), strategy_flags });
+            }
+        };
+
+        add("requested", flags);
+
+        auto flexible = flags;
+        flexible.strict_repo_priority = false;
+        add("flexible_priority", flexible);
+
+        auto downgrade = flags;
+        downgrade.allow_downgrade = true;
+        downgrade.allow_uninstall = true;
+        add("allow_downgrade", downgrade);
+
+        auto relaxed = downgrade;
+        relaxed.strict_repo_priority = false;
+        add("relaxed", relaxed);
+
+        auto reordered = flags;
+        reordered.order_request = !flags.order_request;
+        add("reordered", reordered);
+
+        auto reinstall = flags;
+        reinstall.force_reinstall = true;
+        add("force_reinstall", reinstall);
+
+        return out;
+    }
+
+    namespace
+    {
+        struct FileCloser
+        {
+            void operator()(std::FILE* ptr) const
+            {
+                std::fclose(ptr);
+            }
+        };
+
+        using unique_file_ptr = std::unique_ptr<std::FILE, FileCloser>;
+
+        struct SerializedRepo
+        {
+            RepoCopyInfo info;
+            unique_file_ptr file;
+        };
+
+        /**
+         * Write all repositories with the libsolv binary format into anonymous temporary files.
+         *
+         * This is done once, in the calling thread, since the source pool is not thread safe.
+         */
+        [[nodiscard]] auto serialize_repos(solv::ObjPool& pool)
+            -> expected_t<std::vector<SerializedRepo>>
+        {
+            auto out = std::vector<SerializedRepo>();
+            out.reserve(pool.repo_count());
+            auto error = expected_t<void>();
+            pool.for_each_repo_id(
+                [&](solv::RepoId id)
+                {
+                    auto file = unique_file_ptr(std::tmpfile());
+                    if (file == nullptr)
+                    {
+                        error = make_unexpected(
+                            "Cannot create a temporary file to copy the database",
+                            mamba_error_code::internal_failure
+                        );
+                        return solv::LoopControl::Break;
+                    }
+                    auto info = write_repo_copy(pool, pool.get_repo(id).value(), file.get());
+                    if (!info)
+                    {
+                        error = forward_error(std::move(info));
+                        return solv::LoopControl::Break;
+                    }
+                    out.push_back({ std::move(info).value(), std::move(file) });
+                    return solv::LoopControl::Continue;
+                }
+            );
+            if (!error)
+            {
+                return forward_error(std::move(error));
+            }
+            return { std::move(out) };
+        }
+
+        /** The files are shared between the copies, hence they must not be read concurrently. */
+        [[nodiscard]] auto load_repos(solv::ObjPool& pool, std::vector<SerializedRepo>& repos)
+            -> expected_t<void>
+        {
+            for (auto& serialized : repos)
+            {
+                std::rewind(serialized.file.get());
+                if (auto repo = read_repo_copy(pool, serialized.info, serialized.file.get()); !repo)
+                {
+                    return forward_error(std::move(repo));
+                }
+            }
+            return {};
+        }
+    }
+
+    /********************************************
+     *  Implementation of PortfolioSolver       *
+     ********************************************/
+
+    auto PortfolioSolver::Outcome::has_solution() const -> bool
+    {
+        return solved_index.has_value();
+    }
+
+    auto PortfolioSolver::Outcome::solution() const -> const Solution&
+    {
+        assert(has_solution());
+        return std::get<Solution>(attempts[solved_index.value()].outcome.value().value());
+    }
+
+    auto PortfolioSolver::Outcome::unsolvables() const -> std::vector<const Attempt*>
+    {
+        auto out = std::vector<const Attempt*>();
+        for (const auto& attempt : attempts)
+        {
+            if (attempt.outcome.has_value() && attempt.outcome->has_value()
+                && std::holds_alternative<UnSolvable>(attempt.outcome->value()))
+            {
+                out.push_back(&attempt);
+            }
+        }
+        return out;
+    }
+
+    PortfolioSolver::PortfolioSolver(
+        std::vector<PortfolioStrategy> strategies,
+        std::size_t max_threads
+    )
+        : m_strategies(std::move(strategies))
+        , m_max_threads(max_threads)
+    {
+    }
+
+    auto PortfolioSolver::strategies() const -> const std::vector<PortfolioStrategy>&
+    {
+        return m_strategies;
+    }
+
+    auto
+    PortfolioSolver::solve(Database& database, const Request& request, MatchSpecParser ms_parser)
+        -> expected_t<Outcome>
+    {
+        auto strategies = m_strategies.empty() ? default_portfolio_strategies(request.flags)
+                                               : m_strategies;
+
+        auto repos = serialize_repos(Database::Impl::get(database));
+        if (!repos)
+        {
+            return forward_error(std::move(repos));
+        }
+
+        auto out = Outcome();
+        out.attempts.reserve(strategies.size());
+        for (auto& strategy : strategies)
+        {
+            out.attempts.push_back({ std::move(strategy), nullptr, std::nullopt });
+        }
+
+        constexpr auto no_solution = std::numeric_limits<std::size_t>::max();
+        auto best_solved = std::atomic<std::size_t>(no_solution);
+        auto next = std::atomic<std::size_t>(0);
+        auto first_exception = std::exception_ptr();
+        auto exception_mutex = std::mutex();
+        auto repos_mutex = std::mutex();
+
+        // A more preferred strategy already has a solution
+        const auto is_superseded = [&](std::size_t idx) { return idx > best_solved.load(); };
+
+        const auto skip = [](Attempt& attempt)
+        {
+            attempt.database.reset();
+            attempt.outcome.reset();
+        };
+
+        // The copy is made only when the attempt starts, to not hold one database per strategy
+        const auto load_database = [&](std::size_t idx) -> expected_t<bool>
+        {
+            auto lock = std::lock_guard(repos_mutex);
+            if (is_superseded(idx))
+            {
+                return { false };
+            }
+            auto& attempt = out.attempts[idx];
+            attempt.database = std::make_unique<Database>(
+                database.channel_params(),
+                database.settings()
+            );
+            if (auto loaded = load_repos(Database::Impl::get(*attempt.database), repos.value());
+                !loaded)
+            {
+                return forward_error(std::move(loaded));
+            }
+            return { true };
+        };
+
+        const auto worker = [&]()
+        {
+            for (auto idx = next++; idx < out.attempts.size(); idx = next++)
+            {
+                if (is_superseded(idx))
+                {
+                    continue;
+                }
+                auto& attempt = out.attempts[idx];
+                auto attempt_request = request;
+                attempt_request.flags = attempt.strategy.flags;
+                try
+                {
+                    auto loaded = load_database(idx);
+                    if (!loaded)
+                    {
+                        attempt.outcome = forward_error(std::move(loaded));
+                        continue;
+                    }
+                    if (!loaded.value())
+                    {
+                        skip(attempt);
+                        continue;
+                    }
+                    attempt.outcome = Solver().solve(
+                        *attempt.database,
+                        std::move(attempt_request),
+                        ms_parser
+                    );
+                }
+                catch (...)
+                {
+                    auto lock = std::lock_guard(exception_mutex);
+                    if (!first_exception)
+                    {
+                        first_exception = std::current_exception();
+                    }
+                    continue;
+                }
+                if (attempt.outcome->has_value()
+                    && std::holds_alternative<Solution>(attempt.outcome->value()))
+                {
+                    auto current = best_solved.load();
+                    while ((idx < current) && !best_solved.compare_exchange_weak(current, idx))
+                    {
+                    }
+                }
+                if (is_superseded(idx))
+                {
+                    skip(attempt);
+                }
+            }
+        };
+
+        const std::size_t hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        const auto n_threads = std::min(
+            (m_max_threads > 0) ? m_max_threads : hardware_threads,
+            out.attempts.size()
+        );
+        auto threads = std::vector<std::thread>();
+        threads.reserve(n_threads);
+        for (std::size_t i = 1; i < n_threads; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        if (first_exception)
+        {
+            std::rethrow_exception(first_exception);
+        }
+
+        if (const auto best = best_solved.load(); best != no_solution)
+        {
+            out.solved_index = best;
+            // Attempts that finished after a more preferred solution was found
+            for (auto idx = best + 1; idx < out.attempts.size(); ++idx)
+            {
+                skip(out.attempts[idx]);
+            }
+        }
+        return { std::move(out) };
+    }
+}
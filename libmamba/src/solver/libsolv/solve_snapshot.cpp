@@ -0,0 +1,419 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/util.hpp"
+#include "mamba/solver/libsolv/solve_snapshot.hpp"
+#include "mamba/util/cfile.hpp"
+#include "solv-cpp/pool.hpp"
+#include "solv-cpp/repo.hpp"
+
+#include "solver/libsolv/helpers.hpp"
+
+namespace mamba::solver::libsolv
+{
+    NLOHMANN_JSON_SERIALIZE_ENUM(
+        MatchSpecParser,
+        {
+            { MatchSpecParser::Mixed, "mixed" },
+            { MatchSpecParser::Mamba, "mamba" },
+            { MatchSpecParser::Libsolv, "libsolv" },
+        }
+    )
+
+    namespace
+    {
+        constexpr int snapshot_format_version = 1;
+
+        template <typename Job>
+        inline constexpr auto job_type_name() -> std::string_view
+        {
+            if constexpr (std::is_same_v<Job, Request::Install>)
+            {
+                return "install";
+            }
+            else if constexpr (std::is_same_v<Job, Request::Remove>)
+            {
+                return "remove";
+            }
+            else if constexpr (std::is_same_v<Job, Request::Update>)
+            {
+                return "update";
+            }
+            else if constexpr (std::is_same_v<Job, Request::UpdateAll>)
+            {
+                return "update_all";
+            }
+            else if constexpr (std::is_same_v<Job, Request::Keep>)
+            {
+                return "keep";
+            }
+            else if constexpr (std::is_same_v<Job, Request::Freeze>)
+            {
+                return "freeze";
+            }
+            else
+            {
+                static_assert(std::is_same_v<Job, Request::Pin>);
+                return "pin";
+            }
+        }
+
+        [[nodiscard]] auto request_to_json(const Request& request) -> nlohmann::json
+        {
+            auto j = nlohmann::json::object();
+            j["flags"] = {
+                { "keep_dependencies", request.flags.keep_dependencies },
+                { "keep_user_specs", request.flags.keep_user_specs },
+                { "force_reinstall", request.flags.force_reinstall },
+                { "allow_downgrade", request.flags.allow_downgrade },
+                { "allow_uninstall", request.flags.allow_uninstall },
+                { "strict_repo_priority", request.flags.strict_repo_priority },
+                { "order_request", request.flags.order_request },
+            };
+            auto jobs = nlohmann::json::array();
+            for (const auto& job : request.jobs)
+            {
+                std::visit(
+                    [&](const auto& j_item)
+                    {
+                        using Job = std::decay_t<decltype(j_item)>;
+                        auto j_job = nlohmann::json::object();
+                        j_job["type"] = job_type_name<Job>();
+                        if constexpr (!std::is_same_v<Job, Request::UpdateAll>)
+                        {
+                            j_job["spec"] = j_item.spec.to_string();
+                        }
+                        if constexpr (std::is_same_v<Job, Request::Remove>
+                                      || std::is_same_v<Job, Request::Update>
+                                      || std::is_same_v<Job, Request::UpdateAll>)
+                        {
+                            j_job["clean_dependencies"] = j_item.clean_dependencies;
+                        }
+                        jobs.push_back(std::move(j_job));
+                    },
+                    job
+                );
+            }
+            j["jobs"] = std::move(jobs);
+            return j;
+        }
+
+        template <typename Job>
+        [[nodiscard]] auto job_from_json(const nlohmann::json& j) -> expected_t<Request::Job>
+        {
+            auto job = Job{};
+            if constexpr (!std::is_same_v<Job, Request::UpdateAll>)
+            {
+                auto spec = specs::MatchSpec::parse(j.at("spec").get<std::string>());
+                if (!spec)
+                {
+                    return make_unexpected(spec.error().what(), mamba_error_code::invalid_spec);
+                }
+                job.spec = std::move(spec).value();
+            }
+            if constexpr (std::is_same_v<Job, Request::Remove>
+                          || std::is_same_v<Job, Request::Update>
+                          || std::is_same_v<Job, Request::UpdateAll>)
+            {
+                job.clean_dependencies = j.value("clean_dependencies", job.clean_dependencies);
+            }
+            return { std::move(job) };
+        }
+
+        [[nodiscard]] auto any_job_from_json(const nlohmann::json& j) -> expected_t<Request::Job>
+        {
+            const auto type = j.at("type").get<std::string>();
+            if (type == job_type_name<Request::Install>())
+            {
+                return job_from_json<Request::Install>(j);
+            }
+            if (type == job_type_name<Request::Remove>())
+            {
+                return job_from_json<Request::Remove>(j);
+            }
+            if (type == job_type_name<Request::Update>())
+            {
+                return job_from_json<Request::Update>(j);
+            }
+            if (type == job_type_name<Request::UpdateAll>())
+            {
+                return job_from_json<Request::UpdateAll>(j);
+            }
+            if (type == job_type_name<Request::Keep>())
+            {
+                return job_from_json<Request::Keep>(j);
+            }
+            if (type == job_type_name<Request::Freeze>())
+            {
+                return job_from_json<Request::Freeze>(j);
+            }
+            if (type == job_type_name<Request::Pin>())
+            {
+                return job_from_json<Request::Pin>(j);
+            }
+            return make_unexpected(
+                fmt::format(R"(Unknown job type "{}")", type),
+                mamba_error_code::incorrect_usage
+            );
+        }
+
+        [[nodiscard]] auto request_from_json(const nlohmann::json& j) -> expected_t<Request>
+        {
+            auto request = Request();
+            const auto& flags = j.at("flags");
+            auto& out_flags = request.flags;
+            const auto read_flag = [&](const char* name, bool& flag)
+            { flag = flags.value(name, flag); };
+            read_flag("keep_dependencies", out_flags.keep_dependencies);
+            read_flag("keep_user_specs", out_flags.keep_user_specs);
+            read_flag("force_reinstall", out_flags.force_reinstall);
+            read_flag("allow_downgrade", out_flags.allow_downgrade);
+            read_flag("allow_uninstall", out_flags.allow_uninstall);
+            read_flag("strict_repo_priority", out_flags.strict_repo_priority);
+            read_flag("order_request", out_flags.order_request);
+
+            for (const auto& j_job : j.at("jobs"))
+            {
+                auto job = any_job_from_json(j_job);
+                if (!job)
+                {
+                    return forward_error(std::move(job));
+                }
+                request.jobs.push_back(std::move(job).value());
+            }
+            return { std::move(request) };
+        }
+
+        [[nodiscard]] auto repo_filename(std::size_t index) -> std::string
+        {
+            return fmt::format("repo-{}.solv", index);
+        }
+
+        [[nodiscard]] auto write_repo(
+            solv::ObjPool& pool,
+            solv::ObjRepoView repo,
+            const fs::u8path& path
+        ) -> expected_t<RepoCopyInfo>
+        {
+            const auto error = [&](std::string_view msg)
+            {
+                return make_unexpected(
+                    fmt::format(R"(Cannot write snapshot repo "{}": {})", path.string(), msg),
+                    mamba_error_code::internal_failure
+                );
+            };
+
+            auto file = util::CFile::try_open(path, "wb");
+            if (!file)
+            {
+                return error(file.error().message());
+            }
+            auto info = write_repo_copy(pool, repo, file->raw());
+            auto closed = file->try_close();
+            if (!info)
+            {
+                return error(info.error().what());
+            }
+            if (!closed)
+            {
+                return error(closed.error().message());
+            }
+            return info;
+        }
+
+        [[nodiscard]] auto
+        read_repo(solv::ObjPool& pool, const RepoCopyInfo& info, const fs::u8path& path)
+            -> expected_t<void>
+        {
+            const auto error = [&](std::string_view msg)
+            {
+                return make_unexpected(
+                    fmt::format(R"(Cannot read snapshot repo "{}": {})", path.string(), msg),
+                    mamba_error_code::repodata_not_loaded
+                );
+            };
+
+            auto file = util::CFile::try_open(path, "rb");
+            if (!file)
+            {
+                return error(file.error().message());
+            }
+            auto repo = read_repo_copy(pool, info, file->raw());
+            auto closed = file->try_close();
+            if (!repo)
+            {
+                return error(repo.error().what());
+            }
+            if (!closed)
+            {
+                return error(closed.error().message());
+            }
+            return {};
+        }
+    }
+
+    /******************************************
+     *  Implementation of SolveSnapshot       *
+     ******************************************/
+
+    auto SolveSnapshot::write(
+        Database& database,
+        const Request& request,
+        const fs::u8path& directory,
+        MatchSpecParser ms_parser
+    ) -> expected_t<void>
+    {
+        auto& pool = Database::Impl::get(database);
+
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+        if (ec)
+        {
+            return make_unexpected(
+                fmt::format(
+                    R"(Cannot create snapshot directory "{}": {})",
+                    directory.string(),
+                    ec.message()
+                ),
+                mamba_error_code::internal_failure
+            );
+        }
+
+        auto j_repos = nlohmann::json::array();
+        auto error = expected_t<void>();
+        pool.for_each_repo_id(
+            [&](solv::RepoId id)
+            {
+                auto repo = pool.get_repo(id).value();
+                auto filename = repo_filename(j_repos.size());
+                auto info = write_repo(pool, repo, directory / filename);
+                if (!info)
+                {
+                    error = forward_error(std::move(info));
+                    return solv::LoopControl::Break;
+                }
+                j_repos.push_back({
+                    { "name", std::move(info->name) },
+                    { "file", std::move(filename) },
+                    { "priority", info->priority },
+                    { "subpriority", info->subpriority },
+                    { "installed", info->installed },
+                });
+                return solv::LoopControl::Continue;
+            }
+        );
+        if (!error)
+        {
+            return error;
+        }
+
+        auto j = nlohmann::json::object();
+        j["version"] = snapshot_format_version;
+        j["matchspec_parser"] = ms_parser;
+        j["settings"] = { { "matchspec_parser", database.settings().matchspec_parser } };
+        j["request"] = request_to_json(request);
+        j["repos"] = std::move(j_repos);
+
+        auto out = open_ofstream(directory / metadata_filename);
+        out << j.dump(2);
+        if (!out)
+        {
+            return make_unexpected(
+                fmt::format(R"(Cannot write snapshot metadata in "{}")", directory.string()),
+                mamba_error_code::internal_failure
+            );
+        }
+        return {};
+    }
+
+    auto
+    SolveSnapshot::read(const fs::u8path& directory, specs::ChannelResolveParams channel_params)
+        -> expected_t<SolveSnapshot>
+    {
+        auto j = nlohmann::json();
+        try
+        {
+            auto in = open_ifstream(directory / metadata_filename);
+            j = nlohmann::json::parse(in);
+        }
+        catch (const std::exception& e)
+        {
+            return make_unexpected(
+                fmt::format(
+                    R"(Cannot read snapshot metadata in "{}": {})",
+                    directory.string(),
+                    e.what()
+                ),
+                mamba_error_code::incorrect_usage
+            );
+        }
+
+        try
+        {
+            if (const auto version = j.at("version").get<int>(); version != snapshot_format_version)
+            {
+                return make_unexpected(
+                    fmt::format("Unsupported snapshot format version {}", version),
+                    mamba_error_code::incorrect_usage
+                );
+            }
+
+            auto request = request_from_json(j.at("request"));
+            if (!request)
+            {
+                return forward_error(std::move(request));
+            }
+
+            auto settings = Database::Settings();
+            settings.matchspec_parser = j.at("settings")
+                                            .value("matchspec_parser", settings.matchspec_parser);
+            auto database = Database(std::move(channel_params), settings);
+            auto& pool = Database::Impl::get(database);
+
+            for (const auto& j_repo : j.at("repos"))
+            {
+                const auto info = RepoCopyInfo{
+                    /* .name= */ j_repo.at("name").get<std::string>(),
+                    /* .priority= */ j_repo.value("priority", 0),
+                    /* .subpriority= */ j_repo.value("subpriority", 0),
+                    /* .installed= */ j_repo.value("installed", false),
+                };
+                const auto path = directory / j_repo.at("file").get<std::string>();
+                if (auto read = read_repo(pool, info, path); !read)
+                {
+                    return forward_error(std::move(read));
+                }
+            }
+
+            return { SolveSnapshot{
+                /* .database= */ std::move(database),
+                /* .request= */ std::move(request).value(),
+                /* .matchspec_parser= */
+                j.value("matchspec_parser", MatchSpecParser::Mixed),
+            } };
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            return make_unexpected(
+                fmt::format(
+                    R"(Invalid snapshot metadata in "{}": {})",
+                    directory.string(),
+                    e.what()
+                ),
+                mamba_error_code::incorrect_usage
+            );
+        }
+    }
+}
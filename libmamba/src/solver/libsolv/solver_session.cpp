@@ -0,0 +1,434 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include <solv/pool.h>
+#include <solv/repo.h>
+
+#include "mamba/solver/libsolv/solver_session.hpp"
+#include "solv-cpp/solver.hpp"
+
+#include "solver/libsolv/helpers.hpp"
+
+namespace mamba::solver::libsolv
+{
+    namespace
+    {
+        /**
+         * The state of the solvables in the pool that the whatprovides index depends on.
+         *
+         * Libsolv does not provide a way to update the whatprovides index, but we can avoid
+         * recomputing it (and losing the cached namespace providers) when nothing has changed.
+         * The database generation catches the repositories replaced through the database,
+         * whose ids are reused by libsolv, while the layout of the repositories catches the
+         * solvables changed directly in the pool, such as the pins.
+         */
+        struct PoolFingerprint
+        {
+            struct RepoFingerprint
+            {
+                solv::RepoId id = 0;
+                int start = 0;
+                int end = 0;
+                int nsolvables = 0;
+
+                [[nodiscard]] auto operator==(const RepoFingerprint& other) const -> bool
+                {
+                    return (id == other.id) && (start == other.start) && (end == other.end)
+                           && (nsolvables == other.nsolvables);
+                }
+            };
+
+            std::vector<RepoFingerprint> repos = {};
+            std::size_t database_generation = 0;
+            int nsolvables = 0;
+            solv::RepoId installed = 0;
+
+            [[nodiscard]] static auto
+            make(const solv::ObjPool& pool, std::size_t database_generation) -> PoolFingerprint
+            {
+                auto out = PoolFingerprint();
+                out.database_generation = database_generation;
+                out.nsolvables = pool.raw()->nsolvables;
+                if (auto installed = pool.installed_repo())
+                {
+                    out.installed = installed->id();
+                }
+                out.repos.reserve(pool.repo_count());
+                pool.for_each_repo(
+                    [&](solv::ObjRepoViewConst repo)
+                    {
+                        out.repos.push_back({
+                            /* .id= */ repo.id(),
+                            /* .start= */ repo.raw()->start,
+                            /* .end= */ repo.raw()->end,
+                            /* .nsolvables= */ repo.raw()->nsolvables,
+                        });
+                    }
+                );
+                return out;
+            }
+
+            [[nodiscard]] auto operator==(const PoolFingerprint& other) const -> bool
+            {
+                return (database_generation == other.database_generation)
+                       && (nsolvables == other.nsolvables) && (installed == other.installed)
+                       && (repos == other.repos);
+            }
+        };
+
+        /**
+         * A key for jobs whose translation only depends on pool ids that are never freed.
+         *
+         * Jobs depending on the installed packages (reinstall, update with a full spec) or
+         * on the solvables added (pins) are not cached.
+         */
+        [[nodiscard]] auto
+        job_cache_key(const Request::Job& job, bool force_reinstall, MatchSpecParser parser)
+            -> std::optional<std::string>
+        {
+            return std::visit(
+                [&](const auto& j) -> std::optional<std::string>
+                {
+                    using Job = std::decay_t<decltype(j)>;
+                    auto key = std::to_string(job.index());
+                    key += '|';
+                    key += std::to_string(static_cast<int>(parser));
+                    key += '|';
+                    if constexpr (std::is_same_v<Job, Request::Pin>)
+                    {
+                        return std::nullopt;
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::UpdateAll>)
+                    {
+                        key += j.clean_dependencies ? '1' : '0';
+                        return { std::move(key) };
+                    }
+                    else
+                    {
+                        if constexpr (std::is_same_v<Job, Request::Install>)
+                        {
+                            if (force_reinstall)
+                            {
+                                return std::nullopt;
+                            }
+                        }
+                        if constexpr (std::is_same_v<Job, Request::Update>)
+                        {
+                            if (!j.spec.is_only_package_name())
+                            {
+                                return std::nullopt;
+                            }
+                        }
+                        if constexpr (
+                            std::is_same_v<Job, Request::Remove>
+                            || std::is_same_v<Job, Request::Update>
+                        )
+                        {
+                            key += j.clean_dependencies ? '1' : '0';
+                            key += '|';
+                        }
+                        key += j.spec.to_string();
+                        return { std::move(key) };
+                    }
+                },
+                job
+            );
+        }
+    }
+
+    /******************************************
+     *  Implementation of SolverSession       *
+     ******************************************/
+
+    struct SolverSession::SessionImpl
+    {
+        SessionImpl(Database& db)
+            : database(&db)
+        {
+        }
+
+        Database* database;
+        /** The installed repository created through @ref SolverSession::set_installed_packages. */
+        std::optional<RepoInfo> installed_repo = {};
+        /** The pool state when the whatprovides index was last computed. */
+        std::optional<PoolFingerprint> whatprovides_fingerprint = {};
+        /** The sorted pins represented by the pin solvables. */
+        std::optional<std::vector<std::string>> pin_specs = {};
+        std::vector<solv::SolvableId> pin_solvables = {};
+        std::unordered_map<std::string, solv::ObjQueue> job_cache = {};
+        std::size_t whatprovides_build_count = 0;
+        std::size_t job_cache_hit_count = 0;
+
+        [[nodiscard]] auto pool() -> solv::ObjPool&
+        {
+            return Database::Impl::get(*database);
+        }
+
+        void remove_pin_solvables()
+        {
+            pin_specs.reset();
+            if (pin_solvables.empty())
+            {
+                return;
+            }
+            auto& p = pool();
+            if (auto installed = p.installed_repo())
+            {
+                for (const auto id : pin_solvables)
+                {
+                    auto s = installed->get_solvable(id);
+                    if (s.has_value() && (s->type() == solv::SolvableType::Pin))
+                    {
+                        installed->remove_solvable(id, /* reuse_id= */ true);
+                    }
+                }
+                installed->internalize();
+            }
+            pin_solvables.clear();
+            // Pin solvables with reused ids may not change the fingerprint
+            whatprovides_fingerprint.reset();
+        }
+
+        [[nodiscard]] auto pins_are_valid(const std::vector<std::string>& specs) -> bool
+        {
+            if (!pin_specs.has_value() || (*pin_specs != specs))
+            {
+                return false;
+            }
+            auto installed = pool().installed_repo();
+            if (!installed.has_value())
+            {
+                return pin_solvables.empty();
+            }
+            return std::all_of(
+                pin_solvables.cbegin(),
+                pin_solvables.cend(),
+                [&](solv::SolvableId id)
+                {
+                    auto s = installed->get_solvable(id);
+                    return s.has_value() && (s->type() == solv::SolvableType::Pin);
+                }
+            );
+        }
+
+        [[nodiscard]] auto add_pins(const Request& request, solv::ObjQueue& jobs)
+            -> expected_t<void>
+        {
+            auto& p = pool();
+
+            auto specs = std::vector<std::string>();
+            for (const auto& job : request.jobs)
+            {
+                if (const auto* pin = std::get_if<Request::Pin>(&job))
+                {
+                    specs.push_back(pin->spec.to_string());
+                }
+            }
+            std::sort(specs.begin(), specs.end());
+
+            if (!pins_are_valid(specs))
+            {
+                remove_pin_solvables();
+                for (const auto& job : request.jobs)
+                {
+                    if (const auto* pin = std::get_if<Request::Pin>(&job))
+                    {
+                        // WARNING pins are not working with namespace dependencies so far
+                        auto pin_solv = pool_add_pin(p, pin->spec, MatchSpecParser::Libsolv);
+                        if (!pin_solv)
+                        {
+                            return forward_error(std::move(pin_solv));
+                        }
+                        pin_solvables.push_back(pin_solv->id());
+                    }
+                }
+                pin_specs = std::move(specs);
+            }
+
+            for (const auto id : pin_solvables)
+            {
+                add_pin_to_decision_queue(jobs, p, p.get_solvable(id).value());
+            }
+            return {};
+        }
+
+        void ensure_whatprovides()
+        {
+            auto& p = pool();
+            auto fingerprint = PoolFingerprint::make(p, Database::Impl::generation(*database));
+            const bool up_to_date = whatprovides_fingerprint.has_value()
+                                    && (*whatprovides_fingerprint == fingerprint);
+            if (!up_to_date)
+            {
+                p.create_whatprovides();
+                whatprovides_fingerprint = std::move(fingerprint);
+                ++whatprovides_build_count;
+            }
+        }
+
+        [[nodiscard]] auto
+        add_jobs(const Request& request, solv::ObjQueue& jobs, MatchSpecParser parser)
+            -> expected_t<void>
+        {
+            auto& p = pool();
+            const bool force_reinstall = request.flags.force_reinstall;
+            for (const auto& job : request.jobs)
+            {
+                if (std::holds_alternative<Request::Pin>(job))
+                {
+                    continue;
+                }
+
+                auto key = job_cache_key(job, force_reinstall, parser);
+                if (key.has_value())
+                {
+                    if (auto it = job_cache.find(*key); it != job_cache.cend())
+                    {
+                        jobs.insert(jobs.cend(), it->second.cbegin(), it->second.cend());
+                        ++job_cache_hit_count;
+                        continue;
+                    }
+                }
+
+                auto translated = solv::ObjQueue();
+                auto xpt = add_request_job_to_decision_queue(
+                    job,
+                    translated,
+                    p,
+                    force_reinstall,
+                    parser
+                );
+                if (!xpt)
+                {
+                    return forward_error(std::move(xpt));
+                }
+                jobs.insert(jobs.cend(), translated.cbegin(), translated.cend());
+                if (key.has_value())
+                {
+                    job_cache.emplace(std::move(*key), std::move(translated));
+                }
+            }
+            return {};
+        }
+    };
+
+    SolverSession::SolverSession(Database& database)
+        : m_data(std::make_unique<SessionImpl>(database))
+    {
+    }
+
+    SolverSession::SolverSession(SolverSession&&) = default;
+
+    SolverSession::~SolverSession() = default;
+
+    auto SolverSession::operator=(SolverSession&&) -> SolverSession& = default;
+
+    auto SolverSession::database() -> Database&
+    {
+        return *m_data->database;
+    }
+
+    auto SolverSession::database() const -> const Database&
+    {
+        return *m_data->database;
+    }
+
+    void SolverSession::remove_session_installed_repo()
+    {
+        if (m_data->installed_repo.has_value())
+        {
+            database().remove_repo(*m_data->installed_repo);
+            m_data->installed_repo.reset();
+        }
+        // The pin solvables were in the removed repository
+        m_data->pin_solvables.clear();
+        m_data->pin_specs.reset();
+        m_data->whatprovides_fingerprint.reset();
+    }
+
+    void SolverSession::set_session_installed_repo(RepoInfo repo)
+    {
+        database().set_installed_repo(repo);
+        m_data->installed_repo = repo;
+    }
+
+    void SolverSession::invalidate()
+    {
+        m_data->remove_pin_solvables();
+        m_data->whatprovides_fingerprint.reset();
+        m_data->job_cache.clear();
+    }
+
+    auto SolverSession::whatprovides_build_count() const -> std::size_t
+    {
+        return m_data->whatprovides_build_count;
+    }
+
+    auto SolverSession::job_cache_hit_count() const -> std::size_t
+    {
+        return m_data->job_cache_hit_count;
+    }
+
+    auto SolverSession::solve_impl(const Request& request, MatchSpecParser ms_parser)
+        -> expected_t<Outcome>
+    {
+        auto& pool = m_data->pool();
+        auto jobs = solv::ObjQueue();
+
+        // Pins add solvables to the pool and must be added before the whatprovides index
+        // is computed.
+        return m_data->add_pins(request, jobs)
+            .and_then(
+                [&]()
+                {
+                    m_data->ensure_whatprovides();
+                    return m_data->add_jobs(request, jobs, ms_parser);
+                }
+            )
+            .transform(
+                [&]() -> Outcome
+                {
+                    auto solver = std::make_unique<solv::ObjSolver>(pool);
+                    set_solver_flags(*solver, request.flags);
+                    const bool success = solver->solve(pool, jobs);
+                    if (!success)
+                    {
+                        return { UnSolvable(std::move(solver)) };
+                    }
+                    return { solver_to_solution(pool, *solver, request) };
+                }
+            );
+    }
+
+    auto SolverSession::solve(Request&& request, MatchSpecParser ms_parser) -> expected_t<Outcome>
+    {
+        if (request.flags.order_request)
+        {
+            sort_request_jobs(request.jobs);
+        }
+        return solve_impl(request, ms_parser);
+    }
+
+    auto SolverSession::solve(const Request& request, MatchSpecParser ms_parser)
+        -> expected_t<Outcome>
+    {
+        if (request.flags.order_request)
+        {
+            auto sorted_request = request;
+            sort_request_jobs(sorted_request.jobs);
+            return solve_impl(sorted_request, ms_parser);
+        }
+        return solve_impl(request, ms_parser);
+    }
+}
@@ -5,6 +5,7 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <algorithm>
+#include <chrono>
 #include <functional>
 #include <limits>
 #include <map>
@@ -13,6 +14,7 @@
 #include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include <fmt/color.h>
@@ -21,6 +23,7 @@
 
 #include "mamba/solver/problems_graph.hpp"
 #include "mamba/util/string.hpp"
+#include "mamba/util/tuple_hash.hpp"
 
 namespace mamba::solver
 {
@@ -379,32 +382,137 @@ namespace mamba::solver
         }
 
         /**
-         * The criteria for deciding whether to merge two nodes together.
+         * The data used by the default criteria for deciding whether to merge two nodes.
+         *
+         * Two nodes are merged if they have the same type and name, are not in conflict, and
+         *   - either are both leaves with the same parents (meaning parents can "inject"
+         *     themselves into a bigger problem);
+         *   - or are both not leaves and lead to the same leaves (we don't compare leaves on
+         *     leaves because they resolve to themselves, preventing any merging).
+         *
+         * Apart from the conflicts, this is an equivalence relation, so rather than comparing
+         * nodes pairwise, nodes are grouped by hashing this key and the leaves reachable from
+         * every node are computed only once.
          */
-        auto default_merge_criteria(
-            const ProblemsGraph& pbs,
-            ProblemsGraph::node_id n1,
-            ProblemsGraph::node_id n2
-        ) -> bool
+        struct MergeKey
         {
             using node_id = ProblemsGraph::node_id;
+
+            std::string_view name;
+            /** The parents of a leaf, or the leaves reachable from any other node. */
+            std::vector<node_id> related;
+            std::size_t type_index;
+            bool leaf;
+
+            [[nodiscard]] static auto make(const ProblemsGraph::graph_t& g, node_id n) -> MergeKey
+            {
+                auto key = MergeKey{
+                    /* .name= */ node_name(g.node(n)),
+                    /* .related= */ {},
+                    /* .type_index= */ g.node(n).index(),
+                    /* .leaf= */ g.successors(n).empty(),
+                };
+                if (key.leaf)
+                {
+                    const auto& parents = g.predecessors(n);
+                    key.related.assign(parents.begin(), parents.end());
+                }
+                else
+                {
+                    g.for_each_leaf_id_from(n, [&](node_id m) { key.related.push_back(m); });
+                    std::sort(key.related.begin(), key.related.end());
+                    key.related.erase(
+                        std::unique(key.related.begin(), key.related.end()),
+                        key.related.end()
+                    );
+                }
+                return key;
+            }
+
+            [[nodiscard]] auto operator==(const MergeKey& other) const -> bool = default;
+        };
+
+        struct MergeKeyHash
+        {
+            auto operator()(const MergeKey& key) const -> std::size_t
+            {
+                return util::hash_combine(
+                    util::hash_vals(key.name, key.type_index, key.leaf),
+                    util::hash_range(key.related)
+                );
+            }
+        };
+
+        /**
+         * Merge node indices for a given type of node with the default criteria.
+         *
+         * Give the same partition as ``merge_node_indices_for_one_node_type`` with the default
+         * criteria, but in a time linear in the number of nodes when there are few conflicts.
+         * Nodes are grouped in the same order, each group being seeded by its first node and
+         * excluding later nodes in conflict with that seed.
+         *
+         * @see MergeKey
+         */
+        auto merge_node_indices_for_one_node_type_by_key(
+            const ProblemsGraph& pbs,
+            const std::vector<ProblemsGraph::node_id>& node_indices
+        ) -> std::vector<old_node_id_list>
+        {
             const auto& g = pbs.graph();
-            auto is_leaf = [&g](node_id n) -> bool { return g.successors(n).size() == 0; };
-            auto leaves_from = [&g](node_id n) -> util::flat_set<node_id>
+            const std::size_t n_nodes = node_indices.size();
+
+            auto buckets = std::unordered_map<MergeKey, std::vector<std::size_t>, MergeKeyHash>();
+            buckets.reserve(n_nodes);
+            auto node_bucket = std::vector<const std::vector<std::size_t>*>(n_nodes, nullptr);
+            for (std::size_t i = 0; i < n_nodes; ++i)
             {
-                auto leaves = std::vector<node_id>();
-                g.for_each_leaf_id_from(n, [&leaves](node_id m) { leaves.push_back(m); });
-                return util::flat_set(std::move(leaves));
-            };
-            return (node_name(g.node(n1)) == node_name(g.node(n2)))
-                   // Merging conflicts would be counter-productive in explaining problems
-                   && !(pbs.conflicts().in_conflict(n1, n2))
-                   // We don't want to use leaves_from for leaves because it resolve to themselves,
-                   // preventing any merging.
-                   && ((is_leaf(n1) && is_leaf(n2)) || (leaves_from(n1) == leaves_from(n2)))
-                   // We only check the parents for leaves meaning parents can "inject"
-                   // themselves into a bigger problem
-                   && ((!is_leaf(n1) && !is_leaf(n2)) || (g.predecessors(n1) == g.predecessors(n2)));
+                auto& bucket = buckets[MergeKey::make(g, node_indices[i])];
+                bucket.push_back(i);
+                // Pointers to values are stable in an unordered_map
+                node_bucket[i] = &bucket;
+            }
+
+            std::vector<old_node_id_list> groups{};
+            std::vector<bool> node_added_to_a_group(n_nodes, false);
+            for (std::size_t i = 0; i < n_nodes; ++i)
+            {
+                if (node_added_to_a_group[i])
+                {
+                    continue;
+                }
+                const auto id_i = node_indices[i];
+                auto current_group = old_node_id_list{ id_i };
+                node_added_to_a_group[i] = true;
+                for (const std::size_t j : *node_bucket[i])
+                {
+                    const auto id_j = node_indices[j];
+                    if ((j > i) && !node_added_to_a_group[j]
+                        // Merging conflicts would be counter-productive in explaining problems
+                        && !pbs.conflicts().in_conflict(id_i, id_j))
+                    {
+                        current_group.push_back(id_j);
+                        node_added_to_a_group[j] = true;
+                    }
+                }
+                groups.push_back(std::move(current_group));
+            }
+            return groups;
+        }
+
+        auto merge_node_indices_by_key(
+            const ProblemsGraph& pbs,
+            const node_type_list<old_node_id_list>& nodes_by_type
+        ) -> node_type_list<std::vector<old_node_id_list>>
+        {
+            node_type_list<std::vector<old_node_id_list>> groups(nodes_by_type.size());
+            std::transform(
+                nodes_by_type.begin(),
+                nodes_by_type.end(),
+                groups.begin(),
+                [&](const auto& node_indices)
+                { return merge_node_indices_for_one_node_type_by_key(pbs, node_indices); }
+            );
+            return groups;
         }
 
         using node_id_mapping = std::map<ProblemsGraph::node_id, CompressedProblemsGraph::node_id>;
@@ -447,15 +555,15 @@ namespace mamba::solver
         /**
          * Merge nodes together.
          *
-         * Merge by applying the @p merge_criteria to nodes that hold the same type in the variant.
-         *
-         * @param merge_criteria A binary function that decides whether two nodes should be merged
-         * together. The function is assumed to be symmetric and transitive.
+         * @param old_ids_groups For each node type, a partition of the node indices to merge
+         * together.
          * @return A tuple of the graph with newly created nodes (without edges), the new root node,
          * and a mapping between old node ids and new node ids.
          */
-        template <typename CompFunc>
-        auto merge_nodes(const ProblemsGraph& pbs, CompFunc&& merge_criteria)
+        auto merge_nodes(
+            const ProblemsGraph& pbs,
+            const node_type_list<std::vector<old_node_id_list>>& old_ids_groups
+        )
             -> std::tuple<CompressedProblemsGraph::graph_t, CompressedProblemsGraph::node_id, node_id_mapping>
         {
             const auto& old_graph = pbs.graph();
@@ -464,11 +572,6 @@ namespace mamba::solver
 
             auto old_to_new = node_id_mapping{};
 
-            auto old_ids_groups = merge_node_indices(
-                node_id_by_type(pbs.graph()),
-                std::forward<CompFunc>(merge_criteria)
-            );
-
             {
                 using Node = ProblemsGraph::RootNode;
                 [[maybe_unused]] static constexpr auto type_idx = variant_type_index<
@@ -575,13 +678,13 @@ namespace mamba::solver
             auto merge_func =
                 [&pbs, &merge_criteria](ProblemsGraph::node_id n1, ProblemsGraph::node_id n2)
             { return merge_criteria(pbs, n1, n2); };
-            std::tie(graph, root_node, old_to_new) = merge_nodes(pbs, merge_func);
+            const auto groups = merge_node_indices(node_id_by_type(pbs.graph()), merge_func);
+            std::tie(graph, root_node, old_to_new) = merge_nodes(pbs, groups);
         }
         else
         {
-            auto merge_func = [&pbs](ProblemsGraph::node_id n1, ProblemsGraph::node_id n2)
-            { return default_merge_criteria(pbs, n1, n2); };
-            std::tie(graph, root_node, old_to_new) = merge_nodes(pbs, merge_func);
+            const auto groups = merge_node_indices_by_key(pbs, node_id_by_type(pbs.graph()));
+            std::tie(graph, root_node, old_to_new) = merge_nodes(pbs, groups);
         }
         merge_edges(pbs.graph(), graph, old_to_new);
         auto conflicts = merge_conflicts(pbs.conflicts(), old_to_new);
@@ -1563,9 +1666,27 @@ namespace mamba::solver
 
         void TreeExplainer::write_path(const std::vector<TreeNode>& path)
         {
+            using clock = std::chrono::steady_clock;
+            const auto start = clock::now();
+            const auto budget_exceeded = [&](std::size_t i) -> bool
+            {
+                if ((m_format.max_lines > 0) && (i >= m_format.max_lines))
+                {
+                    return true;
+                }
+                return (m_format.time_budget.count() > 0)
+                       && ((clock::now() - start) > m_format.time_budget);
+            };
+
             const std::size_t length = path.size();
             for (std::size_t i = 0; i < length; ++i)
             {
+                // The root line is always written, the message would be meaningless otherwise.
+                if ((i > 0) && budget_exceeded(i))
+                {
+                    write("... and ", length - i, " more (explanation truncated).");
+                    return;
+                }
                 const bool last = (i == length - 1);
                 const auto& tn = path[i];
                 write_ancestry(tn.ancestry);
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <array>
+#include <limits>
 #include <type_traits>
 #include <variant>
 
@@ -13,6 +14,7 @@
 #include <fmt/ranges.h>
 
 #include "mamba/specs/version_spec.hpp"
+#include "mamba/util/cast.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/util/tuple_hash.hpp"
 
@@ -798,6 +800,210 @@ namespace mamba::specs
         return { VersionSpec{ std::move(parser).tree() } };
     }
 
+    /*******************************
+     *  VersionKey Implementation  *
+     *******************************/
+
+    auto VersionKey::make(const Version& version) -> std::optional<VersionKey>
+    {
+        static constexpr std::size_t max_value = std::numeric_limits<std::uint32_t>::max();
+        static constexpr std::size_t max_written = std::numeric_limits<std::uint8_t>::max();
+
+        const auto& parts = version.version();
+        if (!version.local().empty() || (version.epoch() > max_value)
+            || (parts.size() > max_written))
+        {
+            return std::nullopt;
+        }
+
+        auto key = VersionKey();
+        key.m_values[0] = static_cast<std::uint32_t>(version.epoch());
+        key.m_written_parts = static_cast<std::uint8_t>(parts.size());
+        for (std::size_t i = 0; i < parts.size(); ++i)
+        {
+            const auto& atoms = parts[i].atoms;
+            if ((atoms.size() != 1) || !atoms.front().literal().empty()
+                || (atoms.front().numeral() > max_value))
+            {
+                return std::nullopt;
+            }
+            const auto numeral = static_cast<std::uint32_t>(atoms.front().numeral());
+            if (i < max_parts)
+            {
+                key.m_values[i + 1] = numeral;
+            }
+            // Trailing zeros compare equal to missing parts so they can be dropped
+            else if (numeral != 0)
+            {
+                return std::nullopt;
+            }
+        }
+        return { key };
+    }
+
+    auto VersionKey::starts_with(const VersionKey& prefix) const noexcept -> bool
+    {
+        // Missing parts in this version are zeros, which is how ``Version::starts_with``
+        // compares a prefix longer than the version.
+        // Prefix parts over ``max_parts`` are zeros, as are the ones of this version.
+        const auto n_parts = std::min<std::size_t>(prefix.m_written_parts, max_parts);
+        const auto first = m_values.cbegin();
+        const auto last = first + 1 + static_cast<std::ptrdiff_t>(n_parts);
+        return std::equal(first, last, prefix.m_values.cbegin());
+    }
+
+    /****************************************
+     *  CompiledVersionSpec Implementation  *
+     ****************************************/
+
+    CompiledVersionSpec::CompiledVersionSpec(const VersionSpec& spec)
+    {
+        m_program.reserve(spec.expression_size());
+        m_predicates.reserve(spec.expression_size());
+
+        spec.m_tree.for_each_jump(
+            [&](const VersionPredicate& pred, std::size_t on_true, std::size_t on_false)
+            {
+                auto instr = Instruction{};
+                instr.predicate = util::safe_num_cast<std::uint32_t>(m_predicates.size());
+                instr.on_true = util::safe_num_cast<std::uint32_t>(on_true);
+                instr.on_false = util::safe_num_cast<std::uint32_t>(on_false);
+                instr.opcode = std::visit(
+                    [](const auto& op) -> OpCode
+                    {
+                        using Op = std::decay_t<decltype(op)>;
+                        if constexpr (std::is_same_v<Op, VersionPredicate::free_interval>)
+                        {
+                            return OpCode::free;
+                        }
+                        else if constexpr (std::is_same_v<Op, std::equal_to<Version>>)
+                        {
+                            return OpCode::key_equal;
+                        }
+                        else if constexpr (std::is_same_v<Op, std::not_equal_to<Version>>)
+                        {
+                            return OpCode::key_not_equal;
+                        }
+                        else if constexpr (std::is_same_v<Op, std::greater<Version>>)
+                        {
+                            return OpCode::key_greater;
+                        }
+                        else if constexpr (std::is_same_v<Op, std::greater_equal<Version>>)
+                        {
+                            return OpCode::key_greater_equal;
+                        }
+                        else if constexpr (std::is_same_v<Op, std::less<Version>>)
+                        {
+                            return OpCode::key_less;
+                        }
+                        else if constexpr (std::is_same_v<Op, std::less_equal<Version>>)
+                        {
+                            return OpCode::key_less_equal;
+                        }
+                        else if constexpr (std::is_same_v<Op, VersionPredicate::starts_with>)
+                        {
+                            return OpCode::key_starts_with;
+                        }
+                        else if constexpr (std::is_same_v<Op, VersionPredicate::not_starts_with>)
+                        {
+                            return OpCode::key_not_starts_with;
+                        }
+                        else
+                        {
+                            return OpCode::generic;
+                        }
+                    },
+                    pred.m_operator
+                );
+
+                if ((instr.opcode != OpCode::free) && (instr.opcode != OpCode::generic))
+                {
+                    if (auto key = VersionKey::make(pred.m_version))
+                    {
+                        instr.operand = key.value();
+                    }
+                    else
+                    {
+                        instr.opcode = OpCode::generic;
+                    }
+                }
+
+                m_predicates.push_back(pred);
+                m_program.push_back(instr);
+            }
+        );
+    }
+
+    auto CompiledVersionSpec::execute(
+        const Instruction& instr,
+        const Version& point,
+        const std::optional<VersionKey>& point_key
+    ) const -> bool
+    {
+        if (instr.opcode == OpCode::free)
+        {
+            return true;
+        }
+        if ((instr.opcode == OpCode::generic) || !point_key.has_value())
+        {
+            return m_predicates[instr.predicate].contains(point);
+        }
+
+        const auto& key = point_key.value();
+        switch (instr.opcode)
+        {
+            case (OpCode::key_equal):
+                return key == instr.operand;
+            case (OpCode::key_not_equal):
+                return key != instr.operand;
+            case (OpCode::key_greater):
+                return key > instr.operand;
+            case (OpCode::key_greater_equal):
+                return key >= instr.operand;
+            case (OpCode::key_less):
+                return key < instr.operand;
+            case (OpCode::key_less_equal):
+                return key <= instr.operand;
+            case (OpCode::key_starts_with):
+                return key.starts_with(instr.operand);
+            case (OpCode::key_not_starts_with):
+                return !key.starts_with(instr.operand);
+            default:
+                return m_predicates[instr.predicate].contains(point);
+        }
+    }
+
+    auto CompiledVersionSpec::contains(const Version& point) const -> bool
+    {
+        return contains(point, VersionKey::make(point));
+    }
+
+    auto CompiledVersionSpec::contains(
+        const Version& point,
+        const std::optional<VersionKey>& point_key
+    ) const -> bool
+    {
+        // Same as an empty expression tree
+        if (m_program.empty())
+        {
+            return true;
+        }
+
+        auto pos = std::size_t(0);
+        while (pos < m_program.size())
+        {
+            const auto& instr = m_program[pos];
+            pos = execute(instr, point, point_key) ? instr.on_true : instr.on_false;
+        }
+        // Jumping to the end means the expression is true, one past the end that it is false.
+        return pos == m_program.size();
+    }
+
+    auto CompiledVersionSpec::program_size() const -> std::size_t
+    {
+        return m_program.size();
+    }
+
     namespace version_spec_literals
     {
         auto operator""_vs(const char* str, std::size_t len) -> VersionSpec
@@ -6,14 +6,18 @@
 
 #include <string>
 
+#include <nlohmann/json.hpp>
+
 #include "mamba/core/context.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/timeref.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/download/downloader.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/validation/errors.hpp"
 #include "mamba/validation/repo_checker.hpp"
+#include "mamba/validation/tools.hpp"
 #include "mamba/validation/update_framework.hpp"
 #include "mamba/validation/update_framework_v0_6.hpp"
 #include "mamba/validation/update_framework_v1.hpp"
@@ -56,7 +60,21 @@ namespace mamba::validation
     {
         if (p_index_checker)
         {
+            // An index is only verified again when it or the keys changed
+            const bool can_cache = !verified_indexes_file().empty()
+                                   && !p_index_checker->keys_fingerprint().empty()
+                                   && fs::exists(p);
+            const std::string index_hash = can_cache ? sha256sum(p) : "";
+            if (can_cache && is_verified_index(p, index_hash))
+            {
+                LOG_DEBUG << "Package index '" << p.string() << "' already verified";
+                return;
+            }
             p_index_checker->verify_index(p);
+            if (can_cache)
+            {
+                record_verified_index(p, index_hash);
+            }
         }
         else
         {
@@ -92,6 +110,31 @@ namespace mamba::validation
         }
     }
 
+    void RepoChecker::verify_packages(
+        const std::vector<std::pair<nlohmann::json, std::string_view>>& packages
+    ) const
+    {
+        if (!p_index_checker)
+        {
+            LOG_ERROR << "Index checker not valid.";
+            return;
+        }
+
+        std::vector<RepoIndexChecker::signed_package> parsed;
+        parsed.reserve(packages.size());
+        for (const auto& [signed_data, signatures] : packages)
+        {
+            if (signatures.empty())
+            {
+                LOG_ERROR << "The given package signatures are empty";
+                throw signatures_error();
+            }
+            parsed.emplace_back(signed_data, nlohmann::json::parse(signatures));
+        }
+        LOG_INFO << "Verifying " << parsed.size() << " package(s)...";
+        p_index_checker->verify_packages(parsed);
+    }
+
     void RepoChecker::generate_index_checker()
     {
         if (!p_index_checker)
@@ -165,6 +208,76 @@ namespace mamba::validation
         }
     }
 
+    auto RepoChecker::verified_indexes_file() const -> fs::u8path
+    {
+        if (cache_path().empty())
+        {
+            return "";
+        }
+        return cache_path() / "verified_indexes.json";
+    }
+
+    auto RepoChecker::is_verified_index(const fs::u8path& p, const std::string& index_hash) const
+        -> bool
+    {
+        const auto file = verified_indexes_file();
+        if (!fs::exists(file))
+        {
+            return false;
+        }
+        try
+        {
+            auto in = open_ifstream(file);
+            const auto indexes = nlohmann::json::parse(in);
+            const auto it = indexes.find(p.string());
+            return it != indexes.end() && it->value("sha256", "") == index_hash
+                   && it->value("keys", "") == p_index_checker->keys_fingerprint();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Could not read verified indexes from '" << file.string()
+                      << "': " << e.what();
+            return false;
+        }
+    }
+
+    void
+    RepoChecker::record_verified_index(const fs::u8path& p, const std::string& index_hash) const
+    {
+        const auto file = verified_indexes_file();
+        try
+        {
+            auto indexes = nlohmann::json::object();
+            if (fs::exists(file))
+            {
+                auto in = open_ifstream(file);
+                indexes = nlohmann::json::parse(in, nullptr, false);
+                if (!indexes.is_object())
+                {
+                    indexes = nlohmann::json::object();
+                }
+            }
+            indexes[p.string()] = {
+                { "sha256", index_hash },
+                { "keys", p_index_checker->keys_fingerprint() },
+            };
+            fs::create_directories(file.parent_path());
+            // Concurrent processes each write their own temporary file
+            const auto tmp_file = file.string() + ".tmp."
+                                  + util::generate_random_alphanumeric_string(8);
+            {
+                auto out = open_ofstream(tmp_file);
+                out << indexes.dump(2);
+            }
+            fs::rename(tmp_file, file);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Could not record verified index to '" << file.string()
+                      << "': " << e.what();
+        }
+    }
+
     void RepoChecker::persist_file(const fs::u8path& file_path)
     {
         if (fs::exists(cached_root()))
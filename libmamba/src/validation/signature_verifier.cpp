@@ -0,0 +1,244 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include <openssl/evp.h>
+
+#include "mamba/core/output.hpp"
+#include "mamba/validation/errors.hpp"
+#include "mamba/validation/signature_verifier.hpp"
+#include "mamba/validation/tools.hpp"
+
+namespace mamba::validation
+{
+    struct SignatureVerifier::PublicKey
+    {
+        std::unique_ptr<::EVP_PKEY, decltype(&::EVP_PKEY_free)> key;
+    };
+
+    namespace
+    {
+        auto parse_public_key(const std::string& key_hex) -> ::EVP_PKEY*
+        {
+            int error = 0;
+            auto key_bin = ed25519_key_hex_to_bytes(key_hex, error);
+            if (error != 0)
+            {
+                LOG_DEBUG << "Invalid public key '" << key_hex << "'";
+                return nullptr;
+            }
+            return ::EVP_PKEY_new_raw_public_key(
+                EVP_PKEY_ED25519,
+                nullptr,
+                reinterpret_cast<const unsigned char*>(key_bin.data()),
+                MAMBA_ED25519_KEYSIZE_BYTES
+            );
+        }
+
+        auto verify_with_key(
+            ::EVP_PKEY* key,
+            const std::byte* data,
+            std::size_t data_len,
+            const std::array<std::byte, MAMBA_ED25519_SIGSIZE_BYTES>& signature
+        ) -> bool
+        {
+            // The context is reset rather than reallocated for each signature
+            thread_local auto md_ctx = std::unique_ptr<::EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>(
+                ::EVP_MD_CTX_new(),
+                &::EVP_MD_CTX_free
+            );
+            ::EVP_MD_CTX_reset(md_ctx.get());
+            if (::EVP_DigestVerifyInit(md_ctx.get(), nullptr, nullptr, nullptr, key) != 1)
+            {
+                LOG_DEBUG << "Failed to init verification step";
+                return false;
+            }
+            return ::EVP_DigestVerify(
+                       md_ctx.get(),
+                       reinterpret_cast<const unsigned char*>(signature.data()),
+                       signature.size(),
+                       reinterpret_cast<const unsigned char*>(data),
+                       data_len
+                   )
+                   == 1;
+        }
+    }
+
+    SignatureVerifier::SignatureVerifier(const RoleFullKeys& keyring)
+        : m_threshold(keyring.threshold)
+    {
+        for (const auto& [keyid, key] : keyring.keys)
+        {
+            ::EVP_PKEY* parsed = parse_public_key(key.keyval);
+            if (parsed == nullptr)
+            {
+                LOG_DEBUG << "Failed to read public key of keyid: " << keyid;
+                continue;
+            }
+            m_keys.emplace(
+                keyid,
+                std::make_unique<PublicKey>(PublicKey{ { parsed, &::EVP_PKEY_free } })
+            );
+        }
+    }
+
+    SignatureVerifier::~SignatureVerifier() = default;
+
+    SignatureVerifier::SignatureVerifier(SignatureVerifier&&) noexcept = default;
+
+    auto SignatureVerifier::operator=(SignatureVerifier&&) noexcept -> SignatureVerifier& = default;
+
+    auto SignatureVerifier::threshold() const -> std::size_t
+    {
+        return m_threshold;
+    }
+
+    auto
+    SignatureVerifier::is_valid(std::string_view signed_data, const RoleSignature& signature) const
+        -> bool
+    {
+        auto it = m_keys.find(signature.keyid);
+        if (it == m_keys.end())
+        {
+            LOG_WARNING << "Invalid keyid: " << signature.keyid;
+            return false;
+        }
+
+        int error = 0;
+        const auto sig_bin = ed25519_sig_hex_to_bytes(signature.sig, error);
+        if (error != 0)
+        {
+            LOG_DEBUG << "Invalid signature '" << signature.sig << "' for keyid '"
+                      << signature.keyid << "'";
+            return false;
+        }
+
+        ::EVP_PKEY* key = it->second->key.get();
+        if (signature.pgp_trailer.empty())
+        {
+            return verify_with_key(
+                key,
+                reinterpret_cast<const std::byte*>(signed_data.data()),
+                signed_data.size(),
+                sig_bin
+            );
+        }
+
+        const auto hash = pgp_v4_hashed_msg(signed_data, signature.pgp_trailer, error);
+        return (error == 0) && verify_with_key(key, hash.data(), hash.size(), sig_bin);
+    }
+
+    auto SignatureVerifier::count_valid_signatures(
+        std::string_view signed_data,
+        const std::set<RoleSignature>& signatures
+    ) const -> std::size_t
+    {
+        std::size_t valid_sig = 0;
+        for (const auto& s : signatures)
+        {
+            if (valid_sig >= m_threshold)
+            {
+                break;
+            }
+            if (is_valid(signed_data, s))
+            {
+                ++valid_sig;
+            }
+            else if (m_keys.count(s.keyid) > 0)
+            {
+                LOG_WARNING << "Invalid signature of metadata using keyid: " << s.keyid;
+            }
+        }
+        return valid_sig;
+    }
+
+    void SignatureVerifier::check_signatures(
+        std::string_view signed_data,
+        const std::set<RoleSignature>& signatures
+    ) const
+    {
+        const std::size_t valid_sig = count_valid_signatures(signed_data, signatures);
+        if (valid_sig < m_threshold)
+        {
+            LOG_ERROR << "Threshold of valid signatures is not met (" << valid_sig << "/"
+                      << m_threshold << ")";
+            throw threshold_error();
+        }
+    }
+
+    auto
+    find_invalid_in_parallel(std::size_t count, const std::function<bool(std::size_t)>& is_valid)
+        -> std::vector<std::size_t>
+    {
+        // Each thread takes batches of items, so that small counts stay on this thread
+        constexpr std::size_t batch_size = 64;
+        const std::size_t batch_count = (count + batch_size - 1) / batch_size;
+        const std::size_t thread_count = std::min<std::size_t>(
+            std::max(std::thread::hardware_concurrency(), 1u),
+            batch_count
+        );
+
+        std::atomic<std::size_t> next_batch = 0;
+        std::mutex mutex;
+        std::vector<std::size_t> invalid;
+        std::exception_ptr error = nullptr;
+
+        const auto work = [&]
+        {
+            std::vector<std::size_t> local_invalid;
+            try
+            {
+                for (std::size_t batch = next_batch++; batch < batch_count; batch = next_batch++)
+                {
+                    const std::size_t end = std::min(count, (batch + 1) * batch_size);
+                    for (std::size_t i = batch * batch_size; i < end; ++i)
+                    {
+                        if (!is_valid(i))
+                        {
+                            local_invalid.push_back(i);
+                        }
+                    }
+                }
+            }
+            catch (...)
+            {
+                // The other threads stop at their next batch
+                next_batch = batch_count;
+                std::lock_guard lock(mutex);
+                if (error == nullptr)
+                {
+                    error = std::current_exception();
+                }
+            }
+            std::lock_guard lock(mutex);
+            invalid.insert(invalid.end(), local_invalid.begin(), local_invalid.end());
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count > 0 ? thread_count - 1 : 0);
+        for (std::size_t i = 1; i < thread_count; ++i)
+        {
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        if (error != nullptr)
+        {
+            std::rethrow_exception(error);
+        }
+        std::sort(invalid.begin(), invalid.end());
+        return invalid;
+    }
+}
@@ -4,6 +4,7 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <memory>
 #include <regex>
 #include <utility>
 
@@ -220,13 +221,19 @@ namespace mamba::validation
     verify(const std::byte* data, std::size_t data_len, const std::byte* pk, const std::byte* signature)
         -> int
     {
-        ::EVP_PKEY* ed_key = ::EVP_PKEY_new_raw_public_key(
-            EVP_PKEY_ED25519,
-            nullptr,
-            reinterpret_cast<const unsigned char*>(pk),
-            MAMBA_ED25519_KEYSIZE_BYTES
+        auto ed_key = std::unique_ptr<::EVP_PKEY, decltype(&::EVP_PKEY_free)>(
+            ::EVP_PKEY_new_raw_public_key(
+                EVP_PKEY_ED25519,
+                nullptr,
+                reinterpret_cast<const unsigned char*>(pk),
+                MAMBA_ED25519_KEYSIZE_BYTES
+            ),
+            &::EVP_PKEY_free
+        );
+        auto md_ctx = std::unique_ptr<::EVP_MD_CTX, decltype(&::EVP_MD_CTX_free)>(
+            ::EVP_MD_CTX_new(),
+            &::EVP_MD_CTX_free
         );
-        ::EVP_MD_CTX* md_ctx = ::EVP_MD_CTX_new();
 
         if (ed_key == nullptr)
         {
@@ -235,7 +242,7 @@ namespace mamba::validation
         }
 
         int init_status, verif_status;
-        init_status = ::EVP_DigestVerifyInit(md_ctx, nullptr, nullptr, nullptr, ed_key);
+        init_status = ::EVP_DigestVerifyInit(md_ctx.get(), nullptr, nullptr, nullptr, ed_key.get());
         if (init_status != 1)
         {
             LOG_DEBUG << "Failed to init verification step";
@@ -244,7 +251,7 @@ namespace mamba::validation
 
         std::size_t sig_len = MAMBA_ED25519_SIGSIZE_BYTES;
         verif_status = ::EVP_DigestVerify(
-            md_ctx,
+            md_ctx.get(),
             reinterpret_cast<const unsigned char*>(signature),
             sig_len,
             reinterpret_cast<const unsigned char*>(data),
@@ -256,7 +263,6 @@ namespace mamba::validation
             return verif_status;
         }
 
-        ::EVP_MD_CTX_free(md_ctx);
         return 1;
     }
 
@@ -323,42 +329,26 @@ namespace mamba::validation
         return verify_gpg_hashed_msg(data, pk_bin.data(), signature_bin.data());
     }
 
-    auto verify_gpg(
-        const std::string& data,
-        const std::string& pgp_v4_trailer,
-        const std::string& pk,
-        const std::string& signature
-    ) -> int
+    auto pgp_v4_hashed_msg(std::string_view data, const std::string& pgp_v4_trailer, int& error_code)
+        -> std::array<std::byte, MAMBA_SHA256_SIZE_BYTES>
     {
-        unsigned long long data_len = data.size();
-        auto data_bin = reinterpret_cast<const std::byte*>(data.data());
-
-        int error = 0;
-        auto signature_bin = ed25519_sig_hex_to_bytes(signature, error);
-        if (error)
-        {
-            return error;
-        }
-        auto pk_bin = ed25519_key_hex_to_bytes(pk, error);
-        if (error)
-        {
-            return error;
-        }
+        std::array<std::byte, MAMBA_SHA256_SIZE_BYTES> hash = {};
 
         std::size_t trailer_hex_size = pgp_v4_trailer.size();
         if (trailer_hex_size % 2 != 0)
         {
             LOG_DEBUG << "PGP V4 trailer size is not even: " << pgp_v4_trailer;
-            return 0;
+            error_code = 1;
+            return hash;
         }
 
-        auto pgp_trailer_bin = hex_to_bytes_vec(pgp_v4_trailer, error);
-        if (error)
+        auto pgp_trailer_bin = hex_to_bytes_vec(pgp_v4_trailer, error_code);
+        if (error_code)
         {
-            return error;
+            return hash;
         }
-        auto final_trailer_bin = hex_to_bytes_arr<2>(std::string_view("04ff"), error);
-        assert(!error);
+        auto final_trailer_bin = hex_to_bytes_arr<2>(std::string_view("04ff"), error_code);
+        assert(!error_code);
 
         auto trailer_bin_len_big_endian = static_cast<uint32_t>(pgp_trailer_bin.size());
 
@@ -368,17 +358,45 @@ namespace mamba::validation
         trailer_bin_len_big_endian = __builtin_bswap32(trailer_bin_len_big_endian);
 #endif
 
-        std::array<std::byte, MAMBA_SHA256_SIZE_BYTES> hash;
-
         auto digester = util::Sha256Digester();
         digester.digest_start();
-        digester.digest_update(data_bin, data_len);
+        digester.digest_update(reinterpret_cast<const std::byte*>(data.data()), data.size());
         digester.digest_update(pgp_trailer_bin.data(), pgp_trailer_bin.size());
         digester.digest_update(final_trailer_bin.data(), final_trailer_bin.size());
         digester.digest_update(reinterpret_cast<const std::byte*>(&trailer_bin_len_big_endian), 4);
         digester.digest_finalize_to(hash.data());
 
-        return verify_gpg_hashed_msg(hash.data(), pk_bin.data(), signature_bin.data()) + error;
+        return hash;
+    }
+
+    auto verify_gpg(
+        const std::string& data,
+        const std::string& pgp_v4_trailer,
+        const std::string& pk,
+        const std::string& signature
+    ) -> int
+    {
+        // An invalid input is an invalid signature, the error is not returned since a
+        // status of 1 means success.
+        int error = 0;
+        auto signature_bin = ed25519_sig_hex_to_bytes(signature, error);
+        if (error)
+        {
+            return 0;
+        }
+        auto pk_bin = ed25519_key_hex_to_bytes(pk, error);
+        if (error)
+        {
+            return 0;
+        }
+
+        auto hash = pgp_v4_hashed_msg(data, pgp_v4_trailer, error);
+        if (error)
+        {
+            return 0;
+        }
+
+        return verify_gpg_hashed_msg(hash.data(), pk_bin.data(), signature_bin.data());
     }
 
     void check_timestamp_metadata_format(const std::string& ts)
@@ -16,6 +16,7 @@
 #include "mamba/fs/filesystem.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/validation/errors.hpp"
+#include "mamba/validation/signature_verifier.hpp"
 #include "mamba/validation/tools.hpp"
 #include "mamba/validation/update_framework.hpp"
 
@@ -474,50 +475,7 @@ namespace mamba::validation
         const RoleFullKeys& keyring
     ) const
     {
-        std::size_t valid_sig = 0;
-
-        for (auto& s : signatures)
-        {
-            auto it = keyring.keys.find(s.keyid);
-            if (it != keyring.keys.end())
-            {
-                auto& pk = it->second.keyval;
-                int status;
-
-                if (s.pgp_trailer.empty())
-                {
-                    status = verify(signed_data, pk, s.sig);
-                }
-                else
-                {
-                    status = verify_gpg(signed_data, s.pgp_trailer, pk, s.sig);
-                }
-
-                if (status == 1)
-                {
-                    ++valid_sig;
-                }
-                else
-                {
-                    LOG_WARNING << "Invalid signature of metadata using keyid: " << s.keyid;
-                }
-            }
-            else
-            {
-                LOG_WARNING << "Invalid keyid: " << s.keyid;
-            }
-            if (valid_sig >= keyring.threshold)
-            {
-                break;
-            }
-        }
-
-        if (valid_sig < keyring.threshold)
-        {
-            LOG_ERROR << "Threshold of valid signatures is not met (" << valid_sig << "/"
-                      << keyring.threshold << ")";
-            throw threshold_error();
-        }
+        SignatureVerifier(keyring).check_signatures(signed_data, signatures);
     }
 
     void to_json(nlohmann::json& j, const RoleBase& role)
@@ -597,4 +555,17 @@ namespace mamba::validation
         }
         return root_update;
     }
+
+    void RepoIndexChecker::verify_packages(const std::vector<signed_package>& packages) const
+    {
+        for (const auto& [signed_data, signatures] : packages)
+        {
+            verify_package(signed_data, signatures);
+        }
+    }
+
+    auto RepoIndexChecker::keys_fingerprint() const -> std::string
+    {
+        return "";
+    }
 }
@@ -5,13 +5,18 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <fstream>
+#include <string_view>
 #include <utility>
+#include <vector>
+
+#include <fmt/format.h>
 
 #include "mamba/core/context.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/download/downloader.hpp"
 #include "mamba/specs/conda_url.hpp"
+#include "mamba/util/cryptography.hpp"
 #include "mamba/util/encoding.hpp"
 #include "mamba/validation/errors.hpp"
 #include "mamba/validation/tools.hpp"
@@ -504,12 +509,14 @@ namespace mamba::validation::v0_6
     PkgMgrRole::PkgMgrRole(RoleFullKeys keys, const std::shared_ptr<SpecBase> spec)
         : RoleBase("pkg_mgr", spec)
         , m_keys(std::move(keys))
+        , p_verifier(std::make_shared<SignatureVerifier>(m_keys))
     {
     }
 
     PkgMgrRole::PkgMgrRole(const fs::u8path& p, RoleFullKeys keys, const std::shared_ptr<SpecBase> spec)
         : RoleBase("pkg_mgr", spec)
         , m_keys(std::move(keys))
+        , p_verifier(std::make_shared<SignatureVerifier>(m_keys))
     {
         auto j = read_json_file(p);
         load_from_json(j);
@@ -518,6 +525,7 @@ namespace mamba::validation::v0_6
     PkgMgrRole::PkgMgrRole(const nlohmann::json& j, RoleFullKeys keys, const std::shared_ptr<SpecBase> spec)
         : RoleBase("pkg_mgr", spec)
         , m_keys(std::move(keys))
+        , p_verifier(std::make_shared<SignatureVerifier>(m_keys))
     {
         load_from_json(j);
     }
@@ -529,6 +537,7 @@ namespace mamba::validation::v0_6
     )
         : RoleBase("pkg_mgr", spec)
         , m_keys(std::move(keys))
+        , p_verifier(std::make_shared<SignatureVerifier>(m_keys))
     {
         load_from_json(nlohmann::json::parse(json_str));
     }
@@ -607,18 +616,19 @@ namespace mamba::validation::v0_6
 
     auto PkgMgrRole::pkg_signatures(const nlohmann::json& j) const -> std::set<RoleSignature>
     {
-        auto sigs = j.get<std::map<std::string, std::map<std::string, std::string>>>();
         std::set<RoleSignature> unique_sigs;
 
-        for (auto& s : sigs)
+        for (const auto& [keyid, sig] : j.items())
         {
             std::string pgp_trailer = "";
-            if (s.second.find("other_headers") != s.second.end())
+            if (auto it = sig.find("other_headers"); it != sig.end())
             {
-                pgp_trailer = s.second["other_headers"];
+                pgp_trailer = it->get<std::string>();
             }
 
-            unique_sigs.insert(RoleSignature({ s.first, s.second.at("signature"), pgp_trailer }));
+            unique_sigs.insert(
+                RoleSignature({ keyid, sig.at("signature").get<std::string>(), pgp_trailer })
+            );
         }
 
         return unique_sigs;
@@ -627,35 +637,52 @@ namespace mamba::validation::v0_6
     void
     PkgMgrRole::check_pkg_signatures(const nlohmann::json& metadata, const nlohmann::json& signatures) const
     {
-        std::string signed_data = canonicalize(metadata);
-        auto sigs = pkg_signatures(signatures);
-        auto k = self_keys();
+        p_verifier->check_signatures(canonicalize(metadata), pkg_signatures(signatures));
+    }
 
-        check_signatures(signed_data, sigs, k);
+    auto PkgMgrRole::has_valid_pkg_signatures(
+        const nlohmann::json& metadata,
+        const nlohmann::json& signatures
+    ) const -> bool
+    {
+        const auto valid_sig = p_verifier->count_valid_signatures(
+            canonicalize(metadata),
+            pkg_signatures(signatures)
+        );
+        return valid_sig >= p_verifier->threshold();
     }
 
     void PkgMgrRole::verify_index(const nlohmann::json& j) const
     {
         try
         {
-            auto packages = j.at("packages").get<nlohmann::json::object_t>();
-            auto sigs = j.at("signatures").get<nlohmann::json::object_t>();
-
-            for (auto& it : packages)
+            const auto& packages = j.at("packages");
+            const auto& sigs = j.at("signatures");
+
+            // The packages are looked up first, they are then verified concurrently
+            std::vector<std::pair<const nlohmann::json*, const nlohmann::json*>> to_verify;
+            std::vector<std::string_view> names;
+            to_verify.reserve(packages.size());
+            names.reserve(packages.size());
+            for (const auto& [pkg_name, pkg_meta] : packages.items())
             {
-                auto pkg_name = it.first;
-                auto pkg_meta = it.second;
-                auto pkg_sigs = sigs.at(pkg_name).get<nlohmann::json::object_t>();
+                to_verify.emplace_back(&pkg_meta, &sigs.at(pkg_name));
+                names.push_back(pkg_name);
+            }
 
-                try
-                {
-                    check_pkg_signatures(pkg_meta, pkg_sigs);
-                }
-                catch (const threshold_error& e)
-                {
-                    LOG_ERROR << "Validation failed on package: '" << pkg_name << "' : " << e.what();
-                    throw package_error();
-                }
+            const auto invalid = find_invalid_in_parallel(
+                to_verify.size(),
+                [&](std::size_t i)
+                { return has_valid_pkg_signatures(*to_verify[i].first, *to_verify[i].second); }
+            );
+            for (std::size_t i : invalid)
+            {
+                LOG_ERROR << "Validation failed on package: '" << names[i]
+                          << "' : " << threshold_error().what();
+            }
+            if (!invalid.empty())
+            {
+                throw package_error();
             }
         }
         catch (const nlohmann::json::exception& e)
@@ -710,4 +737,35 @@ namespace mamba::validation::v0_6
             throw package_error();
         }
     }
+
+    void PkgMgrRole::verify_packages(const std::vector<signed_package>& packages) const
+    {
+        const auto invalid = find_invalid_in_parallel(
+            packages.size(),
+            [&](std::size_t i)
+            {
+                const auto& [signed_data, signatures] = packages[i];
+                return has_valid_pkg_signatures(signed_data, signatures.at("signatures"));
+            }
+        );
+        for (std::size_t i : invalid)
+        {
+            LOG_ERROR << "Validation failed on package: '" << packages[i].first.at("name")
+                      << "' : " << threshold_error().what();
+        }
+        if (!invalid.empty())
+        {
+            throw package_error();
+        }
+    }
+
+    auto PkgMgrRole::keys_fingerprint() const -> std::string
+    {
+        std::string keys = std::to_string(m_keys.threshold);
+        for (const auto& [keyid, key] : m_keys.keys)
+        {
+            keys += fmt::format(",{}:{}", keyid, key.keyval);
+        }
+        return util::Sha256Hasher().str_hex_str(keys);
+    }
 }  // namespace v06
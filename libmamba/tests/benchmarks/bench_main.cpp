@@ -0,0 +1,1280 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+/**
+ * Benchmarks of the libmamba solver stack on the test data, of the downloader
+ * scheduling many small transfers from the local filesystem and a loopback HTTP server,
+ * of verbose logging and progress reporting from several threads, of tracing spans, and of
+ * running commands in an environment.
+ *
+ * Results are written as JSON to compare them between releases.
+ * Solve snapshots (see @ref mamba::solver::libsolv::SolveSnapshot) can be replayed with
+ * ``--snapshot``, for instance to profile a slow solve offline under ``perf``.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/activation.hpp"
+#include "mamba/core/context.hpp"
+#include "mamba/core/logging_async.hpp"
+#include "mamba/core/logging_tools.hpp"
+#include "mamba/core/output.hpp"
+#include "mamba/core/run.hpp"
+#include "mamba/core/tracing.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/download/downloader.hpp"
+#include "mamba/download/mirror_map.hpp"
+#include "mamba/fs/filesystem.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/solve_snapshot.hpp"
+#include "mamba/solver/libsolv/solver.hpp"
+#include "mamba/solver/libsolv/unsolvable.hpp"
+#include "mamba/solver/problems_graph.hpp"
+#include "mamba/solver/request.hpp"
+#include "mamba/specs/match_spec.hpp"
+#include "mamba/specs/package_info.hpp"
+#include "mamba/specs/version.hpp"
+#include "mamba/util/string.hpp"
+#include "mamba/util/url_manip.hpp"
+#include "mamba/version.hpp"
+
+#include "../src/core/progress_bar_impl.hpp"
+
+#include "pool_data.hpp"
+
+#ifndef MAMBA_TEST_DATA_DIR
+#error "MAMBA_TEST_DATA_DIR must be defined pointing to test data"
+#endif
+
+using namespace mamba;
+using namespace mamba::solver;
+
+namespace
+{
+    using namespace specs::match_spec_literals;
+
+    struct Options
+    {
+        fs::u8path data_dir = MAMBA_TEST_DATA_DIR;
+        fs::u8path output = {};
+        std::string filter = {};
+        std::vector<std::string> groups = {};
+        std::vector<fs::u8path> snapshots = {};
+        fs::u8path save_snapshots = {};
+        std::size_t repetitions = 10;
+        std::size_t download_requests = 10000;
+        std::size_t runs = 1000;
+        std::size_t log_records = 10000;
+        std::size_t progress_events = 100000;
+        std::size_t trace_spans = 1000000;
+    };
+
+    /** Whether the benchmarks of a group are run, all of them are if no group is given. */
+    [[nodiscard]] auto is_selected(const Options& options, std::string_view group) -> bool
+    {
+        return options.groups.empty()
+               || (std::find(options.groups.cbegin(), options.groups.cend(), group)
+                   != options.groups.cend());
+    }
+
+    /**
+     * Time functions repeatedly and gather statistics in a JSON report.
+     */
+    class Bench
+    {
+    public:
+
+        explicit Bench(const Options& options)
+            : m_options(options)
+        {
+        }
+
+        template <typename Func>
+        void run(std::string_view group, std::string_view name, Func&& func)
+        {
+            const auto full_name = util::concat(group, "/", name);
+            if (!is_selected(m_options, group)
+                || (!m_options.filter.empty() && !util::contains(full_name, m_options.filter)))
+            {
+                return;
+            }
+            std::cerr << "Running " << full_name << '\n';
+
+            // Warm up caches and lazy initializations
+            func();
+
+            auto samples = std::vector<double>();
+            samples.reserve(m_options.repetitions);
+            for (std::size_t i = 0; i < m_options.repetitions; ++i)
+            {
+                // Functions returning a duration time themselves the part to measure
+                if constexpr (std::is_same_v<std::invoke_result_t<Func&>, std::chrono::nanoseconds>)
+                {
+                    samples.push_back(static_cast<double>(func().count()));
+                }
+                else
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    func();
+                    const auto stop = std::chrono::steady_clock::now();
+                    samples.push_back(
+                        std::chrono::duration<double, std::nano>(stop - start).count()
+                    );
+                }
+            }
+            add_result(group, full_name, std::move(samples));
+        }
+
+        [[nodiscard]] auto report() const -> nlohmann::json
+        {
+            return {
+                { "libmamba_version", version() },
+                { "repetitions", m_options.repetitions },
+                { "benchmarks", m_results },
+            };
+        }
+
+    private:
+
+        const Options& m_options;
+        nlohmann::json m_results = nlohmann::json::array();
+
+        void add_result(std::string_view group, std::string_view name, std::vector<double> samples)
+        {
+            std::sort(samples.begin(), samples.end());
+            double total = 0;
+            for (const double s : samples)
+            {
+                total += s;
+            }
+            const auto size = samples.size();
+            const double median = (size % 2 == 1)
+                                      ? samples[size / 2]
+                                      : (samples[size / 2 - 1] + samples[size / 2]) / 2;
+            m_results.push_back({
+                { "name", name },
+                { "group", group },
+                { "repetitions", size },
+                { "min_ns", samples.front() },
+                { "median_ns", median },
+                { "mean_ns", total / static_cast<double>(size) },
+                { "max_ns", samples.back() },
+            });
+        }
+    };
+
+    struct RepodataFile
+    {
+        std::string name;
+        fs::u8path path;
+        std::string url;
+        std::string channel_id;
+    };
+
+    auto repodata_files(const Options& options) -> std::vector<RepodataFile>
+    {
+        return {
+            {
+                "conda-forge-numpy",
+                options.data_dir / "repodata/conda-forge-numpy-linux-64.json",
+                "https://conda.anaconda.org/conda-forge/linux-64",
+                "conda-forge",
+            },
+            {
+                "sudoku",
+                options.data_dir / "repodata/sudoku.json",
+                "https://conda.anaconda.org/jjhelmus/label/sudoku/noarch",
+                "sudoku",
+            },
+        };
+    }
+
+    auto load_repodata(libsolv::Database& db, const RepodataFile& file) -> libsolv::RepoInfo
+    {
+        return db
+            .add_repo_from_repodata_json(
+                file.path,
+                file.url,
+                file.channel_id,
+                libsolv::PipAsPythonDependency::No
+            )
+            .value();
+    }
+
+    void bench_index_loading(Bench& bench, const Options& options)
+    {
+        const auto tmp_dir = TemporaryDirectory();
+
+        for (const auto& file : repodata_files(options))
+        {
+            bench.run(
+                "index_loading",
+                util::concat(file.name, "/json_mamba"),
+                [&]()
+                {
+                    auto db = libsolv::Database({});
+                    return db.add_repo_from_repodata_json(
+                        file.path,
+                        file.url,
+                        file.channel_id,
+                        libsolv::PipAsPythonDependency::No,
+                        libsolv::PackageTypes::CondaOrElseTarBz2,
+                        libsolv::VerifyPackages::No,
+                        libsolv::RepodataParser::Mamba
+                    );
+                }
+            );
+            bench.run(
+                "index_loading",
+                util::concat(file.name, "/json_libsolv"),
+                [&]()
+                {
+                    auto db = libsolv::Database({});
+                    return db.add_repo_from_repodata_json(
+                        file.path,
+                        file.url,
+                        file.channel_id,
+                        libsolv::PipAsPythonDependency::No,
+                        libsolv::PackageTypes::CondaOrElseTarBz2,
+                        libsolv::VerifyPackages::No,
+                        libsolv::RepodataParser::Libsolv
+                    );
+                }
+            );
+
+            const auto solv_file = tmp_dir.path() / util::concat(file.name, ".solv");
+            const auto origin = libsolv::RepodataOrigin{ file.url, "", "" };
+            {
+                auto db = libsolv::Database({});
+                const auto repo = load_repodata(db, file);
+                db.native_serialize_repo(repo, solv_file, origin).value();
+            }
+            bench.run(
+                "index_loading",
+                util::concat(file.name, "/solv"),
+                [&]()
+                {
+                    auto db = libsolv::Database({});
+                    return db.add_repo_from_native_serialization(
+                        solv_file,
+                        origin,
+                        file.channel_id
+                    );
+                }
+            );
+        }
+    }
+
+    struct SolveCase
+    {
+        std::string name;
+        libsolv::Database database;
+        Request request;
+    };
+
+    auto make_solve_corpus(const Options& options) -> std::vector<SolveCase>
+    {
+        auto out = std::vector<SolveCase>();
+        const auto files = repodata_files(options);
+
+        const auto from_repodata = [&](std::string name, const RepodataFile& file, Request request)
+        {
+            auto db = libsolv::Database({});
+            load_repodata(db, file);
+            out.push_back({ std::move(name), std::move(db), std::move(request) });
+        };
+
+        from_repodata(
+            "numpy",
+            files[0],
+            Request{ /* .flags= */ {}, /* .jobs= */ { Request::Install{ "numpy"_ms } } }
+        );
+        from_repodata(
+            "python-numpy-pip",
+            files[0],
+            Request{
+                /* .flags= */ {},
+                /* .jobs= */
+                {
+                    Request::Install{ "python=3.12"_ms },
+                    Request::Install{ "numpy>=1.26"_ms },
+                    Request::Install{ "pip"_ms },
+                },
+            }
+        );
+        from_repodata(
+            "numpy-python-conflict",
+            files[0],
+            Request{
+                /* .flags= */ {},
+                /* .jobs= */
+                {
+                    Request::Install{ "python=3.11"_ms },
+                    Request::Install{ "numpy"_ms },
+                },
+            }
+        );
+        // The sudoku puzzle encoded as packages
+        auto sudoku = Request();
+        for (const auto* clue :
+             { "sudoku_0_0 == 5", "sudoku_1_0 == 3", "sudoku_4_0 == 7", "sudoku_0_1 == 6",
+               "sudoku_3_1 == 1", "sudoku_4_1 == 9", "sudoku_5_1 == 5", "sudoku_1_2 == 9",
+               "sudoku_2_2 == 8", "sudoku_7_2 == 6", "sudoku_0_3 == 8", "sudoku_4_3 == 6",
+               "sudoku_8_3 == 3", "sudoku_0_4 == 4", "sudoku_3_4 == 8", "sudoku_5_4 == 3",
+               "sudoku_8_4 == 1", "sudoku_0_5 == 7", "sudoku_4_5 == 2", "sudoku_8_5 == 6",
+               "sudoku_1_6 == 6", "sudoku_6_6 == 2", "sudoku_7_6 == 8", "sudoku_3_7 == 4",
+               "sudoku_4_7 == 1", "sudoku_5_7 == 9", "sudoku_8_7 == 5", "sudoku_4_8 == 8",
+               "sudoku_7_8 == 7", "sudoku_8_8 == 9" })
+        {
+            sudoku.jobs.push_back(Request::Install{ specs::MatchSpec::parse(clue).value() });
+        }
+        from_repodata("sudoku", files[1], std::move(sudoku));
+
+        // The PubGrub example from the solv-cpp test data
+        const auto pubgrub = [&](std::string name, Request request)
+        {
+            auto pkgs = std::vector<specs::PackageInfo>();
+            for (const auto& simple : solv::test::make_packages())
+            {
+                auto pkg = specs::PackageInfo(simple.name);
+                pkg.version = simple.version;
+                pkg.dependencies = simple.dependencies;
+                pkgs.push_back(std::move(pkg));
+            }
+            auto db = libsolv::Database({});
+            db.add_repo_from_packages(pkgs, "pubgrub");
+            out.push_back({ std::move(name), std::move(db), std::move(request) });
+        };
+        pubgrub(
+            "pubgrub",
+            Request{ /* .flags= */ {}, /* .jobs= */ { Request::Install{ "menu"_ms } } }
+        );
+        pubgrub(
+            "pubgrub-conflict",
+            Request{
+                /* .flags= */ {},
+                /* .jobs= */
+                {
+                    Request::Install{ "menu"_ms },
+                    Request::Install{ "icons=1.*"_ms },
+                    Request::Install{ "intl=5.*"_ms },
+                },
+            }
+        );
+
+        return out;
+    }
+
+    void bench_problems_graph(
+        Bench& bench,
+        std::string_view name,
+        libsolv::Database& db,
+        const libsolv::UnSolvable& unsolvable
+    )
+    {
+        const auto pbs = unsolvable.problems_graph(db);
+        const auto pbs_simplified = simplify_conflicts(pbs);
+        const auto pbs_comp = CompressedProblemsGraph::from_problems_graph(pbs_simplified);
+
+        bench.run(
+            "problems_graph",
+            util::concat(name, "/build"),
+            [&]() { return unsolvable.problems_graph(db); }
+        );
+        bench.run(
+            "problems_graph",
+            util::concat(name, "/simplify"),
+            [&]() { return simplify_conflicts(pbs); }
+        );
+        bench.run(
+            "problems_graph",
+            util::concat(name, "/compress"),
+            [&]() { return CompressedProblemsGraph::from_problems_graph(pbs_simplified); }
+        );
+        bench.run(
+            "problems_graph",
+            util::concat(name, "/message"),
+            [&]() { return problem_tree_msg(pbs_comp); }
+        );
+    }
+
+    void bench_solve(Bench& bench, const Options& options)
+    {
+        for (auto& solve_case : make_solve_corpus(options))
+        {
+            if (!options.save_snapshots.empty())
+            {
+                auto written = libsolv::SolveSnapshot::write(
+                    solve_case.database,
+                    solve_case.request,
+                    options.save_snapshots / solve_case.name
+                );
+                if (!written)
+                {
+                    throw std::move(written).error();
+                }
+            }
+
+            bench.run(
+                "solve",
+                solve_case.name,
+                [&]() { return libsolv::Solver().solve(solve_case.database, solve_case.request); }
+            );
+
+            auto outcome = libsolv::Solver().solve(solve_case.database, solve_case.request).value();
+            if (auto* unsolvable = std::get_if<libsolv::UnSolvable>(&outcome))
+            {
+                bench_problems_graph(bench, solve_case.name, solve_case.database, *unsolvable);
+            }
+        }
+    }
+
+    void bench_parsing(Bench& bench, const Options& options)
+    {
+        auto versions = std::vector<std::string>();
+        auto specs = std::vector<std::string>();
+        for (const auto& file : repodata_files(options))
+        {
+            auto in = open_ifstream(file.path);
+            const auto repodata = nlohmann::json::parse(in);
+            for (const auto* key : { "packages", "packages.conda" })
+            {
+                const auto pkgs = repodata.find(key);
+                if ((pkgs == repodata.end()) || !pkgs->is_object())
+                {
+                    continue;
+                }
+                for (const auto& [_, pkg] : pkgs->items())
+                {
+                    versions.push_back(pkg.at("version").get<std::string>());
+                    for (const auto* deps_key : { "depends", "constrains" })
+                    {
+                        if (auto it = pkg.find(deps_key); (it != pkg.end()) && it->is_array())
+                        {
+                            for (const auto& dep : *it)
+                            {
+                                specs.push_back(dep.get<std::string>());
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        bench.run(
+            "parsing",
+            util::concat("version/", std::to_string(versions.size())),
+            [&]()
+            {
+                std::size_t parsed = 0;
+                for (const auto& str : versions)
+                {
+                    parsed += specs::Version::parse(str).has_value();
+                }
+                return parsed;
+            }
+        );
+        bench.run(
+            "parsing",
+            util::concat("match_spec/", std::to_string(specs.size())),
+            [&]()
+            {
+                std::size_t parsed = 0;
+                for (const auto& str : specs)
+                {
+                    parsed += specs::MatchSpec::parse(str).has_value();
+                }
+                return parsed;
+            }
+        );
+    }
+
+    void bench_snapshots(Bench& bench, const Options& options)
+    {
+        for (const auto& dir : options.snapshots)
+        {
+            const auto name = dir.filename().string();
+            bench.run(
+                "snapshot",
+                util::concat(name, "/load"),
+                [&]() { return libsolv::SolveSnapshot::read(dir, {}).value(); }
+            );
+
+            auto snapshot = libsolv::SolveSnapshot::read(dir, {}).value();
+            bench.run(
+                "snapshot",
+                util::concat(name, "/solve"),
+                [&]()
+                {
+                    return libsolv::Solver().solve(
+                        snapshot.database,
+                        snapshot.request,
+                        snapshot.matchspec_parser
+                    );
+                }
+            );
+        }
+    }
+
+#ifndef _WIN32
+    /**
+     * A minimal HTTP/1.1 server on the loopback interface, answering every request with
+     * the same body, to measure the downloader without network latency.
+     */
+    class LocalHTTPServer
+    {
+    public:
+
+        explicit LocalHTTPServer(std::size_t body_size)
+            : m_response(util::concat(
+                  "HTTP/1.1 200 OK\r\nContent-Length: ",
+                  std::to_string(body_size),
+                  "\r\n\r\n",
+                  std::string(body_size, 'x')
+              ))
+        {
+            auto addr = sockaddr_in{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            auto len = socklen_t(sizeof(addr));
+            m_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+            if ((m_socket < 0) || (::bind(m_socket, reinterpret_cast<sockaddr*>(&addr), len) != 0)
+                || (::listen(m_socket, 128) != 0)
+                || (::getsockname(m_socket, reinterpret_cast<sockaddr*>(&addr), &len) != 0))
+            {
+                throw std::runtime_error("Could not start the local HTTP server");
+            }
+            m_port = ntohs(addr.sin_port);
+            m_acceptor = std::thread([this] { accept_connections(); });
+        }
+
+        LocalHTTPServer(const LocalHTTPServer&) = delete;
+        auto operator=(const LocalHTTPServer&) -> LocalHTTPServer& = delete;
+
+        ~LocalHTTPServer()
+        {
+            // Wake up the acceptor with a last connection
+            m_stop = true;
+            auto addr = sockaddr_in{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(m_port);
+            const int wake = ::socket(AF_INET, SOCK_STREAM, 0);
+            ::connect(wake, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            ::close(wake);
+            m_acceptor.join();
+            ::close(m_socket);
+            // Clients keep their connections open to reuse them in later downloads
+            for (const int client : m_clients)
+            {
+                ::shutdown(client, SHUT_RDWR);
+            }
+            for (auto& connection : m_connections)
+            {
+                connection.join();
+            }
+            for (const int client : m_clients)
+            {
+                ::close(client);
+            }
+        }
+
+        [[nodiscard]] auto url() const -> std::string
+        {
+            return util::concat("http://127.0.0.1:", std::to_string(m_port));
+        }
+
+    private:
+
+        std::string m_response;
+        int m_socket = -1;
+        std::uint16_t m_port = 0;
+        std::atomic<bool> m_stop = false;
+        std::thread m_acceptor;
+        std::vector<std::thread> m_connections;
+        std::vector<int> m_clients;
+
+        void accept_connections()
+        {
+            while (true)
+            {
+                const int client = ::accept(m_socket, nullptr, nullptr);
+                if (m_stop || (client < 0))
+                {
+                    ::close(client);
+                    return;
+                }
+                m_clients.push_back(client);
+                m_connections.emplace_back([this, client] { serve(client); });
+            }
+        }
+
+        void serve(int client) const
+        {
+#ifdef MSG_NOSIGNAL
+            constexpr int send_flags = MSG_NOSIGNAL;
+#else
+            constexpr int send_flags = 0;
+#endif
+            auto request = std::string();
+            auto buffer = std::array<char, 4096>();
+            while (true)
+            {
+                const auto received = ::recv(client, buffer.data(), buffer.size(), 0);
+                if (received <= 0)
+                {
+                    break;
+                }
+                request.append(buffer.data(), static_cast<std::size_t>(received));
+                // Requests have no body and end with an empty line
+                for (auto end = request.find("\r\n\r\n"); end != std::string::npos;
+                     end = request.find("\r\n\r\n"))
+                {
+                    request.erase(0, end + 4);
+                    if (::send(client, m_response.data(), m_response.size(), send_flags) < 0)
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+    };
+#endif
+
+    auto make_download_requests(std::size_t count) -> download::MultiRequest
+    {
+        auto requests = download::MultiRequest();
+        requests.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto name = util::concat("pkg-", std::to_string(i));
+            requests.emplace_back(name, download::MirrorName("bench"), name);
+        }
+        return requests;
+    }
+
+    void
+    bench_download_from(Bench& bench, std::string_view name, std::string url, std::size_t count)
+    {
+        auto mirrors = download::mirror_map();
+        mirrors.add_unique_mirror("bench", download::make_mirror(std::move(url)));
+        auto dl_options = download::Options();
+        dl_options.download_threads = 10;
+
+        bench.run(
+            "download",
+            util::concat(name, "/", std::to_string(count)),
+            [&]()
+            {
+                auto params = download::RemoteFetchParams();
+                auto results = download::download(
+                    make_download_requests(count),
+                    mirrors,
+                    params,
+                    {},
+                    dl_options
+                );
+                for (const auto& res : results)
+                {
+                    if (!res.has_value())
+                    {
+                        throw std::runtime_error(res.error().message);
+                    }
+                }
+                return results.size();
+            }
+        );
+    }
+
+    void bench_download(Bench& bench, const Options& options)
+    {
+        constexpr std::size_t body_size = 1024;
+        const auto count = options.download_requests;
+
+        const auto tmp_dir = TemporaryDirectory();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto out = open_ofstream(tmp_dir.path() / util::concat("pkg-", std::to_string(i)));
+            out << std::string(body_size, 'x');
+        }
+        bench_download_from(bench, "file", util::path_to_url(tmp_dir.path().string()), count);
+
+#ifndef _WIN32
+        const auto server = LocalHTTPServer(body_size);
+        bench_download_from(bench, "http", server.url(), count);
+#endif
+    }
+
+    /**
+     * Threads logging verbose records to a file, as download and extraction workers do at
+     * ``-vvv``, through a synchronous or a ``LogHandler_Async`` log handler.
+     *
+     * ``async`` includes delivering all the records, ``async_callers`` only the time until
+     * the logging threads are done.
+     */
+    void bench_logging(Bench& bench, const Options& options)
+    {
+        constexpr std::size_t thread_count = 4;
+        const auto count = options.log_records;
+
+        const auto tmp_dir = TemporaryDirectory();
+        auto out = open_ofstream(tmp_dir.path() / "bench.log");
+        const auto params = LoggingParams{ .logging_level = log_level::trace };
+
+        const auto log_from_threads = [&]()
+        {
+            auto threads = std::vector<std::thread>();
+            for (std::size_t t = 0; t < thread_count; ++t)
+            {
+                threads.emplace_back(
+                    [&, t]()
+                    {
+                        for (std::size_t i = 0; i < count; ++i)
+                        {
+                            logging::log({
+                                .message = util::concat(
+                                    "Transfer ",
+                                    std::to_string(i),
+                                    " of worker ",
+                                    std::to_string(t),
+                                    ": received 16384 bytes from https://conda.anaconda.org"
+                                ),
+                                .level = log_level::debug,
+                            });
+                        }
+                    }
+                );
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        };
+        const auto name = [&](std::string_view kind)
+        { return util::concat(kind, "/", std::to_string(thread_count * count)); };
+
+        auto sync_handler = logging::LogHandler_Stream<std::ofstream>(out);
+        logging::set_log_handler(&sync_handler, params);
+        bench.run(
+            "logging",
+            name("sync"),
+            [&]()
+            {
+                log_from_threads();
+                logging::flush_logs();
+            }
+        );
+
+        auto async_handler = logging::LogHandler_Async(&sync_handler, { .buffer_size = count });
+        logging::set_log_handler(&async_handler, params);
+        bench.run(
+            "logging",
+            name("async"),
+            [&]()
+            {
+                log_from_threads();
+                logging::flush_logs();
+            }
+        );
+        bench.run(
+            "logging",
+            name("async_callers"),
+            [&]()
+            {
+                const auto start = std::chrono::steady_clock::now();
+                log_from_threads();
+                const auto stop = std::chrono::steady_clock::now();
+                logging::flush_logs();
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+            }
+        );
+        logging::stop_logging();
+
+        if (async_handler.dropped_count() > 0)
+        {
+            std::cerr << "Dropped " << async_handler.dropped_count() << " log records\n";
+        }
+
+        // Trace records filtered out by the log level, as emitted for each file when linking
+        logging::set_log_handler(&sync_handler, LoggingParams{ .logging_level = log_level::warn });
+
+        auto paths = std::vector<fs::u8path>();
+        for (std::size_t i = 0; i < thread_count * count; ++i)
+        {
+            paths.push_back(
+                fs::u8path("lib/python3.12/site-packages/numpy")
+                / util::concat("module_", std::to_string(i), ".py")
+            );
+        }
+        const auto filtered_name = [&](std::string_view kind)
+        { return util::concat(kind, "/", std::to_string(paths.size())); };
+
+        bench.run(
+            "logging",
+            filtered_name("filtered_eager"),
+            [&]()
+            {
+                for (const auto& path : paths)
+                {
+                    // What the `LOG_TRACE` macro expanded to before being lazy
+                    logging::MessageLogger(log_level::trace).stream()
+                        << "hard-linked '" << (tmp_dir.path() / path).string() << "'" << std::endl
+                        << "   --> '" << path.string() << "'";
+                }
+            }
+        );
+        bench.run(
+            "logging",
+            filtered_name("filtered_lazy"),
+            [&]()
+            {
+                for (const auto& path : paths)
+                {
+                    LOG_TRACE << "hard-linked '" << (tmp_dir.path() / path).string() << "'"
+                              << std::endl
+                              << "   --> '" << path.string() << "'";
+                }
+            }
+        );
+        logging::stop_logging();
+    }
+
+    void bench_progress(Bench& bench, const Options& options)
+    {
+        constexpr std::size_t thread_count = 4;
+        constexpr std::size_t bar_count = 100;
+        constexpr std::size_t chunk_size = 16384;
+        const auto count = options.progress_events;
+
+        auto manager = MultiBarManager();
+        auto bars = std::vector<ProgressProxy>();
+        for (std::size_t i = 0; i < bar_count; ++i)
+        {
+            const auto bar_name = util::concat("package-", std::to_string(i));
+            bars.push_back(manager.add_progress_bar(bar_name, {}, 0));
+        }
+
+        // Download progress events of the transfers sent from worker threads while a render
+        // thread prints the bars, timing the worker threads only
+        const auto send_events = [&](auto&& on_progress)
+        {
+            auto rendering = std::atomic<bool>(true);
+            auto render_thread = std::thread(
+                [&]()
+                {
+                    while (rendering)
+                    {
+                        auto out = std::ostringstream();
+                        manager.print(out, 120);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                }
+            );
+
+            const auto start = std::chrono::steady_clock::now();
+            auto threads = std::vector<std::thread>();
+            for (std::size_t t = 0; t < thread_count; ++t)
+            {
+                threads.emplace_back(
+                    [&, t]()
+                    {
+                        for (std::size_t i = 0; i < count; ++i)
+                        {
+                            // Each bar is only updated by one thread, as each transfer
+                            const auto bar = (i * thread_count + t) % bar_count;
+                            on_progress(bar, i * chunk_size, count * chunk_size, chunk_size);
+                        }
+                    }
+                );
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            const auto stop = std::chrono::steady_clock::now();
+
+            rendering = false;
+            render_thread.join();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+        };
+        const auto name = [&](std::string_view kind)
+        { return util::concat(kind, "/", std::to_string(thread_count * count)); };
+
+        // What the download monitors did before reporting the progress
+        using time_point = std::chrono::steady_clock::time_point;
+        auto throttle_time = std::vector<time_point>(bar_count, std::chrono::steady_clock::now());
+        bench.run(
+            "progress",
+            name("update"),
+            [&]()
+            {
+                return send_events(
+                    [&](std::size_t bar, std::size_t current, std::size_t total, std::size_t speed)
+                    {
+                        const auto now = std::chrono::steady_clock::now();
+                        if (now - throttle_time[bar] < std::chrono::milliseconds(50))
+                        {
+                            return;
+                        }
+                        throttle_time[bar] = now;
+                        bars[bar].deactivate_spinner();
+                        bars[bar].update_progress(current, total);
+                        bars[bar].set_speed(speed);
+                    }
+                );
+            }
+        );
+        bench.run(
+            "progress",
+            name("report"),
+            [&]()
+            {
+                return send_events(
+                    [&](std::size_t bar, std::size_t current, std::size_t total, std::size_t speed)
+                    { bars[bar].report_progress(current, total, speed); }
+                );
+            }
+        );
+    }
+
+    void bench_tracing(Bench& bench, const Options& options)
+    {
+        const auto count = options.trace_spans;
+        auto sink = std::atomic<std::size_t>(0);
+        const auto name = [&](std::string_view kind)
+        { return util::concat(kind, "/", std::to_string(count)); };
+
+        bench.run(
+            "tracing",
+            name("no_span"),
+            [&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    sink.fetch_add(i, std::memory_order_relaxed);
+                }
+            }
+        );
+        bench.run(
+            "tracing",
+            name("disabled_span"),
+            [&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    const auto span = tracing::ScopedSpan("link");
+                    sink.fetch_add(i, std::memory_order_relaxed);
+                }
+            }
+        );
+
+        tracing::enable_tracing();
+        bench.run(
+            "tracing",
+            name("enabled_span"),
+            [&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    const auto span = tracing::ScopedSpan("link");
+                    sink.fetch_add(i, std::memory_order_relaxed);
+                }
+                tracing::clear_spans();
+            }
+        );
+        tracing::disable_tracing();
+        tracing::clear_spans();
+    }
+
+#ifndef _WIN32
+    /** Run a function in a forked process and wait for it. */
+    template <typename Func>
+    void fork_and_wait(Func&& child)
+    {
+        const ::pid_t pid = ::fork();
+        if (pid < 0)
+        {
+            throw std::runtime_error("Could not fork");
+        }
+        if (pid == 0)
+        {
+            ::_exit(child());
+        }
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+        {
+            throw std::runtime_error("Run benchmark command failed");
+        }
+    }
+
+    /**
+     * Back-to-back runs of ``true`` in an environment.
+     *
+     * ``exec`` replaces the forked process through ``exec_in_environment``, while
+     * ``wrapper_shell`` only goes through a shell as the supervised ``run_in_environment``
+     * does, without its activation hooks.
+     */
+    void bench_run(Bench& bench, const Options& options)
+    {
+        const auto count = options.runs;
+        const auto tmp_dir = TemporaryDirectory();
+        const auto prefix = tmp_dir.path() / "envs" / "env";
+        fs::create_directories(prefix / "conda-meta");
+
+        auto ctx = Context();
+        ctx.prefix_params.root_prefix = tmp_dir.path();
+        const auto name = [&](std::string_view kind)
+        { return util::concat(kind, "/", std::to_string(count)); };
+
+        bench.run(
+            "run",
+            name("exec"),
+            [&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    fork_and_wait(
+                        [&]
+                        { return exec_in_environment(ctx, prefix, { "true" }, "", 0, false, {}); }
+                    );
+                }
+            }
+        );
+
+        bench.run(
+            "run",
+            name("wrapper_shell"),
+            [&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    fork_and_wait(
+                        []
+                        {
+                            ::execlp("sh", "sh", "-c", "exec \"$@\"", "sh", "true", nullptr);
+                            return 127;
+                        }
+                    );
+                }
+            }
+        );
+
+        bench.run(
+            "run",
+            name("activate"),
+            [&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    PosixActivator(ctx).build_activate(prefix);
+                }
+            }
+        );
+    }
+#endif
+
+    void print_usage(std::ostream& out)
+    {
+        out << "Usage: bench_libmamba [options]\n"
+               "\n"
+               "Options:\n"
+               "  --output FILE        Write the JSON report to FILE instead of stdout\n"
+               "  --repetitions N      Number of timed runs of each benchmark (default 10)\n"
+               "  --filter STR         Only run benchmarks whose name contains STR\n"
+               "  --groups LIST        Only run the comma separated groups, among index_loading,\n"
+               "                       solve, problems_graph, parsing, download, logging,\n"
+               "                       progress, tracing, and run (default all)\n"
+               "  --data-dir DIR       Directory of the libmamba test data\n"
+               "  --snapshot DIR       Only replay the given solve snapshot (repeatable)\n"
+               "  --save-snapshots DIR Save the solve corpus as snapshots in DIR\n"
+               "  --download-requests N Number of requests of the download benchmarks "
+               "(default 10000)\n"
+               "  --runs N             Number of runs of the run benchmarks (default 1000)\n"
+               "  --log-records N      Number of records per thread of the logging benchmarks "
+               "(default 10000)\n"
+               "  --progress-events N  Number of events per thread of the progress benchmarks "
+               "(default 100000)\n"
+               "  --trace-spans N      Number of spans of the tracing benchmarks "
+               "(default 1000000)\n";
+    }
+
+    auto parse_options(int argc, char** argv, Options& options) -> bool
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const auto arg = std::string_view(argv[i]);
+            if ((arg == "-h") || (arg == "--help"))
+            {
+                print_usage(std::cout);
+                std::exit(0);
+            }
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const auto value = std::string(argv[++i]);
+            if (arg == "--output")
+            {
+                options.output = value;
+            }
+            else if (arg == "--repetitions")
+            {
+                options.repetitions = std::max<std::size_t>(std::stoul(value), 1);
+            }
+            else if (arg == "--filter")
+            {
+                options.filter = value;
+            }
+            else if (arg == "--groups")
+            {
+                options.groups = util::split(value, ',');
+            }
+            else if (arg == "--data-dir")
+            {
+                options.data_dir = value;
+            }
+            else if (arg == "--snapshot")
+            {
+                options.snapshots.push_back(value);
+            }
+            else if (arg == "--save-snapshots")
+            {
+                options.save_snapshots = value;
+            }
+            else if (arg == "--download-requests")
+            {
+                options.download_requests = std::max<std::size_t>(std::stoul(value), 1);
+            }
+            else if (arg == "--runs")
+            {
+                options.runs = std::max<std::size_t>(std::stoul(value), 1);
+            }
+            else if (arg == "--log-records")
+            {
+                options.log_records = std::max<std::size_t>(std::stoul(value), 1);
+            }
+            else if (arg == "--progress-events")
+            {
+                options.progress_events = std::max<std::size_t>(std::stoul(value), 1);
+            }
+            else if (arg == "--trace-spans")
+            {
+                options.trace_spans = std::max<std::size_t>(std::stoul(value), 1);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto options = Options();
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage(std::cerr);
+        return 2;
+    }
+
+    // Log records are kept in memory until a console exists
+    auto ctx = Context();
+    auto console = Console(ctx);
+
+    auto bench = Bench(options);
+    try
+    {
+        if (options.snapshots.empty())
+        {
+            // Skipping the groups entirely also skips the setup of their data
+            if (is_selected(options, "index_loading"))
+            {
+                bench_index_loading(bench, options);
+            }
+            if (is_selected(options, "solve") || is_selected(options, "problems_graph"))
+            {
+                bench_solve(bench, options);
+            }
+            if (is_selected(options, "parsing"))
+            {
+                bench_parsing(bench, options);
+            }
+            if (is_selected(options, "download"))
+            {
+                bench_download(bench, options);
+            }
+            if (is_selected(options, "logging"))
+            {
+                bench_logging(bench, options);
+            }
+            if (is_selected(options, "progress"))
+            {
+                bench_progress(bench, options);
+            }
+            if (is_selected(options, "tracing"))
+            {
+                bench_tracing(bench, options);
+            }
+#ifndef _WIN32
+            if (is_selected(options, "run"))
+            {
+                bench_run(bench, options);
+            }
+#endif
+        }
+        else
+        {
+            bench_snapshots(bench, options);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Benchmark failed: " << e.what() << '\n';
+        return 1;
+    }
+
+    const auto report = bench.report().dump(2);
+    if (options.output.empty())
+    {
+        std::cout << report << '\n';
+    }
+    else
+    {
+        auto out = open_ofstream(options.output);
+        out << report << '\n';
+    }
+    return 0;
+}
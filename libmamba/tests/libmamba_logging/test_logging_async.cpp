@@ -0,0 +1,214 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <typeindex>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+#include <fmt/core.h>
+
+#include <mamba/core/logging_async.hpp>
+#include <mamba/core/logging_spdlog.hpp>
+#include <mamba/core/logging_tools.hpp>
+
+#include "test_logging_common.hpp"
+
+namespace mamba::logging
+{
+    namespace
+    {
+        // Output stream slow enough for the logging threads to fill their buffer
+        struct SlowStream
+        {
+            std::ostringstream out;
+
+            auto operator<<(const std::string& str) -> SlowStream&
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                out << str;
+                return *this;
+            }
+
+            auto operator<<(const char* cstr) -> SlowStream&
+            {
+                return *this << std::string(cstr);
+            }
+
+            auto flush() -> SlowStream&
+            {
+                return *this;
+            }
+        };
+
+        auto output_lines(const std::string& output) -> std::vector<std::string>
+        {
+            std::vector<std::string> lines;
+            std::istringstream in(output);
+            for (std::string line; std::getline(in, line);)
+            {
+                if (!line.empty())
+                {
+                    lines.push_back(std::move(line));
+                }
+            }
+            return lines;
+        }
+
+        auto any_log(std::string message, log_level level = log_level::info) -> LogRecord
+        {
+            return { .message = std::move(message), .level = level, .source = log_source::tests };
+        }
+    }
+
+    TEST_CASE("LogHandler_Async delivers the records of each thread in order")
+    {
+        std::ostringstream out;
+        LogHandler_Stream<std::ostringstream> backend(out);
+        LogHandler_Async handler(&backend, { .buffer_size = 1 << 16 });
+
+        handler.start_log_handling({ .logging_level = log_level::info }, { log_source::tests });
+        REQUIRE(handler.is_started());
+
+        static constexpr std::size_t thread_count = 4;
+        static constexpr std::size_t record_count = 500;
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    for (std::size_t i = 0; i < record_count; ++i)
+                    {
+                        handler.log(any_log(fmt::format("{} {}", t, i)));
+                        // Filtered out
+                        handler.log(any_log("debug", log_level::debug));
+                    }
+                }
+            );
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        handler.flush();
+        std::map<std::size_t, std::size_t> next_record;
+        for (const auto& line : output_lines(out.str()))
+        {
+            std::size_t t = 0;
+            std::size_t i = 0;
+            REQUIRE(std::sscanf(line.c_str(), "info tests : %zu %zu", &t, &i) == 2);
+            REQUIRE(next_record[t] == i);
+            ++next_record[t];
+        }
+        REQUIRE(next_record.size() == thread_count);
+        for (const auto& [t, count] : next_record)
+        {
+            REQUIRE(count == record_count);
+        }
+        REQUIRE(handler.dropped_count() == 0);
+
+        // Stopping delivers the pending records
+        handler.log(any_log("last"));
+        handler.stop_log_handling(stop_reason::manual_stop);
+        REQUIRE_FALSE(handler.is_started());
+        REQUIRE(output_lines(out.str()).back() == "info tests : last");
+    }
+
+    TEST_CASE("LogHandler_Async drops records when the buffer is full")
+    {
+        SlowStream out;
+        LogHandler_Stream<SlowStream> backend(out);
+        LogHandler_Async handler(&backend, { .buffer_size = 4 });
+        handler.start_log_handling({ .logging_level = log_level::debug }, { log_source::tests });
+
+        static constexpr std::size_t record_count = 1000;
+        for (std::size_t i = 0; i < record_count; ++i)
+        {
+            handler.log(any_log("verbose", log_level::debug));
+        }
+        for (std::size_t i = 0; i < record_count; ++i)
+        {
+            handler.log(any_log("important", log_level::warn));
+        }
+        handler.stop_log_handling(stop_reason::manual_stop);
+
+        const auto lines = output_lines(out.out.str());
+        const auto count_lines = [&](std::string_view message)
+        {
+            return std::count_if(
+                lines.begin(),
+                lines.end(),
+                [&](const auto& line) { return line.ends_with(message); }
+            );
+        };
+        const auto verbose_count = static_cast<std::size_t>(count_lines(": verbose"));
+        REQUIRE(handler.dropped_count() > 0);
+        REQUIRE(verbose_count + handler.dropped_count() == record_count);
+        REQUIRE(count_lines(": important") == record_count);
+        REQUIRE(count_lines("log records dropped by the asynchronous log handler") > 0);
+    }
+
+    TEST_CASE("LogHandler_Async flushes at the flush threshold")
+    {
+        testing::LogHandler_Tester backend;
+        LogHandler_Async handler(&backend, { .flush_interval = std::chrono::hours(1) });
+        handler.start_log_handling({ .logging_level = log_level::info }, { log_source::tests });
+        handler.set_flush_threshold(log_level::err);
+
+        handler.log(any_log("info"));
+        REQUIRE(backend.capture_stats().log_count == 0);
+
+        handler.log(any_log("error", log_level::err));
+        const auto stats = backend.capture_stats();
+        REQUIRE(stats.log_count == 2);
+        REQUIRE(stats.flush_all_count == 1);
+
+        handler.stop_log_handling(stop_reason::manual_stop);
+        REQUIRE(backend.capture_stats().stop_count == 1);
+    }
+
+    TEST_CASE("LogHandler_Async logging API basic tests")
+    {
+        const auto results = testing::test_classic_inline_logging_api_usage(
+            LogHandler_Async(testing::LogHandler_Tester{}),
+            { .log_count = 42 }
+        );
+        REQUIRE(results.handler.has_value());
+        REQUIRE_FALSE(results.handler.unsafe_get<LogHandler_Async>()->is_started());
+    }
+
+    TEST_CASE("use_async_log_handler")
+    {
+        testing::LogHandler_Tester backend;
+        set_log_handler(&backend);
+        on_scope_exit _{ [] { stop_logging(); } };
+
+        use_async_log_handler();
+        REQUIRE(get_log_handler().type_id() == std::type_index(typeid(LogHandler_Async)));
+        auto* handler = get_log_handler().unsafe_get<LogHandler_Async>();
+        REQUIRE(handler->is_started());
+
+        // Already asynchronous
+        use_async_log_handler();
+        REQUIRE(get_log_handler().unsafe_get<LogHandler_Async>() == handler);
+
+        log(any_log("delivered", log_level::err));
+        flush_logs();
+        REQUIRE(backend.capture_stats().log_count == 1);
+    }
+
+    TEST_CASE("LogHandler_Async concurrency")
+    {
+        testing::test_concurrent_logging_api_support(LogHandler_Async(
+            spdlogimpl::LogHandler_spdlog({ .redirect_to_null_sink = true })
+        ));
+    }
+}
@@ -2,7 +2,10 @@
 
 #include <catch2/catch_all.hpp>
 
+#include <mamba/core/context.hpp>
 #include <mamba/core/logging.hpp>
+#include <mamba/core/output.hpp>
+#include <mamba/core/util_scope.hpp>
 
 #include "test_logging_common.hpp"
 
@@ -45,4 +48,45 @@ namespace mamba::logging
         }
     }
 
+    TEST_CASE("LOG macros only evaluate the records which are not filtered out")
+    {
+        testing::LogHandler_Tester tester;
+        set_log_handler(&tester, LoggingParams{ .logging_level = log_level::info });
+        on_scope_exit _{ [] { stop_logging(); } };
+
+        // Records logged without a console are kept whatever their level
+        REQUIRE(is_log_enabled(log_level::trace));
+
+        Context context;
+        Console console(context);
+
+        std::size_t evaluation_count = 0;
+        const auto message = [&]
+        {
+            ++evaluation_count;
+            return "message";
+        };
+
+        REQUIRE_FALSE(is_log_enabled(log_level::debug));
+        LOG_DEBUG << message();
+        REQUIRE(evaluation_count == 0);
+
+        LOG_INFO << message();
+        REQUIRE(evaluation_count == 1);
+        REQUIRE(tester.capture_stats().log_count == 1);
+
+        // The backtrace keeps the records whatever their level
+        enable_backtrace(10);
+        LOG_TRACE << message();
+        REQUIRE(evaluation_count == 2);
+        disable_backtrace();
+        REQUIRE_FALSE(is_log_enabled(log_level::trace));
+
+        set_log_level(log_level::trace);
+        REQUIRE(is_log_enabled(log_level::trace));
+
+        set_logging_params({ .logging_level = log_level::err });
+        REQUIRE_FALSE(is_log_enabled(log_level::warn));
+        REQUIRE(is_log_enabled(log_level::critical));
+    }
 }
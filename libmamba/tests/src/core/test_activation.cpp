@@ -1,7 +1,13 @@
+#include <chrono>
+
 #include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
 
 #include "mamba/core/activation.hpp"
 #include "mamba/core/context.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/util/environment.hpp"
+#include "mamba/util/string.hpp"
 
 #include "mambatests.hpp"
 
@@ -34,5 +40,93 @@ namespace mamba
             const fs::u8path& alt_folder = "/home/user/some/env";
             REQUIRE(a.get_default_env(alt_folder) == alt_folder);
         }
+
+        TEST_CASE("Activator activation cache")
+        {
+            const auto restore = mambatests::EnvironmentCleaner(mambatests::CleanMambaEnv());
+            const auto tmp_dir = TemporaryDirectory();
+            const auto cache_dir = tmp_dir.path() / "cache" / "mamba" / "activation";
+            const auto prefix = tmp_dir.path() / "envs" / "env";
+            const auto activate_d = prefix / "etc" / "conda" / "activate.d";
+            fs::create_directories(prefix / "conda-meta");
+            fs::create_directories(activate_d);
+            util::set_env("XDG_CACHE_HOME", (tmp_dir.path() / "cache").string());
+            util::set_env("PATH", "/usr/bin");
+
+            Context ctx;
+            ctx.prefix_params.root_prefix = tmp_dir.path() / "root";
+            const auto activate = [&]
+            {
+                PosixActivator activator(ctx);
+                return activator.activate(prefix, false);
+            };
+            const auto cache_files = [&]
+            {
+                std::vector<fs::u8path> files;
+                for (const auto& entry : fs::directory_iterator(cache_dir))
+                {
+                    files.push_back(entry.path());
+                }
+                return files;
+            };
+
+            const auto script = activate();
+            REQUIRE(util::contains(script, "CONDA_DEFAULT_ENV='env'"));
+            REQUIRE(cache_files().size() == 1);
+
+            SECTION("Cached activation is used")
+            {
+                const auto cache_file = cache_files().front();
+                auto j = nlohmann::json::parse(open_ifstream(cache_file));
+                j["transform"]["export_vars"].push_back({ "CACHED", "true" });
+                open_ofstream(cache_file) << j.dump();
+
+                REQUIRE(util::contains(activate(), "CACHED='true'"));
+            }
+
+            SECTION("New activation scripts invalidate the cache")
+            {
+                open_ofstream(activate_d / "script.sh") << "";
+                fs::last_write_time(
+                    activate_d,
+                    fs::last_write_time(activate_d) + std::chrono::seconds(1)
+                );
+                REQUIRE(util::contains(activate(), "script.sh"));
+            }
+
+            SECTION("Edited environment variable files invalidate the cache")
+            {
+                const auto env_vars_d = prefix / "etc" / "conda" / "env_vars.d";
+                const auto env_vars_file = env_vars_d / "pkg.json";
+                fs::create_directories(env_vars_d);
+                open_ofstream(env_vars_file) << R"({"PKG_VAR": "old"})";
+                REQUIRE(util::contains(activate(), "PKG_VAR='old'"));
+
+                // Rewriting a file in place does not change its directory
+                const auto dir_mtime = fs::last_write_time(env_vars_d);
+                open_ofstream(env_vars_file) << R"({"PKG_VAR": "new"})";
+                fs::last_write_time(
+                    env_vars_file,
+                    fs::last_write_time(env_vars_file) + std::chrono::seconds(1)
+                );
+                REQUIRE(fs::last_write_time(env_vars_d) == dir_mtime);
+                REQUIRE(util::contains(activate(), "PKG_VAR='new'"));
+            }
+
+            SECTION("Environment variables invalidate the cache")
+            {
+                util::set_env("PATH", "/opt/bin");
+                REQUIRE(util::contains(activate(), "/opt/bin"));
+                REQUIRE(cache_files().size() == 1);
+            }
+
+            SECTION("Activation cache can be disabled")
+            {
+                fs::remove_all(cache_dir);
+                ctx.use_activation_cache = false;
+                REQUIRE(activate() == script);
+                REQUIRE_FALSE(fs::exists(cache_dir));
+            }
+        }
     }
 }  // namespace mamba
@@ -4,6 +4,8 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <chrono>
+
 #include <catch2/catch_all.hpp>
 
 #include "mamba/api/configuration.hpp"
@@ -310,6 +312,85 @@ namespace mamba
                 );
             }
 
+            TEST_CASE_METHOD(Configuration, "rc_snapshot")
+            {
+                const auto cache_dir = TemporaryDirectory();
+                util::set_env("XDG_CACHE_HOME", cache_dir.path().string());
+                util::set_env("MAMBA_TEST_CHANNEL", "test1");
+                const auto snapshot_file = cache_dir.path() / "mamba" / "rc_snapshot.bin";
+
+                const auto rc_file = tempfile_ptr->path();
+                // Recently modified files are not added to the snapshot
+                const auto old_time = fs::file_time_type::clock::now() - std::chrono::hours(1);
+                const auto write_rc = [&](const std::string& rc, fs::file_time_type time)
+                {
+                    {
+                        auto out = open_ofstream(rc_file);
+                        out << rc;
+                    }
+                    fs::last_write_time(rc_file, time);
+                };
+                const auto channels = [&]
+                { return config.at("channels").value<std::vector<std::string>>(); };
+                const auto load = [&]
+                {
+                    config.reset_configurables();
+                    config.at("rc_files").set_value<std::vector<fs::u8path>>({ rc_file });
+                    config.load();
+                };
+
+                write_rc("channels: [$MAMBA_TEST_CHANNEL]\nssl_verify: false", old_time);
+                load();
+                REQUIRE(fs::exists(snapshot_file));
+                REQUIRE(channels() == std::vector<std::string>{ "test1" });
+                REQUIRE(ctx.remote_fetch_params.ssl_verify == "<false>");
+
+                SECTION("Unchanged files are read from the snapshot")
+                {
+                    // Same size and modification time
+                    write_rc("channels: [$MAMBA_TEST_CHANNEL]\nssl_verify: fals2", old_time);
+                    load();
+                    REQUIRE(channels() == std::vector<std::string>{ "test1" });
+                    REQUIRE(ctx.remote_fetch_params.ssl_verify == "<false>");
+                }
+
+                SECTION("Modified files are read again")
+                {
+                    write_rc(
+                        "channels: [$MAMBA_TEST_CHANNEL]\nssl_verify: fals2",
+                        old_time + std::chrono::seconds(1)
+                    );
+                    load();
+                    REQUIRE(ctx.remote_fetch_params.ssl_verify == "fals2");
+                }
+
+                SECTION("Expanded environment variables are checked")
+                {
+                    util::set_env("MAMBA_TEST_CHANNEL", "test2");
+                    load();
+                    REQUIRE(channels() == std::vector<std::string>{ "test2" });
+                }
+
+                SECTION("Snapshot can be disabled")
+                {
+                    util::set_env("MAMBA_NO_RC_SNAPSHOT", "true");
+                    write_rc("channels: [$MAMBA_TEST_CHANNEL]\nssl_verify: fals2", old_time);
+                    load();
+                    REQUIRE(ctx.remote_fetch_params.ssl_verify == "fals2");
+                    ctx.src_params.no_rc_snapshot = false;
+                }
+
+                SECTION("Invalid snapshot is ignored")
+                {
+                    {
+                        auto out = open_ofstream(snapshot_file);
+                        out << "MAMBARC";
+                    }
+                    load();
+                    REQUIRE(channels() == std::vector<std::string>{ "test1" });
+                }
+            }
+
             TEST_CASE_METHOD(Configuration, "load_file_specs")
             {
                 std::string file_specs = unindent(R"(
@@ -10,6 +10,7 @@
 #include <string>
 
 #include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
 
 #include "mambatests.hpp"
 
@@ -22,6 +23,8 @@
 #include "mamba/core/channel_context.hpp"
 #include "mamba/core/history.hpp"
 #include "mamba/core/prefix_data.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/core/util_scope.hpp"
 
 #include "mambatests.hpp"
 
@@ -144,6 +147,111 @@ namespace mamba
             REQUIRE(installed_pkg_diff.find("xtl")->second.version == "0.8.0");
         }
 
+        TEST_CASE("history_index")
+        {
+            auto channel_context = ChannelContext::make_conda_compatible(mambatests::context());
+
+            const auto tmp_dir = TemporaryDirectory();
+            const auto history_file = tmp_dir.path() / "conda-meta" / "history";
+            const auto index_file = tmp_dir.path() / "conda-meta" / "history.idx";
+            fs::create_directories(history_file.parent_path());
+            fs::copy(mambatests::test_data_dir / "history/parse/conda-meta/history", history_file);
+
+            const auto spec = [](std::string_view str)
+            { return specs::MatchSpec::parse(str).value(); };
+            const auto expected_specs = std::unordered_map<std::string, specs::MatchSpec>{
+                { "cpp-tabulate", spec("cpp-tabulate") },
+                { "openssl", spec("openssl=3.5.0") },
+                { "wheel", spec("wheel=0.40.0") },
+                { "xtl", spec("xtl=0.8.0") },
+            };
+
+            History history_instance(tmp_dir.path(), channel_context);
+            REQUIRE(history_instance.get_requested_specs_map() == expected_specs);
+            REQUIRE(fs::exists(index_file));
+
+            SECTION("Requested specs are read from the index")
+            {
+                auto index = nlohmann::json::parse(open_ifstream(index_file));
+                index["requested_specs"]["pytest"] = "pytest>=8";
+                open_ofstream(index_file) << index.dump();
+
+                auto specs_map = History(tmp_dir.path(), channel_context).get_requested_specs_map();
+                REQUIRE(specs_map.size() == expected_specs.size() + 1);
+                REQUIRE(specs_map.at("pytest") == spec("pytest>=8"));
+            }
+
+            SECTION("New entries are indexed")
+            {
+                auto request = History::UserRequest{};
+                request.date = "2025-04-15 10:00:00";
+                request.cmd = "micromamba install numpy";
+                request.link_dists = { "conda-forge::numpy-2.2.4-py313h17eae1a_0" };
+                request.update = { "numpy>=2" };
+                history_instance.add_entry(request);
+
+                auto specs_map = history_instance.get_requested_specs_map();
+                REQUIRE(specs_map.size() == expected_specs.size() + 1);
+                REQUIRE(specs_map.at("numpy") == spec("numpy>=2"));
+
+                const auto all_requests = history_instance.get_user_requests();
+                const auto last_revision = all_requests.back().revision_num;
+                const auto new_requests = history_instance.get_user_requests_from_revision(
+                    last_revision
+                );
+                REQUIRE(new_requests.size() == 1);
+                REQUIRE(new_requests.front().revision_num == last_revision);
+                REQUIRE(new_requests.front().link_dists == request.link_dists);
+            }
+
+            SECTION("Rewritten history is indexed again")
+            {
+                {
+                    auto out = open_ofstream(history_file);
+                    out << "==> 2025-04-14 09:23:10 <==\n"
+                           "# cmd: micromamba install nlohmann_json\n"
+                           "+conda-forge::nlohmann_json-3.12.0-h3f2d84a_0\n"
+                           "# update specs: [\"nlohmann_json\"]\n";
+                }
+                auto specs_map = History(tmp_dir.path(), channel_context).get_requested_specs_map();
+                REQUIRE(specs_map.size() == 1);
+                REQUIRE(specs_map.at("nlohmann_json") == spec("nlohmann_json"));
+            }
+
+#ifndef _WIN32
+            SECTION("Read-only prefixes are not indexed")
+            {
+                fs::remove(index_file);
+                const auto conda_meta = history_file.parent_path();
+                const auto perms = fs::status(conda_meta).permissions();
+                fs::permissions(conda_meta, fs::perms::owner_read | fs::perms::owner_exec);
+                on_scope_exit restore_perms([&] { fs::permissions(conda_meta, perms); });
+
+                auto specs_map = History(tmp_dir.path(), channel_context).get_requested_specs_map();
+                REQUIRE(specs_map == expected_specs);
+                REQUIRE_FALSE(fs::exists(index_file));
+            }
+#endif
+
+            SECTION("Revision diff from the index")
+            {
+                const std::size_t target_revision = 1;
+                const auto pkg_diff = PackageDiff::from_revision(history_instance, target_revision);
+                const auto expected_diff = PackageDiff::from_revision(
+                    history_instance.get_user_requests(),
+                    target_revision
+                );
+                REQUIRE(pkg_diff.removed_pkg_diff.size() == expected_diff.removed_pkg_diff.size());
+                REQUIRE(
+                    pkg_diff.installed_pkg_diff.size() == expected_diff.installed_pkg_diff.size()
+                );
+                for (const auto& [name, pkg] : expected_diff.installed_pkg_diff)
+                {
+                    REQUIRE(pkg_diff.installed_pkg_diff.at(name).version == pkg.version);
+                }
+            }
+        }
+
 #ifndef _WIN32
         TEST_CASE("parse_segfault")
         {
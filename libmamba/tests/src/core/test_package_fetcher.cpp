@@ -4,6 +4,7 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <cstdint>
 #include <fstream>
 
 #include <catch2/catch_all.hpp>
@@ -13,6 +14,7 @@
 #include "mamba/core/package_handling.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/fs/filesystem.hpp"
+#include "mamba/validation/tools.hpp"
 
 #include "mambatests.hpp"
 
@@ -193,4 +195,85 @@ namespace
         REQUIRE(repodata_record["constrains"].size() == 1);
         REQUIRE(repodata_record["constrains"][0] == "pytz");
     }
+
+    TEST_CASE("StreamingExtraction")
+    {
+        TemporaryDirectory temp_dir;
+        const auto pkg_dir = temp_dir.path() / "pkg-1.0-0";
+        fs::create_directories(pkg_dir / "info");
+        fs::create_directories(pkg_dir / "lib");
+        {
+            std::ofstream index_file((pkg_dir / "info" / "index.json").std_path());
+            index_file << R"({"name": "pkg", "version": "1.0", "build": "0"})";
+            // Hardly compressible data, so that the package spans many writes
+            std::string data(100000, '\0');
+            std::uint32_t state = 1;
+            for (auto& c : data)
+            {
+                state = state * 1664525 + 1013904223;
+                c = static_cast<char>(state >> 24);
+            }
+            std::ofstream data_file((pkg_dir / "lib" / "data.txt").std_path(), std::ios::binary);
+            data_file << data;
+        }
+        const auto package_path = temp_dir.path() / "pkg-1.0-0.conda";
+        create_package(pkg_dir, package_path, /* compression_level= */ 1, /* compression_threads= */ 1);
+
+        std::string package;
+        {
+            auto in = open_ifstream(package_path);
+            package.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+
+        // Writes the package as a download does, not reporting the block at `skipped_offset`
+        const auto download_path = temp_dir.path() / "pkgs" / "pkg-1.0-0.conda";
+        fs::create_directories(download_path.parent_path());
+        constexpr std::size_t block_size = 1000;
+        REQUIRE(package.size() > 10 * block_size);
+        const auto download = [&](StreamingExtraction& extraction, std::size_t skipped_offset)
+        {
+            auto out = open_ofstream(download_path, std::ios::binary);
+            for (std::size_t offset = 0; offset < package.size(); offset += block_size)
+            {
+                const std::size_t size = std::min(block_size, package.size() - offset);
+                out.write(package.data() + offset, static_cast<std::streamsize>(size));
+                out.flush();
+                if (offset != skipped_offset)
+                {
+                    extraction.on_write(offset, size);
+                }
+            }
+        };
+        const auto dest_dir = temp_dir.path() / "pkgs" / "pkg-1.0-0.staging";
+
+        SECTION("Sequential writes")
+        {
+            StreamingExtraction extraction(download_path, package.size(), dest_dir, {});
+            download(extraction, package.size());
+
+            const auto sha256 = extraction.wait();
+            REQUIRE(sha256.has_value());
+            REQUIRE(sha256.value() == validation::sha256sum(package_path));
+            REQUIRE(fs::exists(dest_dir / "info" / "index.json"));
+            REQUIRE(fs::file_size(dest_dir / "lib" / "data.txt") == 100000);
+        }
+
+        SECTION("Missing write")
+        {
+            StreamingExtraction extraction(download_path, package.size(), dest_dir, {});
+            download(extraction, 5 * block_size);
+
+            REQUIRE_FALSE(extraction.wait().has_value());
+            REQUIRE_FALSE(fs::exists(dest_dir));
+        }
+
+        SECTION("Cancelled")
+        {
+            {
+                StreamingExtraction extraction(download_path, package.size(), dest_dir, {});
+                extraction.on_write(0, 0);
+            }
+            REQUIRE_FALSE(fs::exists(dest_dir));
+        }
+    }
 }
@@ -396,5 +396,28 @@ namespace mamba
             REQUIRE(ostream.str() == "conda-forge        0%");
             ostream.str("");
         }
+
+        TEST_CASE_METHOD(progress_bar, "report_progress")
+        {
+            // Applied when the manager prints the bars
+            proxy.report_progress(50, 200, 10);
+            REQUIRE_FALSE(proxy.started());
+            REQUIRE(proxy.current() == 0);
+
+            p_progress_bar_manager->print(ostream, 100);
+            REQUIRE(proxy.started());
+            REQUIRE(proxy.current() == 50);
+            REQUIRE(proxy.total() == 200);
+            REQUIRE(proxy.speed() == 10);
+            REQUIRE(proxy.progress() == 25.);
+
+            // Completing applies the last reported progress
+            proxy.report_progress(120, 0, 20);
+            proxy.mark_as_completed();
+            REQUIRE(proxy.completed());
+            REQUIRE(proxy.current() == 120);
+            REQUIRE(proxy.total() == 120);
+            REQUIRE(proxy.speed() == 20);
+        }
     }
 }  // namespace mamba
@@ -194,6 +194,23 @@ TEST_CASE("SubdirIndexLoader", "[mamba::core][mamba::core::SubdirIndexLoader]")
         CHECK(subdirs[1].valid_json_cache_path().has_value());
     }
 
+    SECTION("Fall back to repodata.json without zst index")
+    {
+        const auto tmp_dir = TemporaryDirectory();
+        auto caches = MultiPackageCache({ tmp_dir.path() }, ValidationParams{});
+
+        auto subdirs = std::array{
+            SubdirIndexLoader::create({}, local_channel, "linux-64", caches).value(),
+            SubdirIndexLoader::create({}, local_channel, "noarch", caches).value(),
+        };
+
+        auto result = SubdirIndexLoader::download_required_indexes(subdirs, {}, {}, mirrors, {}, {});
+        REQUIRE(result.has_value());
+
+        CHECK(subdirs[1].valid_cache_found());
+        CHECK_FALSE(subdirs[1].metadata().has_up_to_date_zst());
+    }
+
     SECTION("Download indexes repodata ttl")
     {
         const auto tmp_dir = TemporaryDirectory();
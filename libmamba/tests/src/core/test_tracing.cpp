@@ -0,0 +1,137 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <chrono>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <thread>
+
+#include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/tracing.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/core/util_scope.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        auto trace_span_names() -> std::multiset<std::string>
+        {
+            std::multiset<std::string> names;
+            const auto trace = tracing::to_trace_events();
+            for (const auto& event : trace["traceEvents"])
+            {
+                names.insert(event["name"].get<std::string>());
+            }
+            return names;
+        }
+    }
+
+    TEST_CASE("tracing")
+    {
+        tracing::clear_spans();
+        on_scope_exit guard(
+            []
+            {
+                tracing::disable_tracing();
+                tracing::clear_spans();
+            }
+        );
+
+        SECTION("Spans are not recorded when disabled")
+        {
+            REQUIRE_FALSE(tracing::is_tracing_enabled());
+            {
+                const auto span = tracing::ScopedSpan("disabled");
+            }
+            tracing::record_span("disabled", tracing::clock::now(), tracing::clock::now());
+            REQUIRE(trace_span_names().empty());
+        }
+
+        SECTION("Spans are recorded per thread")
+        {
+            tracing::enable_tracing();
+            const std::string package = "pkg";
+            {
+                const auto outer = tracing::ScopedSpan("outer");
+                const auto inner = tracing::ScopedSpan("inner", package);
+            }
+            std::thread([] { const auto span = tracing::ScopedSpan("worker"); }).join();
+            // Started before enabling the tracing, as the configuration loading
+            const auto earlier = tracing::clock::now() - std::chrono::seconds(1);
+            tracing::record_span("earlier", earlier, earlier + std::chrono::milliseconds(5));
+
+            const auto expected_names = std::multiset<std::string>{
+                "outer",
+                "inner",
+                "worker",
+                "earlier",
+            };
+            REQUIRE(trace_span_names() == expected_names);
+
+            const auto trace = tracing::to_trace_events();
+            std::set<std::int64_t> tids;
+            for (const auto& event : trace["traceEvents"])
+            {
+                REQUIRE(event["ph"] == "X");
+                REQUIRE(event["ts"].get<std::int64_t>() >= 0);
+                REQUIRE(event["dur"].get<std::int64_t>() >= 0);
+                tids.insert(event["tid"].get<std::int64_t>());
+                if (event["name"] == "inner")
+                {
+                    REQUIRE(event["args"]["detail"] == package);
+                }
+                if (event["name"] == "earlier")
+                {
+                    REQUIRE(event["ts"] == 0);
+                    REQUIRE(event["dur"] == 5000);
+                }
+            }
+            REQUIRE(tids.size() == 2);
+
+            const auto tmp_dir = TemporaryDirectory();
+            const auto trace_file = tmp_dir.path() / "trace.json";
+            tracing::write_trace(trace_file);
+            auto in = open_ifstream(trace_file);
+            REQUIRE(nlohmann::json::parse(in) == trace);
+
+            tracing::clear_spans();
+            REQUIRE(trace_span_names().empty());
+        }
+
+        SECTION("Spans are recorded on named tracks")
+        {
+            tracing::enable_tracing();
+            const auto start = tracing::clock::now();
+            const auto end = start + std::chrono::milliseconds(5);
+            // Overlapping spans of a single thread
+            tracing::record_track_span("first", "download", start, end);
+            tracing::record_track_span("second", "download", start, end);
+            tracing::record_track_span("first", "receiving", start, end);
+
+            const auto trace = tracing::to_trace_events();
+            std::set<std::int64_t> span_tids;
+            std::set<std::string> track_names;
+            for (const auto& event : trace["traceEvents"])
+            {
+                if (event["ph"] == "M")
+                {
+                    REQUIRE(event["name"] == "thread_name");
+                    track_names.insert(event["args"]["name"].get<std::string>());
+                }
+                else
+                {
+                    span_tids.insert(event["tid"].get<std::int64_t>());
+                }
+            }
+            REQUIRE(span_tids.size() == 2);
+            REQUIRE(track_names == std::set<std::string>{ "first", "second" });
+        }
+    }
+}
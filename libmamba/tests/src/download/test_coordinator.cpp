@@ -0,0 +1,239 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/core/util.hpp"
+#include "mamba/core/util_scope.hpp"
+#include "mamba/download/coordinator.hpp"
+#include "mamba/download/downloader.hpp"
+#include "mamba/util/string.hpp"
+#include "mamba/util/url_manip.hpp"
+#include "mamba/validation/tools.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        TEST_CASE("Fetch coordinator", "[mamba::download]")
+        {
+            if (!download::FetchCoordinator::is_supported())
+            {
+                SKIP("The fetch coordinator is not supported on this platform");
+            }
+
+            const auto tmp_dir = TemporaryDirectory();
+            const auto source = tmp_dir.path() / "pkg-1.0-0.tar.bz2";
+            {
+                auto out = open_ofstream(source);
+                out << "package content";
+            }
+            const auto url = util::path_to_url(source.string());
+            const auto sha256 = validation::sha256sum(source);
+
+            const auto socket = tmp_dir.path() / "coordinator.sock";
+            // Room for a single artifact
+            download::FetchCoordinator coordinator(
+                socket,
+                tmp_dir.path() / "staging",
+                download::RemoteFetchParams{},
+                specs::AuthenticationDataBase{},
+                download::Options{},
+                download::StagingLimits{ fs::file_size(source), std::chrono::hours(1) }
+            );
+            std::thread server([&coordinator] { coordinator.serve(); });
+            on_scope_exit guard(
+                [&]
+                {
+                    coordinator.stop();
+                    server.join();
+                }
+            );
+            // Wait for the coordinator to listen
+            for (int i = 0; i < 100 && !fs::exists(socket); ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            REQUIRE(fs::exists(socket));
+
+            auto options = download::Options{};
+            options.coordinator_socket = socket.string();
+
+            const auto fetch = [&](const fs::u8path& filename,
+                                   const std::string& checksum,
+                                   bool is_valid = true,
+                                   const std::string& from_url = {})
+            {
+                download::Request request(
+                    "pkg",
+                    download::MirrorName(""),
+                    from_url.empty() ? url : from_url,
+                    filename.string(),
+                    /* lhead_only= */ false,
+                    /* lignore_failure= */ true
+                );
+                request.sha256 = checksum;
+                request.on_success = [is_valid](const download::Success&) -> expected_t<void>
+                {
+                    if (is_valid)
+                    {
+                        return {};
+                    }
+                    return make_unexpected("Invalid package", mamba_error_code::unknown);
+                };
+                return download::download(std::move(request), {}, {}, {}, options);
+            };
+
+            const auto first = tmp_dir.path() / "first" / "pkg-1.0-0.tar.bz2";
+            const auto second = tmp_dir.path() / "second" / "pkg-1.0-0.tar.bz2";
+            fs::create_directories(first.parent_path());
+            fs::create_directories(second.parent_path());
+
+            SECTION("Serve requests")
+            {
+                const auto res = fetch(first, sha256);
+                REQUIRE(res.has_value());
+                REQUIRE(std::get<download::Filename>(res.value().content).value == first.string());
+                REQUIRE(fs::file_size(first) == fs::file_size(source));
+
+                // The artifacts with a checksum are served again without being downloaded
+                fs::remove(source);
+                REQUIRE(fetch(second, sha256).has_value());
+                REQUIRE(fs::file_size(second) == fs::file_size(first));
+
+                // Each requester gets its own copy
+                open_ofstream(second) << "modified";
+                REQUIRE(fs::file_size(first) == std::string_view("package content").size());
+            }
+
+            SECTION("Least recently requested artifacts are removed beyond the staging limits")
+            {
+                const auto other_source = tmp_dir.path() / "other-1.0-0.tar.bz2";
+                open_ofstream(other_source) << "other content";
+                const auto other_url = util::path_to_url(other_source.string());
+                const auto other_sha256 = validation::sha256sum(other_source);
+
+                REQUIRE(fetch(first, sha256).has_value());
+                REQUIRE(fetch(second, other_sha256, true, other_url).has_value());
+                REQUIRE(coordinator.downloaded_count() == 2);
+
+                // Only the last artifact is still served without being downloaded
+                fs::remove(source);
+                fs::remove(other_source);
+                REQUIRE(fetch(second, other_sha256, true, other_url).has_value());
+                REQUIRE_FALSE(fetch(first, sha256).has_value());
+            }
+
+#ifndef _WIN32
+            SECTION("Concurrent requests are downloaded once")
+            {
+                // The coordinator reads the pipe once all the clients wait for the artifact
+                const auto pipe = tmp_dir.path() / "pipe-1.0-0.tar.bz2";
+                REQUIRE(::mkfifo(pipe.string().c_str(), S_IRUSR | S_IWUSR) == 0);
+                const auto pipe_url = util::path_to_url(pipe.string());
+
+                constexpr std::size_t client_count = 4;
+                std::vector<fs::u8path> targets;
+                std::vector<std::optional<download::Result>> results(client_count);
+                std::vector<std::thread> clients;
+                for (std::size_t i = 0; i < client_count; ++i)
+                {
+                    targets.push_back(tmp_dir.path() / std::to_string(i) / "pipe-1.0-0.tar.bz2");
+                    fs::create_directories(targets.back().parent_path());
+                }
+                for (std::size_t i = 0; i < client_count; ++i)
+                {
+                    clients.emplace_back(
+                        [&, i] { results[i] = fetch(targets[i], sha256, true, pipe_url); }
+                    );
+                }
+                on_scope_exit join_clients(
+                    [&]
+                    {
+                        for (auto& client : clients)
+                        {
+                            client.join();
+                        }
+                    }
+                );
+                for (int i = 0; i < 500 && coordinator.requested_count() < client_count; ++i)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                REQUIRE(coordinator.requested_count() == client_count);
+
+                // Opening a pipe to write fails until it is opened to read
+                int fd = -1;
+                for (int i = 0; i < 500 && fd < 0; ++i)
+                {
+                    fd = ::open(pipe.string().c_str(), O_WRONLY | O_NONBLOCK);
+                    if (fd < 0)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                }
+                REQUIRE(fd >= 0);
+                const std::string content = "package content";
+                const auto written = ::write(fd, content.data(), content.size());
+                ::close(fd);
+                REQUIRE(written == static_cast<ssize_t>(content.size()));
+
+                for (auto& client : clients)
+                {
+                    client.join();
+                }
+                clients.clear();
+
+                REQUIRE(coordinator.downloaded_count() == 1);
+                for (std::size_t i = 0; i < client_count; ++i)
+                {
+                    REQUIRE(results[i].has_value());
+                    REQUIRE(results[i].value().has_value());
+                    auto in = open_ifstream(targets[i]);
+                    const auto received = std::string(std::istreambuf_iterator<char>(in), {});
+                    REQUIRE(received == content);
+                }
+            }
+#endif
+
+            SECTION("Artifacts not matching their checksum are not served")
+            {
+                const auto res = fetch(first, std::string(64, '0'));
+                REQUIRE_FALSE(res.has_value());
+                REQUIRE(util::contains(res.error().message, "checksum"));
+            }
+
+            SECTION("Artifacts failing the client validation are dropped")
+            {
+                REQUIRE_FALSE(fetch(first, sha256, /* is_valid= */ false).has_value());
+
+                // Downloaded again rather than served from the staging directory
+                fs::remove(source);
+                REQUIRE_FALSE(fetch(second, sha256).has_value());
+            }
+
+            SECTION("Fallback to in-process downloads")
+            {
+                options.coordinator_socket = (tmp_dir.path() / "none.sock").string();
+                const auto target = tmp_dir.path() / "pkg.tar.bz2";
+                REQUIRE(fetch(target, sha256).has_value());
+                REQUIRE(fs::file_size(target) == fs::file_size(source));
+            }
+        }
+    }
+}
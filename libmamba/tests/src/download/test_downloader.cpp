@@ -10,6 +10,10 @@
 #include "mamba/core/util.hpp"
 #include "mamba/download/downloader.hpp"
 #include "mamba/util/string.hpp"
+#include "mamba/util/url_manip.hpp"
+
+#include "../src/download/curl.hpp"
+#include "../src/download/downloader_impl.hpp"
 
 namespace mamba
 {
@@ -45,6 +49,133 @@ namespace mamba
             REQUIRE_THROWS_AS(download::download(dl_request, {}, {}, {}), std::runtime_error);
         }
 
+        TEST_CASE("Spread downloads across mirrors", "[mamba::download]")
+        {
+            const auto tmp_dir = TemporaryDirectory();
+
+            auto mirrors = download::mirror_map();
+            for (const auto* name : { "mirror_a", "mirror_b" })
+            {
+                const auto subdir = tmp_dir.path() / name / "noarch";
+                fs::create_directories(subdir);
+                auto out = open_ofstream(subdir / "pkg.txt");
+                out << "content";
+                out.close();
+                mirrors.add_unique_mirror(
+                    "channel",
+                    download::make_mirror(util::path_to_url((tmp_dir.path() / name).string()))
+                );
+            }
+
+            download::MultiRequest requests;
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                requests.emplace_back(
+                    fmt::format("pkg_{}", i),
+                    download::MirrorName("channel"),
+                    "noarch/pkg.txt",
+                    (tmp_dir.path() / fmt::format("pkg_{}.txt", i)).string()
+                );
+            }
+
+            auto options = download::Options{};
+            options.download_threads = 4;
+            download::MultiResult res = download::download(requests, mirrors, {}, {}, options);
+            REQUIRE(res.size() == std::size_t(4));
+            for (const auto& r : res)
+            {
+                REQUIRE(r.has_value());
+            }
+
+            // Without measurements, the transfers are spread over the least loaded mirrors
+            for (const auto& mirror : mirrors.get_mirrors("channel"))
+            {
+                REQUIRE(mirror->successful_transfers() > 0);
+                REQUIRE(mirror->performance().measured_transfers > 0);
+            }
+        }
+
+        TEST_CASE("Reuse transfer resources across downloads", "[mamba::download]")
+        {
+            const auto tmp_dir = TemporaryDirectory();
+            auto out = open_ofstream(tmp_dir.path() / "pkg.txt");
+            out << "content";
+            out.close();
+            const auto url = util::path_to_url((tmp_dir.path() / "pkg.txt").string());
+
+            auto& context = download::TransferContext::instance();
+            const auto initial_stats = context.stats();
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                download::Request request(
+                    "pkg",
+                    download::MirrorName(""),
+                    url,
+                    (tmp_dir.path() / fmt::format("pkg_{}.txt", i)).string()
+                );
+                REQUIRE(download::download(std::move(request), {}, {}, {}).has_value());
+            }
+            REQUIRE(context.stats().transfer_count == initial_stats.transfer_count + 2);
+
+            // Released handles are handed out again
+            auto handle = context.acquire_handle();
+            const auto id = handle.get_id();
+            context.release_handle(std::move(handle));
+            REQUIRE(context.acquire_handle().get_id() == id);
+        }
+
+        TEST_CASE("Transfer budget", "[mamba::download]")
+        {
+            SECTION("Connections per host")
+            {
+                auto budget = download::TransferBudget(0, 2);
+                REQUIRE(budget.free_connections("conda.anaconda.org") == 2);
+
+                budget.add_connection("conda.anaconda.org");
+                budget.add_connection("conda.anaconda.org");
+                REQUIRE(budget.free_connections("conda.anaconda.org") == 0);
+                REQUIRE(budget.free_connections("repo.prefix.dev") == 2);
+
+                budget.remove_connection("conda.anaconda.org");
+                REQUIRE(budget.free_connections("conda.anaconda.org") == 1);
+
+                // Local files are not limited
+                budget.add_connection("");
+                budget.add_connection("");
+                budget.add_connection("");
+                REQUIRE(budget.free_connections("") > 0);
+            }
+
+            SECTION("Unlimited bandwidth")
+            {
+                auto budget = download::TransferBudget(0, 0);
+                download::CURLHandle handle;
+                REQUIRE(budget.consume_bandwidth(handle, std::size_t(1) << 30));
+                REQUIRE(budget.consume_bandwidth(handle, std::size_t(1) << 30));
+                REQUIRE_FALSE(budget.next_resume_time().has_value());
+            }
+
+            SECTION("Paused transfers")
+            {
+                auto budget = download::TransferBudget(1024, 0);
+                download::CURLHandle first;
+                download::CURLHandle second;
+
+                // The last write may exceed the bucket, the next ones wait for it to refill
+                REQUIRE(budget.consume_bandwidth(first, 1024 * 1024));
+                REQUIRE_FALSE(budget.consume_bandwidth(second, 1024));
+                REQUIRE_FALSE(budget.consume_bandwidth(first, 1024));
+
+                const auto resume_time = budget.next_resume_time();
+                REQUIRE(resume_time.has_value());
+                REQUIRE(resume_time.value() > std::chrono::steady_clock::now());
+
+                budget.forget_transfer(first);
+                budget.forget_transfer(second);
+                REQUIRE_FALSE(budget.next_resume_time().has_value());
+            }
+        }
+
         TEST_CASE("Use CA certificate from the root prefix", "[mamba::download]")
         {
             const auto tmp_dir = TemporaryDirectory();
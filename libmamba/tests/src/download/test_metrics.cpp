@@ -0,0 +1,120 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/tracing.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/core/util_scope.hpp"
+#include "mamba/download/downloader.hpp"
+#include "mamba/download/metrics.hpp"
+#include "mamba/util/url_manip.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        TEST_CASE("TransferMetrics", "[mamba::download]")
+        {
+            const auto tmp_dir = TemporaryDirectory();
+            const auto source = tmp_dir.path() / "pkg.txt";
+            {
+                auto out = open_ofstream(source);
+                out << "package content";
+            }
+
+            download::MultiRequest requests;
+            requests.emplace_back(
+                "pkg",
+                download::MirrorName(""),
+                util::path_to_url(source.string()),
+                (tmp_dir.path() / "pkg_copy.txt").string()
+            );
+            requests.emplace_back(
+                "missing",
+                download::MirrorName(""),
+                util::path_to_url((tmp_dir.path() / "missing.txt").string()),
+                (tmp_dir.path() / "missing_copy.txt").string(),
+                /* lhead_only= */ false,
+                /* lignore_failure= */ true
+            );
+            bool progress_called = false;
+            requests.front().progress = [&progress_called](const download::Event&)
+            { progress_called = true; };
+
+            tracing::clear_spans();
+            tracing::enable_tracing();
+            on_scope_exit guard(
+                []
+                {
+                    tracing::disable_tracing();
+                    tracing::clear_spans();
+                }
+            );
+
+            download::TransferMetrics metrics;
+            metrics.observe(requests);
+            download::download(std::move(requests), {}, {}, {});
+            REQUIRE(progress_called);
+
+            SECTION("JSON report")
+            {
+                const auto report = metrics.to_json();
+                REQUIRE(report["transfers"].size() == 2);
+
+                const auto& pkg = report["transfers"][0];
+                REQUIRE(pkg["name"] == "pkg");
+                REQUIRE(pkg["success"] == true);
+                REQUIRE(pkg["attempts"] == 1);
+                REQUIRE(pkg["downloaded_size"] == fs::file_size(source));
+                REQUIRE(pkg["timings_us"].contains("first_byte"));
+
+                const auto& missing = report["transfers"][1];
+                REQUIRE(missing["name"] == "missing");
+                REQUIRE(missing["success"] == false);
+                REQUIRE(missing.contains("error"));
+
+                const auto& total = report["total"];
+                REQUIRE(total["transfers"] == 2);
+                REQUIRE(total["failed"] == 1);
+                REQUIRE(total["downloaded_size"] == fs::file_size(source));
+            }
+
+            SECTION("Trace events")
+            {
+                const auto trace = tracing::to_trace_events();
+                const auto& events = trace["traceEvents"];
+                REQUIRE(events.is_array());
+
+                const auto has_event = [&events](std::string_view name, std::string_view ph)
+                {
+                    return std::any_of(
+                        events.begin(),
+                        events.end(),
+                        [&](const auto& e) { return e["name"] == name && e["ph"] == ph; }
+                    );
+                };
+                REQUIRE(has_event("download", "X"));
+                REQUIRE(has_event("thread_name", "M"));
+                for (const auto& e : events)
+                {
+                    if (e["ph"] == "M")
+                    {
+                        REQUIRE(
+                            ((e["args"]["name"] == "pkg") || (e["args"]["name"] == "missing"))
+                        );
+                    }
+                    if (e["ph"] == "X")
+                    {
+                        REQUIRE(e["ts"].get<std::int64_t>() >= 0);
+                        REQUIRE(e["dur"].get<std::int64_t>() >= 0);
+                    }
+                }
+            }
+        }
+    }
+}
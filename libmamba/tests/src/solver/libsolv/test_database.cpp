@@ -327,30 +327,44 @@ namespace
                 REQUIRE(repo1.has_value());
                 REQUIRE(repo1->package_count() == 33);
 
-                db.for_each_package_in_repo(
-                    repo1.value(),
-                    [&](const auto& p)
+                const auto check_signatures = [](const specs::PackageInfo& p)
+                {
+                    if (p.name == "_libgcc_mutex")
                     {
-                        if (p.name == "_libgcc_mutex")
-                        {
-                            REQUIRE(
-                                p.signatures
-                                == R"({"signatures":{"0b7a133184c9c98333923dhfdg86031adc5db1fds54kfga941fe2c94a12fdjg8":{"signature":"0b83c91ddd8b81bbc7a67a586bde4a271bd8f97069c25306870e314f3664ab02083c91ddd8b0dfjsg763jbd0jh14671d960bb303d1eb787307c04c414ediz95a"}}})"
-                            );
-                        }
-                        else if (p.name == "bzip2")
-                        {
-                            REQUIRE(
-                                p.signatures
-                                == R"({"signatures":{"f7a651f55db194031a6c1240b7a133184c9c98333923dc9319d1fe2c94a1242d":{"signature":"058bf4b5d5cb738736870e314f3664b83c91ddd8b81bbc7a67a875d0454c14671d960a02858e059d154876dab6bde853d763c1a3bd8f97069c25304a2710200d"}}})"
-                            );
-                        }
-                        else
-                        {
-                            REQUIRE(p.signatures == "");
-                        }
+                        REQUIRE(
+                            p.signatures
+                            == R"({"signatures":{"0b7a133184c9c98333923dhfdg86031adc5db1fds54kfga941fe2c94a12fdjg8":{"signature":"0b83c91ddd8b81bbc7a67a586bde4a271bd8f97069c25306870e314f3664ab02083c91ddd8b0dfjsg763jbd0jh14671d960bb303d1eb787307c04c414ediz95a"}}})"
+                        );
                     }
-                );
+                    else if (p.name == "bzip2")
+                    {
+                        REQUIRE(
+                            p.signatures
+                            == R"({"signatures":{"f7a651f55db194031a6c1240b7a133184c9c98333923dc9319d1fe2c94a1242d":{"signature":"058bf4b5d5cb738736870e314f3664b83c91ddd8b81bbc7a67a875d0454c14671d960a02858e059d154876dab6bde853d763c1a3bd8f97069c25304a2710200d"}}})"
+                        );
+                    }
+                    else
+                    {
+                        REQUIRE(p.signatures == "");
+                    }
+                };
+                db.for_each_package_in_repo(repo1.value(), check_signatures);
+
+                SECTION("Read serialized repo")
+                {
+                    auto tmp_dir = TemporaryDirectory();
+                    auto solv_file = tmp_dir.path() / "repo1.solv";
+                    auto origin = libsolv::RepodataOrigin{
+                        /* .url= */ "https://repo.mamba.pm",
+                        /* .etag= */ "etag",
+                        /* .mod= */ "Fri, 11 Feb 2022 13:52:44 GMT",
+                    };
+                    db.native_serialize_repo(repo1.value(), solv_file, origin);
+                    auto repo2 = db.add_repo_from_native_serialization(solv_file, origin, "conda-forge")
+                                     .value();
+                    REQUIRE(repo2.package_count() == 33);
+                    db.for_each_package_in_repo(repo2, check_signatures);
+                }
             }
 
             SECTION("Using libsolv parser")
@@ -0,0 +1,145 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <array>
+#include <variant>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/portfolio_solver.hpp"
+#include "mamba/specs/match_spec.hpp"
+#include "mamba/specs/package_info.hpp"
+
+using namespace mamba;
+using namespace mamba::solver;
+
+namespace
+{
+    using namespace specs::match_spec_literals;
+
+    TEST_CASE("Default portfolio strategies", "[mamba::solver][mamba::solver::libsolv]")
+    {
+        SECTION("Default flags")
+        {
+            const auto strategies = libsolv::default_portfolio_strategies({});
+            REQUIRE(strategies.size() == 4);
+            REQUIRE(strategies[0].name == "requested");
+            REQUIRE(strategies[1].name == "flexible_priority");
+            REQUIRE_FALSE(strategies[1].flags.strict_repo_priority);
+            // Downgrades are already allowed by default, hence "allow_downgrade" and "relaxed"
+            // are the same as the previous strategies.
+            REQUIRE(strategies[2].name == "reordered");
+            REQUIRE(strategies[3].name == "force_reinstall");
+        }
+
+        SECTION("Strict flags")
+        {
+            auto flags = Request::Flags();
+            flags.allow_downgrade = false;
+            const auto strategies = libsolv::default_portfolio_strategies(flags);
+            REQUIRE(strategies.size() == 6);
+            REQUIRE(strategies[2].name == "allow_downgrade");
+            REQUIRE(strategies[2].flags.allow_downgrade);
+            REQUIRE(strategies[3].name == "relaxed");
+        }
+    }
+
+    TEST_CASE("Solve with a PortfolioSolver", "[mamba::solver][mamba::solver::libsolv]")
+    {
+        auto db = libsolv::Database({});
+
+        const auto repo1 = db.add_repo_from_packages(
+            std::array{ specs::PackageInfo("numpy", "1.0.0", "repo1", 0) },
+            "repo1",
+            libsolv::PipAsPythonDependency::No
+        );
+        const auto repo2 = db.add_repo_from_packages(
+            std::array{ specs::PackageInfo("numpy", "2.0.0", "repo2", 0) },
+            "repo2",
+            libsolv::PipAsPythonDependency::No
+        );
+        db.set_repo_priority(repo1, { 2, 0 });
+        db.set_repo_priority(repo2, { 1, 0 });
+
+        const auto max_threads = GENERATE(std::size_t(1), std::size_t(4));
+
+        SECTION("The requested flags are preferred")
+        {
+            const auto request = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "numpy"_ms } },
+            };
+            const auto outcome = libsolv::PortfolioSolver({}, max_threads).solve(db, request);
+
+            REQUIRE(outcome.has_value());
+            REQUIRE(outcome->has_solution());
+            REQUIRE(outcome->solved_index == 0);
+            const auto& solution = outcome->solution();
+            REQUIRE(solution.actions.size() == 1);
+            const auto& install = std::get<Solution::Install>(solution.actions.front());
+            REQUIRE(install.install.version == "1.0.0");
+        }
+
+        SECTION("Relaxed flags are used when the request is not satisfiable")
+        {
+            const auto request = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "numpy>=2.0"_ms } },
+            };
+            const auto outcome = libsolv::PortfolioSolver({}, max_threads).solve(db, request);
+
+            REQUIRE(outcome.has_value());
+            REQUIRE(outcome->has_solution());
+            REQUIRE(outcome->solved_index == 1);
+            REQUIRE(outcome->attempts[1].strategy.name == "flexible_priority");
+            const auto& solution = outcome->solution();
+            REQUIRE(solution.actions.size() == 1);
+            const auto& install = std::get<Solution::Install>(solution.actions.front());
+            REQUIRE(install.install.version == "2.0.0");
+
+            // The first attempt is always run
+            REQUIRE(outcome->attempts[0].outcome.has_value());
+            REQUIRE(outcome->unsolvables().size() >= 1);
+        }
+
+        SECTION("All problems are reported")
+        {
+            const auto request = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "numpy>=3.0"_ms } },
+            };
+            const auto outcome = libsolv::PortfolioSolver({}, max_threads).solve(db, request);
+
+            REQUIRE(outcome.has_value());
+            REQUIRE_FALSE(outcome->has_solution());
+            const auto unsolvables = outcome->unsolvables();
+            REQUIRE(unsolvables.size() == outcome->attempts.size());
+            for (const auto* attempt : unsolvables)
+            {
+                const auto& unsolvable = std::get<libsolv::UnSolvable>(attempt->outcome->value());
+                REQUIRE_FALSE(unsolvable.problems(*attempt->database).empty());
+            }
+        }
+
+        SECTION("Custom strategies")
+        {
+            auto flexible = Request::Flags();
+            flexible.strict_repo_priority = false;
+            auto solver = libsolv::PortfolioSolver({ { "flexible", flexible } }, max_threads);
+
+            const auto request = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "numpy>=2.0"_ms } },
+            };
+            const auto outcome = solver.solve(db, request);
+
+            REQUIRE(outcome.has_value());
+            REQUIRE(outcome->attempts.size() == 1);
+            REQUIRE(outcome->solved_index == 0);
+        }
+    }
+}
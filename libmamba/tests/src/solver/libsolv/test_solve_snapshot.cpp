@@ -0,0 +1,132 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <array>
+#include <variant>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/core/util.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/solve_snapshot.hpp"
+#include "mamba/solver/libsolv/solver.hpp"
+#include "mamba/specs/match_spec.hpp"
+#include "mamba/specs/package_info.hpp"
+
+using namespace mamba;
+using namespace mamba::solver;
+
+namespace
+{
+    using namespace specs::match_spec_literals;
+
+    TEST_CASE("Write and read a SolveSnapshot", "[mamba::solver][mamba::solver::libsolv]")
+    {
+        const auto tmp_dir = TemporaryDirectory();
+        const auto snapshot_dir = tmp_dir.path() / "snapshot";
+
+        auto db = libsolv::Database({});
+        const auto installed = db.add_repo_from_packages(
+            std::array{ specs::PackageInfo("numpy", "1.0.0", "installed", 0) },
+            "installed"
+        );
+        db.set_installed_repo(installed);
+        const auto repo = db.add_repo_from_packages(
+            std::array{
+                specs::PackageInfo("numpy", "1.0.0", "repo", 0),
+                specs::PackageInfo("numpy", "2.0.0", "repo", 0),
+                specs::PackageInfo("scipy", "1.0.0", "repo", 0),
+            },
+            "repo"
+        );
+        db.set_repo_priority(repo, { 3, 1 });
+
+        auto request = Request{
+            /* .flags= */ {},
+            /* .jobs= */ {
+                Request::Update{ "numpy"_ms, false },
+                Request::Install{ "scipy>=1.0"_ms },
+                Request::Keep{ "numpy"_ms },
+                Request::Pin{ "numpy<3.0"_ms },
+            },
+        };
+        request.flags.allow_uninstall = false;
+
+        const auto written = libsolv::SolveSnapshot::write(
+            db,
+            request,
+            snapshot_dir,
+            libsolv::MatchSpecParser::Libsolv
+        );
+        REQUIRE(written.has_value());
+        REQUIRE(fs::exists(snapshot_dir / libsolv::SolveSnapshot::metadata_filename));
+
+        auto snapshot = libsolv::SolveSnapshot::read(snapshot_dir, {});
+        REQUIRE(snapshot.has_value());
+
+        SECTION("Database and request are restored")
+        {
+            auto& replay_db = snapshot->database;
+            REQUIRE(replay_db.repo_count() == db.repo_count());
+            REQUIRE(replay_db.package_count() == db.package_count());
+            REQUIRE(replay_db.installed_repo().has_value());
+            REQUIRE(replay_db.installed_repo()->name() == "installed");
+            REQUIRE(snapshot->matchspec_parser == libsolv::MatchSpecParser::Libsolv);
+
+            const auto& replay_request = snapshot->request;
+            REQUIRE_FALSE(replay_request.flags.allow_uninstall);
+            REQUIRE(replay_request.jobs.size() == request.jobs.size());
+            const auto& update = std::get<Request::Update>(replay_request.jobs[0]);
+            REQUIRE(update.spec.to_string() == "numpy");
+            REQUIRE_FALSE(update.clean_dependencies);
+            REQUIRE(std::get<Request::Install>(replay_request.jobs[1]).spec.to_string() == "scipy>=1.0");
+            REQUIRE(std::holds_alternative<Request::Keep>(replay_request.jobs[2]));
+            REQUIRE(std::holds_alternative<Request::Pin>(replay_request.jobs[3]));
+
+            replay_db.for_each_package_matching(
+                "scipy"_ms,
+                [&](const auto& pkg) { REQUIRE(pkg.version == "1.0.0"); }
+            );
+        }
+
+        SECTION("Same solution on the replayed solve")
+        {
+            const auto outcome = libsolv::Solver().solve(db, request);
+            REQUIRE(outcome.has_value());
+            REQUIRE(std::holds_alternative<Solution>(outcome.value()));
+            const auto& solution = std::get<Solution>(outcome.value());
+
+            const auto replay_outcome = libsolv::Solver().solve(
+                snapshot->database,
+                snapshot->request,
+                snapshot->matchspec_parser
+            );
+            REQUIRE(replay_outcome.has_value());
+            REQUIRE(std::holds_alternative<Solution>(replay_outcome.value()));
+            const auto& replay_solution = std::get<Solution>(replay_outcome.value());
+            REQUIRE(replay_solution.actions.size() == solution.actions.size());
+        }
+    }
+
+    TEST_CASE("Read an invalid SolveSnapshot", "[mamba::solver][mamba::solver::libsolv]")
+    {
+        const auto tmp_dir = TemporaryDirectory();
+
+        SECTION("Missing directory")
+        {
+            REQUIRE_FALSE(libsolv::SolveSnapshot::read(tmp_dir.path() / "missing", {}).has_value());
+        }
+
+        SECTION("Unknown job")
+        {
+            auto out = open_ofstream(tmp_dir.path() / libsolv::SolveSnapshot::metadata_filename);
+            out << R"({"version": 1, "settings": {}, "repos": [],)"
+                << R"("request": {"flags": {}, "jobs": [{"type": "dance"}]}})";
+            out.close();
+            REQUIRE_FALSE(libsolv::SolveSnapshot::read(tmp_dir.path(), {}).has_value());
+        }
+    }
+}
@@ -0,0 +1,210 @@
+// Copyright (c) 2024, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/solver.hpp"
+#include "mamba/solver/libsolv/solver_session.hpp"
+#include "mamba/specs/match_spec.hpp"
+#include "mamba/specs/package_info.hpp"
+
+using namespace mamba;
+using namespace mamba::solver;
+
+namespace
+{
+    using namespace specs::match_spec_literals;
+    using PackageInfo = specs::PackageInfo;
+
+    auto make_pkg(std::string name, std::string version, std::vector<std::string> deps = {})
+        -> PackageInfo
+    {
+        auto pkg = PackageInfo(std::move(name));
+        pkg.version = std::move(version);
+        pkg.dependencies = std::move(deps);
+        return pkg;
+    }
+
+    auto installed_version(const Solution& solution, std::string_view name)
+        -> std::optional<std::string>
+    {
+        for (const auto& action : solution.actions)
+        {
+            if (const auto* install = std::get_if<Solution::Install>(&action))
+            {
+                if (install->install.name == name)
+                {
+                    return install->install.version;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    auto solve_ok(libsolv::SolverSession& session, const Request& request) -> Solution
+    {
+        auto outcome = session.solve(request);
+        REQUIRE(outcome.has_value());
+        REQUIRE(std::holds_alternative<Solution>(outcome.value()));
+        return std::get<Solution>(std::move(outcome).value());
+    }
+
+    TEST_CASE("Solve with a SolverSession", "[mamba::solver][mamba::solver::libsolv]")
+    {
+        auto db = libsolv::Database({});
+        db.add_repo_from_packages(
+            std::array{
+                make_pkg("foo", "1.0"),
+                make_pkg("foo", "2.0"),
+                make_pkg("bar", "1.0", { "foo=1.0" }),
+                make_pkg("bar", "2.0", { "foo=2.0" }),
+            },
+            "repo",
+            libsolv::PipAsPythonDependency::No
+        );
+
+        auto session = libsolv::SolverSession(db);
+
+        SECTION("Repeated solves reuse the whatprovides index and jobs")
+        {
+            const auto request = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "bar"_ms } },
+            };
+
+            const auto first = solve_ok(session, request);
+            REQUIRE(installed_version(first, "bar") == "2.0");
+            REQUIRE(installed_version(first, "foo") == "2.0");
+            REQUIRE(session.whatprovides_build_count() == 1);
+            REQUIRE(session.job_cache_hit_count() == 0);
+
+            const auto second = solve_ok(session, request);
+            REQUIRE(second.actions.size() == first.actions.size());
+            REQUIRE(session.whatprovides_build_count() == 1);
+            REQUIRE(session.job_cache_hit_count() == 1);
+
+            // Same outcome as a fresh solver
+            const auto outcome = libsolv::Solver().solve(db, request);
+            REQUIRE(outcome.has_value());
+            REQUIRE(std::holds_alternative<Solution>(outcome.value()));
+            REQUIRE(std::get<Solution>(outcome.value()).actions.size() == first.actions.size());
+        }
+
+        SECTION("Pins are reused and replaced")
+        {
+            const auto pinned = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Pin{ "foo=1.0"_ms }, Request::Install{ "bar"_ms } },
+            };
+
+            const auto first = solve_ok(session, pinned);
+            REQUIRE(installed_version(first, "bar") == "1.0");
+            REQUIRE(installed_version(first, "foo") == "1.0");
+            REQUIRE(session.whatprovides_build_count() == 1);
+
+            const auto second = solve_ok(session, pinned);
+            REQUIRE(installed_version(second, "bar") == "1.0");
+            REQUIRE(session.whatprovides_build_count() == 1);
+
+            const auto other_pin = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Pin{ "foo=2.0"_ms }, Request::Install{ "bar"_ms } },
+            };
+            const auto third = solve_ok(session, other_pin);
+            REQUIRE(installed_version(third, "bar") == "2.0");
+            REQUIRE(session.whatprovides_build_count() == 2);
+
+            const auto unpinned = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "foo<2.0"_ms } },
+            };
+            const auto fourth = solve_ok(session, unpinned);
+            REQUIRE(installed_version(fourth, "foo") == "1.0");
+        }
+
+        SECTION("Swap installed packages")
+        {
+            const auto request = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "foo"_ms } },
+            };
+
+            session.set_installed_packages(std::array{ make_pkg("foo", "1.0") });
+            REQUIRE(solve_ok(session, request).actions.empty());
+
+            session.set_installed_packages(std::vector<PackageInfo>{});
+            REQUIRE(installed_version(solve_ok(session, request), "foo") == "2.0");
+            REQUIRE(session.whatprovides_build_count() == 2);
+            REQUIRE(db.repo_count() == 2);
+        }
+
+        SECTION("Changes in the database are detected")
+        {
+            const auto request = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "foo"_ms } },
+            };
+            REQUIRE(installed_version(solve_ok(session, request), "foo") == "2.0");
+
+            db.add_repo_from_packages(
+                std::array{ make_pkg("foo", "3.0") },
+                "other",
+                libsolv::PipAsPythonDependency::No
+            );
+            REQUIRE(installed_version(solve_ok(session, request), "foo") == "3.0");
+            REQUIRE(session.whatprovides_build_count() == 2);
+        }
+
+        SECTION("Replacing a repository with one of the same size is detected")
+        {
+            const auto request = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "baz"_ms } },
+            };
+
+            auto repo = db.add_repo_from_packages(
+                std::array{ make_pkg("baz", "1.0", { "foo=1.0" }), make_pkg("qux", "1.0") },
+                "refreshed",
+                libsolv::PipAsPythonDependency::No
+            );
+            REQUIRE(installed_version(solve_ok(session, request), "foo") == "1.0");
+
+            // The freed repository and solvable ids are reused by the new repository
+            db.remove_repo(repo);
+            db.add_repo_from_packages(
+                std::array{ make_pkg("baz", "1.0", { "quux" }), make_pkg("quux", "1.0") },
+                "refreshed",
+                libsolv::PipAsPythonDependency::No
+            );
+            const auto solution = solve_ok(session, request);
+            REQUIRE(installed_version(solution, "quux") == "1.0");
+            REQUIRE_FALSE(installed_version(solution, "foo").has_value());
+            REQUIRE(session.whatprovides_build_count() == 2);
+        }
+
+        SECTION("Invalidate discards the reused state")
+        {
+            const auto request = Request{
+                /* .flags= */ {},
+                /* .jobs= */ { Request::Install{ "foo"_ms } },
+            };
+            REQUIRE(installed_version(solve_ok(session, request), "foo") == "2.0");
+
+            session.invalidate();
+            REQUIRE(installed_version(solve_ok(session, request), "foo") == "2.0");
+            REQUIRE(session.whatprovides_build_count() == 2);
+            REQUIRE(session.job_cache_hit_count() == 0);
+        }
+    }
+}
@@ -634,6 +634,77 @@ TEST_CASE("NamedList", "[mamba::solver]")
     }
 }
 
+namespace
+{
+    /**
+     * The pairwise merge criteria formerly used by default, used as a reference.
+     */
+    auto reference_merge_criteria(
+        const ProblemsGraph& pbs,
+        ProblemsGraph::node_id n1,
+        ProblemsGraph::node_id n2
+    ) -> bool
+    {
+        using node_id = ProblemsGraph::node_id;
+        const auto& g = pbs.graph();
+        auto node_name = [](const ProblemsGraph::node_t& node) -> std::string_view
+        {
+            return std::visit(
+                [](const auto& n) -> std::string_view
+                {
+                    using Node = std::remove_cv_t<std::remove_reference_t<decltype(n)>>;
+                    if constexpr (std::is_same_v<Node, ProblemsGraph::RootNode>)
+                    {
+                        return "";
+                    }
+                    else if constexpr (std::is_same_v<Node, ProblemsGraph::PackageNode>)
+                    {
+                        return n.name;
+                    }
+                    else
+                    {
+                        return n.name().to_string();
+                    }
+                },
+                node
+            );
+        };
+        auto is_leaf = [&g](node_id n) -> bool { return g.successors(n).size() == 0; };
+        auto leaves_from = [&g](node_id n) -> util::flat_set<node_id>
+        {
+            auto leaves = std::vector<node_id>();
+            g.for_each_leaf_id_from(n, [&leaves](node_id m) { leaves.push_back(m); });
+            return util::flat_set(std::move(leaves));
+        };
+        return (node_name(g.node(n1)) == node_name(g.node(n2)))
+               && !(pbs.conflicts().in_conflict(n1, n2))
+               && ((is_leaf(n1) && is_leaf(n2)) || (leaves_from(n1) == leaves_from(n2)))
+               && ((!is_leaf(n1) && !is_leaf(n2)) || (g.predecessors(n1) == g.predecessors(n2)));
+    }
+
+    using problem_factory = decltype(&create_basic_conflict);
+
+    auto problem_scenarios() -> std::vector<std::pair<std::string_view, problem_factory>>
+    {
+        return {
+            { "Basic conflict", &create_basic_conflict },
+            { "PubGrub example", &create_pubgrub },
+            { "Harder PubGrub example", &create_pubgrub_hard },
+            { "PubGrub example with missing packages", &create_pubgrub_missing },
+            { "Pin conflict", &create_pin_conflict },
+            { "PyTorch CPU", &create_pytorch_cpu },
+            { "PyTorch Cuda", &create_pytorch_cuda },
+            { "Cuda Toolkit", &create_cudatoolkit },
+            { "Jpeg", &create_jpeg9b },
+            { "R base", &create_r_base },
+            { "SCIP", &create_scip },
+            { "Two different Python", &create_double_python },
+            { "Numba", &create_numba },
+            { "Sudoku", &create_sudoku },
+        };
+    }
+}
+
 TEST_CASE("Create problem graph", "[mamba::solver]")
 {
     const auto [name, factory] = GENERATE(
@@ -779,6 +850,41 @@ TEST_CASE("Create problem graph", "[mamba::solver]")
                 REQUIRE(tmp);
             }
 
+            SECTION("Same compression as the pairwise merge criteria")
+            {
+                const auto pbs_ref = CompressedProblemsGraph::from_problems_graph(
+                    pbs_simplified,
+                    &reference_merge_criteria
+                );
+                const auto& graph_ref = pbs_ref.graph();
+                REQUIRE(graph_comp.number_of_nodes() == graph_ref.number_of_nodes());
+                REQUIRE(graph_comp.number_of_edges() == graph_ref.number_of_edges());
+                REQUIRE(problem_tree_msg(pbs_comp) == problem_tree_msg(pbs_ref));
+            }
+
+            SECTION("Compose error message with a budget")
+            {
+                const auto message = problem_tree_msg(pbs_comp);
+                const auto n_lines = util::split(message, "\n").size();
+
+                auto format = ProblemsMessageFormat();
+                format.max_lines = 2;
+                const auto truncated = problem_tree_msg(pbs_comp, format);
+                REQUIRE(util::split(truncated, "\n").size() <= 3);
+                if (n_lines > 2)
+                {
+                    REQUIRE(util::ends_with(truncated, "(explanation truncated)."));
+                }
+                else
+                {
+                    REQUIRE(truncated == message);
+                }
+
+                format.max_lines = 0;
+                format.time_budget = std::chrono::hours(1);
+                REQUIRE(problem_tree_msg(pbs_comp, format) == message);
+            }
+
             SECTION("Compose error message")
             {
                 const auto message = problem_tree_msg(pbs_comp);
@@ -806,3 +912,44 @@ TEST_CASE("Create problem graph", "[mamba::solver]")
         }
     }
 }
+
+TEST_CASE("Benchmark problem graph explanation", "[mamba::solver][.benchmark]")
+{
+    auto& ctx = mambatests::context();
+    auto channel_context = ChannelContext::make_conda_compatible(ctx);
+
+    for (const auto& [name, factory] : problem_scenarios())
+    {
+        auto [db, request] = factory(ctx, channel_context);
+        auto outcome = solver::libsolv::Solver().solve(db, request).value();
+        REQUIRE(std::holds_alternative<solver::libsolv::UnSolvable>(outcome));
+        auto& unsolvable = std::get<solver::libsolv::UnSolvable>(outcome);
+        const auto pbs_init = unsolvable.problems_graph(db);
+        const auto pbs_simplified = simplify_conflicts(pbs_init);
+        const auto pbs_comp = CompressedProblemsGraph::from_problems_graph(pbs_simplified);
+
+        BENCHMARK(fmt::format("{} - problems_graph", name))
+        {
+            return unsolvable.problems_graph(db);
+        };
+        BENCHMARK(fmt::format("{} - simplify_conflicts", name))
+        {
+            return simplify_conflicts(pbs_init);
+        };
+        BENCHMARK(fmt::format("{} - from_problems_graph", name))
+        {
+            return CompressedProblemsGraph::from_problems_graph(pbs_simplified);
+        };
+        BENCHMARK(fmt::format("{} - from_problems_graph (pairwise)", name))
+        {
+            return CompressedProblemsGraph::from_problems_graph(
+                pbs_simplified,
+                &reference_merge_criteria
+            );
+        };
+        BENCHMARK(fmt::format("{} - problem_tree_msg", name))
+        {
+            return problem_tree_msg(pbs_comp);
+        };
+    }
+}
@@ -5,7 +5,10 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <array>
+#include <random>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <catch2/catch_all.hpp>
 
@@ -623,4 +626,153 @@ namespace
         REQUIRE(hash_fn(spec1) == hash_fn(spec2));
         REQUIRE(hash_fn(spec1) != hash_fn(spec3));
     }
+
+    TEST_CASE("VersionKey", "[mamba::specs][mamba::specs::VersionSpec]")
+    {
+        REQUIRE(VersionKey::make("1.2.3"_v).has_value());
+        REQUIRE(VersionKey::make("2!1.2.3"_v).has_value());
+        REQUIRE(VersionKey::make("1.2.3.0.0.0.0.0"_v).has_value());
+        REQUIRE_FALSE(VersionKey::make("1.2.3.0.0.0.0.1"_v).has_value());
+        REQUIRE_FALSE(VersionKey::make("1.2.3a"_v).has_value());
+        REQUIRE_FALSE(VersionKey::make("1.2.3+local"_v).has_value());
+
+        const auto key = [](std::string_view str)
+        { return VersionKey::make(Version::parse(str).value()).value(); };
+        REQUIRE(key("1.2") == key("1.2.0"));
+        REQUIRE(key("1.2") < key("1.10"));
+        REQUIRE(key("1.2") > key("1.1.9"));
+        REQUIRE(key("1!0.1") > key("9.9"));
+        REQUIRE(key("1.2.3").starts_with(key("1.2")));
+        REQUIRE(key("1.2").starts_with(key("1.2.0")));
+        REQUIRE_FALSE(key("1.2").starts_with(key("1.2.1")));
+        REQUIRE_FALSE(key("1.20").starts_with(key("1.2")));
+    }
+
+    TEST_CASE("CompiledVersionSpec", "[mamba::specs][mamba::specs::VersionSpec]")
+    {
+        REQUIRE(CompiledVersionSpec().contains("1.0"_v));
+        REQUIRE(CompiledVersionSpec(VersionSpec()).program_size() == 0);
+
+        const auto spec = CompiledVersionSpec(">=1.2,<2.0|>=3.1,!=3.1.5"_vs);
+        REQUIRE(spec.program_size() == 4);
+        REQUIRE(spec.contains("1.2"_v));
+        REQUIRE(spec.contains("1.9.9"_v));
+        REQUIRE_FALSE(spec.contains("2.0"_v));
+        REQUIRE_FALSE(spec.contains("3.0"_v));
+        REQUIRE(spec.contains("3.1"_v));
+        REQUIRE_FALSE(spec.contains("3.1.5"_v));
+        REQUIRE(spec.contains("3.1.5post1"_v));
+        REQUIRE(spec.contains("4.0a"_v));
+    }
+
+    namespace
+    {
+        template <typename Generator>
+        auto random_version_str(Generator& gen) -> std::string
+        {
+            static constexpr auto literals = std::array<std::string_view, 6>{
+                "a", "dev", "post", "rc", "_", "*",
+            };
+            auto pick = [&](std::size_t n)
+            { return std::uniform_int_distribution<std::size_t>(0, n - 1)(gen); };
+
+            auto out = std::string();
+            if (pick(10) == 0)
+            {
+                out += std::to_string(pick(3)) + "!";
+            }
+            const auto n_parts = 1 + pick(8);
+            for (std::size_t i = 0; i < n_parts; ++i)
+            {
+                if (i > 0)
+                {
+                    out += ".";
+                }
+                // Mostly small numbers to get many equalities
+                out += std::to_string(pick(4) == 0 ? pick(20) : pick(3));
+                if (pick(8) == 0)
+                {
+                    out += literals[pick(literals.size() - 1)];
+                }
+            }
+            if (pick(15) == 0)
+            {
+                out += "+" + std::to_string(pick(3));
+            }
+            return out;
+        }
+
+        template <typename Generator>
+        auto random_spec_str(Generator& gen, std::size_t depth = 0) -> std::string
+        {
+            static constexpr auto operators = std::array<std::string_view, 10>{
+                "", "==", "!=", ">", ">=", "<", "<=", "=", "~=", "*",
+            };
+            auto pick = [&](std::size_t n)
+            { return std::uniform_int_distribution<std::size_t>(0, n - 1)(gen); };
+
+            if ((depth < 3) && (pick(3) == 0))
+            {
+                const auto* const op = pick(2) == 0 ? "," : "|";
+                return "(" + random_spec_str(gen, depth + 1) + op + random_spec_str(gen, depth + 1)
+                       + ")";
+            }
+
+            const auto op = operators[pick(operators.size())];
+            if (op == "*")
+            {
+                return "*";
+            }
+            auto out = std::string(op) + random_version_str(gen);
+            if (pick(4) == 0)
+            {
+                out += ".*";
+            }
+            if ((depth < 3) && (pick(2) == 0))
+            {
+                out += (pick(2) == 0 ? "," : "|") + random_spec_str(gen, depth + 1);
+            }
+            return out;
+        }
+    }
+
+    TEST_CASE(
+        "CompiledVersionSpec differential fuzzing",
+        "[mamba::specs][mamba::specs::VersionSpec]"
+    )
+    {
+        // Fixed seed for reproducibility
+        auto gen = std::mt19937(42);
+
+        auto versions = std::vector<Version>();
+        while (versions.size() < 200)
+        {
+            if (auto ver = Version::parse(random_version_str(gen)))
+            {
+                versions.push_back(std::move(ver).value());
+            }
+        }
+
+        std::size_t n_specs = 0;
+        while (n_specs < 2000)
+        {
+            const auto str = random_spec_str(gen);
+            auto maybe_spec = VersionSpec::parse(str);
+            if (!maybe_spec.has_value())
+            {
+                continue;
+            }
+            ++n_specs;
+            const auto& spec = maybe_spec.value();
+            const auto compiled = CompiledVersionSpec(spec);
+            for (const auto& ver : versions)
+            {
+                if (compiled.contains(ver) != spec.contains(ver))
+                {
+                    CAPTURE(str, spec.to_string(), ver.to_string());
+                    REQUIRE(compiled.contains(ver) == spec.contains(ver));
+                }
+            }
+        }
+    }
 }
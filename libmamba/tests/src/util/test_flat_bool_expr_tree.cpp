@@ -451,6 +451,68 @@ namespace
         }
     }
 
+    TEST_CASE("Jump linearization")
+    {
+        auto parser = InfixParser<std::size_t, BoolOperator>{};
+        // Infix:  ((x0 or x1) and (x2 or x3 or x4) and x5) or x6
+        REQUIRE(parser.push_left_parenthesis());
+        REQUIRE(parser.push_left_parenthesis());
+        REQUIRE(parser.push_variable(0));
+        REQUIRE(parser.push_operator(BoolOperator::logical_or));
+        REQUIRE(parser.push_variable(1));
+        REQUIRE(parser.push_right_parenthesis());
+        REQUIRE(parser.push_operator(BoolOperator::logical_and));
+        REQUIRE(parser.push_left_parenthesis());
+        REQUIRE(parser.push_variable(2));
+        REQUIRE(parser.push_operator(BoolOperator::logical_or));
+        REQUIRE(parser.push_variable(3));
+        REQUIRE(parser.push_operator(BoolOperator::logical_or));
+        REQUIRE(parser.push_variable(4));
+        REQUIRE(parser.push_right_parenthesis());
+        REQUIRE(parser.push_operator(BoolOperator::logical_and));
+        REQUIRE(parser.push_variable(5));
+        REQUIRE(parser.push_right_parenthesis());
+        REQUIRE(parser.push_operator(BoolOperator::logical_or));
+        REQUIRE(parser.push_variable(6));
+        REQUIRE(parser.finalize());
+        auto tree = flat_bool_expr_tree(std::move(parser).tree());
+
+        struct Jump
+        {
+            std::size_t var;
+            std::size_t on_true;
+            std::size_t on_false;
+        };
+
+        auto jumps = std::vector<Jump>();
+        tree.for_each_jump([&](std::size_t var, std::size_t on_true, std::size_t on_false)
+                           { jumps.push_back({ var, on_true, on_false }); });
+
+        static constexpr std::size_t n_vars = 7;
+        REQUIRE(jumps.size() == n_vars);
+        for (std::size_t i = 0; i < n_vars; ++i)
+        {
+            CAPTURE(i);
+            // Variables are visited in order and jumps only go forward
+            REQUIRE(jumps[i].var == i);
+            REQUIRE(jumps[i].on_true > i);
+            REQUIRE(jumps[i].on_false > i);
+        }
+
+        for (std::size_t x = 0; x < (1 << n_vars); ++x)
+        {
+            const auto values = integer_to_bools<n_vars>(x);
+            CAPTURE(values);
+            auto pos = std::size_t(0);
+            while (pos < jumps.size())
+            {
+                pos = values[jumps[pos].var] ? jumps[pos].on_true : jumps[pos].on_false;
+            }
+            const auto eval = [&values](std::size_t idx) { return values[idx]; };
+            REQUIRE((pos == n_vars) == tree.evaluate(eval));
+        }
+    }
+
     TEST_CASE("Infix traversal")
     {
         auto parser = InfixParser<std::size_t, BoolOperator>{};
@@ -0,0 +1,151 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <stdexcept>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/util/encoding.hpp"
+#include "mamba/validation/errors.hpp"
+#include "mamba/validation/signature_verifier.hpp"
+#include "mamba/validation/tools.hpp"
+
+using namespace mamba;
+using namespace mamba::validation;
+
+class SignatureVerifierT
+{
+public:
+
+    SignatureVerifierT()
+    {
+        for (auto& [pk, sk] : keypairs)
+        {
+            generate_ed25519_keypair(pk.data(), sk.data());
+            keyring.keys[hex(pk)] = Key::from_ed25519(hex(pk));
+        }
+        keyring.threshold = 2;
+    }
+
+protected:
+
+    using keypair_type = std::pair<
+        std::array<std::byte, MAMBA_ED25519_KEYSIZE_BYTES>,
+        std::array<std::byte, MAMBA_ED25519_KEYSIZE_BYTES>>;
+
+    std::array<keypair_type, 3> keypairs;
+    RoleFullKeys keyring;
+    std::string data = "Some text.";
+
+    template <std::size_t size>
+    static auto hex(const std::array<std::byte, size>& bytes) -> std::string
+    {
+        return util::bytes_to_hex_str(bytes.data(), bytes.data() + bytes.size());
+    }
+
+    auto signature(std::size_t key, const std::string& signed_data) const -> RoleSignature
+    {
+        std::array<std::byte, MAMBA_ED25519_SIGSIZE_BYTES> sig;
+        sign(signed_data, keypairs[key].second.data(), sig.data());
+        return { hex(keypairs[key].first), hex(sig), "" };
+    }
+};
+
+namespace
+{
+    TEST_CASE_METHOD(SignatureVerifierT, "count_valid_signatures")
+    {
+        const SignatureVerifier verifier(keyring);
+        REQUIRE(verifier.threshold() == 2);
+
+        REQUIRE(verifier.count_valid_signatures(data, { signature(0, data) }) == 1);
+        REQUIRE(
+            verifier.count_valid_signatures(data, { signature(0, data), signature(1, "Other text.") })
+            == 1
+        );
+        // Counting stops at the threshold
+        REQUIRE(
+            verifier.count_valid_signatures(
+                data,
+                { signature(0, data), signature(1, data), signature(2, data) }
+            )
+            == 2
+        );
+
+        const RoleSignature unknown_key = { "unknown", signature(0, data).sig, "" };
+        const RoleSignature illformed = { signature(1, data).keyid, "not_hex", "" };
+        REQUIRE(verifier.count_valid_signatures(data, { unknown_key, illformed }) == 0);
+    }
+
+    TEST_CASE_METHOD(SignatureVerifierT, "check_signatures")
+    {
+        const SignatureVerifier verifier(keyring);
+        verifier.check_signatures(data, { signature(0, data), signature(2, data) });
+        REQUIRE_THROWS_AS(verifier.check_signatures(data, { signature(0, data) }), threshold_error);
+    }
+
+    TEST_CASE("check_signatures_pgp")
+    {
+        // Same data and signature as the GPG tests of the validation tools
+        const std::string pk = "2b920f88531576643ada0a632915d1dcdd377557647093f29cbe251ba8c33724";
+        const std::string sig = "d891de3fc102a2ff7b96559ff2f4d81a8e25b5d51a44e10a9fbc5bdc3febf22120582f30e26f6dfe9450ca8100566af7cbc286bf7f52c700d074acd3d4a01603";
+        const std::string trailer = "04001608001d1621040673d781a8b80bcb7b002040ac7bc8bcf821360d050260a52453";
+        const std::string data = R"({
+  "delegations": {
+    "key_mgr": {
+      "pubkeys": [
+        "013ddd714962866d12ba5bae273f14d48c89cf0773dee2dbf6d4561e521c83f7"
+      ],
+      "threshold": 1
+    },
+    "root": {
+      "pubkeys": [
+        "2b920f88531576643ada0a632915d1dcdd377557647093f29cbe251ba8c33724"
+      ],
+      "threshold": 1
+    }
+  },
+  "expiration": "2022-05-19T14:44:35Z",
+  "metadata_spec_version": "0.6.0",
+  "timestamp": "2021-05-19T14:44:35Z",
+  "type": "root",
+  "version": 1
+})";
+
+        const SignatureVerifier verifier(RoleFullKeys({ { pk, Key::from_ed25519(pk) } }, 1));
+        verifier.check_signatures(data, { { pk, sig, trailer } });
+        REQUIRE(verifier.count_valid_signatures(data + " ", { { pk, sig, trailer } }) == 0);
+        REQUIRE(verifier.count_valid_signatures(data, { { pk, sig, "not_hex" } }) == 0);
+    }
+
+    TEST_CASE("find_invalid_in_parallel")
+    {
+        REQUIRE(find_invalid_in_parallel(0, [](std::size_t) { return false; }).empty());
+
+        const auto invalid = find_invalid_in_parallel(
+            1000,
+            [](std::size_t i) { return (i % 97) != 3; }
+        );
+        REQUIRE(
+            invalid == std::vector<std::size_t>{ 3, 100, 197, 294, 391, 488, 585, 682, 779, 876, 973 }
+        );
+
+        REQUIRE_THROWS_AS(
+            find_invalid_in_parallel(
+                1000,
+                [](std::size_t i)
+                {
+                    if (i == 500)
+                    {
+                        throw std::runtime_error("invalid item");
+                    }
+                    return true;
+                }
+            ),
+            std::runtime_error
+        );
+    }
+}
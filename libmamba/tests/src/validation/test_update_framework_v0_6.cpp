@@ -1166,6 +1166,61 @@ namespace
             index_error
         );
     }
+
+    TEST_CASE_METHOD(PkgMgrT_v06, "verify_index_many_packages")
+    {
+        auto key_mgr = root->create_key_mgr(key_mgr_json);
+        auto pkg_mgr = key_mgr.create_pkg_mgr(pkg_mgr_json);
+
+        // More packages than a single batch of the parallel verification
+        const auto pkg = repodata_json["packages"]["test-package1-0.1-0.tar.bz2"];
+        for (int i = 0; i < 300; ++i)
+        {
+            auto pkg_i = pkg;
+            pkg_i["build_number"] = i;
+            const auto filename = "test-package1-0.1-" + std::to_string(i) + ".tar.bz2";
+            repodata_json["packages"][filename] = pkg_i;
+        }
+        const auto many_signed_repodata_json = sign_repodata();
+        pkg_mgr.verify_index(many_signed_repodata_json);
+
+        nl::json wrong_pkg_patch = R"([
+                                { "op": "replace", "path": "/packages/test-package1-0.1-250.tar.bz2/version", "value": "0.1.1" }
+                                ])"_json;
+        REQUIRE_THROWS_AS(
+            pkg_mgr.verify_index(many_signed_repodata_json.patch(wrong_pkg_patch)),
+            package_error
+        );
+    }
+
+    TEST_CASE_METHOD(PkgMgrT_v06, "verify_packages")
+    {
+        auto key_mgr = root->create_key_mgr(key_mgr_json);
+        auto pkg_mgr = key_mgr.create_pkg_mgr(pkg_mgr_json);
+
+        std::vector<RepoIndexChecker::signed_package> packages;
+        for (const auto& [name, meta] : signed_repodata_json["packages"].items())
+        {
+            packages.emplace_back(
+                meta,
+                nl::json{ { "signatures", signed_repodata_json["signatures"][name] } }
+            );
+        }
+        pkg_mgr.verify_packages(packages);
+
+        packages.front().first["version"] = "0.1.1";
+        REQUIRE_THROWS_AS(pkg_mgr.verify_packages(packages), package_error);
+    }
+
+    TEST_CASE_METHOD(PkgMgrT_v06, "keys_fingerprint")
+    {
+        auto key_mgr = root->create_key_mgr(key_mgr_json);
+        auto pkg_mgr = key_mgr.create_pkg_mgr(pkg_mgr_json);
+        REQUIRE_FALSE(pkg_mgr.keys_fingerprint().empty());
+        REQUIRE(
+            pkg_mgr.keys_fingerprint() == key_mgr.create_pkg_mgr(pkg_mgr_json).keys_fingerprint()
+        );
+    }
 }
 
 class RepoCheckerT : public PkgMgrT_v06
@@ -1226,6 +1281,31 @@ namespace
         checker.verify_index(signed_repodata_json);
     }
 
+    TEST_CASE_METHOD(RepoCheckerT, "verify_index_from_path")
+    {
+        const auto cache_dir = channel_dir->path() / "cache";
+        fs::create_directories(cache_dir);
+        RepoChecker checker(mambatests::context(), m_repo_base_url, m_ref_path, cache_dir);
+        checker.generate_index_checker();
+
+        const auto repodata_file = channel_dir->path() / "repodata.json";
+        write_role(signed_repodata_json, repodata_file);
+        checker.verify_index(repodata_file);
+        // The verified index is recorded, with its hash
+        std::ifstream verified_file((cache_dir / "verified_indexes.json").std_path());
+        const auto verified = nl::json::parse(verified_file);
+        REQUIRE(verified.contains(repodata_file.string()));
+        REQUIRE(verified[repodata_file.string()]["sha256"] == sha256sum(repodata_file));
+        checker.verify_index(repodata_file);
+
+        // A modified index is verified again
+        nl::json wrong_pkg_patch = R"([
+                                { "op": "replace", "path": "/packages/test-package1-0.1-0.tar.bz2/version", "value": "0.1.1" }
+                                ])"_json;
+        write_role(signed_repodata_json.patch(wrong_pkg_patch), repodata_file);
+        REQUIRE_THROWS_AS(checker.verify_index(repodata_file), index_error);
+    }
+
     TEST_CASE_METHOD(RepoCheckerT, "root_freeze_attack")
     {
         nl::json patch = nl::json::parse(
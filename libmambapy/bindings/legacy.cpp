@@ -8,6 +8,7 @@
 
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
+#include <pybind11/chrono.h>
 #include <pybind11/functional.h>
 #include <pybind11/iostream.h>
 #include <pybind11/operators.h>
@@ -184,7 +185,6 @@ namespace mambapy
             expected_t<void> download_res;
             if (SubdirIndexMonitor::can_monitor(ctx))
             {
-                SubdirIndexMonitor check_monitor({ true, true });
                 SubdirIndexMonitor index_monitor;
                 download_res = SubdirIndexLoader::download_required_indexes(
                     m_subdirs,
@@ -193,7 +193,6 @@ namespace mambapy
                     ctx.mirrors,
                     ctx.download_options(),
                     ctx.remote_fetch_params,
-                    &check_monitor,
                     &index_monitor
                 );
             }
@@ -494,7 +493,15 @@ bind_submodule_impl(pybind11::module_ m)
         .def_readwrite("download_threads", &download::Options::download_threads)
         .def_readwrite("fail_fast", &download::Options::fail_fast)
         .def_readwrite("sort", &download::Options::sort)
-        .def_readwrite("verbose", &download::Options::verbose);
+        .def_readwrite("verbose", &download::Options::verbose)
+        .def_readwrite("hedge_min_size", &download::Options::hedge_min_size)
+        .def_readwrite("hedge_min_speed_Bps", &download::Options::hedge_min_speed_Bps)
+        .def_readwrite("hedge_delay", &download::Options::hedge_delay)
+        .def_readwrite("chunk_min_size", &download::Options::chunk_min_size)
+        .def_readwrite("max_chunks", &download::Options::max_chunks)
+        .def_readwrite("max_speed_Bps", &download::Options::max_speed_Bps)
+        .def_readwrite("max_host_connections", &download::Options::max_host_connections)
+        .def_readwrite("coordinator_socket", &download::Options::coordinator_socket);
 
     py::class_<download::mirror_map>(m, "MirrorMap")
         .def(py::init<>())
@@ -986,6 +993,12 @@ bind_submodule_impl(pybind11::module_ m)
         .def_readwrite("show_anaconda_channel_warnings", &Context::show_anaconda_channel_warnings)
         .def_readwrite("dry_run", &Context::dry_run)
         .def_readwrite("download_only", &Context::download_only)
+        .def_readwrite("download_chunk_min_size", &Context::download_chunk_min_size)
+        .def_readwrite("download_max_speed", &Context::download_max_speed)
+        .def_readwrite("download_max_host_connections", &Context::download_max_host_connections)
+        .def_readwrite("download_coordinator", &Context::download_coordinator)
+        .def_readwrite("trace_file", &Context::trace_file)
+        .def_readwrite("extract_while_downloading", &Context::extract_while_downloading)
         .def_readwrite("add_pip_as_python_dependency", &Context::add_pip_as_python_dependency)
         .def_readwrite("envs_dirs", &Context::envs_dirs)
         .def_readwrite("pkgs_dirs", &Context::pkgs_dirs)
@@ -1722,6 +1735,7 @@ bind_submodule_impl(pybind11::module_ m)
                     /* .sparse= */ sparse,
                     // Unused by this function so we're not making it part of the API
                     /* .subproc_mode= */ extract_subproc_mode::mamba_package,
+                    /* .streaming= */ false,
                 }
             );
         }
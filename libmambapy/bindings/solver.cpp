@@ -2,6 +2,7 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <pybind11/chrono.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -404,22 +405,30 @@ namespace mambapy
                 py::init(
                     [](fmt::text_style unavailable,
                        fmt::text_style available,
-                       std::array<std::string_view, 4> indents) -> ProblemsMessageFormat
+                       std::array<std::string_view, 4> indents,
+                       std::size_t max_lines,
+                       std::chrono::milliseconds time_budget) -> ProblemsMessageFormat
                     {
                         return {
                             /* .unavailable= */ unavailable,
                             /* .available= */ available,
                             /* .indents= */ indents,
+                            /* .max_lines= */ max_lines,
+                            /* .time_budget= */ time_budget,
                         };
                     }
                 ),
                 py::arg("unavailable"),
                 py::arg("available"),
-                py::arg("indents")
+                py::arg("indents"),
+                py::arg("max_lines") = 0,
+                py::arg("time_budget") = std::chrono::milliseconds(0)
             )
             .def_readwrite("unavailable", &ProblemsMessageFormat::unavailable)
             .def_readwrite("available", &ProblemsMessageFormat::available)
             .def_readwrite("indents", &ProblemsMessageFormat::indents)
+            .def_readwrite("max_lines", &ProblemsMessageFormat::max_lines)
+            .def_readwrite("time_budget", &ProblemsMessageFormat::time_budget)
             .def("__copy__", &copy<ProblemsMessageFormat>)
             .def("__deepcopy__", &deepcopy<ProblemsMessageFormat>, py::arg("memo"));
 
@@ -14,6 +14,7 @@
 #include "mamba/solver/libsolv/parameters.hpp"
 #include "mamba/solver/libsolv/repo_info.hpp"
 #include "mamba/solver/libsolv/solver.hpp"
+#include "mamba/solver/libsolv/solver_session.hpp"
 #include "mamba/solver/libsolv/unsolvable.hpp"
 
 #include "bind_utils.hpp"
@@ -315,5 +316,41 @@ namespace mambapy
                     throw std::runtime_error("Use Solver.solve");
                 }
             );
+
+        py::class_<SolverSession>(m, "SolverSession")
+            .def(py::init<Database&>(), py::arg("database"), py::keep_alive<1, 2>())
+            .def(
+                "set_installed_packages",
+                [](SolverSession& self,
+                   py::iterable packages,
+                   std::string_view name,
+                   PipAsPythonDependency add)
+                {
+                    static constexpr auto cast = [](py::handle pkg)
+                    { return pkg.cast<specs::PackageInfo>(); };
+
+                    return self.set_installed_packages(
+                        packages | std::ranges::views::transform(cast),
+                        name,
+                        add
+                    );
+                },
+                py::arg("packages"),
+                py::arg("name") = "installed",
+                py::arg("add_pip_as_python_dependency") = PipAsPythonDependency::No
+            )
+            .def("invalidate", &SolverSession::invalidate)
+            .def(
+                "solve",
+                [](SolverSession& self, const solver::Request& request, MatchSpecParser ms_parser)
+                { return self.solve(request, ms_parser); },
+                py::arg("request"),
+                py::arg("matchspec_parser") = MatchSpecParser::Mixed
+            )
+            .def_property_readonly(
+                "whatprovides_build_count",
+                &SolverSession::whatprovides_build_count
+            )
+            .def_property_readonly("job_cache_hit_count", &SolverSession::job_cache_hit_count);
     }
 }
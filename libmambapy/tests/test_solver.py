@@ -1,5 +1,6 @@
 import random
 import copy
+import datetime
 
 import pytest
 
@@ -236,14 +237,20 @@ def test_ProblemsMessageFormat():
     assert format.available.foreground == libmambapy.utils.TextTerminalColor.Green
     assert format.unavailable.foreground == libmambapy.utils.TextTerminalColor.Red
     assert format.indents == ["a", "b", "c", "d"]
+    assert format.max_lines == 0
+    assert format.time_budget == datetime.timedelta(0)
 
     # Setters
     format.available = libmambapy.utils.TextStyle(foreground="White")
     format.unavailable = libmambapy.utils.TextStyle(foreground="Black")
     format.indents = ["1", "2", "3", "4"]
+    format.max_lines = 10
+    format.time_budget = datetime.timedelta(milliseconds=50)
     assert format.available.foreground == libmambapy.utils.TextTerminalColor.White
     assert format.unavailable.foreground == libmambapy.utils.TextTerminalColor.Black
     assert format.indents == ["1", "2", "3", "4"]
+    assert format.max_lines == 10
+    assert format.time_budget == datetime.timedelta(milliseconds=50)
 
     # Copy
     other = copy.deepcopy(format)
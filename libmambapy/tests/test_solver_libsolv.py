@@ -324,3 +324,36 @@ def test_Solver_Solution():
 
     assert isinstance(outcome, libmambapy.solver.Solution)
     assert len(outcome.actions) == 1
+
+
+def test_SolverSession():
+    Request = libmambapy.solver.Request
+
+    db = libsolv.Database(libmambapy.specs.ChannelResolveParams())
+    db.add_repo_from_packages(
+        [
+            libmambapy.specs.PackageInfo(name="foo", version="1.0"),
+            libmambapy.specs.PackageInfo(name="foo", version="2.0"),
+        ],
+    )
+
+    session = libsolv.SolverSession(db)
+    request = Request([Request.Install(libmambapy.specs.MatchSpec.parse("foo"))])
+
+    outcome = session.solve(request)
+    assert isinstance(outcome, libmambapy.solver.Solution)
+    assert len(outcome.actions) == 1
+
+    session.set_installed_packages([libmambapy.specs.PackageInfo(name="foo", version="1.0")])
+    outcome = session.solve(request)
+    assert isinstance(outcome, libmambapy.solver.Solution)
+    assert len(outcome.actions) == 0
+
+    outcome = session.solve(request)
+    assert isinstance(outcome, libmambapy.solver.Solution)
+    assert session.whatprovides_build_count == 2
+    assert session.job_cache_hit_count == 2
+
+    session.invalidate()
+    outcome = session.solve(request)
+    assert session.whatprovides_build_count == 3
@@ -30,6 +30,15 @@ init_rc_options(CLI::App* subcom, Configuration& config)
 
     auto& no_env = config.at("no_env");
     subcom->add_flag("--no-env", no_env.get_cli_config<bool>(), no_env.description())->group(cli_group);
+
+    auto& no_rc_snapshot = config.at("no_rc_snapshot");
+    subcom
+        ->add_flag(
+            "--no-rc-snapshot",
+            no_rc_snapshot.get_cli_config<bool>(),
+            no_rc_snapshot.description()
+        )
+        ->group(cli_group);
 }
 
 void
@@ -88,6 +97,16 @@ init_general_options(CLI::App* subcom, Configuration& config)
         ->add_flag("--experimental", experimental.get_cli_config<bool>(), experimental.description())
         ->group(cli_group);
 
+    auto& trace_file = config.at("trace_file");
+    subcom
+        ->add_option(
+            "--trace-file",
+            trace_file.get_cli_config<std::string>(),
+            trace_file.description()
+        )
+        ->option_text("FILE")
+        ->group(cli_group);
+
     auto& use_uv = config.at("use_uv");
     subcom->add_flag("--use-uv", use_uv.get_cli_config<bool>(), use_uv.description())->group(cli_group);
 
@@ -0,0 +1,89 @@
+// Copyright (c) 2023, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <chrono>
+#include <cstdint>
+
+#include "mamba/api/configuration.hpp"
+#include "mamba/core/package_cache.hpp"
+#include "mamba/download/coordinator.hpp"
+
+#include "common_options.hpp"
+
+using namespace mamba;  // NOLINT(build/namespaces)
+
+void
+set_fetch_coordinator_command(CLI::App* subcom, Configuration& config)
+{
+    init_general_options(subcom, config);
+
+    static std::string socket_path;
+    subcom
+        ->add_option(
+            "--socket",
+            socket_path,
+            "Unix socket to listen on (default is the `download_coordinator` setting)"
+        )
+        ->option_text("PATH");
+
+    const auto default_limits = download::StagingLimits{};
+    static std::size_t max_staging_size_mb = default_limits.max_size >> 20;
+    subcom
+        ->add_option(
+            "--max-staging-size",
+            max_staging_size_mb,
+            "Size of the downloaded packages kept to be served again, in MiB"
+        )
+        ->option_text("MIB");
+    static std::int64_t max_staging_age_s = default_limits.max_age.count();
+    subcom
+        ->add_option(
+            "--max-staging-age",
+            max_staging_age_s,
+            "Time after which a package that is not requested again is removed, in seconds"
+        )
+        ->option_text("SECONDS");
+
+    subcom->callback(
+        [&]
+        {
+            auto& ctx = config.context();
+            config.at("use_target_prefix_fallback").set_value(true);
+            config.at("use_default_prefix_fallback").set_value(true);
+            config.at("use_root_prefix_fallback").set_value(true);
+            config.load();
+
+            if (!download::FetchCoordinator::is_supported())
+            {
+                throw std::runtime_error("The fetch coordinator is not supported on this platform");
+            }
+            const fs::u8path socket = socket_path.empty() ? ctx.download_coordinator : socket_path;
+            if (socket.empty())
+            {
+                throw std::runtime_error("No socket given with --socket or `download_coordinator`");
+            }
+
+            // Staged in the package cache, where the packages are copied
+            MultiPackageCache caches(ctx.pkgs_dirs, ctx.validation_params);
+            const fs::u8path pkgs_dir = caches.first_writable_path();
+            if (pkgs_dir.empty())
+            {
+                throw std::runtime_error("No writable package cache to stage the downloads");
+            }
+
+            download::FetchCoordinator coordinator(
+                socket,
+                pkgs_dir / "cache" / "fetch_coordinator",
+                ctx.remote_fetch_params,
+                ctx.authentication_info(),
+                ctx.download_options(),
+                { max_staging_size_mb << 20, std::chrono::seconds(max_staging_age_s) }
+            );
+            Console::stream() << "Fetch coordinator listening on " << socket.string() << std::endl;
+            coordinator.serve();
+        }
+    );
+}
@@ -22,6 +22,7 @@
 #include "mamba/core/execution.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/thread_utils.hpp"
+#include "mamba/core/tracing.hpp"
 #include "mamba/core/util_os.hpp"
 #include "mamba/version.hpp"
 
@@ -109,6 +110,11 @@ main(int argc, char** argv)
         set_sig_interrupted();
     }
 
+    if (!ctx.trace_file.empty() && tracing::is_tracing_enabled())
+    {
+        tracing::write_trace(ctx.trace_file);
+    }
+
     reset_console();
 
     if (error_to_report)
@@ -165,6 +165,13 @@ set_run_command(CLI::App* subcom, Configuration& config)
     static bool clean_env = false;
     subcom->add_flag("--clean-env", clean_env, "Start with a clean environment");
 
+    static bool exec = false;
+    subcom->add_flag(
+        "--exec",
+        exec,
+        "Replace this process with the command instead of running it as a child process. Ignored with --detach or --label"
+    );
+
     static std::vector<std::string> env_vars;
     subcom->add_option("-e,--env", env_vars, "Add env vars with -e ENVVAR or -e ENVVAR=VALUE")
         ->option_text("ENVVAR")
@@ -230,6 +237,21 @@ set_run_command(CLI::App* subcom, Configuration& config)
                 return ctx.prefix_params.root_prefix;
             };
 
+            if (exec && !detach && specific_process_name.empty())
+            {
+                // Only returns if the command could not be executed
+                const int exit_code = mamba::exec_in_environment(
+                    config.context(),
+                    get_prefix(),
+                    raw_command,
+                    cwd,
+                    stream_options,
+                    clean_env,
+                    env_vars
+                );
+                exit(exit_code);
+            }
+
             int exit_code = mamba::run_in_environment(
                 config.context(),
                 get_prefix(),
@@ -105,6 +105,12 @@ set_umamba_command(CLI::App* com, mamba::Configuration& config)
     CLI::App* auth_subcom = com->add_subcommand("auth", "Login or logout of a given host");
     set_auth_command(auth_subcom);
 
+    CLI::App* fetch_coordinator_subcom = com->add_subcommand(
+        "fetch-coordinator",
+        "Download packages and indexes on behalf of the processes of this host"
+    );
+    set_fetch_coordinator_command(fetch_coordinator_subcom, config);
+
     CLI::App* search_subcom = com->add_subcommand(
         "search",
         "Find packages in active environment or channels\n"
@@ -28,6 +28,9 @@ set_constructor_command(CLI::App* subcom, mamba::Configuration& config);
 void
 set_create_command(CLI::App* subcom, mamba::Configuration& config);
 
+void
+set_fetch_coordinator_command(CLI::App* subcom, mamba::Configuration& config);
+
 void
 set_info_command(CLI::App* subcom, mamba::Configuration& config);
 
@@ -25,6 +25,8 @@ class ChannelHandler(http.server.SimpleHTTPRequestHandler):
             channel = channels[channel_name]
             self.directory = channel["directory"]
             auth = channel["auth"]
+            if channel["flaky"] and self.path.endswith((".tar.bz2", ".conda")):
+                return self.flaky_do_GET()
             if auth == "none":
                 return super().do_GET()
             elif auth == "basic":
@@ -39,6 +41,50 @@ class ChannelHandler(http.server.SimpleHTTPRequestHandler):
 
         self.send_response(404)
 
+    interrupted_paths = set()
+
+    def flaky_do_GET(self) -> None:
+        """Cut the first full transfer of a package halfway, and serve byte ranges."""
+        path = self.translate_path(self.path)
+        if not os.path.isfile(path):
+            self.send_error(404)
+            return
+        with open(path, "rb") as f:
+            content = f.read()
+        etag = f'"{os.stat(path).st_mtime_ns:x}-{len(content):x}"'
+
+        range_header = self.headers.get("Range", "")
+        match = re.match(r"^bytes=(\d+)-(\d*)$", range_header)
+        is_range = match is not None and self.headers.get("If-Range", etag) == etag
+        if is_range:
+            print(f"Range request: {self.path} {range_header}")
+            start = int(match.group(1))
+            end = min(int(match.group(2) or len(content) - 1), len(content) - 1)
+            if start > end:
+                self.send_response(416)
+                self.send_header("Content-Range", f"bytes */{len(content)}")
+                self.end_headers()
+                return
+            self.send_response(206)
+            self.send_header("Content-Range", f"bytes {start}-{end}/{len(content)}")
+        else:
+            start, end = 0, len(content) - 1
+            self.send_response(200)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Content-Length", str(end + 1 - start))
+        self.send_header("Accept-Ranges", "bytes")
+        self.send_header("ETag", etag)
+        self.end_headers()
+
+        if not is_range and self.path not in self.interrupted_paths:
+            self.interrupted_paths.add(self.path)
+            print(f"Interrupting transfer: {self.path}")
+            self.wfile.write(content[: len(content) // 2])
+            self.wfile.flush()
+            self.close_connection = True
+            return
+        self.wfile.write(content[start : end + 1])
+
     def basic_do_HEAD(self) -> None:
         self.send_response(200)
         self.send_header("Content-type", "text/html")
@@ -144,6 +190,11 @@ channel_parser.add_argument(
     default=None,
     help="Use token as API Key",
 )
+channel_parser.add_argument(
+    "--flaky",
+    action="store_true",
+    help="Interrupt the first transfer of every package and support range requests",
+)
 
 
 # Global args can be given anywhere with the first set of args for backward compatibility.
@@ -0,0 +1,76 @@
+from pathlib import Path
+
+import pytest
+
+from .test_login import create, reposerver_single
+
+
+@pytest.fixture
+def flaky_server(xprocess):
+    yield from reposerver_single(xprocess, auth="none", flaky=True)
+
+
+def test_resume_interrupted_download(flaky_server, xprocess, tmp_path):
+    env_folder = tmp_path / "env"
+    root_folder = tmp_path / "root"
+
+    create("-c", flaky_server, "_r-mutex", folder=env_folder, root=root_folder)
+
+    assert (env_folder / "conda-meta" / "_r-mutex-1.0.1-anacondar_1.json").exists()
+    pkgs_dir = root_folder / "pkgs"
+    assert not list(pkgs_dir.glob("*.partial"))
+    assert not list(pkgs_dir.glob("*.partial.json"))
+
+    log = Path(xprocess.getinfo("reposerver").logpath).read_text()
+    assert "Interrupting transfer: /noarch/_r-mutex-1.0.1-anacondar_1.tar.bz2" in log
+    assert "Range request: /noarch/_r-mutex-1.0.1-anacondar_1.tar.bz2 bytes=1783-" in log
+
+
+def test_chunked_download(flaky_server, xprocess, tmp_path, monkeypatch):
+    env_folder = tmp_path / "env"
+    root_folder = tmp_path / "root"
+    monkeypatch.setenv("MAMBA_DOWNLOAD_CHUNK_MIN_SIZE", "1000")
+    monkeypatch.setenv("MAMBA_DOWNLOAD_THREADS", "4")
+
+    create("-c", flaky_server, "_r-mutex", folder=env_folder, root=root_folder)
+
+    assert (env_folder / "conda-meta" / "_r-mutex-1.0.1-anacondar_1.json").exists()
+
+    # The package of 3566 bytes is split into 4 chunks
+    log = Path(xprocess.getinfo("reposerver").logpath).read_text()
+    pkg = "/noarch/_r-mutex-1.0.1-anacondar_1.tar.bz2"
+    for byte_range in ["0-890", "891-1781", "1782-2672", "2673-3565"]:
+        assert f"Range request: {pkg} bytes={byte_range}" in log
+
+
+@pytest.fixture
+def plain_server(xprocess):
+    yield from reposerver_single(xprocess, auth="none")
+
+
+def test_index_without_zst(plain_server, xprocess, tmp_path):
+    root_folder = tmp_path / "root"
+    log_path = Path(xprocess.getinfo("reposerver").logpath)
+
+    offset = len(log_path.read_text())
+    create("-c", plain_server, "_r-mutex", folder=tmp_path / "env", root=root_folder)
+    log = log_path.read_text()[offset:]
+
+    # The zst index is directly requested instead of being checked first
+    assert '"HEAD ' not in log
+    assert '"GET /noarch/repodata.json.zst HTTP/1.1" 404' in log
+    assert '"GET /noarch/repodata.json HTTP/1.1" 200' in log
+
+    # Its absence is remembered when revalidating the index
+    offset = len(log_path.read_text())
+    create(
+        "-c",
+        plain_server,
+        "_r-mutex",
+        "--repodata-ttl=0",
+        folder=tmp_path / "env2",
+        root=root_folder,
+    )
+    log = log_path.read_text()[offset:]
+    assert "repodata.json.zst" not in log
+    assert '"GET /noarch/repodata.json HTTP/1.1"' in log
@@ -53,8 +53,10 @@ def reposerver_multi(
                 "--password",
                 channel["password"],
             ]
-        else:
+        elif auth != "none":
             raise ValueError("Wrong authentication method")
+        if channel.get("flaky", False):
+            computed_args += ["--flaky"]
         computed_args += ["--"]
 
     class Starter(ProcessStarter):